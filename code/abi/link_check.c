@@ -0,0 +1,326 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/framework.h"
+#include <stdio.h>
+
+/*
+ * Link check for the public C API: every function declared in the
+ * framework headers is referenced here, so a declaration without an
+ * implementation fails the build instead of the first caller. Inline
+ * helpers and the flag-gated instrumentation hooks are left out; the C++
+ * wrappers are checked by link_check.cpp.
+ */
+
+typedef void (*api_fn)(void);
+
+#define API(f) { #f, (api_fn)f }
+
+static const struct {
+    const char* name;
+    api_fn fn;
+} g_api[] = {
+    /* quizzed.h */
+    API(fossil_game_quizzed_create),
+    API(fossil_game_quizzed_remove),
+    API(fossil_game_quizzed_add_question),
+    API(fossil_game_quizzed_add_option),
+    API(fossil_game_quizzed_remove_question),
+    API(fossil_game_quizzed_ai_generate),
+    API(fossil_game_quizzed_ask),
+    API(fossil_game_quizzed_options),
+    API(fossil_game_quizzed_answer),
+    API(fossil_game_quizzed_score),
+    API(fossil_game_quizzed_reset),
+    /* multiplayer.h */
+    API(fossil_game_multiplayer_set_transport),
+    API(fossil_game_multiplayer_create_session),
+    API(fossil_game_multiplayer_destroy_session),
+    API(fossil_game_multiplayer_join),
+    API(fossil_game_multiplayer_leave),
+    API(fossil_game_multiplayer_broadcast),
+    API(fossil_game_multiplayer_send),
+    API(fossil_game_multiplayer_set_cell_size),
+    API(fossil_game_multiplayer_set_position),
+    API(fossil_game_multiplayer_clear_position),
+    API(fossil_game_multiplayer_broadcast_radius),
+    API(fossil_game_multiplayer_broadcast_near),
+    API(fossil_game_multiplayer_broadcast_cells),
+    API(fossil_game_multiplayer_query_radius),
+    API(fossil_game_multiplayer_poll),
+    API(fossil_game_multiplayer_pending),
+    API(fossil_game_multiplayer_dropped),
+    /* player.h */
+    API(fossil_game_player_create),
+    API(fossil_game_player_remove),
+    API(fossil_game_player_destroy),
+    API(fossil_game_player_set_attr),
+    API(fossil_game_player_get_attr),
+    API(fossil_game_player_set_int),
+    API(fossil_game_player_set_float),
+    API(fossil_game_player_set_string),
+    API(fossil_game_player_set_blob),
+    API(fossil_game_player_get_int),
+    API(fossil_game_player_get_float),
+    API(fossil_game_player_get_string),
+    API(fossil_game_player_get_blob),
+    API(fossil_game_player_attr_type),
+    API(fossil_game_player_unset_attr),
+    API(fossil_game_player_attr_key),
+    API(fossil_game_player_get_int_by_key),
+    API(fossil_game_player_set_int_by_key),
+    API(fossil_game_player_get_float_by_key),
+    API(fossil_game_player_set_float_by_key),
+    API(fossil_game_player_attr_foreach),
+    API(fossil_game_player_add_item),
+    API(fossil_game_player_remove_item),
+    API(fossil_game_player_has_item),
+    API(fossil_game_player_inventory_add),
+    API(fossil_game_player_inventory_remove),
+    API(fossil_game_player_inventory_count),
+    API(fossil_game_player_inventory_transfer),
+    API(fossil_game_player_inventory_trade),
+    API(fossil_game_player_inventory_begin),
+    API(fossil_game_player_inventory_next),
+    API(fossil_game_player_inventory_list),
+    API(fossil_game_player_query_holders),
+    API(fossil_game_player_query_tag),
+    API(fossil_game_player_join_session),
+    API(fossil_game_player_leave_session),
+    API(fossil_game_player_get_session),
+    API(fossil_game_player_session_count),
+    API(fossil_game_player_session_list),
+    API(fossil_game_player_evict_session),
+    API(fossil_game_player_enable_feature),
+    API(fossil_game_player_disable_feature),
+    API(fossil_game_player_has_feature),
+    API(fossil_game_player_enable_control),
+    API(fossil_game_player_disable_control),
+    API(fossil_game_player_npc_update),
+    API(fossil_game_player_inventory_foreach),
+    API(fossil_game_player_foreach_in_session),
+    API(fossil_game_player_handle),
+    /* clinker.h */
+    API(fossil_game_clinker_create),
+    API(fossil_game_clinker_destroy),
+    API(fossil_game_clinker_set_trait),
+    API(fossil_game_clinker_get_trait),
+    API(fossil_game_clinker_tick),
+    API(fossil_game_clinker_choose_action),
+    API(fossil_game_clinker_tick_all),
+    API(fossil_game_clinker_count),
+    API(fossil_game_clinker_start_action),
+    API(fossil_game_clinker_define_action),
+    API(fossil_game_clinker_add_consideration),
+    API(fossil_game_clinker_add_effect),
+    API(fossil_game_clinker_set_drift),
+    API(fossil_game_clinker_decide_all),
+    API(fossil_game_clinker_set_simd),
+    API(fossil_game_clinker_load_archetype),
+    API(fossil_game_clinker_load_archetype_file),
+    API(fossil_game_clinker_load_error),
+    API(fossil_game_clinker_enable_feature),
+    API(fossil_game_clinker_disable_feature),
+    API(fossil_game_clinker_has_feature),
+    API(fossil_game_clinker_query_feature),
+    /* session.h */
+    API(fossil_game_session_create),
+    API(fossil_game_session_destroy),
+    API(fossil_game_session_start),
+    API(fossil_game_session_stop),
+    API(fossil_game_session_tick),
+    API(fossil_game_session_add_player),
+    API(fossil_game_session_remove_player),
+    API(fossil_game_session_player_count),
+    API(fossil_game_session_ticks),
+    /* score.h */
+    API(fossil_game_score_update),
+    API(fossil_game_score_get),
+    API(fossil_game_score_reset),
+    API(fossil_game_score_handle),
+    API(fossil_game_score_get_by_handle),
+    API(fossil_game_score_leaderboard),
+    API(fossil_game_score_matchmaking),
+    API(fossil_game_score_define_achievement),
+    API(fossil_game_score_add_rule),
+    API(fossil_game_score_on_unlock),
+    API(fossil_game_score_add_achievement),
+    API(fossil_game_score_has_achievement),
+    API(fossil_game_score_achievement_count),
+    API(fossil_game_score_achievement_holders),
+    API(fossil_game_score_quiz_answer),
+    API(fossil_game_score_quiz_streak),
+    API(fossil_game_score_window_create),
+    API(fossil_game_score_window_destroy),
+    API(fossil_game_score_window_advance),
+    API(fossil_game_score_window_get),
+    API(fossil_game_score_window_rank),
+    API(fossil_game_score_window_count),
+    API(fossil_game_score_window_top),
+    API(fossil_game_score_rating_period),
+    API(fossil_game_score_rating_get),
+    API(fossil_game_score_rating_set),
+    API(fossil_game_score_rating_set_tau),
+    API(fossil_game_score_rating_matchmaking),
+    API(fossil_game_score_shard_export),
+    API(fossil_game_score_shard_merge),
+    API(fossil_game_score_merged_top),
+    API(fossil_game_score_merged_total),
+    API(fossil_game_score_merged_rank),
+    API(fossil_game_score_merged_free),
+    API(fossil_game_score_rank_estimate),
+    API(fossil_game_score_rank_of),
+    API(fossil_game_score_percentile),
+    API(fossil_game_scoreboard_submit),
+    API(fossil_game_scoreboard_join),
+    API(fossil_game_scoreboard_get),
+    API(fossil_game_scoreboard_rank),
+    API(fossil_game_scoreboard_leaderboard),
+    API(fossil_game_scoreboard_matchmake),
+    /* sync.h */
+    API(fossil_game_sync_capture),
+    API(fossil_game_sync_encode),
+    API(fossil_game_sync_ack),
+    API(fossil_game_sync_drop_client),
+    API(fossil_game_sync_release),
+    API(fossil_game_sync_mirror_create),
+    API(fossil_game_sync_mirror_free),
+    API(fossil_game_sync_apply),
+    API(fossil_game_sync_mirror_tick),
+    API(fossil_game_sync_mirror_count),
+    API(fossil_game_sync_mirror_score),
+    API(fossil_game_sync_mirror_item_count),
+    API(fossil_game_sync_mirror_attr),
+    API(fossil_game_sync_mirror_items),
+    API(fossil_game_sync_mirror_attrs),
+    /* feature.h */
+    API(fossil_game_feature_register),
+    API(fossil_game_feature_lookup),
+    API(fossil_game_feature_name),
+    API(fossil_game_feature_count),
+    /* item.h */
+    API(fossil_game_item_define),
+    API(fossil_game_item_load),
+    API(fossil_game_item_intern),
+    API(fossil_game_item_lookup),
+    API(fossil_game_item_name),
+    API(fossil_game_item_count),
+    API(fossil_game_item_stack_size),
+    API(fossil_game_item_has_tag),
+    API(fossil_game_item_tag_lookup),
+    API(fossil_game_item_tag_name),
+    API(fossil_game_item_tagged),
+    API(fossil_game_item_catalog_acquire),
+    API(fossil_game_item_catalog_release),
+    API(fossil_game_item_catalog_version),
+    API(fossil_game_item_catalog_get),
+    /* state.h */
+    API(fossil_game_state_save),
+    API(fossil_game_state_load),
+    API(fossil_game_state_save_background),
+    API(fossil_game_state_poll),
+    API(fossil_game_state_put_u64),
+    API(fossil_game_state_put_i64),
+    API(fossil_game_state_put_f64),
+    API(fossil_game_state_put_bytes),
+    API(fossil_game_state_put_str),
+    API(fossil_game_state_get_u64),
+    API(fossil_game_state_get_i64),
+    API(fossil_game_state_get_f64),
+    API(fossil_game_state_get_bytes),
+    API(fossil_game_state_get_str),
+    API(fossil_game_player_state_save),
+    API(fossil_game_player_state_load),
+    API(fossil_game_score_state_save),
+    API(fossil_game_score_state_load),
+    API(fossil_game_quizzed_state_save),
+    API(fossil_game_quizzed_state_load),
+    API(fossil_game_wal_state_save),
+    API(fossil_game_wal_state_load),
+    API(fossil_game_player_state_clear),
+    API(fossil_game_score_state_clear),
+    API(fossil_game_quizzed_state_clear),
+    /* wal.h */
+    API(fossil_game_wal_open),
+    API(fossil_game_wal_commit),
+    API(fossil_game_wal_close),
+    API(fossil_game_wal_replay),
+    API(fossil_game_wal_checkpoint),
+    API(fossil_game_wal_compact),
+    API(fossil_game_wal_lsn),
+    API(fossil_game_wal_record_player_create),
+    API(fossil_game_wal_record_player_remove),
+    API(fossil_game_wal_record_score_update),
+    API(fossil_game_wal_record_score_reset),
+    API(fossil_game_wal_record_scoreboard_join),
+    API(fossil_game_wal_record_inventory_add),
+    API(fossil_game_wal_record_inventory_remove),
+    API(fossil_game_wal_record_inventory_trade),
+    API(fossil_game_wal_record_quizzed_answer),
+    API(fossil_game_wal_record_quizzed_create),
+    API(fossil_game_wal_record_quizzed_remove),
+    API(fossil_game_wal_record_quizzed_question),
+    API(fossil_game_wal_record_quizzed_option),
+    API(fossil_game_wal_record_quizzed_remove_question),
+    API(fossil_game_wal_record_quizzed_reset),
+    /* metrics.h */
+    API(fossil_game_metrics_enable),
+    API(fossil_game_metrics_enabled),
+    API(fossil_game_metrics_set_sample),
+    API(fossil_game_metrics_snapshot_take),
+    API(fossil_game_metrics_reset),
+    API(fossil_game_metrics_api_name),
+    API(fossil_game_metrics_quantile),
+    API(fossil_game_metrics_export),
+    API(fossil_game_player_metrics_registry),
+    API(fossil_game_score_metrics_registry),
+    API(fossil_game_quizzed_metrics_registry),
+    API(fossil_game_session_metrics_registry),
+    API(fossil_game_clinker_metrics_registry),
+    /* trace.h */
+    API(fossil_game_trace_enable),
+    API(fossil_game_trace_enabled),
+    API(fossil_game_trace_frame_begin),
+    API(fossil_game_trace_frame_end),
+    API(fossil_game_trace_frame),
+    API(fossil_game_trace_set_budget),
+    API(fossil_game_trace_zone_begin),
+    API(fossil_game_trace_zone_end),
+    API(fossil_game_trace_export),
+    API(fossil_game_trace_dump),
+    API(fossil_game_trace_clear),
+};
+
+int main(void)
+{
+    size_t n=sizeof(g_api)/sizeof(g_api[0]);
+    for(size_t i=0;i<n;i++){
+        if(!g_api[i].fn){
+            fprintf(stderr,"unresolved: %s\n",g_api[i].name);
+            return 1;
+        }
+    }
+    printf("%zu public functions resolved\n",n);
+    return 0;
+}
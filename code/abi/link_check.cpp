@@ -0,0 +1,182 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/framework.h"
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * Link check for the C++ wrappers of player, score, quiz and the log: each wrapper
+ * member is called once on a small world, so a wrapper that names a
+ * missing C function fails the build, and one that calls the wrong one
+ * fails the run.
+ */
+
+static int g_failures=0;
+
+static void expect(bool ok,const char* what)
+{
+    if(!ok){
+        std::fprintf(stderr,"link_check: %s\n",what);
+        g_failures++;
+    }
+}
+
+static void check_player()
+{
+    fossil::game::Player p("lc_player");
+    expect(p.create()==0,"Player::create");
+    p.setAttr("title","knight");
+    expect(p.getAttr("title")!=nullptr,"Player::getAttr");
+    p.setInt("hp",42);
+    expect(p.getInt("hp")==42,"Player::getInt");
+    p.setFloat("speed",1.5);
+    expect(p.getFloat("speed")==1.5,"Player::getFloat");
+    p.addItem("lc_sword");
+    p.removeItem("lc_sword");
+    expect(p.itemCount("lc_sword")==0 && !p.hasItem("lc_sword"),"Player::itemCount");
+    p.enableFeature("lc_flag");
+    expect(p.hasFeature("lc_flag"),"Player::hasFeature");
+    p.disableFeature("lc_flag");
+    expect(p.destroy()==0,"Player::destroy");
+}
+
+static void check_score()
+{
+    fossil::game::Scoreboard b("lc_board");
+    expect(b.submit("lc_a",10)==0 && b.submit("lc_b",12)==0,"Scoreboard::submit");
+    expect(b.get("lc_a")==10,"Scoreboard::get");
+    expect(b.rank("lc_b")>=1,"Scoreboard::rank");
+    const char* top=b.leaderboard();
+    expect(top && std::string_view(top)=="lc_b","Scoreboard::leaderboard");
+    const char* match=b.matchmake("lc_a");
+    expect(match && std::string_view(match)=="lc_b","Scoreboard::matchmake");
+
+    using fossil::game::Achievements;
+    expect(Achievements::define("lc_ach")>=0,"Achievements::define");
+    expect(Achievements::rule("lc_ach",FOSSIL_GAME_SCORE_RULE_SCORE,1000)==0,"Achievements::rule");
+    expect(Achievements::grant("lc_a","lc_ach")==0 && Achievements::has("lc_a","lc_ach"),"Achievements::grant");
+    expect(Achievements::count("lc_a")==1 && Achievements::holders("lc_ach")==1,"Achievements::count");
+
+    long long rank=0;
+    double top_share=0;
+    using fossil::game::ScoreRank;
+    expect(ScoreRank::estimate("lc_a",&rank)==0 && ScoreRank::of(12,&rank)==0,"ScoreRank::estimate");
+    expect(ScoreRank::percentile("lc_a",&top_share)==0,"ScoreRank::percentile");
+
+    fossil::game::ScoreWindow w("lc_window");
+    fossil::game::ScoreWindow::advance(0);
+    expect(w.create(0,60,4)==0,"ScoreWindow::create");
+    expect(fossil_game_score_update("lc_a",3)==0,"score_update");
+    long long got=0;
+    int wrank=0,n=0;
+    const char* ids[4];
+    long long scores[4];
+    expect(w.get("lc_a",&got)==0 && got==3,"ScoreWindow::get");
+    expect(w.rank("lc_a",&wrank)==0 && w.top(ids,scores,4,&n)==0,"ScoreWindow::rank");
+
+    using fossil::game::Rating;
+    fossil_game_score_match_result r={ "lc_a","lc_b",1.0 };
+    double mu,phi,sigma;
+    char** opponents=nullptr;
+    expect(Rating::set("lc_a",1500,200,0.06)==0 && Rating::period(&r,1)==0,"Rating::period");
+    expect(Rating::get("lc_a",&mu,&phi,&sigma)==0 && mu>1500,"Rating::get");
+    expect(Rating::matchmaking("lc_a",2.0,&opponents,&n)==0,"Rating::matchmaking");
+    std::free(opponents);
+
+    unsigned char* blob=nullptr;
+    size_t len=0;
+    expect(fossil::game::ScoreMerge::exportShard("lc_board",8,&blob,&len)==0,"ScoreMerge::exportShard");
+    const unsigned char* exports[1]={ blob };
+    fossil::game::ScoreMerge m(exports,&len,1,8);
+    expect(m.ok() && m.total()==2 && m.top(ids,scores,4,&n)==0 && m.rank(12,&rank)==0,"ScoreMerge");
+    std::free(blob);
+}
+
+static void check_quiz()
+{
+    fossil::game::Quizzed q("lc_quiz");
+    expect(q.create()==0,"Quizzed::create");
+    expect(q.addQuestion("q1","Two plus two?")==0,"Quizzed::addQuestion");
+    expect(q.addOption("q1","a","3")==0 && q.addOption("q1","b","4",true)==0,"Quizzed::addOption");
+    const char* text=q.ask("lc_a");
+    expect(text && std::string_view(text)=="Two plus two?","Quizzed::ask");
+    q.answer("lc_a","b");
+    expect(q.score("lc_a")==1,"Quizzed::score");
+    expect(q.reset("lc_a")==0 && q.score("lc_a")==0,"Quizzed::reset");
+}
+
+static void check_wal()
+{
+    using fossil::game::WriteAheadLog;
+    {
+        WriteAheadLog log("lc_check.wal");
+        expect(log.ok() && log.commit()==0,"WriteAheadLog::ok");
+        {
+            WriteAheadLog other("lc_check.wal");
+            expect(!other.ok() && other.error()==-5,"WriteAheadLog::error");
+        }
+        /* the second instance did not own the log, so it is still open */
+        expect(log.commit()==0,"WriteAheadLog owner");
+    }
+    expect(fossil_game_wal_commit()==-1,"~WriteAheadLog");
+    std::remove("lc_check.wal");
+}
+
+static void check_cxx()
+{
+    using namespace fossil::game::cxx;
+    auto p=Player::create("lc_cxx");
+    expect(p.has_value() && p->setInt("hp",7).has_value() && p->getInt("hp").value_or(0)==7,"cxx::Player");
+    expect(p->addItem("lc_gem",2).has_value() && p->inventory().has_value(),"cxx::Player::inventory");
+
+    ScoreDelta deltas[]={ { "lc_cxx",5 },{ "lc_a",1 } };
+    expect(Score::update(deltas).has_value() && Score::get("lc_cxx").value_or(0)==5,"cxx::Score::update");
+    ScoreDelta entries[]={ { "lc_c1",5 },{ "lc_c2",9 } };
+    expect(Scoreboard::submit("lc_cxx_board",entries).has_value(),"cxx::Scoreboard::submit");
+    expect(Scoreboard::get("lc_cxx_board","lc_c1").value_or(0)==5,"cxx::Scoreboard::get");
+    expect(Scoreboard::leader("lc_cxx_board").value_or("")=="lc_c2","cxx::Scoreboard::leader");
+    expect(Scoreboard::matchmake("lc_cxx_board","lc_c2").value_or("")=="lc_c1","cxx::Scoreboard::matchmake");
+    expect(Score::leaderboard().has_value(),"cxx::Score::leaderboard");
+
+    Quiz q("lc_quiz");
+    auto opts=q.options("lc_cxx");
+    expect(opts.has_value() && opts->size()==2,"cxx::Quiz::options");
+    QuizAnswer answers[]={ { "lc_cxx","b" } };
+    expect(q.answer(answers).has_value() && q.score("lc_cxx").value_or(0)==1,"cxx::Quiz::answer");
+    expect(p->destroy().has_value(),"cxx::Player::destroy");
+}
+
+int main()
+{
+    check_player();
+    check_score();
+    check_quiz();
+    check_wal();
+    check_cxx();
+
+    if(g_failures) return 1;
+    std::printf("C++ wrappers resolved\n");
+    return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/clinker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * NPC engine throughput: per-NPC ticks through the id lookup against one
+ * batched tick_all over the archetype, utility decisions per second for
+ * each SIMD path the CPU supports, feature mask scans, then a
+ * behavior-tree archetype.
+ *
+ *   fossil_game_bench_clinker [npcs] [ticks]
+ */
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec/1e9;
+}
+
+int main(int argc,char** argv)
+{
+    int npcs=argc>1?atoi(argv[1]):100000;
+    int ticks=argc>2?atoi(argv[2]):100;
+
+    char** ids=malloc(sizeof(char*)*(size_t)npcs);
+    if(!ids) return 1;
+
+    for(int i=0;i<npcs;i++){
+        ids[i]=malloc(32);
+        snprintf(ids[i],32,"npc_%d",i);
+        fossil_game_clinker_create(ids[i],"villager");
+        if(i%3==0) fossil_game_clinker_start_action(ids[i],"wander",5+i%20);
+    }
+
+    double t0=now_s();
+    for(int t=0;t<ticks;t++)
+        for(int i=0;i<npcs;i++)
+            fossil_game_clinker_tick(ids[i]);
+    double single=now_s()-t0;
+
+    t0=now_s();
+    for(int t=0;t<ticks;t++)
+        fossil_game_clinker_tick_all("villager");
+    double batched=now_s()-t0;
+
+    double per=(double)npcs*ticks;
+    printf("clinker: npcs=%d ticks=%d\n",npcs,ticks);
+    printf("  tick(id)        : %.2f ns/npc  (%.1f%% of a 10 Hz core)\n",
+           single/per*1e9,single/ticks*10*100);
+    printf("  tick_all        : %.2f ns/npc  (%.3f%% of a 10 Hz core)\n",
+           batched/per*1e9,batched/ticks*10*100);
+
+    /* 8 actions x 2 considerations over 4 traits */
+    static const char* traits[]={"hunger","energy","fear","greed"};
+    static const char* actions[]={"eat","sleep","flee","trade","wander","guard","gossip","work"};
+    char value[32];
+
+    for(int i=0;i<npcs;i++){
+        snprintf(ids[i],32,"mind_%d",i);
+        fossil_game_clinker_create(ids[i],"thinker");
+        for(int t=0;t<4;t++){
+            snprintf(value,sizeof(value),"%.3f",(double)rand()/RAND_MAX);
+            fossil_game_clinker_set_trait(ids[i],traits[t],value);
+        }
+    }
+    for(int a=0;a<8;a++){
+        fossil_game_clinker_define_action("thinker",actions[a],1.0f-a*0.05f,10);
+        fossil_game_clinker_add_consideration("thinker",actions[a],traits[a%4],
+            FOSSIL_GAME_CLINKER_CURVE_LOGISTIC,1.0f,8.0f,0.0f,0.5f);
+        fossil_game_clinker_add_consideration("thinker",actions[a],traits[(a+1)%4],
+            a%2?FOSSIL_GAME_CLINKER_CURVE_QUADRATIC:FOSSIL_GAME_CLINKER_CURVE_LINEAR,
+            a%2?-1.0f:1.0f,0.0f,a%2?1.0f:0.2f,0.0f);
+    }
+
+    static const char* names[]={"scalar","sse2","avx2"};
+    int top=fossil_game_clinker_set_simd(FOSSIL_GAME_CLINKER_SIMD_AVX2);
+    for(int level=0;level<=top;level++){
+        fossil_game_clinker_set_simd(level);
+        fossil_game_clinker_decide_all("thinker");
+
+        t0=now_s();
+        for(int t=0;t<ticks;t++)
+            fossil_game_clinker_decide_all("thinker");
+        double dt=now_s()-t0;
+
+        printf("  decide %-8s : %.1f M decisions/s (%.2f ns/npc, 8 actions)\n",
+               names[level],per/dt/1e6,dt/per*1e9);
+    }
+
+    /* sparse feature: 1 in 100 thinkers */
+    for(int i=0;i<npcs;i+=100)
+        fossil_game_clinker_enable_feature(ids[i],"glow");
+    const char** found=malloc(sizeof(char*)*(size_t)(npcs/100+1));
+    int hits=0;
+    for(int level=0;level<=top&&found;level++){
+        fossil_game_clinker_set_simd(level);
+
+        t0=now_s();
+        for(int t=0;t<ticks;t++)
+            fossil_game_clinker_query_feature("thinker","glow",found,npcs/100+1,&hits);
+        double dt=now_s()-t0;
+
+        printf("  feature %-7s : %.3f ns/npc scanned (%d hits)\n",names[level],dt/per*1e9,hits);
+    }
+    free(found);
+    fossil_game_clinker_set_simd(-1);
+
+    /* behavior tree over the thinker's traits, short actions so most NPCs re-plan often */
+    fossil_game_clinker_load_archetype("sentry",
+        "selector\n"
+        "  sequence\n"
+        "    condition fear > 0.8\n"
+        "    action flee 2\n"
+        "  sequence\n"
+        "    condition hunger > 0.6\n"
+        "    invert\n"
+        "      condition energy < 0.2\n"
+        "    action eat 3\n"
+        "  sequence\n"
+        "    condition greed >= 0.5\n"
+        "    action trade 1\n"
+        "  wait 2\n");
+    char sentry[32];
+    for(int i=0;i<npcs;i++){
+        snprintf(sentry,sizeof(sentry),"sentry_%d",i);
+        fossil_game_clinker_create(sentry,"sentry");
+        for(int t=0;t<4;t++){
+            snprintf(value,sizeof(value),"%.3f",(double)rand()/RAND_MAX);
+            fossil_game_clinker_set_trait(sentry,traits[t],value);
+        }
+    }
+
+    t0=now_s();
+    for(int t=0;t<ticks;t++)
+        fossil_game_clinker_tick_all("sentry");
+    double tree=now_s()-t0;
+    printf("  tick_all (tree) : %.2f ns/npc\n",tree/per*1e9);
+
+    for(int i=0;i<npcs;i++){
+        snprintf(sentry,sizeof(sentry),"sentry_%d",i);
+        fossil_game_clinker_destroy(sentry);
+        fossil_game_clinker_destroy(ids[i]);
+        snprintf(ids[i],32,"npc_%d",i);
+        fossil_game_clinker_destroy(ids[i]);
+        free(ids[i]);
+    }
+    free(ids);
+    return 0;
+}
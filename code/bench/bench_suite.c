@@ -0,0 +1,538 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#define FOSSIL_GAME_FAST_PATH
+
+#include "fossil/game/clinker.h"
+#include "fossil/game/item.h"
+#include "fossil/game/player.h"
+#include "fossil/game/quizzed.h"
+#include "fossil/game/score.h"
+#include "fossil/game/session.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Benchmark suite for the player, score and quiz hot paths. Every
+ * microbenchmark and scenario runs at each population size; populations
+ * grow in place from one size to the next, so the registries hold exactly
+ * that many players when a size is measured.
+ *
+ *   fossil_game_bench [--sizes 1k,100k,1M] [--filter NAME] [--text] [--no-limits]
+ *
+ * Output is one JSON document on stdout (or a table with --text) so runs can
+ * be diffed release to release. Microbenchmarks report the best and median
+ * of three timed passes. Benchmarks whose current implementation scales
+ * quadratically are capped (see LIMIT_*) and report "skipped" past the cap
+ * unless --no-limits is given.
+ */
+
+#define PASSES 3
+#define MICRO_OPS 200000
+#define SESSION_MEMBERS 10000
+#define SESSION_SIZE 100
+#define SESSION_TICKS 20
+#define QUIZ_QUESTIONS 10
+#define QUIZ_OPTIONS 4
+
+/* leaderboards populate with a linear duplicate check, quizzes find players by linear scan */
+#define LIMIT_LEADERBOARD 20000
+#define LIMIT_QUIZ 10000
+
+typedef struct {
+    const char* filter;
+    int text;
+    int no_limits;
+    int first;                  /* no result emitted yet */
+} options_t;
+
+static options_t g_opt;
+static char (*g_ids)[24];
+static uint32_t* g_order;       /* random player indices, one per op */
+static uint32_t* g_score_handles;
+static const fossil_game_player_view** g_views;
+static volatile long g_sink;    /* keeps timed reads from being optimized out */
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec/1e9;
+}
+
+static int selected(const char* name)
+{
+    return !g_opt.filter||strstr(name,g_opt.filter)!=NULL;
+}
+
+static int cmp_double(const void* a,const void* b)
+{
+    double x=*(const double*)a,y=*(const double*)b;
+    return x<y?-1:x>y;
+}
+
+/* extra is a JSON fragment (without braces) appended to the result object */
+static void emit(const char* name,const char* kind,int population,long ops,double best,double median,const char* extra)
+{
+    if(g_opt.text){
+        printf("  %-24s %-8s %9d %12.1f ns/op %12.1f ns/op (median)%s%s\n",
+               name,kind,population,best*1e9/(double)ops,median*1e9/(double)ops,
+               extra?"  ":"",extra?extra:"");
+        return;
+    }
+
+    printf("%s\n    {\"name\":\"%s\",\"kind\":\"%s\",\"population\":%d,\"ops\":%ld,"
+           "\"ns_per_op\":%.2f,\"ns_per_op_median\":%.2f%s%s}",
+           g_opt.first?"":",",name,kind,population,ops,
+           best*1e9/(double)ops,median*1e9/(double)ops,extra?",":"",extra?extra:"");
+    g_opt.first=0;
+}
+
+static void skip(const char* name,const char* kind,int population,int limit)
+{
+    if(g_opt.text){
+        printf("  %-24s %-8s %9d skipped (limit %d)\n",name,kind,population,limit);
+        return;
+    }
+
+    printf("%s\n    {\"name\":\"%s\",\"kind\":\"%s\",\"population\":%d,\"skipped\":true,\"limit\":%d}",
+           g_opt.first?"":",",name,kind,population,limit);
+    g_opt.first=0;
+}
+
+/* ============================================================
+   Microbenchmarks
+   ============================================================ */
+
+typedef void (*op_fn)(long i,void* ctx);
+
+static void micro(const char* name,int population,long ops,op_fn fn,void* ctx)
+{
+    if(!selected(name)) return;
+
+    double t[PASSES];
+    for(int p=0;p<PASSES;p++){
+        double t0=now_s();
+        for(long i=0;i<ops;i++) fn(i,ctx);
+        t[p]=now_s()-t0;
+    }
+
+    qsort(t,PASSES,sizeof(double),cmp_double);
+    emit(name,"micro",population,ops,t[0],t[PASSES/2],NULL);
+}
+
+#define ID(i) g_ids[g_order[(i)%MICRO_OPS]]
+
+static void op_lookup(long i,void* ctx)       { (void)ctx; fossil_game_player_get_session(ID(i)); }
+static void op_attr_set(long i,void* ctx)     { (void)ctx; fossil_game_player_set_int(ID(i),"hp",i); }
+static void op_attr_get(long i,void* ctx)     { int64_t v; (void)ctx; fossil_game_player_get_int(ID(i),"hp",&v); }
+static void op_attr_get_key(long i,void* ctx) { int64_t v; fossil_game_player_get_int_by_key(ID(i),*(int*)ctx,&v); }
+static void op_inv_add(long i,void* ctx)      { (void)ctx; fossil_game_player_inventory_add(ID(i),"ore",1); }
+static void op_inv_remove(long i,void* ctx)   { (void)ctx; fossil_game_player_inventory_remove(ID(i),"ore",1); }
+static void op_score_update(long i,void* ctx) { (void)ctx; fossil_game_score_update(ID(i),1); }
+
+static void op_rank_estimate(long i,void* ctx)
+{
+    long long rank;
+    (void)ctx;
+    fossil_game_score_rank_estimate(ID(i),&rank,NULL);
+}
+
+static void op_leaderboard(long i,void* ctx)
+{
+    const char** ids=NULL;
+    int n=0;
+    (void)i;
+    fossil_game_score_leaderboard((const char*)ctx,&ids,&n);
+    free((void*)ids);
+}
+
+static void op_matchmaking(long i,void* ctx)
+{
+    char** ids=NULL;
+    int n=0;
+    (void)ctx;
+    fossil_game_score_matchmaking(ID(i),&ids,&n);
+    free(ids);
+}
+
+static void op_rating_matchmaking(long i,void* ctx)
+{
+    char** ids=NULL;
+    int n=0;
+    (void)ctx;
+    fossil_game_score_rating_matchmaking(ID(i),1.0,&ids,&n);
+    free(ids);
+}
+
+static void op_shard_export(long i,void* ctx)
+{
+    unsigned char* buf=NULL;
+    size_t len=0;
+    (void)i; (void)ctx;
+    fossil_game_score_shard_export(NULL,100,&buf,&len);
+    free(buf);
+}
+
+/*
+ * Hot reads, by id through the library and through handles with the
+ * inline fast path. The loops are written out rather than run through
+ * micro() so the inline reads are not measured behind an indirect call.
+ * Every other player holds a gem.
+ */
+#define TIMED_READ(name,population,expr) do{                    \
+        if(!selected(name)) break;                              \
+        double t_[PASSES];                                      \
+        for(int p_=0;p_<PASSES;p_++){                           \
+            long sum=0;                                         \
+            double t0_=now_s();                                 \
+            for(long i=0;i<MICRO_OPS;i++){ long k=g_order[i]; sum+=(expr); } \
+            t_[p_]=now_s()-t0_;                                 \
+            g_sink+=sum;                                        \
+        }                                                       \
+        qsort(t_,PASSES,sizeof(double),cmp_double);             \
+        emit(name,"micro",population,MICRO_OPS,t_[0],t_[PASSES/2],NULL); \
+    }while(0)
+
+static int score_by_id(const char* id)
+{
+    int v=0;
+    fossil_game_score_get(id,&v);
+    return v;
+}
+
+static int score_by_handle(uint32_t h)
+{
+    int v=0;
+    fossil_game_score_get_by_handle(h,&v);
+    return v;
+}
+
+static void bench_reads(int prev,int population)
+{
+    for(int i=prev;i<population;i++){
+        if(i%2==0) fossil_game_player_inventory_add(g_ids[i],"gem",1);
+        fossil_game_score_handle(g_ids[i],&g_score_handles[i]);
+        g_views[i]=fossil_game_player_handle(g_ids[i]);
+    }
+    int gem=fossil_game_item_lookup("gem");
+
+    TIMED_READ("score_get",population,score_by_id(g_ids[k]));
+    TIMED_READ("score_get_handle",population,score_by_handle(g_score_handles[k]));
+    TIMED_READ("score_get_fast",population,fossil_game_score_fast_get(g_score_handles[k]));
+    TIMED_READ("has_item",population,fossil_game_player_has_item(g_ids[k],"gem"));
+    TIMED_READ("has_item_fast",population,fossil_game_player_fast_has_item(g_views[k],gem));
+}
+
+/* One rating period of MICRO_OPS results between neighbours in the visiting order */
+static void bench_rating_period(int population)
+{
+    if(!selected("score_rating_period") || population<8) return;
+
+    fossil_game_score_match_result* results=malloc(sizeof(*results)*MICRO_OPS);
+    if(!results) return;
+    for(long i=0;i<MICRO_OPS;i++){
+        results[i].player_a=ID(i);
+        results[i].player_b=g_ids[(g_order[i]+1+i%7)%(uint32_t)population];
+        results[i].score_a=(double)(i%3)*0.5;
+    }
+
+    double t[PASSES];
+    for(int p=0;p<PASSES;p++){
+        double t0=now_s();
+        fossil_game_score_rating_period(results,MICRO_OPS);
+        t[p]=now_s()-t0;
+    }
+
+    qsort(t,PASSES,sizeof(double),cmp_double);
+    emit("score_rating_period","micro",population,MICRO_OPS,t[0],t[PASSES/2],NULL);
+    free(results);
+}
+
+static void op_quiz_ask(long i,void* ctx)
+{
+    fossil_game_quizzed_ask((const char*)ctx,g_ids[i%LIMIT_QUIZ]);
+}
+
+static void op_quiz_answer(long i,void* ctx)
+{
+    fossil_game_quizzed_answer((const char*)ctx,g_ids[i%LIMIT_QUIZ],"a");
+}
+
+/* ============================================================
+   Scenarios
+   ============================================================ */
+
+/* 10k players in sessions of 100 write a score and an attribute, then every session ticks */
+static void scenario_session_tick(int population)
+{
+    const char* name="session_tick_10k";
+    if(!selected(name)) return;
+
+    int members=population<SESSION_MEMBERS?population:SESSION_MEMBERS;
+    int sessions=(members+SESSION_SIZE-1)/SESSION_SIZE;
+    char sid[32];
+
+    for(int s=0;s<sessions;s++){
+        snprintf(sid,sizeof(sid),"bench_%d_%d",population,s);
+        fossil_game_session_create(sid);
+        fossil_game_session_start(sid);
+    }
+    for(int m=0;m<members;m++){
+        snprintf(sid,sizeof(sid),"bench_%d_%d",population,m/SESSION_SIZE);
+        fossil_game_session_add_player(sid,g_ids[m]);
+        if(m%4==0 && fossil_game_clinker_create(g_ids[m],"bench_npc")==0)
+            fossil_game_clinker_start_action(g_ids[m],"wander",5+m%20);
+    }
+
+    double t[SESSION_TICKS];
+    for(int k=0;k<SESSION_TICKS;k++){
+        double t0=now_s();
+        for(int m=0;m<members;m++){
+            fossil_game_score_update(g_ids[m],1);
+            fossil_game_player_set_int(g_ids[m],"hp",k);
+        }
+        for(int s=0;s<sessions;s++){
+            snprintf(sid,sizeof(sid),"bench_%d_%d",population,s);
+            fossil_game_session_tick(sid);
+        }
+        t[k]=now_s()-t0;
+    }
+
+    for(int s=0;s<sessions;s++){
+        snprintf(sid,sizeof(sid),"bench_%d_%d",population,s);
+        fossil_game_session_destroy(sid);
+    }
+
+    qsort(t,SESSION_TICKS,sizeof(double),cmp_double);
+    char extra[128];
+    snprintf(extra,sizeof(extra),"\"members\":%d,\"sessions\":%d,\"ms_per_tick\":%.3f,\"ms_per_tick_p90\":%.3f",
+             members,sessions,t[SESSION_TICKS/2]*1e3,t[SESSION_TICKS*9/10]*1e3);
+    emit(name,"scenario",population,members,t[0],t[SESSION_TICKS/2],extra);
+}
+
+static void build_quiz(const char* quiz)
+{
+    char qid[32],text[64],opt[2]={0,0};
+
+    fossil_game_quizzed_create(quiz);
+    for(int q=0;q<QUIZ_QUESTIONS;q++){
+        snprintf(qid,sizeof(qid),"q%d",q);
+        snprintf(text,sizeof(text),"Question %d?",q);
+        fossil_game_quizzed_add_question(quiz,qid,text);
+        for(int o=0;o<QUIZ_OPTIONS;o++){
+            opt[0]=(char)('a'+o);
+            fossil_game_quizzed_add_option(quiz,qid,opt,opt,o==q%QUIZ_OPTIONS);
+        }
+    }
+}
+
+/* every participant is asked and answers each question of a live round */
+static void scenario_live_quiz(int population,int participants)
+{
+    const char* name="live_quiz_event";
+    if(!selected(name)) return;
+
+    char quiz[32],opt[2]={0,0};
+    snprintf(quiz,sizeof(quiz),"live_%d",population);
+    build_quiz(quiz);
+
+    double t[QUIZ_QUESTIONS];
+    for(int q=0;q<QUIZ_QUESTIONS;q++){
+        double t0=now_s();
+        for(int p=0;p<participants;p++){
+            fossil_game_quizzed_ask(quiz,g_ids[p]);
+            opt[0]=(char)('a'+(p+q)%QUIZ_OPTIONS);
+            fossil_game_quizzed_answer(quiz,g_ids[p],opt);
+        }
+        t[q]=now_s()-t0;
+    }
+
+    qsort(t,QUIZ_QUESTIONS,sizeof(double),cmp_double);
+    char extra[128];
+    snprintf(extra,sizeof(extra),"\"participants\":%d,\"questions\":%d,\"ms_per_round\":%.3f",
+             participants,QUIZ_QUESTIONS,t[QUIZ_QUESTIONS/2]*1e3);
+    emit(name,"scenario",population,participants,t[0],t[QUIZ_QUESTIONS/2],extra);
+}
+
+/* ============================================================
+   Driver
+   ============================================================ */
+
+static void grow(int from,int to)
+{
+    for(int i=from;i<to;i++){
+        snprintf(g_ids[i],sizeof(g_ids[i]),"bench_player_%d",i);
+        fossil_game_player_create(g_ids[i]);
+        fossil_game_player_set_int(g_ids[i],"hp",100);
+        fossil_game_score_update(g_ids[i],rand()%5000);
+    }
+}
+
+static void run_size(int prev,int population)
+{
+    double t0=now_s();
+    grow(prev,population);
+    double created=now_s()-t0;
+
+    if(selected("player_create") && population>prev)
+        emit("player_create","micro",population,population-prev,created,created,NULL);
+
+    /* random visiting order over the whole population */
+    uint32_t x=2463534242u;
+    for(int i=0;i<MICRO_OPS;i++){
+        x^=x<<13; x^=x>>17; x^=x<<5;
+        g_order[i]=x%(uint32_t)population;
+    }
+
+    int hp=fossil_game_player_attr_key("hp");
+    micro("player_lookup",population,MICRO_OPS,op_lookup,NULL);
+    micro("attr_set",population,MICRO_OPS,op_attr_set,NULL);
+    micro("attr_get",population,MICRO_OPS,op_attr_get,NULL);
+    micro("attr_get_by_key",population,MICRO_OPS,op_attr_get_key,&hp);
+
+    /* remove undoes add pass by pass, so both run against the same holdings */
+    if(selected("inventory")){
+        const char* saved=g_opt.filter;
+        g_opt.filter=NULL;
+        double ta[PASSES],tr[PASSES];
+        for(int p=0;p<PASSES;p++){
+            double s=now_s();
+            for(long i=0;i<MICRO_OPS;i++) op_inv_add(i,NULL);
+            ta[p]=now_s()-s;
+            s=now_s();
+            for(long i=0;i<MICRO_OPS;i++) op_inv_remove(i,NULL);
+            tr[p]=now_s()-s;
+        }
+        qsort(ta,PASSES,sizeof(double),cmp_double);
+        qsort(tr,PASSES,sizeof(double),cmp_double);
+        emit("inventory_add","micro",population,MICRO_OPS,ta[0],ta[PASSES/2],NULL);
+        emit("inventory_remove","micro",population,MICRO_OPS,tr[0],tr[PASSES/2],NULL);
+        g_opt.filter=saved;
+    }
+
+    bench_reads(prev,population);
+    micro("score_update",population,MICRO_OPS,op_score_update,NULL);
+    micro("score_rank_estimate",population,MICRO_OPS,op_rank_estimate,NULL);
+
+    if(selected("score_leaderboard")){
+        if(population>LIMIT_LEADERBOARD && !g_opt.no_limits){
+            skip("score_leaderboard","micro",population,LIMIT_LEADERBOARD);
+        }else{
+            char board[32];
+            snprintf(board,sizeof(board),"bench_%d",population);
+            op_leaderboard(0,board);    /* first fetch fills the board */
+            micro("score_leaderboard",population,10,op_leaderboard,board);
+        }
+    }
+    micro("score_matchmaking",population,100,op_matchmaking,NULL);
+    micro("score_shard_export",population,5,op_shard_export,NULL);
+    bench_rating_period(population);
+    micro("score_rating_matchmaking",population,100,op_rating_matchmaking,NULL);
+
+    int participants=population<LIMIT_QUIZ?population:LIMIT_QUIZ;
+    if(population>LIMIT_QUIZ && g_opt.no_limits) participants=population;
+
+    if(selected("quizzed")){
+        char quiz[32];
+        snprintf(quiz,sizeof(quiz),"micro_%d",population);
+        build_quiz(quiz);
+        micro("quizzed_ask",population,participants,op_quiz_ask,quiz);
+        micro("quizzed_answer",population,participants,op_quiz_answer,quiz);
+    }
+
+    scenario_session_tick(population);
+    scenario_live_quiz(population,participants);
+}
+
+static int parse_size(const char* s)
+{
+    char* end;
+    double v=strtod(s,&end);
+    if(*end=='k'||*end=='K') v*=1e3;
+    else if(*end=='m'||*end=='M') v*=1e6;
+    return v>=1&&v<=1e8?(int)v:-1;
+}
+
+int main(int argc,char** argv)
+{
+    int sizes[16]={1000,100000,1000000};
+    int count=3;
+
+    for(int i=1;i<argc;i++){
+        if(strcmp(argv[i],"--text")==0){ g_opt.text=1; continue; }
+        if(strcmp(argv[i],"--no-limits")==0){ g_opt.no_limits=1; continue; }
+        if(i+1>=argc){ fprintf(stderr,"missing value for %s\n",argv[i]); return 1; }
+
+        if(strcmp(argv[i],"--filter")==0){
+            g_opt.filter=argv[++i];
+        }else if(strcmp(argv[i],"--sizes")==0){
+            count=0;
+            for(char* tok=strtok(argv[++i],",");tok && count<16;tok=strtok(NULL,",")){
+                sizes[count]=parse_size(tok);
+                if(sizes[count]<0){ fprintf(stderr,"bad size %s\n",tok); return 1; }
+                count++;
+            }
+        }else{
+            fprintf(stderr,"unknown option %s\n",argv[i]);
+            return 1;
+        }
+    }
+
+    int max=0;
+    for(int i=0;i<count;i++){
+        if(i && sizes[i]<=sizes[i-1]){ fprintf(stderr,"sizes must increase\n"); return 1; }
+        max=sizes[i];
+    }
+
+    g_ids=calloc((size_t)max,sizeof(*g_ids));
+    g_order=malloc(sizeof(*g_order)*MICRO_OPS);
+    g_score_handles=malloc(sizeof(*g_score_handles)*(size_t)max);
+    g_views=malloc(sizeof(*g_views)*(size_t)max);
+    if(!g_ids||!g_order||!g_score_handles||!g_views) return 1;
+
+    fossil_game_clinker_define_action("bench_npc","wander",1.0f,10);
+
+    g_opt.first=1;
+    if(g_opt.text) printf("fossil_game_bench\n");
+    else printf("{\"suite\":\"fossil_game_bench\",\"passes\":%d,\"results\":[",PASSES);
+
+    int prev=0;
+    for(int i=0;i<count;i++){
+        run_size(prev,sizes[i]);
+        prev=sizes[i];
+        fflush(stdout);
+    }
+
+    if(!g_opt.text) printf("\n]}\n");
+
+    free(g_ids);
+    free(g_order);
+    free(g_score_handles);
+    free((void*)g_views);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/player.h"
+#include "fossil/game/score.h"
+#include "fossil/game/sync.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Replication cost per client per tick: a session of P players, each carrying
+ * a score, a handful of stacks and a few attributes, with a small fraction
+ * mutated every tick. One client mirror applies its updates to time decoding.
+ *
+ *   fossil_game_bench_sync [players] [clients] [ticks] [churn_percent]
+ */
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec*1e6+ts.tv_nsec/1e3;
+}
+
+int main(int argc,char** argv)
+{
+    int players=argc>1?atoi(argv[1]):256;
+    int clients=argc>2?atoi(argv[2]):64;
+    int ticks=argc>3?atoi(argv[3]):1000;
+    int churn=argc>4?atoi(argv[4]):5;
+
+    char id[64],item[64];
+    for(int i=0;i<players;i++){
+        snprintf(id,sizeof(id),"player_%d",i);
+        fossil_game_player_create(id);
+        fossil_game_player_join_session(id,"arena");
+        fossil_game_score_update(id,rand()%5000);
+        for(int k=0;k<16;k++){
+            snprintf(item,sizeof(item),"item_%d",rand()%64);
+            fossil_game_player_inventory_add(id,item,1+rand()%20);
+        }
+        fossil_game_player_set_int(id,"level",1+rand()%60);
+        fossil_game_player_set_float(id,"health",100.0);
+        fossil_game_player_set_string(id,"zone","harbor");
+    }
+
+    size_t cap=1<<22;
+    unsigned char* buf=malloc(cap);
+    char client[64];
+    fossil_game_sync_mirror* mirror=fossil_game_sync_mirror_create();
+
+    /* full state for a fresh client */
+    uint32_t tick=0;
+    size_t full=0;
+    fossil_game_sync_capture("arena",&tick);
+    fossil_game_sync_encode("arena","probe",buf,cap,&full);
+    fossil_game_sync_drop_client("arena","probe");
+
+    for(int c=0;c<clients;c++){
+        size_t n=0;
+        snprintf(client,sizeof(client),"client_%d",c);
+        fossil_game_sync_encode("arena",client,buf,cap,&n);
+        if(c==0) fossil_game_sync_apply(mirror,buf,n,NULL);
+        fossil_game_sync_ack("arena",client,tick);
+    }
+
+    double capture_us=0,encode_us=0,apply_us=0;
+    size_t delta_bytes=0;
+
+    for(int t=0;t<ticks;t++){
+        int changes=players*churn/100;
+        for(int k=0;k<changes;k++){
+            snprintf(id,sizeof(id),"player_%d",rand()%players);
+            fossil_game_score_update(id,1+rand()%10);
+            if(rand()%2==0)
+                fossil_game_player_set_float(id,"health",rand()%1000/10.0);
+            if(rand()%4==0){
+                snprintf(item,sizeof(item),"item_%d",rand()%64);
+                fossil_game_player_inventory_add(id,item,1);
+            }
+        }
+
+        double t0=now_us();
+        fossil_game_sync_capture("arena",&tick);
+        double t1=now_us();
+        capture_us+=t1-t0;
+
+        for(int c=0;c<clients;c++){
+            size_t n=0;
+            snprintf(client,sizeof(client),"client_%d",c);
+            if(fossil_game_sync_encode("arena",client,buf,cap,&n)!=0){
+                fprintf(stderr,"encode failed\n");
+                return 1;
+            }
+            if(c==0){
+                double t2=now_us();
+                if(fossil_game_sync_apply(mirror,buf,n,NULL)!=0){
+                    fprintf(stderr,"apply failed\n");
+                    return 1;
+                }
+                apply_us+=now_us()-t2;
+            }
+            fossil_game_sync_ack("arena",client,tick);
+            delta_bytes+=n;
+        }
+        encode_us+=now_us()-t1;
+    }
+    encode_us-=apply_us;
+
+    double per=(double)ticks*clients;
+    printf("sync: players=%d clients=%d ticks=%d churn=%d%%\n",players,clients,ticks,churn);
+    printf("  full state      : %zu bytes/client\n",full);
+    printf("  delta           : %.1f bytes/client/tick\n",delta_bytes/per);
+    printf("  encode          : %.3f us/client/tick\n",encode_us/per);
+    printf("  capture         : %.3f us/tick\n",capture_us/ticks);
+    printf("  apply           : %.3f us/tick\n",apply_us/ticks);
+
+    fossil_game_sync_mirror_free(mirror);
+    free(buf);
+    fossil_game_sync_release("arena");
+    return 0;
+}
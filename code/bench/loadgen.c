@@ -0,0 +1,384 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/multiplayer.h"
+#include "fossil/game/trace.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Load generator for the multiplayer layer over the in-process loopback
+ * transport. N clients spread across M sessions join, leave and chat at the
+ * configured per-second rates; every tick all mailboxes are drained and the
+ * enqueue-to-dequeue latency of each delivered message is recorded.
+ *
+ *   fossil_game_loadgen [--clients N] [--sessions M] [--ticks T] [--tick-hz H]
+ *                       [--chat R] [--churn R] [--broadcast PCT] [--seed S]
+ *                       [--world W] [--radius R]
+ *                       [--realtime] [--json] [--max-p99-us US]
+ *                       [--trace PATH] [--budget-ms MS]
+ *
+ * With --world, clients random-walk in a W x W area and broadcasts are scoped
+ * to members within --radius of the sender (area-of-interest fan-out).
+ *
+ * Rates are per client per second of simulated time (ticks / tick-hz). With
+ * --realtime each tick is paced to wall-clock; otherwise ticks run back to
+ * back. --max-p99-us makes the exit status 2 when the p99 delivery latency
+ * exceeds the bound, so the tool can gate a pipeline.
+ *
+ * Each tick is a trace frame with "clients" and "drain" zones. --trace
+ * writes the buffered Chrome trace to PATH at exit (zones need a library
+ * built with with_trace); with --budget-ms the first tick over budget
+ * dumps its last TRACE_DUMP_FRAMES frames there instead. Overruns are
+ * counted either way.
+ */
+
+#define TRACE_DUMP_FRAMES 8
+
+/* log2 buckets split into 4 linear sub-buckets each */
+#define SUB_BITS 2
+#define BUCKETS (64<<SUB_BITS)
+
+typedef struct {
+    uint64_t counts[BUCKETS];
+    uint64_t total;
+    uint64_t max;
+} histogram_t;
+
+static int bucket_of(uint64_t v)
+{
+    if(v<(1u<<SUB_BITS)) return (int)v;
+    int log=0;
+    while((v>>log)>1) log++;
+    int sub=(int)((v>>(log-SUB_BITS))&((1u<<SUB_BITS)-1));
+    return ((log-SUB_BITS+1)<<SUB_BITS)+sub;
+}
+
+static uint64_t bucket_upper(int b)
+{
+    if(b<(1<<SUB_BITS)) return (uint64_t)b;
+    int log=(b>>SUB_BITS)+SUB_BITS-1;
+    uint64_t sub=(uint64_t)(b&((1<<SUB_BITS)-1));
+    return ((((uint64_t)1<<SUB_BITS)+sub+1)<<(log-SUB_BITS))-1;
+}
+
+static void record(histogram_t* h,uint64_t v)
+{
+    h->counts[bucket_of(v)]++;
+    h->total++;
+    if(v>h->max) h->max=v;
+}
+
+static uint64_t percentile(const histogram_t* h,double p)
+{
+    if(!h->total) return 0;
+    uint64_t want=(uint64_t)(p*(double)h->total+0.5);
+    if(want==0) want=1;
+
+    uint64_t seen=0;
+    for(int b=0;b<BUCKETS;b++){
+        seen+=h->counts[b];
+        if(seen>=want) return bucket_upper(b)<h->max?bucket_upper(b):h->max;
+    }
+    return h->max;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec*1000000000ull+(uint64_t)ts.tv_nsec;
+}
+
+static double chance(void)
+{
+    return (double)rand()/((double)RAND_MAX+1.0);
+}
+
+typedef struct {
+    int clients;
+    int sessions;
+    int ticks;
+    double tick_hz;
+    double chat;
+    double churn;
+    double broadcast;
+    unsigned seed;
+    double world;
+    double radius;
+    int realtime;
+    int json;
+    double max_p99_us;
+    const char* trace;
+    double budget_ms;
+} options_t;
+
+static int parse(options_t* o,int argc,char** argv)
+{
+    for(int i=1;i<argc;i++){
+        const char* a=argv[i];
+        const char* v=i+1<argc?argv[i+1]:NULL;
+
+        if(strcmp(a,"--realtime")==0){ o->realtime=1; continue; }
+        if(strcmp(a,"--json")==0){ o->json=1; continue; }
+        if(!v){ fprintf(stderr,"missing value for %s\n",a); return -1; }
+
+        if(strcmp(a,"--clients")==0) o->clients=atoi(v);
+        else if(strcmp(a,"--sessions")==0) o->sessions=atoi(v);
+        else if(strcmp(a,"--ticks")==0) o->ticks=atoi(v);
+        else if(strcmp(a,"--tick-hz")==0) o->tick_hz=atof(v);
+        else if(strcmp(a,"--chat")==0) o->chat=atof(v);
+        else if(strcmp(a,"--churn")==0) o->churn=atof(v);
+        else if(strcmp(a,"--broadcast")==0) o->broadcast=atof(v)/100.0;
+        else if(strcmp(a,"--seed")==0) o->seed=(unsigned)strtoul(v,NULL,10);
+        else if(strcmp(a,"--world")==0) o->world=atof(v);
+        else if(strcmp(a,"--radius")==0) o->radius=atof(v);
+        else if(strcmp(a,"--max-p99-us")==0) o->max_p99_us=atof(v);
+        else if(strcmp(a,"--trace")==0) o->trace=v;
+        else if(strcmp(a,"--budget-ms")==0) o->budget_ms=atof(v);
+        else{ fprintf(stderr,"unknown option %s\n",a); return -1; }
+        i++;
+    }
+
+    if(o->clients<=0||o->sessions<=0||o->ticks<=0||o->tick_hz<=0){
+        fprintf(stderr,"clients, sessions, ticks and tick-hz must be positive\n");
+        return -1;
+    }
+    if(o->sessions>o->clients) o->sessions=o->clients;
+    return 0;
+}
+
+typedef struct {
+    const char* path;
+    int dumped;
+    uint64_t overruns;
+} overrun_t;
+
+static void on_overrun(uint64_t frame,double frame_ms,void* ctx)
+{
+    overrun_t* ov=ctx;
+    (void)frame; (void)frame_ms;
+
+    ov->overruns++;
+    if(ov->path && !ov->dumped){
+        fossil_game_trace_dump(ov->path,TRACE_DUMP_FRAMES);
+        ov->dumped=1;
+    }
+}
+
+int main(int argc,char** argv)
+{
+    options_t o={1000,10,600,60.0,1.0,0.05,0.10,1u,0.0,64.0,0,0,0.0,NULL,0.0};
+    if(parse(&o,argc,argv)!=0) return 1;
+    srand(o.seed);
+
+    overrun_t ov={o.trace,0,0};
+    if(o.trace && fossil_game_trace_enable(1)!=0)
+        fprintf(stderr,"library built without with_trace: frames only\n");
+    fossil_game_trace_set_budget(o.budget_ms,on_overrun,&ov);
+
+    double p_chat=o.chat/o.tick_hz;
+    double p_churn=o.churn/o.tick_hz;
+
+    char** session_ids=malloc(sizeof(char*)*(size_t)o.sessions);
+    char** client_ids=malloc(sizeof(char*)*(size_t)o.clients);
+    unsigned char* online=calloc((size_t)o.clients,1);
+    float* pos=calloc((size_t)o.clients*2,sizeof(float));
+    histogram_t* latency=calloc(1,sizeof(*latency));
+    if(!session_ids||!client_ids||!online||!pos||!latency) return 1;
+
+    for(int i=0;i<o.sessions;i++){
+        session_ids[i]=malloc(32);
+        snprintf(session_ids[i],32,"room_%d",i);
+        fossil_game_multiplayer_create_session(session_ids[i]);
+    }
+    for(int i=0;i<o.clients;i++){
+        client_ids[i]=malloc(32);
+        snprintf(client_ids[i],32,"client_%d",i);
+        if(fossil_game_multiplayer_join(session_ids[i%o.sessions],client_ids[i])==0)
+            online[i]=1;
+        if(o.world>0){
+            pos[2*i]=(float)(chance()*o.world);
+            pos[2*i+1]=(float)(chance()*o.world);
+            fossil_game_multiplayer_set_position(session_ids[i%o.sessions],client_ids[i],pos[2*i],pos[2*i+1]);
+        }
+    }
+
+    uint64_t joins=0,leaves=0,sends=0,broadcasts=0,fanout=0,failed=0,delivered=0;
+    int per_session=(o.clients+o.sessions-1)/o.sessions;
+    char msg[96],buf[256];
+
+    uint64_t start=now_ns();
+    uint64_t tick_ns=(uint64_t)(1e9/o.tick_hz);
+
+    for(int t=0;t<o.ticks;t++){
+        fossil_game_trace_frame_begin();
+        fossil_game_trace_zone_begin("clients");
+        for(int i=0;i<o.clients;i++){
+            const char* room=session_ids[i%o.sessions];
+
+            if(!online[i]){
+                if(chance()<p_churn && fossil_game_multiplayer_join(room,client_ids[i])==0){
+                    online[i]=1;
+                    joins++;
+                    if(o.world>0)
+                        fossil_game_multiplayer_set_position(room,client_ids[i],pos[2*i],pos[2*i+1]);
+                }
+                continue;
+            }
+            if(o.world>0){
+                float* p=&pos[2*i];
+                p[0]+=(float)(chance()*2.0-1.0);
+                p[1]+=(float)(chance()*2.0-1.0);
+                if(p[0]<0) p[0]=0; else if(p[0]>o.world) p[0]=(float)o.world;
+                if(p[1]<0) p[1]=0; else if(p[1]>o.world) p[1]=(float)o.world;
+                fossil_game_multiplayer_set_position(room,client_ids[i],p[0],p[1]);
+            }
+            if(chance()<p_churn){
+                fossil_game_multiplayer_leave(room,client_ids[i]);
+                online[i]=0;
+                leaves++;
+                continue;
+            }
+            if(chance()>=p_chat) continue;
+
+            snprintf(msg,sizeof(msg),"tick %d from %s",t,client_ids[i]);
+            if(chance()<o.broadcast){
+                int n=o.world>0
+                    ?fossil_game_multiplayer_broadcast_near(room,client_ids[i],(float)o.radius,msg)
+                    :fossil_game_multiplayer_broadcast(room,msg);
+                if(n>0) fanout+=(uint64_t)n;
+                broadcasts++;
+            }else{
+                int peer=(i%o.sessions)+o.sessions*(rand()%per_session);
+                if(peer>=o.clients) peer=i;
+                if(fossil_game_multiplayer_send(room,client_ids[peer],msg)==0) sends++;
+                else failed++;
+            }
+        }
+
+        fossil_game_trace_zone_end("clients");
+
+        fossil_game_trace_zone_begin("drain");
+        for(int i=0;i<o.clients;i++){
+            if(!online[i]) continue;
+
+            size_t n;
+            uint64_t lat;
+            while(fossil_game_multiplayer_poll(session_ids[i%o.sessions],client_ids[i],
+                                               buf,sizeof(buf),&n,&lat)==1){
+                record(latency,lat);
+                delivered++;
+            }
+        }
+        fossil_game_trace_zone_end("drain");
+        fossil_game_trace_frame_end();
+
+        if(o.realtime){
+            uint64_t due=start+(uint64_t)(t+1)*tick_ns;
+            uint64_t now=now_ns();
+            if(due>now){
+                struct timespec ts={(time_t)((due-now)/1000000000ull),(long)((due-now)%1000000000ull)};
+                nanosleep(&ts,NULL);
+            }
+        }
+    }
+
+    double wall=(double)(now_ns()-start)/1e9;
+    if(o.trace && !ov.dumped) fossil_game_trace_dump(o.trace,0);
+    double p50=percentile(latency,0.50)/1e3;
+    double p90=percentile(latency,0.90)/1e3;
+    double p99=percentile(latency,0.99)/1e3;
+    double p999=percentile(latency,0.999)/1e3;
+    double max=(double)latency->max/1e3;
+
+    if(o.json){
+        printf("{\"clients\":%d,\"sessions\":%d,\"ticks\":%d,\"tick_hz\":%.1f,"
+               "\"wall_s\":%.6f,\"joins\":%llu,\"leaves\":%llu,\"sends\":%llu,"
+               "\"broadcasts\":%llu,\"avg_fanout\":%.2f,\"failed\":%llu,\"delivered\":%llu,"
+               "\"dropped\":%llu,\"delivered_per_s\":%.1f,\"overruns\":%llu,"
+               "\"latency_us\":{\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f},"
+               "\"histogram_ns\":[",
+               o.clients,o.sessions,o.ticks,o.tick_hz,wall,
+               (unsigned long long)joins,(unsigned long long)leaves,
+               (unsigned long long)sends,(unsigned long long)broadcasts,
+               broadcasts?(double)fanout/(double)broadcasts:0.0,
+               (unsigned long long)failed,(unsigned long long)delivered,
+               (unsigned long long)fossil_game_multiplayer_dropped(),
+               delivered/wall,(unsigned long long)ov.overruns,p50,p90,p99,p999,max);
+        int first=1;
+        for(int b=0;b<BUCKETS;b++){
+            if(!latency->counts[b]) continue;
+            printf("%s[%llu,%llu]",first?"":",",
+                   (unsigned long long)bucket_upper(b),(unsigned long long)latency->counts[b]);
+            first=0;
+        }
+        printf("]}\n");
+    }else{
+        printf("loadgen: clients=%d sessions=%d ticks=%d tick_hz=%.1f%s\n",
+               o.clients,o.sessions,o.ticks,o.tick_hz,o.realtime?" (realtime)":"");
+        printf("  wall            : %.3f s\n",wall);
+        printf("  joins/leaves    : %llu / %llu\n",(unsigned long long)joins,(unsigned long long)leaves);
+        printf("  sends/broadcasts: %llu / %llu (failed %llu, avg fan-out %.1f)\n",
+               (unsigned long long)sends,(unsigned long long)broadcasts,(unsigned long long)failed,
+               broadcasts?(double)fanout/(double)broadcasts:0.0);
+        printf("  delivered       : %llu (%.0f msg/s, dropped %llu)\n",
+               (unsigned long long)delivered,delivered/wall,
+               (unsigned long long)fossil_game_multiplayer_dropped());
+        if(o.budget_ms>0)
+            printf("  overruns        : %llu ticks over %.2f ms\n",(unsigned long long)ov.overruns,o.budget_ms);
+        printf("  latency us      : p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+               p50,p90,p99,p999,max);
+        printf("  histogram (ns <=, count):\n");
+        for(int b=0;b<BUCKETS;b++){
+            if(!latency->counts[b]) continue;
+            int bar=(int)(50.0*(double)latency->counts[b]/(double)latency->total);
+            printf("    %12llu %10llu %.*s\n",(unsigned long long)bucket_upper(b),
+                   (unsigned long long)latency->counts[b],bar,
+                   "##################################################");
+        }
+    }
+
+    for(int i=0;i<o.sessions;i++){
+        fossil_game_multiplayer_destroy_session(session_ids[i]);
+        free(session_ids[i]);
+    }
+    for(int i=0;i<o.clients;i++) free(client_ids[i]);
+    free(session_ids);
+    free(client_ids);
+    free(online);
+    free(pos);
+
+    int over=o.max_p99_us>0 && p99>o.max_p99_us;
+    free(latency);
+
+    if(over){
+        fprintf(stderr,"p99 latency %.2f us exceeds %.2f us\n",p99,o.max_p99_us);
+        return 2;
+    }
+    return 0;
+}
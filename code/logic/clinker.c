@@ -0,0 +1,1540 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/clinker.h"
+#include "fossil/game/feature.h"
+#include "fossil/game/metrics.h"
+#include "fossil/game/trace.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define CLINKER_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* AVX2 is compiled per function and picked at runtime on GNU-compatible x86 compilers */
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CLINKER_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+static char* fossil_strdup(const char* s)
+{
+    if(!s) return NULL;
+
+    size_t len = 0;
+    while(s[len]) len++;
+
+    char* out = (char*)malloc(len + 1);
+    if(!out) return NULL;
+    FOSSIL_GAME_METRIC_ALLOC();
+
+    for(size_t i=0;i<=len;i++)
+        out[i] = s[i];
+
+    return out;
+}
+
+/* ============================================================
+   Internal structures
+   ============================================================ */
+
+#define NO_ACTION UINT16_MAX
+
+#define FEATURE_WORDS (FOSSIL_GAME_FEATURE_MAX/64)
+
+#define BT_NO_NODE UINT16_MAX
+#define BT_MAX_DEPTH 32
+
+typedef struct {
+    char* key;
+    char** values;          /* one per NPC slot, NULL = unset */
+    float* numbers;         /* numeric reading of values, 0 when unset */
+    float drift;            /* added every tick */
+    int bounded;            /* driven by drift or effects, kept in [0,1] */
+} clinker_trait_t;
+
+typedef struct {
+    uint32_t trait;
+    int curve;
+    float m,k,b,c;
+} clinker_consideration_t;
+
+typedef struct {
+    uint32_t trait;
+    float per_tick;
+} clinker_effect_t;
+
+typedef struct {
+    int scored;             /* takes part in utility selection */
+    float weight;
+    uint32_t duration;
+
+    clinker_consideration_t* considerations;
+    uint32_t consideration_count;
+
+    clinker_effect_t* effects;
+    uint32_t effect_count;
+} clinker_action_t;
+
+/* Compiled behavior tree node, 16 bytes */
+typedef struct {
+    uint8_t op;
+    uint8_t cmp;            /* condition comparison */
+    uint16_t arg;           /* trait column or action index */
+    uint16_t parent;        /* BT_NO_NODE at the root */
+    uint16_t end;           /* one past the last node of this subtree */
+    uint16_t ticks;         /* action or wait duration */
+    uint16_t pad;
+    float value;            /* condition threshold */
+} bt_node_t;
+
+/*
+ * One archetype owns its NPCs as parallel columns indexed by slot; the hot
+ * per-tick state sits in narrow arrays so tick_all streams through them.
+ */
+typedef struct {
+    char* name;
+
+    uint32_t count;
+    uint32_t cap;
+
+    /* hot columns */
+    uint32_t* age;
+    uint32_t* timer;
+    uint16_t* action;
+    uint16_t* choice;       /* last utility decision */
+    uint16_t* bt;           /* running tree leaf, BT_NO_NODE = enter at root */
+
+    /* cold columns */
+    char** ids;
+    uint32_t* hashes;
+    uint64_t* features[FEATURE_WORDS];  /* registry bit masks, one word column each */
+
+    clinker_trait_t* traits;
+    uint32_t trait_count;
+
+    char** actions;         /* action names, indexed by action column */
+    clinker_action_t* defs; /* parallel to actions */
+    uint16_t action_count;
+    int scored_count;
+
+    bt_node_t* tree;        /* shared by every NPC of the archetype */
+    uint16_t tree_len;
+} archetype_t;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t arch;
+    uint32_t ref;           /* slot + 1, 0 = empty */
+} npc_slot_t;
+
+/* Global registries */
+static archetype_t** g_archetypes=NULL;
+static uint32_t g_archetype_count=0;
+
+static npc_slot_t* g_index=NULL;
+static uint32_t g_index_cap=0;
+static uint32_t g_index_used=0;
+
+
+/* ============================================================
+   Helpers
+   ============================================================ */
+
+static uint32_t hash_str(const char* s)
+{
+    uint32_t h=2166136261u;
+    while(*s){
+        h^=(unsigned char)*s++;
+        h*=16777619u;
+    }
+    return h;
+}
+
+static long index_find(const char* id,uint32_t h)
+{
+    if(!g_index_cap) return -1;
+
+    uint32_t mask=g_index_cap-1;
+    for(uint32_t i=h&mask;g_index[i].ref;i=(i+1)&mask){
+        const npc_slot_t* e=&g_index[i];
+        if(e->hash==h && strcmp(g_archetypes[e->arch]->ids[e->ref-1],id)==0)
+            return (long)i;
+    }
+    return -1;
+}
+
+static int index_insert(uint32_t h,uint32_t arch,uint32_t slot)
+{
+    if((g_index_used+1)*4>g_index_cap*3){
+        uint32_t cap=g_index_cap?g_index_cap*2:64;
+        npc_slot_t* tmp=calloc(cap,sizeof(*tmp));
+        if(!tmp) return -1;
+
+        for(uint32_t i=0;i<g_index_cap;i++){
+            if(!g_index[i].ref) continue;
+            uint32_t j=g_index[i].hash&(cap-1);
+            while(tmp[j].ref) j=(j+1)&(cap-1);
+            tmp[j]=g_index[i];
+        }
+
+        free(g_index);
+        g_index=tmp;
+        g_index_cap=cap;
+    }
+
+    uint32_t i=h&(g_index_cap-1);
+    while(g_index[i].ref) i=(i+1)&(g_index_cap-1);
+    g_index[i].hash=h;
+    g_index[i].arch=arch;
+    g_index[i].ref=slot+1;
+    g_index_used++;
+    return 0;
+}
+
+static void index_erase(uint32_t pos)
+{
+    uint32_t mask=g_index_cap-1;
+    uint32_t hole=pos;
+
+    for(uint32_t i=(pos+1)&mask;g_index[i].ref;i=(i+1)&mask){
+        uint32_t home=g_index[i].hash&mask;
+        if(((i-home)&mask)>=((i-hole)&mask)){
+            g_index[hole]=g_index[i];
+            hole=i;
+        }
+    }
+
+    g_index[hole].ref=0;
+    g_index_used--;
+}
+
+static void index_retarget(uint32_t h,uint32_t arch,uint32_t from,uint32_t to)
+{
+    uint32_t mask=g_index_cap-1;
+    for(uint32_t i=h&mask;g_index[i].ref;i=(i+1)&mask){
+        if(g_index[i].arch==arch && g_index[i].ref==from+1){
+            g_index[i].ref=to+1;
+            return;
+        }
+    }
+}
+
+static archetype_t* find_archetype(const char* name,uint32_t* out_idx)
+{
+    for(uint32_t i=0;i<g_archetype_count;i++){
+        if(strcmp(g_archetypes[i]->name,name)==0){
+            if(out_idx) *out_idx=i;
+            return g_archetypes[i];
+        }
+    }
+    return NULL;
+}
+
+static archetype_t* create_archetype(const char* name,uint32_t* out_idx)
+{
+    archetype_t** tmp=realloc(g_archetypes,sizeof(*tmp)*(g_archetype_count+1));
+    if(!tmp) return NULL;
+    g_archetypes=tmp;
+
+    archetype_t* a=calloc(1,sizeof(*a));
+    if(!a) return NULL;
+
+    a->name=fossil_strdup(name);
+    if(!a->name){ free(a); return NULL; }
+
+    *out_idx=g_archetype_count;
+    g_archetypes[g_archetype_count++]=a;
+    return a;
+}
+
+#define GROW_COLUMN(col,cap) do{ \
+    void* t_=realloc((col),sizeof(*(col))*(cap)); \
+    if(!t_) return -1; \
+    (col)=t_; \
+}while(0)
+
+static int archetype_reserve(archetype_t* a,uint32_t need)
+{
+    if(need<=a->cap) return 0;
+
+    uint32_t cap=a->cap?a->cap*2:64;
+    while(cap<need) cap*=2;
+
+    GROW_COLUMN(a->age,cap);
+    GROW_COLUMN(a->timer,cap);
+    GROW_COLUMN(a->action,cap);
+    GROW_COLUMN(a->choice,cap);
+    GROW_COLUMN(a->bt,cap);
+    GROW_COLUMN(a->ids,cap);
+    GROW_COLUMN(a->hashes,cap);
+    for(int w=0;w<FEATURE_WORDS;w++)
+        GROW_COLUMN(a->features[w],cap);
+
+    for(uint32_t t=0;t<a->trait_count;t++){
+        GROW_COLUMN(a->traits[t].values,cap);
+        GROW_COLUMN(a->traits[t].numbers,cap);
+        memset(a->traits[t].values+a->cap,0,sizeof(char*)*(cap-a->cap));
+        memset(a->traits[t].numbers+a->cap,0,sizeof(float)*(cap-a->cap));
+    }
+
+    a->cap=cap;
+    return 0;
+}
+
+/* Resolves an NPC id to its archetype and slot */
+static archetype_t* find_npc(const char* id,uint32_t* out_slot)
+{
+    if(!id) return NULL;
+
+    long pos=index_find(id,hash_str(id));
+    if(pos<0) return NULL;
+
+    *out_slot=g_index[pos].ref-1;
+    return g_archetypes[g_index[pos].arch];
+}
+
+static inline float clamp01(float v)
+{
+    return v<0.0f?0.0f:(v>1.0f?1.0f:v);
+}
+
+static clinker_trait_t* find_trait(archetype_t* a,const char* key,int create)
+{
+    for(uint32_t i=0;i<a->trait_count;i++)
+        if(strcmp(a->traits[i].key,key)==0)
+            return &a->traits[i];
+
+    if(!create) return NULL;
+
+    clinker_trait_t* tmp=realloc(a->traits,sizeof(*tmp)*(a->trait_count+1));
+    if(!tmp) return NULL;
+    a->traits=tmp;
+
+    clinker_trait_t* t=&a->traits[a->trait_count];
+    memset(t,0,sizeof(*t));
+    t->key=fossil_strdup(key);
+    t->values=calloc(a->cap?a->cap:1,sizeof(char*));
+    t->numbers=calloc(a->cap?a->cap:1,sizeof(float));
+    if(!t->key||!t->values||!t->numbers){
+        free(t->key);
+        free(t->values);
+        free(t->numbers);
+        return NULL;
+    }
+
+    a->trait_count++;
+    return t;
+}
+
+static int find_action(archetype_t* a,const char* name,int create)
+{
+    for(uint16_t i=0;i<a->action_count;i++)
+        if(strcmp(a->actions[i],name)==0)
+            return i;
+
+    if(!create || a->action_count==NO_ACTION) return -1;
+
+    char** tmp=realloc(a->actions,sizeof(char*)*(a->action_count+1));
+    if(!tmp) return -1;
+    a->actions=tmp;
+
+    clinker_action_t* defs=realloc(a->defs,sizeof(*defs)*(a->action_count+1));
+    if(!defs) return -1;
+    a->defs=defs;
+
+    a->actions[a->action_count]=fossil_strdup(name);
+    if(!a->actions[a->action_count]) return -1;
+    memset(&a->defs[a->action_count],0,sizeof(*a->defs));
+    return a->action_count++;
+}
+
+/* ============================================================
+   Lifecycle
+   ============================================================ */
+
+int fossil_game_clinker_create(const char* npc_id,const char* archetype)
+{
+    if(!npc_id) return -1;
+    if(!archetype) archetype="default";
+
+    uint32_t h=hash_str(npc_id);
+    if(index_find(npc_id,h)>=0) return -2;
+
+    uint32_t arch;
+    archetype_t* a=find_archetype(archetype,&arch);
+    if(!a) a=create_archetype(archetype,&arch);
+    if(!a || archetype_reserve(a,a->count+1)!=0) return -3;
+
+    uint32_t slot=a->count;
+    a->ids[slot]=fossil_strdup(npc_id);
+    if(!a->ids[slot] || index_insert(h,arch,slot)!=0){
+        free(a->ids[slot]);
+        return -3;
+    }
+
+    a->hashes[slot]=h;
+    a->age[slot]=0;
+    a->timer[slot]=0;
+    a->action[slot]=NO_ACTION;
+    a->choice[slot]=NO_ACTION;
+    a->bt[slot]=BT_NO_NODE;
+    for(int w=0;w<FEATURE_WORDS;w++)
+        a->features[w][slot]=0;
+    for(uint32_t t=0;t<a->trait_count;t++){
+        a->traits[t].values[slot]=NULL;
+        a->traits[t].numbers[slot]=0.0f;
+    }
+
+    a->count++;
+    return 0;
+}
+
+int fossil_game_clinker_destroy(const char* npc_id)
+{
+    if(!npc_id) return -1;
+
+    uint32_t h=hash_str(npc_id);
+    long pos=index_find(npc_id,h);
+    if(pos<0) return -2;
+
+    uint32_t arch=g_index[pos].arch;
+    uint32_t slot=g_index[pos].ref-1;
+    archetype_t* a=g_archetypes[arch];
+
+    free(a->ids[slot]);
+    for(uint32_t t=0;t<a->trait_count;t++)
+        free(a->traits[t].values[slot]);
+
+    index_erase((uint32_t)pos);
+
+    /* keep columns dense: move the last NPC into the hole */
+    uint32_t last=--a->count;
+    if(slot!=last){
+        a->age[slot]=a->age[last];
+        a->timer[slot]=a->timer[last];
+        a->action[slot]=a->action[last];
+        a->choice[slot]=a->choice[last];
+        a->bt[slot]=a->bt[last];
+        a->ids[slot]=a->ids[last];
+        a->hashes[slot]=a->hashes[last];
+        for(int w=0;w<FEATURE_WORDS;w++)
+            a->features[w][slot]=a->features[w][last];
+        for(uint32_t t=0;t<a->trait_count;t++){
+            a->traits[t].values[slot]=a->traits[t].values[last];
+            a->traits[t].numbers[slot]=a->traits[t].numbers[last];
+        }
+
+        index_retarget(a->hashes[slot],arch,last,slot);
+    }
+    return 0;
+}
+
+int fossil_game_clinker_count(const char* archetype)
+{
+    if(!archetype) return -1;
+    archetype_t* a=find_archetype(archetype,NULL);
+    return a?(int)a->count:0;
+}
+
+/* ============================================================
+   Traits
+   ============================================================ */
+
+int fossil_game_clinker_set_trait(const char* npc_id,const char* key,const char* value)
+{
+    uint32_t slot;
+    archetype_t* a=find_npc(npc_id,&slot);
+    if(!a||!key) return -1;
+
+    clinker_trait_t* t=find_trait(a,key,value!=NULL);
+    if(!t) return value?-2:0;
+
+    char* copy=NULL;
+    if(value){
+        copy=fossil_strdup(value);
+        if(!copy) return -2;
+    }
+
+    free(t->values[slot]);
+    t->values[slot]=copy;
+    t->numbers[slot]=copy?strtof(copy,NULL):0.0f;
+    if(t->bounded) t->numbers[slot]=clamp01(t->numbers[slot]);
+    return 0;
+}
+
+const char* fossil_game_clinker_get_trait(const char* npc_id,const char* key)
+{
+    uint32_t slot;
+    archetype_t* a=find_npc(npc_id,&slot);
+    if(!a||!key) return NULL;
+
+    clinker_trait_t* t=find_trait(a,key,0);
+    if(!t) return NULL;
+
+    /* simulated traits are authoritative as numbers; refresh the text on read */
+    if(t->bounded){
+        char buf[32];
+        snprintf(buf,sizeof(buf),"%g",(double)t->numbers[slot]);
+        if(!t->values[slot] || strcmp(t->values[slot],buf)!=0){
+            char* copy=fossil_strdup(buf);
+            if(copy){
+                free(t->values[slot]);
+                t->values[slot]=copy;
+            }
+        }
+    }
+    return t->values[slot];
+}
+
+/* ============================================================
+   Utility scoring
+   ============================================================ */
+
+/*
+ * An action's utility is its weight times the product of its considerations,
+ * each a response curve over one numeric trait clamped to [0,1]. Scoring runs
+ * in blocks of NPCs, one action at a time, so every pass is a straight walk
+ * over a trait column that the SIMD kernels below can consume 4 or 8 lanes
+ * at a time. The highest positive utility wins; ties go to the earlier action.
+ */
+#define BLOCK 256
+
+static inline float curve_value(const clinker_consideration_t* c,float x)
+{
+    float d=x-c->c,y;
+
+    switch(c->curve){
+    case FOSSIL_GAME_CLINKER_CURVE_QUADRATIC:
+        y=c->m*d*d+c->b;
+        break;
+    case FOSSIL_GAME_CLINKER_CURVE_LOGISTIC:{
+        float t=c->k*d;
+        y=c->b+c->m*(0.5f+0.5f*t/(1.0f+(t<0.0f?-t:t)));
+        break;
+    }
+    case FOSSIL_GAME_CLINKER_CURVE_STEP:
+        y=c->b+(x>=c->c?c->m:0.0f);
+        break;
+    default:
+        y=c->m*d+c->b;
+        break;
+    }
+    return clamp01(y);
+}
+
+typedef void (*curve_kernel_fn)(const clinker_consideration_t* c,const float* x,float* acc,uint32_t n);
+typedef void (*select_kernel_fn)(const float* score,float* best,float* best_idx,float action,uint32_t n);
+typedef uint32_t (*scan_kernel_fn)(const uint64_t* words,uint64_t bit,uint32_t from,uint32_t n);
+
+static void curve_scalar(const clinker_consideration_t* c,const float* x,float* acc,uint32_t n)
+{
+    const float m=c->m,k=c->k,b=c->b,cc=c->c;
+
+    /* one loop per curve so the compiler can keep the body branch-free */
+    switch(c->curve){
+    case FOSSIL_GAME_CLINKER_CURVE_QUADRATIC:
+        for(uint32_t i=0;i<n;i++){ float d=x[i]-cc; acc[i]*=clamp01(m*d*d+b); }
+        break;
+    case FOSSIL_GAME_CLINKER_CURVE_LOGISTIC:
+        for(uint32_t i=0;i<n;i++){
+            float t=k*(x[i]-cc);
+            acc[i]*=clamp01(b+m*(0.5f+0.5f*t/(1.0f+(t<0.0f?-t:t))));
+        }
+        break;
+    case FOSSIL_GAME_CLINKER_CURVE_STEP:
+        for(uint32_t i=0;i<n;i++) acc[i]*=clamp01(b+(x[i]>=cc?m:0.0f));
+        break;
+    default:
+        for(uint32_t i=0;i<n;i++) acc[i]*=clamp01(m*(x[i]-cc)+b);
+        break;
+    }
+}
+
+static void select_scalar(const float* score,float* best,float* best_idx,float action,uint32_t n)
+{
+    for(uint32_t i=0;i<n;i++){
+        if(score[i]>best[i]){
+            best[i]=score[i];
+            best_idx[i]=action;
+        }
+    }
+}
+
+#ifdef CLINKER_HAVE_SSE2
+/* clamp the curve output to [0,1] and fold it into the running product */
+#define CURVE_STORE(y) \
+    _mm_storeu_ps(acc+i,_mm_mul_ps(_mm_loadu_ps(acc+i),_mm_min_ps(_mm_max_ps((y),zero),one)))
+
+static void curve_sse2(const clinker_consideration_t* c,const float* x,float* acc,uint32_t n)
+{
+    const __m128 m=_mm_set1_ps(c->m),k=_mm_set1_ps(c->k);
+    const __m128 b=_mm_set1_ps(c->b),cc=_mm_set1_ps(c->c);
+    const __m128 zero=_mm_setzero_ps(),one=_mm_set1_ps(1.0f),half=_mm_set1_ps(0.5f);
+    const __m128 sign=_mm_set1_ps(-0.0f);
+    uint32_t i=0;
+
+    switch(c->curve){
+    case FOSSIL_GAME_CLINKER_CURVE_QUADRATIC:
+        for(;i+4<=n;i+=4){
+            __m128 d=_mm_sub_ps(_mm_loadu_ps(x+i),cc);
+            CURVE_STORE(_mm_add_ps(_mm_mul_ps(m,_mm_mul_ps(d,d)),b));
+        }
+        break;
+    case FOSSIL_GAME_CLINKER_CURVE_LOGISTIC:
+        for(;i+4<=n;i+=4){
+            __m128 t=_mm_mul_ps(k,_mm_sub_ps(_mm_loadu_ps(x+i),cc));
+            __m128 s=_mm_div_ps(t,_mm_add_ps(one,_mm_andnot_ps(sign,t)));
+            CURVE_STORE(_mm_add_ps(b,_mm_mul_ps(m,_mm_add_ps(half,_mm_mul_ps(half,s)))));
+        }
+        break;
+    case FOSSIL_GAME_CLINKER_CURVE_STEP:
+        for(;i+4<=n;i+=4){
+            __m128 v=_mm_loadu_ps(x+i);
+            CURVE_STORE(_mm_add_ps(b,_mm_and_ps(_mm_cmpge_ps(v,cc),m)));
+        }
+        break;
+    default:
+        for(;i+4<=n;i+=4)
+            CURVE_STORE(_mm_add_ps(_mm_mul_ps(m,_mm_sub_ps(_mm_loadu_ps(x+i),cc)),b));
+        break;
+    }
+    curve_scalar(c,x+i,acc+i,n-i);
+}
+#undef CURVE_STORE
+
+static void select_sse2(const float* score,float* best,float* best_idx,float action,uint32_t n)
+{
+    const __m128 act=_mm_set1_ps(action);
+    uint32_t i=0;
+
+    for(;i+4<=n;i+=4){
+        __m128 s=_mm_loadu_ps(score+i);
+        __m128 bv=_mm_loadu_ps(best+i);
+        __m128 win=_mm_cmpgt_ps(s,bv);
+        __m128 idx=_mm_loadu_ps(best_idx+i);
+        _mm_storeu_ps(best+i,_mm_max_ps(s,bv));
+        _mm_storeu_ps(best_idx+i,_mm_or_ps(_mm_and_ps(win,act),_mm_andnot_ps(win,idx)));
+    }
+    select_scalar(score+i,best+i,best_idx+i,action,n-i);
+}
+#endif
+
+#ifdef CLINKER_HAVE_AVX2
+#define CURVE_STORE(y) \
+    _mm256_storeu_ps(acc+i,_mm256_mul_ps(_mm256_loadu_ps(acc+i),_mm256_min_ps(_mm256_max_ps((y),zero),one)))
+
+__attribute__((target("avx2")))
+static void curve_avx2(const clinker_consideration_t* c,const float* x,float* acc,uint32_t n)
+{
+    const __m256 m=_mm256_set1_ps(c->m),k=_mm256_set1_ps(c->k);
+    const __m256 b=_mm256_set1_ps(c->b),cc=_mm256_set1_ps(c->c);
+    const __m256 zero=_mm256_setzero_ps(),one=_mm256_set1_ps(1.0f),half=_mm256_set1_ps(0.5f);
+    const __m256 sign=_mm256_set1_ps(-0.0f);
+    uint32_t i=0;
+
+    switch(c->curve){
+    case FOSSIL_GAME_CLINKER_CURVE_QUADRATIC:
+        for(;i+8<=n;i+=8){
+            __m256 d=_mm256_sub_ps(_mm256_loadu_ps(x+i),cc);
+            CURVE_STORE(_mm256_add_ps(_mm256_mul_ps(m,_mm256_mul_ps(d,d)),b));
+        }
+        break;
+    case FOSSIL_GAME_CLINKER_CURVE_LOGISTIC:
+        for(;i+8<=n;i+=8){
+            __m256 t=_mm256_mul_ps(k,_mm256_sub_ps(_mm256_loadu_ps(x+i),cc));
+            __m256 s=_mm256_div_ps(t,_mm256_add_ps(one,_mm256_andnot_ps(sign,t)));
+            CURVE_STORE(_mm256_add_ps(b,_mm256_mul_ps(m,_mm256_add_ps(half,_mm256_mul_ps(half,s)))));
+        }
+        break;
+    case FOSSIL_GAME_CLINKER_CURVE_STEP:
+        for(;i+8<=n;i+=8){
+            __m256 v=_mm256_loadu_ps(x+i);
+            CURVE_STORE(_mm256_add_ps(b,_mm256_and_ps(_mm256_cmp_ps(v,cc,_CMP_GE_OQ),m)));
+        }
+        break;
+    default:
+        for(;i+8<=n;i+=8)
+            CURVE_STORE(_mm256_add_ps(_mm256_mul_ps(m,_mm256_sub_ps(_mm256_loadu_ps(x+i),cc)),b));
+        break;
+    }
+    curve_scalar(c,x+i,acc+i,n-i);
+}
+#undef CURVE_STORE
+
+__attribute__((target("avx2")))
+static void select_avx2(const float* score,float* best,float* best_idx,float action,uint32_t n)
+{
+    const __m256 act=_mm256_set1_ps(action);
+    uint32_t i=0;
+
+    for(;i+8<=n;i+=8){
+        __m256 s=_mm256_loadu_ps(score+i);
+        __m256 bv=_mm256_loadu_ps(best+i);
+        __m256 win=_mm256_cmp_ps(s,bv,_CMP_GT_OQ);
+        _mm256_storeu_ps(best+i,_mm256_max_ps(s,bv));
+        _mm256_storeu_ps(best_idx+i,_mm256_blendv_ps(_mm256_loadu_ps(best_idx+i),act,win));
+    }
+    select_scalar(score+i,best+i,best_idx+i,action,n-i);
+}
+#endif
+
+/* Feature scans return the first slot at or after `from` whose word has the bit, or n */
+static uint32_t scan_scalar(const uint64_t* words,uint64_t bit,uint32_t from,uint32_t n)
+{
+    for(uint32_t i=from;i<n;i++)
+        if(words[i]&bit) return i;
+    return n;
+}
+
+#ifdef CLINKER_HAVE_SSE2
+static uint32_t scan_sse2(const uint64_t* words,uint64_t bit,uint32_t from,uint32_t n)
+{
+    const __m128i m=_mm_set1_epi64x((long long)bit);
+    const __m128i zero=_mm_setzero_si128();
+    uint32_t i=from;
+
+    /* skip blocks of four NPCs without the bit; the scalar tail finds the hit */
+    for(;i+4<=n;i+=4){
+        __m128i x=_mm_or_si128(_mm_and_si128(_mm_loadu_si128((const __m128i*)(words+i)),m),
+                               _mm_and_si128(_mm_loadu_si128((const __m128i*)(words+i+2)),m));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi32(x,zero))!=0xFFFF) break;
+    }
+    return scan_scalar(words,bit,i,n);
+}
+#endif
+
+#ifdef CLINKER_HAVE_AVX2
+__attribute__((target("avx2")))
+static uint32_t scan_avx2(const uint64_t* words,uint64_t bit,uint32_t from,uint32_t n)
+{
+    const __m256i m=_mm256_set1_epi64x((long long)bit);
+    uint32_t i=from;
+
+    for(;i+8<=n;i+=8){
+        __m256i x=_mm256_or_si256(_mm256_loadu_si256((const __m256i*)(words+i)),
+                                  _mm256_loadu_si256((const __m256i*)(words+i+4)));
+        if(!_mm256_testz_si256(x,m)) break;
+    }
+    return scan_scalar(words,bit,i,n);
+}
+#endif
+
+static int g_simd=-1;
+static curve_kernel_fn g_curve=curve_scalar;
+static select_kernel_fn g_select=select_scalar;
+static scan_kernel_fn g_scan=scan_scalar;
+
+static int simd_supported(void)
+{
+#ifdef CLINKER_HAVE_AVX2
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return FOSSIL_GAME_CLINKER_SIMD_AVX2;
+#endif
+#ifdef CLINKER_HAVE_SSE2
+    return FOSSIL_GAME_CLINKER_SIMD_SSE2;
+#else
+    return FOSSIL_GAME_CLINKER_SIMD_SCALAR;
+#endif
+}
+
+/*
+ * The default picks the widest feature scan but keeps decide on SSE2: in
+ * bench_clinker the AVX2 curve and select kernels score fewer decisions
+ * per second than SSE2 (about 30M/s against 40M/s), while the AVX2 scan is
+ * clearly faster. Asking for AVX2 explicitly still uses it everywhere.
+ */
+int fossil_game_clinker_set_simd(int level)
+{
+    int best=simd_supported();
+    if(level>best) level=best;
+
+    int scan=level<0?best:level;
+    if(level<0) level=best>FOSSIL_GAME_CLINKER_SIMD_SSE2?FOSSIL_GAME_CLINKER_SIMD_SSE2:best;
+
+    g_curve=curve_scalar;
+    g_select=select_scalar;
+    g_scan=scan_scalar;
+#ifdef CLINKER_HAVE_SSE2
+    if(level==FOSSIL_GAME_CLINKER_SIMD_SSE2){ g_curve=curve_sse2; g_select=select_sse2; }
+    if(scan==FOSSIL_GAME_CLINKER_SIMD_SSE2) g_scan=scan_sse2;
+#endif
+#ifdef CLINKER_HAVE_AVX2
+    if(level==FOSSIL_GAME_CLINKER_SIMD_AVX2){ g_curve=curve_avx2; g_select=select_avx2; }
+    if(scan==FOSSIL_GAME_CLINKER_SIMD_AVX2) g_scan=scan_avx2;
+#endif
+
+    g_simd=level;
+    return level;
+}
+
+static void decide_block(archetype_t* a,uint32_t base,uint32_t n)
+{
+    float best[BLOCK],best_idx[BLOCK],score[BLOCK];
+
+    for(uint32_t i=0;i<n;i++){
+        best[i]=0.0f;
+        best_idx[i]=(float)NO_ACTION;
+    }
+
+    for(uint16_t act=0;act<a->action_count;act++){
+        const clinker_action_t* def=&a->defs[act];
+        if(!def->scored) continue;
+
+        for(uint32_t i=0;i<n;i++) score[i]=def->weight;
+        for(uint32_t k=0;k<def->consideration_count;k++){
+            const clinker_consideration_t* c=&def->considerations[k];
+            g_curve(c,a->traits[c->trait].numbers+base,score,n);
+        }
+        g_select(score,best,best_idx,(float)act,n);
+    }
+
+    for(uint32_t i=0;i<n;i++)
+        a->choice[base+i]=(uint16_t)best_idx[i];
+}
+
+static void decide_all(archetype_t* a)
+{
+    if(g_simd<0) fossil_game_clinker_set_simd(-1);
+
+    for(uint32_t base=0;base<a->count;base+=BLOCK){
+        uint32_t n=a->count-base<BLOCK?a->count-base:BLOCK;
+        decide_block(a,base,n);
+    }
+}
+
+static uint16_t decide_one(const archetype_t* a,uint32_t slot)
+{
+    float best=0.0f;
+    uint16_t pick=NO_ACTION;
+
+    for(uint16_t act=0;act<a->action_count;act++){
+        const clinker_action_t* def=&a->defs[act];
+        if(!def->scored) continue;
+
+        float score=def->weight;
+        for(uint32_t k=0;k<def->consideration_count;k++){
+            const clinker_consideration_t* c=&def->considerations[k];
+            score*=curve_value(c,a->traits[c->trait].numbers[slot]);
+        }
+        if(score>best){
+            best=score;
+            pick=act;
+        }
+    }
+    return pick;
+}
+
+int fossil_game_clinker_define_action(const char* archetype,const char* action,float weight,int duration_ticks)
+{
+    if(!archetype||!action||duration_ticks<=0) return -1;
+
+    uint32_t arch;
+    archetype_t* a=find_archetype(archetype,&arch);
+    if(!a) a=create_archetype(archetype,&arch);
+    if(!a) return -2;
+
+    int idx=find_action(a,action,1);
+    if(idx<0) return -2;
+
+    clinker_action_t* def=&a->defs[idx];
+    if(!def->scored) a->scored_count++;
+    def->scored=1;
+    def->weight=weight;
+    def->duration=(uint32_t)duration_ticks;
+    return 0;
+}
+
+/* Resolves the action and trait column an archetype-level definition refers to */
+static clinker_action_t* action_trait(const char* archetype,const char* action,const char* trait,
+                                      archetype_t** out_a,uint32_t* out_trait)
+{
+    if(!archetype||!action||!trait) return NULL;
+
+    archetype_t* a=find_archetype(archetype,NULL);
+    if(!a) return NULL;
+
+    int idx=find_action(a,action,0);
+    clinker_trait_t* t=find_trait(a,trait,1);
+    if(idx<0||!t) return NULL;
+
+    *out_a=a;
+    *out_trait=(uint32_t)(t-a->traits);
+    return &a->defs[idx];
+}
+
+int fossil_game_clinker_add_consideration(const char* archetype,const char* action,const char* trait,
+                                          int curve,float m,float k,float b,float c)
+{
+    archetype_t* a;
+    uint32_t col;
+    clinker_action_t* def=action_trait(archetype,action,trait,&a,&col);
+    if(!def) return -1;
+
+    clinker_consideration_t* tmp=realloc(def->considerations,sizeof(*tmp)*(def->consideration_count+1));
+    if(!tmp) return -2;
+    def->considerations=tmp;
+
+    clinker_consideration_t* cons=&tmp[def->consideration_count++];
+    cons->trait=col;
+    cons->curve=curve;
+    cons->m=m;
+    cons->k=k;
+    cons->b=b;
+    cons->c=c;
+    return 0;
+}
+
+int fossil_game_clinker_add_effect(const char* archetype,const char* action,const char* trait,float per_tick)
+{
+    archetype_t* a;
+    uint32_t col;
+    clinker_action_t* def=action_trait(archetype,action,trait,&a,&col);
+    if(!def) return -1;
+
+    clinker_effect_t* tmp=realloc(def->effects,sizeof(*tmp)*(def->effect_count+1));
+    if(!tmp) return -2;
+    def->effects=tmp;
+
+    tmp[def->effect_count].trait=col;
+    tmp[def->effect_count].per_tick=per_tick;
+    def->effect_count++;
+    a->traits[col].bounded=1;
+    return 0;
+}
+
+int fossil_game_clinker_set_drift(const char* archetype,const char* trait,float per_tick)
+{
+    if(!archetype||!trait) return -1;
+
+    archetype_t* a=find_archetype(archetype,NULL);
+    if(!a) return -1;
+
+    clinker_trait_t* t=find_trait(a,trait,1);
+    if(!t) return -2;
+
+    t->drift=per_tick;
+    t->bounded=1;
+    return 0;
+}
+
+int fossil_game_clinker_decide_all(const char* archetype)
+{
+    if(!archetype) return -1;
+
+    archetype_t* a=find_archetype(archetype,NULL);
+    if(!a) return 0;
+
+    decide_all(a);
+    return (int)a->count;
+}
+
+/* ============================================================
+   Behavior trees
+   ============================================================ */
+
+/*
+ * An archetype's tree is compiled once into a preorder node array shared by
+ * all of its NPCs. Children follow their parent directly and `end` marks one
+ * past the subtree, so siblings are reached by index and nothing points
+ * anywhere. An NPC only carries the running leaf and the action timer.
+ */
+enum {
+    BT_SELECTOR,
+    BT_SEQUENCE,
+    BT_INVERT,
+    BT_CONDITION,
+    BT_ACTION,
+    BT_WAIT,
+    BT_UTILITY,
+    BT_SUCCEED,
+    BT_FAIL
+};
+
+enum { CMP_LT, CMP_LE, CMP_GT, CMP_GE, CMP_EQ, CMP_NE };
+
+enum { BT_FAILURE, BT_SUCCESS, BT_RUNNING };
+
+static const char* const bt_names[]={
+    "selector","sequence","invert","condition","action","wait","utility","succeed","fail"
+};
+
+static char g_load_error[128]="";
+
+static int load_fail(int line,const char* what)
+{
+    snprintf(g_load_error,sizeof(g_load_error),"line %d: %s",line,what);
+    return -2;
+}
+
+/* Whole-token numbers only, so "3x" or "abc" are errors rather than 3 and 0 */
+static int parse_float(const char* s,float* out)
+{
+    char* end;
+    float v=strtof(s,&end);
+    if(end==s || *end) return -1;
+    *out=v;
+    return 0;
+}
+
+static int parse_ticks(const char* s,int* out)
+{
+    char* end;
+    long v=strtol(s,&end,10);
+    if(end==s || *end) return -1;
+    *out=v<0?0:v>UINT16_MAX?UINT16_MAX:(int)v;
+    return 0;
+}
+
+static int parse_cmp(const char* s)
+{
+    static const char* const ops[]={"<","<=",">",">=","==","!="};
+    for(int i=0;i<6;i++)
+        if(strcmp(s,ops[i])==0) return i;
+    return -1;
+}
+
+static int bt_close(bt_node_t* nodes,uint16_t node,uint32_t end,int line)
+{
+    nodes[node].end=(uint16_t)end;
+
+    /* children close first, so the single child's subtree must run to our end */
+    if(nodes[node].op==BT_INVERT && (end==node+1u || nodes[node+1].end!=end))
+        return load_fail(line,"invert takes exactly one child");
+    return 0;
+}
+
+static void drop_names(archetype_t* a,uint32_t traits,uint16_t actions)
+{
+    while(a->trait_count>traits){
+        clinker_trait_t* t=&a->traits[--a->trait_count];
+        free(t->key);
+        free(t->values);
+        free(t->numbers);
+    }
+    while(a->action_count>actions)
+        free(a->actions[--a->action_count]);
+}
+
+static int bt_compile(archetype_t* a,const char* src,bt_node_t** out,uint16_t* out_len)
+{
+    bt_node_t* nodes=NULL;
+    uint32_t count=0,cap=0;
+
+    int indent_of[BT_MAX_DEPTH];
+    uint16_t open[BT_MAX_DEPTH];
+    int depth=0,line_no=0,rc=0;
+
+    const char* p=src;
+    while(*p && rc==0){
+        const char* eol=strchr(p,'\n');
+        size_t len=eol?(size_t)(eol-p):strlen(p);
+        line_no++;
+
+        char line[256];
+        if(len>=sizeof(line)){ rc=load_fail(line_no,"line too long"); break; }
+        memcpy(line,p,len);
+        line[len]='\0';
+        p=eol?eol+1:p+len;
+
+        char* hash=strchr(line,'#');
+        if(hash) *hash='\0';
+
+        int indent=0;
+        while(line[indent]==' '||line[indent]=='\t') indent+=line[indent]=='\t'?4:1;
+
+        char tok[4][64]={{0}};
+        int ntok=sscanf(line,"%63s %63s %63s %63s",tok[0],tok[1],tok[2],tok[3]);
+        if(ntok<=0) continue;
+
+        /* close every open node at or beyond this indentation */
+        while(depth>0 && indent_of[depth-1]>=indent && rc==0)
+            rc=bt_close(nodes,open[--depth],count,line_no);
+        if(rc!=0) break;
+
+        if(depth==0 && count>0){ rc=load_fail(line_no,"more than one root"); break; }
+        if(depth>0 && nodes[open[depth-1]].op>BT_INVERT){ rc=load_fail(line_no,"leaf nodes take no children"); break; }
+        if(depth>0 && nodes[open[depth-1]].op==BT_INVERT && count>open[depth-1]+1u){
+            rc=load_fail(line_no,"invert takes exactly one child");
+            break;
+        }
+        if(depth==BT_MAX_DEPTH){ rc=load_fail(line_no,"tree too deep"); break; }
+        if(count>=BT_NO_NODE-1){ rc=load_fail(line_no,"tree too large"); break; }
+
+        if(count==cap){
+            cap=cap?cap*2:16;
+            bt_node_t* tmp=realloc(nodes,sizeof(*tmp)*cap);
+            if(!tmp){ rc=-3; break; }
+            nodes=tmp;
+        }
+
+        bt_node_t* n=&nodes[count];
+        memset(n,0,sizeof(*n));
+        n->parent=depth?open[depth-1]:BT_NO_NODE;
+
+        int op=-1;
+        for(int i=0;i<(int)(sizeof(bt_names)/sizeof(*bt_names));i++)
+            if(strcmp(tok[0],bt_names[i])==0) op=i;
+        if(op<0){ rc=load_fail(line_no,"unknown node"); break; }
+        n->op=(uint8_t)op;
+
+        if(op==BT_CONDITION){
+            clinker_trait_t* t;
+            int cmp=ntok==4?parse_cmp(tok[2]):-1;
+            if(cmp<0 || parse_float(tok[3],&n->value)!=0){
+                rc=load_fail(line_no,"expected: condition <trait> <op> <value>");
+                break;
+            }
+            if(!(t=find_trait(a,tok[1],1))){ rc=-3; break; }
+            n->cmp=(uint8_t)cmp;
+            n->arg=(uint16_t)(t-a->traits);
+        }else if(op==BT_ACTION){
+            int ticks=0;
+            if(ntok<2 || (ntok>=3 && parse_ticks(tok[2],&ticks)!=0)){
+                rc=load_fail(line_no,"expected: action <name> [ticks]");
+                break;
+            }
+            int act=find_action(a,tok[1],1);
+            if(act<0){ rc=-3; break; }
+            if(ntok<3) ticks=(int)a->defs[act].duration;
+            n->arg=(uint16_t)act;
+            n->ticks=(uint16_t)(ticks>0?(ticks<UINT16_MAX?ticks:UINT16_MAX):1);
+        }else if(op==BT_WAIT){
+            int ticks=0;
+            if(ntok<2 || parse_ticks(tok[1],&ticks)!=0 || ticks<=0){
+                rc=load_fail(line_no,"expected: wait <ticks>");
+                break;
+            }
+            n->ticks=(uint16_t)ticks;
+        }
+
+        indent_of[depth]=indent;
+        open[depth++]=(uint16_t)count;
+        count++;
+    }
+
+    while(depth>0 && rc==0)
+        rc=bt_close(nodes,open[--depth],count,line_no);
+
+    if(rc==0 && count==0) rc=load_fail(line_no,"empty tree");
+
+    if(rc!=0){
+        free(nodes);
+        return rc;
+    }
+
+    *out=nodes;
+    *out_len=(uint16_t)count;
+    return 0;
+}
+
+static int bt_test(const bt_node_t* n,float v)
+{
+    switch(n->cmp){
+    case CMP_LT: return v<n->value;
+    case CMP_LE: return v<=n->value;
+    case CMP_GT: return v>n->value;
+    case CMP_GE: return v>=n->value;
+    case CMP_EQ: return v==n->value;
+    default:     return v!=n->value;
+    }
+}
+
+/*
+ * Runs NPC i's tree until a leaf starts running or the root completes. With
+ * a running leaf that just finished, the walk resumes upward from it with
+ * success; otherwise it enters at the root. A resumed walk that finishes the
+ * root may enter it once more, so each node is entered at most twice per call.
+ */
+static void bt_run(archetype_t* a,uint32_t i)
+{
+    const bt_node_t* tree=a->tree;
+    uint16_t node=a->bt[i];
+    int status=BT_SUCCESS;
+    int entering=node==BT_NO_NODE;
+    int restarted=entering;
+
+    if(entering) node=0;
+    a->bt[i]=BT_NO_NODE;
+
+    for(;;){
+        const bt_node_t* n=&tree[node];
+
+        if(entering){
+            switch(n->op){
+            case BT_SELECTOR:
+            case BT_SEQUENCE:
+                if(n->end>node+1){ node++; continue; }
+                status=n->op==BT_SEQUENCE?BT_SUCCESS:BT_FAILURE;
+                break;
+            case BT_INVERT:
+                node++;
+                continue;
+            case BT_CONDITION:
+                status=bt_test(n,a->traits[n->arg].numbers[i])?BT_SUCCESS:BT_FAILURE;
+                break;
+            case BT_ACTION:
+                a->action[i]=n->arg;
+                a->timer[i]=n->ticks;
+                a->bt[i]=node;
+                return;
+            case BT_WAIT:
+                a->action[i]=NO_ACTION;
+                a->timer[i]=n->ticks;
+                a->bt[i]=node;
+                return;
+            case BT_UTILITY:{
+                uint16_t pick=a->scored_count?decide_one(a,i):NO_ACTION;
+                if(pick==NO_ACTION){ status=BT_FAILURE; break; }
+                a->action[i]=pick;
+                a->timer[i]=a->defs[pick].duration;
+                a->bt[i]=node;
+                return;
+            }
+            case BT_SUCCEED:
+                status=BT_SUCCESS;
+                break;
+            default:
+                status=BT_FAILURE;
+                break;
+            }
+            entering=0;
+        }
+
+        /* node finished with status; let the parent react */
+        uint16_t parent=n->parent;
+        if(parent==BT_NO_NODE){
+            /* a resumed tree that completes starts over at once, but only once */
+            if(restarted) return;
+            restarted=1;
+            node=0;
+            entering=1;
+            continue;
+        }
+
+        const bt_node_t* pn=&tree[parent];
+        int next=n->end<pn->end;
+
+        if(pn->op==BT_SEQUENCE && status==BT_SUCCESS && next){
+            node=n->end;
+            entering=1;
+        }else if(pn->op==BT_SELECTOR && status==BT_FAILURE && next){
+            node=n->end;
+            entering=1;
+        }else{
+            if(pn->op==BT_INVERT) status=status==BT_SUCCESS?BT_FAILURE:BT_SUCCESS;
+            node=parent;
+        }
+    }
+}
+
+int fossil_game_clinker_load_archetype(const char* archetype,const char* source)
+{
+    if(!archetype||!source) return -1;
+
+    uint32_t arch;
+    archetype_t* a=find_archetype(archetype,&arch);
+    int created=!a;
+    if(!a) a=create_archetype(archetype,&arch);
+    if(!a) return -3;
+
+    /* a tree that does not compile leaves the archetype as it was */
+    uint32_t traits=a->trait_count;
+    uint16_t actions=a->action_count;
+
+    bt_node_t* tree;
+    uint16_t len;
+    int rc=bt_compile(a,source,&tree,&len);
+    if(rc!=0){
+        drop_names(a,traits,actions);
+        if(created){
+            g_archetype_count--;
+            free(a->traits);
+            free(a->actions);
+            free(a->defs);
+            free(a->name);
+            free(a);
+        }
+        return rc;
+    }
+
+    free(a->tree);
+    a->tree=tree;
+    a->tree_len=len;
+
+    /* running actions finish, then every NPC re-enters the new tree at its root */
+    for(uint32_t i=0;i<a->count;i++)
+        a->bt[i]=BT_NO_NODE;
+
+    g_load_error[0]='\0';
+    return 0;
+}
+
+int fossil_game_clinker_load_archetype_file(const char* archetype,const char* path)
+{
+    if(!archetype||!path) return -1;
+
+    FILE* f=fopen(path,"rb");
+    if(!f) return -4;
+
+    char* buf=NULL;
+    size_t len=0,cap=0,n;
+    char chunk[4096];
+    while((n=fread(chunk,1,sizeof(chunk),f))>0){
+        if(len+n+1>cap){
+            cap=(len+n+1)*2;
+            char* tmp=realloc(buf,cap);
+            if(!tmp){ free(buf); fclose(f); return -3; }
+            buf=tmp;
+        }
+        memcpy(buf+len,chunk,n);
+        len+=n;
+    }
+    fclose(f);
+
+    if(!buf) return load_fail(0,"empty tree");
+    buf[len]='\0';
+
+    int rc=fossil_game_clinker_load_archetype(archetype,buf);
+    free(buf);
+    return rc;
+}
+
+const char* fossil_game_clinker_load_error(void)
+{
+    return g_load_error;
+}
+
+/* ============================================================
+   Simulation
+   ============================================================ */
+
+static inline void apply_effects(archetype_t* a,uint32_t i)
+{
+    if(a->action[i]==NO_ACTION) return;
+
+    const clinker_action_t* def=&a->defs[a->action[i]];
+    for(uint32_t e=0;e<def->effect_count;e++){
+        float* v=&a->traits[def->effects[e].trait].numbers[i];
+        *v=clamp01(*v+def->effects[e].per_tick);
+    }
+}
+
+static inline void begin(archetype_t* a,uint32_t i,uint16_t act)
+{
+    if(act==NO_ACTION) return;
+    a->action[i]=act;
+    a->timer[i]=a->defs[act].duration;
+}
+
+/* The per-NPC step; tick_all runs the same phases column by column */
+static void step(archetype_t* a,uint32_t i)
+{
+    for(uint32_t t=0;t<a->trait_count;t++)
+        if(a->traits[t].drift!=0.0f)
+            a->traits[t].numbers[i]=clamp01(a->traits[t].numbers[i]+a->traits[t].drift);
+
+    a->age[i]++;
+    if(a->timer[i]){
+        apply_effects(a,i);
+        if(--a->timer[i]==0) a->action[i]=NO_ACTION;
+    }
+
+    if(a->tree){
+        if(!a->timer[i]) bt_run(a,i);
+    }else if(a->action[i]==NO_ACTION && a->scored_count)
+        begin(a,i,a->choice[i]=decide_one(a,i));
+}
+
+int fossil_game_clinker_tick(const char* npc_id)
+{
+    uint32_t slot;
+    archetype_t* a=find_npc(npc_id,&slot);
+    if(!a) return -1;
+
+    step(a,slot);
+    return 0;
+}
+
+static int clinker_tick_all(const char* archetype)
+{
+    if(!archetype) return -1;
+
+    archetype_t* a=find_archetype(archetype,NULL);
+    if(!a) return 0;
+
+    uint32_t n=a->count;
+    uint32_t* age=a->age;
+    uint32_t* timer=a->timer;
+    uint16_t* action=a->action;
+
+    FOSSIL_GAME_TRACE_BEGIN("clinker_drift");
+    for(uint32_t t=0;t<a->trait_count;t++){
+        float d=a->traits[t].drift;
+        float* v=a->traits[t].numbers;
+        if(d==0.0f) continue;
+        for(uint32_t i=0;i<n;i++)
+            v[i]=clamp01(v[i]+d);
+    }
+    FOSSIL_GAME_TRACE_END("clinker_drift");
+
+    FOSSIL_GAME_TRACE_BEGIN("clinker_effects");
+    for(uint32_t i=0;i<n;i++){
+        age[i]++;
+        uint32_t t=timer[i];
+        if(t){
+            apply_effects(a,i);
+            timer[i]=--t;
+            if(!t) action[i]=NO_ACTION;
+        }
+    }
+    FOSSIL_GAME_TRACE_END("clinker_effects");
+
+    FOSSIL_GAME_TRACE_BEGIN("clinker_decide");
+    if(a->tree){
+        /* shared bytecode: only NPCs whose action just finished walk the tree */
+        for(uint32_t i=0;i<n;i++)
+            if(!timer[i]) bt_run(a,i);
+    }else if(a->scored_count){
+        decide_all(a);
+        for(uint32_t i=0;i<n;i++)
+            if(action[i]==NO_ACTION)
+                begin(a,i,a->choice[i]);
+    }
+    FOSSIL_GAME_TRACE_END("clinker_decide");
+    return (int)n;
+}
+
+int fossil_game_clinker_tick_all(const char* archetype)
+{
+    FOSSIL_GAME_METRIC_BEGIN(CLINKER_TICK_ALL);
+    FOSSIL_GAME_TRACE_BEGIN("clinker_tick_all");
+    int rc=clinker_tick_all(archetype);
+    FOSSIL_GAME_TRACE_END("clinker_tick_all");
+    FOSSIL_GAME_METRIC_END(CLINKER_TICK_ALL);
+    return rc;
+}
+
+int fossil_game_clinker_start_action(const char* npc_id,const char* action,int ticks)
+{
+    uint32_t slot;
+    archetype_t* a=find_npc(npc_id,&slot);
+    if(!a||!action||ticks<=0) return -1;
+
+    int idx=find_action(a,action,1);
+    if(idx<0) return -2;
+
+    a->action[slot]=(uint16_t)idx;
+    a->timer[slot]=(uint32_t)ticks;
+    a->bt[slot]=BT_NO_NODE;
+    return 0;
+}
+
+const char* fossil_game_clinker_choose_action(const char* npc_id)
+{
+    uint32_t slot;
+    archetype_t* a=find_npc(npc_id,&slot);
+    if(!a) return NULL;
+
+    /* a running action keeps the NPC busy; otherwise report what it would pick now */
+    uint16_t act=a->action[slot];
+    if(act==NO_ACTION && a->scored_count && !a->tree) act=decide_one(a,slot);
+    return act==NO_ACTION?"idle":a->actions[act];
+}
+
+/* ============================================================
+   Features
+   ============================================================ */
+
+static int set_feature(const char* npc_id,const char* feature,int enabled)
+{
+    uint32_t slot;
+    archetype_t* a=find_npc(npc_id,&slot);
+    if(!a||!feature) return -1;
+
+    /* clearing a name nobody registered is a no-op, not a new bit */
+    int bit=enabled?fossil_game_feature_register(feature):fossil_game_feature_lookup(feature);
+    if(bit<0) return enabled?-2:0;
+
+    uint64_t b=(uint64_t)1<<(bit&63);
+    if(enabled) a->features[bit>>6][slot]|=b;
+    else        a->features[bit>>6][slot]&=~b;
+    return 0;
+}
+
+int fossil_game_clinker_enable_feature(const char* npc_id,const char* feature){
+    return set_feature(npc_id,feature,1);
+}
+int fossil_game_clinker_disable_feature(const char* npc_id,const char* feature){
+    return set_feature(npc_id,feature,0);
+}
+
+int fossil_game_clinker_has_feature(const char* npc_id,const char* feature)
+{
+    uint32_t slot;
+    archetype_t* a=find_npc(npc_id,&slot);
+    if(!a||!feature) return -1;
+
+    int bit=fossil_game_feature_lookup(feature);
+    if(bit<0) return 0;
+    return (int)((a->features[bit>>6][slot]>>(bit&63))&1);
+}
+
+int fossil_game_clinker_query_feature(const char* archetype,const char* feature,
+                                      const char** out_ids,int cap,int* out_count)
+{
+    if(!archetype||!feature||!out_count||(cap>0&&!out_ids)) return -1;
+    *out_count=0;
+
+    archetype_t* a=find_archetype(archetype,NULL);
+    int bit=fossil_game_feature_lookup(feature);
+    if(!a||bit<0) return 0;
+    if(g_simd<0) fossil_game_clinker_set_simd(-1);
+
+    const uint64_t* words=a->features[bit>>6];
+    uint64_t b=(uint64_t)1<<(bit&63);
+    uint32_t n=a->count;
+    int found=0;
+
+    for(uint32_t i=g_scan(words,b,0,n);i<n;i=g_scan(words,b,i+1,n)){
+        if(found<cap) out_ids[found]=a->ids[i];
+        found++;
+    }
+
+    *out_count=found;
+    return found>cap?-4:0;
+}
+
+/* ============================================================
+   Metrics
+   ============================================================ */
+
+void fossil_game_clinker_metrics_registry(fossil_game_metrics_registry* out)
+{
+    out->npcs=g_index_used;
+}
@@ -0,0 +1,126 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/feature.h"
+#include <stdlib.h>
+#include <string.h>
+
+static char* fossil_strdup(const char* s)
+{
+    if(!s) return NULL;
+
+    size_t len = 0;
+    while(s[len]) len++;
+
+    char* out = (char*)malloc(len + 1);
+    if(!out) return NULL;
+
+    for(size_t i=0;i<=len;i++)
+        out[i] = s[i];
+
+    return out;
+}
+
+/* ============================================================
+   Registry
+   ============================================================ */
+
+#define FEATURE_SLOTS (FOSSIL_GAME_FEATURE_MAX*2)   /* power of two, half full at most */
+
+static const char* const g_builtin[]={
+#define FOSSIL_GAME_FEATURE_NAME(id,name) name,
+    FOSSIL_GAME_FEATURE_LIST(FOSSIL_GAME_FEATURE_NAME)
+#undef FOSSIL_GAME_FEATURE_NAME
+};
+
+static const char* g_names[FOSSIL_GAME_FEATURE_MAX];
+static int g_count=0;
+
+/* open-addressing name -> bit+1, 0 = empty */
+static uint8_t g_slots[FEATURE_SLOTS];
+
+static uint32_t hash_str(const char* s)
+{
+    uint32_t h=2166136261u;
+    while(*s){
+        h^=(unsigned char)*s++;
+        h*=16777619u;
+    }
+    return h;
+}
+
+static uint32_t slot_of(const char* name)
+{
+    uint32_t i=hash_str(name)&(FEATURE_SLOTS-1);
+    while(g_slots[i] && strcmp(g_names[g_slots[i]-1],name)!=0)
+        i=(i+1)&(FEATURE_SLOTS-1);
+    return i;
+}
+
+static void seed(void)
+{
+    for(int i=0;i<FOSSIL_GAME_FEATURE_BUILTIN_COUNT;i++){
+        g_names[i]=g_builtin[i];
+        g_slots[slot_of(g_builtin[i])]=(uint8_t)(i+1);
+    }
+    g_count=FOSSIL_GAME_FEATURE_BUILTIN_COUNT;
+}
+
+int fossil_game_feature_lookup(const char* name)
+{
+    if(!name) return -1;
+    if(!g_count) seed();
+
+    uint32_t i=slot_of(name);
+    return g_slots[i]?g_slots[i]-1:-1;
+}
+
+int fossil_game_feature_register(const char* name)
+{
+    if(!name) return -1;
+    if(!g_count) seed();
+
+    uint32_t i=slot_of(name);
+    if(g_slots[i]) return g_slots[i]-1;
+    if(g_count==FOSSIL_GAME_FEATURE_MAX) return -2;
+
+    char* copy=fossil_strdup(name);
+    if(!copy) return -3;
+
+    g_names[g_count]=copy;
+    g_slots[i]=(uint8_t)(g_count+1);
+    return g_count++;
+}
+
+const char* fossil_game_feature_name(int bit)
+{
+    if(!g_count) seed();
+    return bit>=0 && bit<g_count?g_names[bit]:NULL;
+}
+
+int fossil_game_feature_count(void)
+{
+    if(!g_count) seed();
+    return g_count;
+}
@@ -39,8 +39,82 @@ const char* fossil_game_clinker_get_trait(const char* npc_id,const char* key);
 int fossil_game_clinker_tick(const char* npc_id);
 const char* fossil_game_clinker_choose_action(const char* npc_id);
 
+/*
+ * NPCs are stored per archetype in contiguous columns. tick_all advances
+ * every NPC of an archetype in one pass and returns how many were ticked.
+ * An action runs for a number of ticks; when it expires the NPC is idle.
+ */
+int fossil_game_clinker_tick_all(const char* archetype);
+int fossil_game_clinker_count(const char* archetype);
+int fossil_game_clinker_start_action(const char* npc_id,const char* action,int ticks);
+
+/*
+ * Utility AI. Traits are also read as numbers (strtof, 0 when unset). A
+ * scored action's utility is its weight times the product of its
+ * considerations, each a response curve over one trait clamped to [0,1]:
+ *
+ *   LINEAR     y = m*(x-c) + b
+ *   QUADRATIC  y = m*(x-c)^2 + b
+ *   LOGISTIC   y = b + m*(0.5 + 0.5*t/(1+|t|)),  t = k*(x-c)
+ *   STEP       y = b + (x >= c ? m : 0)
+ *
+ * Idle NPCs start the highest positive utility action on their next tick.
+ * Drift and per-tick action effects keep the traits they touch in [0,1].
+ * decide_all scores a whole archetype with SSE2 by default, where the
+ * AVX2 kernels measure slower; feature queries use the widest SIMD the CPU
+ * offers. set_simd(-1) restores that default, a level forces every kernel
+ * to it (capped at what the CPU supports), and both return the decide
+ * level in use.
+ */
+#define FOSSIL_GAME_CLINKER_CURVE_LINEAR    0
+#define FOSSIL_GAME_CLINKER_CURVE_QUADRATIC 1
+#define FOSSIL_GAME_CLINKER_CURVE_LOGISTIC  2
+#define FOSSIL_GAME_CLINKER_CURVE_STEP      3
+
+#define FOSSIL_GAME_CLINKER_SIMD_SCALAR 0
+#define FOSSIL_GAME_CLINKER_SIMD_SSE2   1
+#define FOSSIL_GAME_CLINKER_SIMD_AVX2   2
+
+int fossil_game_clinker_define_action(const char* archetype,const char* action,float weight,int duration_ticks);
+int fossil_game_clinker_add_consideration(const char* archetype,const char* action,const char* trait,
+                                          int curve,float m,float k,float b,float c);
+int fossil_game_clinker_add_effect(const char* archetype,const char* action,const char* trait,float per_tick);
+int fossil_game_clinker_set_drift(const char* archetype,const char* trait,float per_tick);
+
+int fossil_game_clinker_decide_all(const char* archetype);
+int fossil_game_clinker_set_simd(int level);
+
+/*
+ * Behavior trees. load_archetype compiles an indented script into flat
+ * bytecode shared by every NPC of the archetype; each NPC keeps only its
+ * running leaf. Once loaded, the tree replaces automatic utility selection.
+ * One node per line, children indented under their parent, '#' comments:
+ *
+ *   selector | sequence         composites, run children in order
+ *   invert                      exactly one child, flips success/failure
+ *   condition <trait> <op> <n>  op is < <= > >= == !=
+ *   action <name> [ticks]       runs for ticks (default: its duration)
+ *   wait <ticks>                idles for ticks
+ *   utility                     starts the best scored action, fails if none
+ *   succeed | fail
+ *
+ * Returns -2 on a script error (see load_error), -4 if the file can't be read.
+ */
+int fossil_game_clinker_load_archetype(const char* archetype,const char* source);
+int fossil_game_clinker_load_archetype_file(const char* archetype,const char* path);
+const char* fossil_game_clinker_load_error(void);
+
+/*
+ * Features are bits from the shared registry (feature.h), stored as one mask
+ * per NPC. query_feature lists the archetype's NPCs that have a feature with
+ * a SIMD scan of the mask column; -4 when cap is too small (out_count holds
+ * the total).
+ */
 int fossil_game_clinker_enable_feature(const char* npc_id,const char* feature);
 int fossil_game_clinker_disable_feature(const char* npc_id,const char* feature);
+int fossil_game_clinker_has_feature(const char* npc_id,const char* feature);
+int fossil_game_clinker_query_feature(const char* archetype,const char* feature,
+                                      const char** out_ids,int cap,int* out_count);
 
 #ifdef __cplusplus
 }
@@ -53,9 +127,12 @@ class Clinker {
 public:
     Clinker(const char* i):id(i){}
     void tick(){ fossil_game_clinker_tick(id); }
+    void startAction(const char* a,int ticks){ fossil_game_clinker_start_action(id,a,ticks); }
     const char* chooseAction(){ return fossil_game_clinker_choose_action(id); }
     void enableFeature(const char* f){ fossil_game_clinker_enable_feature(id,f); }
     void disableFeature(const char* f){ fossil_game_clinker_disable_feature(id,f); }
+    bool hasFeature(const char* f){ return fossil_game_clinker_has_feature(id,f)>0; }
+    static int loadArchetype(const char* archetype,const char* source){ return fossil_game_clinker_load_archetype(archetype,source); }
 };
 }
 #endif
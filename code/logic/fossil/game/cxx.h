@@ -0,0 +1,513 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_CXX_H
+#define FOSSIL_GAME_CXX_H
+
+#include "player.h"
+#include "quizzed.h"
+#include "score.h"
+
+#ifdef __cplusplus
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/*
+ * C++20 API over the player, score and quiz stores.
+ *
+ * Ids are std::string_view; the C calls need NUL-terminated strings, so
+ * short ids are copied onto the stack per call. Player and Quiz are
+ * handles that keep their own id, so repeated calls copy nothing.
+ * Fallible calls return Result<T>, modelled on std::expected: a value, or
+ * the C API's negative code as Error. Lists the C API mallocs come back as
+ * IdList, which frees on destruction; ids inside stay owned by the
+ * library. Batch calls take std::span and stop at the first failure,
+ * reporting its position in Error::index.
+ */
+namespace fossil::game::cxx {
+
+struct Error {
+    int code;                   /* negative C return code */
+    size_t index=0;             /* failing element of a batch */
+};
+
+template<class T>
+class [[nodiscard]] Result {
+public:
+    Result(T v) : val(std::move(v)) {}
+    Result(Error e) : err(e) {}
+
+    bool has_value() const noexcept { return val.has_value(); }
+    explicit operator bool() const noexcept { return val.has_value(); }
+
+    T& value() & { if(!val) std::abort(); return *val; }
+    const T& value() const & { if(!val) std::abort(); return *val; }
+    T&& value() && { if(!val) std::abort(); return std::move(*val); }
+    T& operator*() & noexcept { return *val; }
+    const T& operator*() const & noexcept { return *val; }
+    T* operator->() noexcept { return &*val; }
+    const T* operator->() const noexcept { return &*val; }
+
+    template<class U> T value_or(U&& fallback) const & { return val?*val:static_cast<T>(std::forward<U>(fallback)); }
+    Error error() const noexcept { return err; }
+private:
+    std::optional<T> val;
+    Error err{0};
+};
+
+template<>
+class [[nodiscard]] Result<void> {
+public:
+    Result() = default;
+    Result(Error e) : err(e) {}
+
+    bool has_value() const noexcept { return err.code==0; }
+    explicit operator bool() const noexcept { return err.code==0; }
+    Error error() const noexcept { return err; }
+private:
+    Error err{0};
+};
+
+namespace detail {
+
+/* NUL-terminated copy of an id for one C call */
+class CStr {
+public:
+    explicit CStr(std::string_view s){
+        if(s.size()<sizeof(small)){
+            std::memcpy(small,s.data(),s.size());
+            small[s.size()]='\0';
+            ptr=small;
+        }else{
+            big.assign(s);
+            ptr=big.c_str();
+        }
+    }
+    CStr(const CStr&)=delete;
+    CStr& operator=(const CStr&)=delete;
+    const char* c_str() const noexcept { return ptr; }
+private:
+    char small[64];
+    std::string big;
+    const char* ptr;
+};
+
+inline Result<void> check(int rc){ if(rc<0) return Error{rc}; return {}; }
+inline const char* board(std::string_view id,std::optional<CStr>& hold){
+    if(id.empty()) return nullptr;
+    hold.emplace(id);
+    return hold->c_str();
+}
+
+}
+
+/* Ids from a malloc'd C array; the array is freed, the ids are borrowed */
+class IdList {
+public:
+    IdList() = default;
+    IdList(const char** ids,int count) : ids(ids),n(count>0?(size_t)count:0) {}
+    IdList(IdList&& o) noexcept : ids(std::exchange(o.ids,nullptr)),n(std::exchange(o.n,0)) {}
+    IdList& operator=(IdList&& o) noexcept { std::swap(ids,o.ids); std::swap(n,o.n); return *this; }
+    IdList(const IdList&)=delete;
+    IdList& operator=(const IdList&)=delete;
+    ~IdList(){ std::free(ids); }
+
+    size_t size() const noexcept { return n; }
+    bool empty() const noexcept { return n==0; }
+    std::string_view operator[](size_t i) const noexcept { return ids[i]; }
+
+    class iterator {
+    public:
+        using value_type=std::string_view;
+        using difference_type=std::ptrdiff_t;
+        iterator() = default;
+        explicit iterator(const char* const* p) : p(p) {}
+        std::string_view operator*() const noexcept { return *p; }
+        iterator& operator++() noexcept { ++p; return *this; }
+        iterator operator++(int) noexcept { iterator t=*this; ++p; return t; }
+        bool operator==(const iterator&) const = default;
+    private:
+        const char* const* p=nullptr;
+    };
+    iterator begin() const noexcept { return iterator(ids); }
+    iterator end() const noexcept { return iterator(ids+n); }
+private:
+    const char** ids=nullptr;
+    size_t n=0;
+};
+
+struct InventoryEntry {
+    std::string_view item;      /* valid until the inventory next changes */
+    int count;
+};
+
+class Player {
+public:
+    explicit Player(std::string_view id) : pid(id) {}
+
+    static Result<Player> create(std::string_view id){
+        detail::CStr c(id);
+        int rc=fossil_game_player_create(c.c_str());
+        if(rc<0) return Error{rc};
+        return Player(id);
+    }
+
+    const std::string& id() const noexcept { return pid; }
+    Result<void> destroy(){ return detail::check(fossil_game_player_destroy(pid.c_str())); }
+
+    Result<int64_t> getInt(std::string_view key) const {
+        detail::CStr k(key);
+        int64_t v;
+        int rc=fossil_game_player_get_int(pid.c_str(),k.c_str(),&v);
+        if(rc<0) return Error{rc};
+        return v;
+    }
+    Result<void> setInt(std::string_view key,int64_t v){
+        detail::CStr k(key);
+        return detail::check(fossil_game_player_set_int(pid.c_str(),k.c_str(),v));
+    }
+    Result<double> getFloat(std::string_view key) const {
+        detail::CStr k(key);
+        double v;
+        int rc=fossil_game_player_get_float(pid.c_str(),k.c_str(),&v);
+        if(rc<0) return Error{rc};
+        return v;
+    }
+    Result<void> setFloat(std::string_view key,double v){
+        detail::CStr k(key);
+        return detail::check(fossil_game_player_set_float(pid.c_str(),k.c_str(),v));
+    }
+    /* Borrowed until the attribute changes */
+    Result<std::string_view> getString(std::string_view key) const {
+        detail::CStr k(key);
+        const char* s=fossil_game_player_get_string(pid.c_str(),k.c_str());
+        if(!s) return Error{-2};
+        return std::string_view(s);
+    }
+    Result<void> setString(std::string_view key,std::string_view value){
+        detail::CStr k(key);
+        std::string v(value);
+        return detail::check(fossil_game_player_set_string(pid.c_str(),k.c_str(),v.c_str()));
+    }
+
+    Result<void> addItem(std::string_view item,int count=1){
+        detail::CStr i(item);
+        return detail::check(fossil_game_player_inventory_add(pid.c_str(),i.c_str(),count));
+    }
+    Result<void> removeItem(std::string_view item,int count=1){
+        detail::CStr i(item);
+        return detail::check(fossil_game_player_inventory_remove(pid.c_str(),i.c_str(),count));
+    }
+    Result<int> itemCount(std::string_view item) const {
+        detail::CStr i(item);
+        int n=fossil_game_player_inventory_count(pid.c_str(),i.c_str());
+        if(n<0) return Error{n};
+        return n;
+    }
+    bool hasItem(std::string_view item) const {
+        detail::CStr i(item);
+        return fossil_game_player_has_item(pid.c_str(),i.c_str())>0;
+    }
+    Result<std::vector<InventoryEntry>> inventory() const {
+        const char* items[32];
+        int counts[32];
+        int n=0;
+        int rc=fossil_game_player_inventory_list(pid.c_str(),items,counts,32,&n);
+        std::vector<const char*> bigItems;
+        std::vector<int> bigCounts;
+        const char** ip=items;
+        int* cp=counts;
+        if(rc==-4){
+            bigItems.resize((size_t)n);
+            bigCounts.resize((size_t)n);
+            ip=bigItems.data();
+            cp=bigCounts.data();
+            rc=fossil_game_player_inventory_list(pid.c_str(),ip,cp,n,&n);
+        }
+        if(rc<0) return Error{rc};
+
+        std::vector<InventoryEntry> out;
+        out.reserve((size_t)n);
+        for(int i=0;i<n;i++) out.push_back({ ip[i],cp[i] });
+        return out;
+    }
+
+    Result<void> joinSession(std::string_view session){
+        detail::CStr s(session);
+        return detail::check(fossil_game_player_join_session(pid.c_str(),s.c_str()));
+    }
+    Result<void> leaveSession(){ return detail::check(fossil_game_player_leave_session(pid.c_str())); }
+    std::optional<std::string_view> session() const {
+        const char* s=fossil_game_player_get_session(pid.c_str());
+        if(!s) return std::nullopt;
+        return std::string_view(s);
+    }
+
+    Result<void> enableFeature(std::string_view f){
+        detail::CStr c(f);
+        return detail::check(fossil_game_player_enable_feature(pid.c_str(),c.c_str()));
+    }
+    Result<void> disableFeature(std::string_view f){
+        detail::CStr c(f);
+        return detail::check(fossil_game_player_disable_feature(pid.c_str(),c.c_str()));
+    }
+    bool hasFeature(std::string_view f) const {
+        detail::CStr c(f);
+        return fossil_game_player_has_feature(pid.c_str(),c.c_str())>0;
+    }
+private:
+    std::string pid;
+};
+
+struct ScoreDelta {
+    std::string_view player;
+    int points;
+};
+
+struct ScoreEntry {
+    std::string_view player;    /* owned by the library */
+    long long score;
+};
+
+class Score {
+public:
+    static Result<void> update(std::string_view player,int points){
+        detail::CStr p(player);
+        return detail::check(fossil_game_score_update(p.c_str(),points));
+    }
+    static Result<size_t> update(std::span<const ScoreDelta> deltas){
+        for(size_t i=0;i<deltas.size();i++){
+            detail::CStr p(deltas[i].player);
+            int rc=fossil_game_score_update(p.c_str(),deltas[i].points);
+            if(rc<0) return Error{rc,i};
+        }
+        return deltas.size();
+    }
+    static Result<int> get(std::string_view player){
+        detail::CStr p(player);
+        int v;
+        int rc=fossil_game_score_get(p.c_str(),&v);
+        if(rc<0) return Error{rc};
+        return v;
+    }
+
+    /* Empty board id = the global board */
+    static Result<IdList> leaderboard(std::string_view board={}){
+        std::optional<detail::CStr> hold;
+        const char** ids=nullptr;
+        int n=0;
+        int rc=fossil_game_score_leaderboard(detail::board(board,hold),&ids,&n);
+        if(rc<0) return Error{rc};
+        return IdList(ids,n);
+    }
+    static Result<IdList> matchmaking(std::string_view player){
+        detail::CStr p(player);
+        char** ids=nullptr;
+        int n=0;
+        int rc=fossil_game_score_matchmaking(p.c_str(),&ids,&n);
+        if(rc<0) return Error{rc};
+        return IdList(const_cast<const char**>(ids),n);
+    }
+
+    static Result<void> ratingPeriod(std::span<const fossil_game_score_match_result> results){
+        return detail::check(fossil_game_score_rating_period(results.data(),results.size()));
+    }
+    static Result<IdList> ratingMatchmaking(std::string_view player,double k){
+        detail::CStr p(player);
+        char** ids=nullptr;
+        int n=0;
+        int rc=fossil_game_score_rating_matchmaking(p.c_str(),k,&ids,&n);
+        if(rc<0) return Error{rc};
+        return IdList(const_cast<const char**>(ids),n);
+    }
+
+    static Result<long long> rankEstimate(std::string_view player){
+        detail::CStr p(player);
+        long long r;
+        int rc=fossil_game_score_rank_estimate(p.c_str(),&r,nullptr);
+        if(rc<0) return Error{rc};
+        return r;
+    }
+    static Result<double> percentile(std::string_view player){
+        detail::CStr p(player);
+        double top;
+        int rc=fossil_game_score_percentile(p.c_str(),&top);
+        if(rc<0) return Error{rc};
+        return top;
+    }
+
+    static Result<std::vector<ScoreEntry>> windowTop(std::string_view window,int cap){
+        detail::CStr w(window);
+        std::vector<const char*> ids((size_t)(cap>0?cap:0));
+        std::vector<long long> scores(ids.size());
+        int n=0;
+        int rc=fossil_game_score_window_top(w.c_str(),ids.data(),scores.data(),cap,&n);
+        if(rc<0) return Error{rc};
+
+        std::vector<ScoreEntry> out;
+        out.reserve((size_t)n);
+        for(int i=0;i<n;i++) out.push_back({ ids[(size_t)i],scores[(size_t)i] });
+        return out;
+    }
+};
+
+/* Empty board id = the global board */
+class Scoreboard {
+public:
+    static Result<void> submit(std::string_view board,std::string_view player,int score){
+        std::optional<detail::CStr> hold;
+        detail::CStr p(player);
+        return detail::check(fossil_game_scoreboard_submit(detail::board(board,hold),p.c_str(),score));
+    }
+    static Result<size_t> submit(std::string_view board,std::span<const ScoreDelta> scores){
+        std::optional<detail::CStr> hold;
+        const char* b=detail::board(board,hold);
+        for(size_t i=0;i<scores.size();i++){
+            detail::CStr p(scores[i].player);
+            int rc=fossil_game_scoreboard_submit(b,p.c_str(),scores[i].points);
+            if(rc<0) return Error{rc,i};
+        }
+        return scores.size();
+    }
+    static Result<int> get(std::string_view board,std::string_view player){
+        std::optional<detail::CStr> hold;
+        detail::CStr p(player);
+        int v;
+        int rc=fossil_game_scoreboard_get(detail::board(board,hold),p.c_str(),&v);
+        if(rc<0) return Error{rc};
+        return v;
+    }
+    static std::optional<std::string_view> leader(std::string_view board={}){
+        std::optional<detail::CStr> hold;
+        const char* id=fossil_game_scoreboard_leaderboard(detail::board(board,hold));
+        if(!id) return std::nullopt;
+        return std::string_view(id);
+    }
+    static std::optional<std::string_view> matchmake(std::string_view board,std::string_view player){
+        std::optional<detail::CStr> hold;
+        detail::CStr p(player);
+        const char* id=fossil_game_scoreboard_matchmake(detail::board(board,hold),p.c_str());
+        if(!id) return std::nullopt;
+        return std::string_view(id);
+    }
+};
+
+struct QuizOption {
+    std::string_view id;        /* valid until the question is removed */
+    std::string_view text;
+};
+
+struct QuizAnswer {
+    std::string_view player;
+    std::string_view option;
+};
+
+class Quiz {
+public:
+    explicit Quiz(std::string_view id) : qid(id) {}
+
+    static Result<Quiz> create(std::string_view id){
+        detail::CStr c(id);
+        int rc=fossil_game_quizzed_create(c.c_str());
+        if(rc<0) return Error{rc};
+        return Quiz(id);
+    }
+
+    const std::string& id() const noexcept { return qid; }
+
+    Result<void> addQuestion(std::string_view question,std::string_view text){
+        detail::CStr q(question);
+        std::string t(text);
+        return detail::check(fossil_game_quizzed_add_question(qid.c_str(),q.c_str(),t.c_str()));
+    }
+    Result<void> addOption(std::string_view question,std::string_view option,std::string_view text,bool correct=false){
+        detail::CStr q(question),o(option);
+        std::string t(text);
+        return detail::check(fossil_game_quizzed_add_option(qid.c_str(),q.c_str(),o.c_str(),t.c_str(),correct));
+    }
+
+    /* The player's current question */
+    std::optional<std::string_view> ask(std::string_view player){
+        detail::CStr p(player);
+        const char* text=fossil_game_quizzed_ask(qid.c_str(),p.c_str());
+        if(!text) return std::nullopt;
+        return std::string_view(text);
+    }
+    Result<std::vector<QuizOption>> options(std::string_view player){
+        detail::CStr p(player);
+        const char* ids[8];
+        const char* texts[8];
+        int n=0;
+        int rc=fossil_game_quizzed_options(qid.c_str(),p.c_str(),ids,texts,8,&n);
+        std::vector<const char*> bigIds,bigTexts;
+        const char** ip=ids;
+        const char** tp=texts;
+        if(rc==-4){
+            bigIds.resize((size_t)n);
+            bigTexts.resize((size_t)n);
+            ip=bigIds.data();
+            tp=bigTexts.data();
+            rc=fossil_game_quizzed_options(qid.c_str(),p.c_str(),ip,tp,n,&n);
+        }
+        if(rc<0) return Error{rc};
+
+        std::vector<QuizOption> out;
+        out.reserve((size_t)n);
+        for(int i=0;i<n;i++) out.push_back({ ip[i],tp[i] });
+        return out;
+    }
+
+    Result<void> answer(std::string_view player,std::string_view option){
+        detail::CStr p(player),o(option);
+        return detail::check(fossil_game_quizzed_answer(qid.c_str(),p.c_str(),o.c_str()));
+    }
+    Result<size_t> answer(std::span<const QuizAnswer> answers){
+        for(size_t i=0;i<answers.size();i++){
+            detail::CStr p(answers[i].player),o(answers[i].option);
+            int rc=fossil_game_quizzed_answer(qid.c_str(),p.c_str(),o.c_str());
+            if(rc<0) return Error{rc,i};
+        }
+        return answers.size();
+    }
+    Result<int> score(std::string_view player) const {
+        detail::CStr p(player);
+        int s=fossil_game_quizzed_score(qid.c_str(),p.c_str());
+        if(s<0) return Error{s};
+        return s;
+    }
+private:
+    std::string qid;
+};
+
+}
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_FEATURE_H
+#define FOSSIL_GAME_FEATURE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Feature registry.
+ *
+ * Each feature name is assigned a bit once; players and NPCs then keep their
+ * features as a FOSSIL_GAME_FEATURE_MAX-bit mask instead of a list of names.
+ * The built-in features below always hold the first bits, in this order, so
+ * code can test them without a lookup. Other names take the next free bit
+ * the first time they are registered.
+ */
+#define FOSSIL_GAME_FEATURE_MAX 128
+
+#define FOSSIL_GAME_FEATURE_LIST(X) \
+    X(MOVE,      "move")            \
+    X(CHAT,      "chat")            \
+    X(TRADE,     "trade")           \
+    X(COMBAT,    "combat")          \
+    X(INVENTORY, "inventory")       \
+    X(QUIZ,      "quiz")            \
+    X(AI,        "ai")              \
+    X(SPECTATE,  "spectate")
+
+enum {
+#define FOSSIL_GAME_FEATURE_ENUM(id,name) FOSSIL_GAME_FEATURE_##id,
+    FOSSIL_GAME_FEATURE_LIST(FOSSIL_GAME_FEATURE_ENUM)
+#undef FOSSIL_GAME_FEATURE_ENUM
+    FOSSIL_GAME_FEATURE_BUILTIN_COUNT
+};
+
+typedef struct {
+    uint64_t bits[FOSSIL_GAME_FEATURE_MAX/64];
+} fossil_game_feature_mask_t;
+
+/* Bit for a name, registering it if new (-2 when the registry is full) */
+int fossil_game_feature_register(const char* name);
+
+/* Bit for a registered name, -1 if unknown */
+int fossil_game_feature_lookup(const char* name);
+
+const char* fossil_game_feature_name(int bit);
+int fossil_game_feature_count(void);
+
+static inline void fossil_game_feature_mask_set(fossil_game_feature_mask_t* m,int bit,int on)
+{
+    uint64_t b=(uint64_t)1<<(bit&63);
+    if(on) m->bits[bit>>6]|=b;
+    else   m->bits[bit>>6]&=~b;
+}
+
+static inline int fossil_game_feature_mask_test(const fossil_game_feature_mask_t* m,int bit)
+{
+    return (int)((m->bits[bit>>6]>>(bit&63))&1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace fossil::game {
+class Feature {
+public:
+    static int bit(const char* name){ return fossil_game_feature_register(name); }
+    static const char* name(int bit){ return fossil_game_feature_name(bit); }
+};
+}
+#endif
+
+#endif
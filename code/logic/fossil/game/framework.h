@@ -32,5 +32,13 @@
 #include "clinker.h"
 #include "session.h"
 #include "score.h"
+#include "sync.h"
+#include "feature.h"
+#include "item.h"
+#include "state.h"
+#include "wal.h"
+#include "metrics.h"
+#include "trace.h"
+#include "cxx.h"
 
 #endif /* FOSSIL_GAME_FRAMEWORK_H */
@@ -0,0 +1,104 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_ITEM_H
+#define FOSSIL_GAME_ITEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Item catalog.
+ *
+ * Item ids are interned into compact integer ids the first time they are
+ * seen, whether or not they have a definition; inventories store those
+ * integers. Definitions (stack size and tags) live in an immutable catalog
+ * version shared by every player. define and load publish a new version
+ * copied from the current one, so a view acquired earlier keeps reading the
+ * definitions it started with until it is released.
+ *
+ * load takes one definition per line, '#' starts a comment:
+ *
+ *   <item_id> <stack_size> [tag ...]      stack_size 0 = unlimited
+ */
+#define FOSSIL_GAME_ITEM_MAX_TAGS 16
+
+typedef struct {
+    const char* id;
+    int32_t stack_size;         /* 0 = unlimited */
+    uint32_t tag_count;
+    const uint16_t* tags;       /* tag ids, see tag_name */
+    int defined;
+} fossil_game_item_def;
+
+typedef struct fossil_game_item_catalog fossil_game_item_catalog;
+
+int fossil_game_item_define(const char* item_id,int stack_size,const char* const* tags,size_t tag_count);
+int fossil_game_item_load(const char* source);
+
+/* Compact ids; lookup returns -1 for an id never seen */
+int fossil_game_item_intern(const char* item_id);
+int fossil_game_item_lookup(const char* item_id);
+const char* fossil_game_item_name(int item);
+int fossil_game_item_count(void);
+
+/* Current definitions */
+int fossil_game_item_stack_size(int item);
+int fossil_game_item_has_tag(int item,const char* tag);
+int fossil_game_item_tag_lookup(const char* tag);
+const char* fossil_game_item_tag_name(int tag);
+
+/* Items carrying a tag in the current catalog (-1 unknown tag) */
+int fossil_game_item_tagged(const char* tag,const uint32_t** out_items,size_t* out_count);
+
+/* Copy-on-write views */
+const fossil_game_item_catalog* fossil_game_item_catalog_acquire(void);
+void fossil_game_item_catalog_release(const fossil_game_item_catalog* catalog);
+uint32_t fossil_game_item_catalog_version(const fossil_game_item_catalog* catalog);
+const fossil_game_item_def* fossil_game_item_catalog_get(const fossil_game_item_catalog* catalog,int item);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace fossil::game {
+class ItemCatalog {
+    const fossil_game_item_catalog* view;
+public:
+    ItemCatalog():view(fossil_game_item_catalog_acquire()){}
+    ~ItemCatalog(){ fossil_game_item_catalog_release(view); }
+    ItemCatalog(const ItemCatalog&)=delete;
+    ItemCatalog& operator=(const ItemCatalog&)=delete;
+    uint32_t version() const { return fossil_game_item_catalog_version(view); }
+    const fossil_game_item_def* get(const char* item) const { return fossil_game_item_catalog_get(view,fossil_game_item_lookup(item)); }
+};
+}
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_METRICS_H
+#define FOSSIL_GAME_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Call counters and latency histograms for the hot fossil_game_* calls.
+ *
+ * Recording is compiled in only when the library is built with the
+ * with_metrics option (which defines FOSSIL_GAME_METRICS); otherwise the
+ * instrumentation expands to nothing and enable returns -4. When compiled
+ * in, recording still starts disabled and costs one predictable branch per
+ * call until fossil_game_metrics_enable(1).
+ *
+ * Calls are counted exactly; latency is timed on one call in every
+ * sample_every per thread (default 16) since reading the clock twice costs
+ * more than most calls being measured. Histograms hold the timed calls and
+ * total_ns is scaled up to all calls.
+ *
+ * Each thread records into its own block, so recording takes no locks.
+ * snapshot merges every block; a snapshot taken while other threads record
+ * may miss their in-flight calls. Latencies are bucketed by power of two:
+ * bucket b counts timed calls that took less than bucket_ns[b] and at least
+ * bucket_ns[b-1].
+ */
+
+/* Instrumented calls */
+enum {
+    FOSSIL_GAME_METRIC_PLAYER_CREATE,
+    FOSSIL_GAME_METRIC_PLAYER_REMOVE,
+    FOSSIL_GAME_METRIC_PLAYER_GET_INT,
+    FOSSIL_GAME_METRIC_PLAYER_SET_INT,
+    FOSSIL_GAME_METRIC_PLAYER_GET_ATTR,
+    FOSSIL_GAME_METRIC_PLAYER_INVENTORY_ADD,
+    FOSSIL_GAME_METRIC_PLAYER_INVENTORY_REMOVE,
+    FOSSIL_GAME_METRIC_PLAYER_INVENTORY_TRADE,
+    FOSSIL_GAME_METRIC_SCORE_UPDATE,
+    FOSSIL_GAME_METRIC_SCORE_LEADERBOARD,
+    FOSSIL_GAME_METRIC_SCORE_MATCHMAKING,
+    FOSSIL_GAME_METRIC_SCORE_RATING_PERIOD,
+    FOSSIL_GAME_METRIC_QUIZZED_ASK,
+    FOSSIL_GAME_METRIC_QUIZZED_ANSWER,
+    FOSSIL_GAME_METRIC_SESSION_TICK,
+    FOSSIL_GAME_METRIC_CLINKER_TICK_ALL,
+    FOSSIL_GAME_METRIC_MULTIPLAYER_BROADCAST,
+    FOSSIL_GAME_METRIC_API_COUNT
+};
+
+#define FOSSIL_GAME_METRICS_BUCKETS 40
+
+typedef struct {
+    uint64_t calls;
+    uint64_t samples;           /* timed calls, the histogram population */
+    double total_ns;            /* estimated over all calls */
+    double max_ns;
+    uint64_t buckets[FOSSIL_GAME_METRICS_BUCKETS];
+} fossil_game_metrics_api;
+
+/* Registry sizes, read from the stores when the snapshot is taken */
+typedef struct {
+    size_t players;
+    size_t score_players;
+    size_t boards;
+    size_t quizzes;
+    size_t sessions;
+    size_t npcs;
+} fossil_game_metrics_registry;
+
+typedef struct {
+    int compiled;               /* library built with metrics */
+    int enabled;
+    double bucket_ns[FOSSIL_GAME_METRICS_BUCKETS];
+    fossil_game_metrics_api api[FOSSIL_GAME_METRIC_API_COUNT];
+    uint64_t allocations;       /* heap allocations on the instrumented paths */
+    fossil_game_metrics_registry registry;
+} fossil_game_metrics_snapshot;
+
+/* Returns -4 when the library was built without metrics */
+int fossil_game_metrics_enable(int on);
+int fossil_game_metrics_enabled(void);
+
+/* Times one call in every `every` per thread; 1 times every call */
+int fossil_game_metrics_set_sample(uint32_t every);
+
+/* Merges every thread's counters; registry sizes are filled even without metrics */
+int fossil_game_metrics_snapshot_take(fossil_game_metrics_snapshot* out);
+
+/* Zeroes the counters of every thread */
+void fossil_game_metrics_reset(void);
+
+/* "score_update" etc., NULL for an unknown api */
+const char* fossil_game_metrics_api_name(int api);
+
+/* Latency at quantile q (0..1), taken as the upper bound of the bucket it falls in */
+double fossil_game_metrics_quantile(const fossil_game_metrics_snapshot* s,int api,double q);
+
+/* Writes a snapshot as one JSON object */
+int fossil_game_metrics_export(FILE* out);
+
+/* Registry size hooks, one per store */
+void fossil_game_player_metrics_registry(fossil_game_metrics_registry* out);
+void fossil_game_score_metrics_registry(fossil_game_metrics_registry* out);
+void fossil_game_quizzed_metrics_registry(fossil_game_metrics_registry* out);
+void fossil_game_session_metrics_registry(fossil_game_metrics_registry* out);
+void fossil_game_clinker_metrics_registry(fossil_game_metrics_registry* out);
+
+/* ===== Instrumentation used by the library sources ===== */
+
+#if defined(FOSSIL_GAME_METRICS)
+extern int fossil_game_metrics_on;
+uint64_t fossil_game_metrics_begin(int api);
+void fossil_game_metrics_end(int api,uint64_t start);
+void fossil_game_metrics_alloc(void);
+
+#define FOSSIL_GAME_METRIC_BEGIN(api) \
+    uint64_t fossil_metric_start_=fossil_game_metrics_on?fossil_game_metrics_begin(FOSSIL_GAME_METRIC_##api):0
+#define FOSSIL_GAME_METRIC_END(api) \
+    do{ if(fossil_metric_start_) fossil_game_metrics_end(FOSSIL_GAME_METRIC_##api,fossil_metric_start_); }while(0)
+#define FOSSIL_GAME_METRIC_ALLOC() \
+    do{ if(fossil_game_metrics_on) fossil_game_metrics_alloc(); }while(0)
+#else
+#define FOSSIL_GAME_METRIC_BEGIN(api) ((void)0)
+#define FOSSIL_GAME_METRIC_END(api) ((void)0)
+#define FOSSIL_GAME_METRIC_ALLOC() ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace fossil::game {
+class Metrics {
+public:
+    static int enable(bool on=true){ return fossil_game_metrics_enable(on?1:0); }
+    static int sample(uint32_t every){ return fossil_game_metrics_set_sample(every); }
+    static bool enabled(){ return fossil_game_metrics_enabled()!=0; }
+    static int snapshot(fossil_game_metrics_snapshot& out){ return fossil_game_metrics_snapshot_take(&out); }
+    static void reset(){ fossil_game_metrics_reset(); }
+    static int exportJson(FILE* out){ return fossil_game_metrics_export(out); }
+};
+}
+#endif
+
+#endif
@@ -25,19 +25,67 @@
 #ifndef FOSSIL_GAME_MULTIPLAYER_H
 #define FOSSIL_GAME_MULTIPLAYER_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Message delivery goes through a transport. The default is an in-process
+ * loopback that queues each message in the recipient's mailbox together with
+ * its enqueue time; mailboxes are drained with fossil_game_multiplayer_poll.
+ * A custom transport receives every delivery instead.
+ */
+typedef struct fossil_game_multiplayer_transport {
+    void* ctx;
+    int (*deliver)(void* ctx,const char* session_id,const char* player_id,
+                   const char* message,size_t len);
+} fossil_game_multiplayer_transport;
+
+/* Bytes queued per loopback mailbox before further messages are dropped */
+#define FOSSIL_GAME_MULTIPLAYER_MAILBOX_MAX (1u<<20)
+
+int fossil_game_multiplayer_set_transport(const fossil_game_multiplayer_transport* transport);
+
 int fossil_game_multiplayer_create_session(const char* session_id);
 int fossil_game_multiplayer_destroy_session(const char* session_id);
 
 int fossil_game_multiplayer_join(const char* session_id,const char* player_id);
 int fossil_game_multiplayer_leave(const char* session_id,const char* player_id);
 
+/* Broadcasts return how many members it was delivered to; full mailboxes drop it */
 int fossil_game_multiplayer_broadcast(const char* session_id,const char* message);
 int fossil_game_multiplayer_send(const char* session_id,const char* player_id,const char* message);
 
+/*
+ * Interest management. Members that report a position are tracked in a
+ * uniform grid (cell size defaults to 32 world units) that is updated only
+ * when a member crosses a cell boundary. Scoped broadcasts reach members
+ * within a radius, or within a set of cells given as (cx,cy) pairs, and
+ * return the number of deliveries. Members without a position only receive
+ * session-wide broadcasts and direct sends. Positions, radii and the cell
+ * size must be finite (-1 otherwise).
+ */
+int fossil_game_multiplayer_set_cell_size(const char* session_id,float cell_size);
+int fossil_game_multiplayer_set_position(const char* session_id,const char* player_id,float x,float y);
+int fossil_game_multiplayer_clear_position(const char* session_id,const char* player_id);
+
+int fossil_game_multiplayer_broadcast_radius(const char* session_id,float x,float y,float radius,const char* message);
+int fossil_game_multiplayer_broadcast_near(const char* session_id,const char* player_id,float radius,const char* message);
+int fossil_game_multiplayer_broadcast_cells(const char* session_id,const int32_t* cells,size_t cell_count,const char* message);
+
+/* Ids of members within radius; -4 when cap is too small (out_count holds the total) */
+int fossil_game_multiplayer_query_radius(const char* session_id,float x,float y,float radius,
+                                         const char** out_ids,int cap,int* out_count);
+
+/* Loopback mailbox: 1 = message read, 0 = empty, -4 = cap too small (message kept) */
+int fossil_game_multiplayer_poll(const char* session_id,const char* player_id,
+                                 char* out,size_t cap,size_t* out_len,uint64_t* out_latency_ns);
+int fossil_game_multiplayer_pending(const char* session_id,const char* player_id);
+uint64_t fossil_game_multiplayer_dropped(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,8 +98,11 @@ public:
     Multiplayer(const char* s):id(s){}
     void join(const char* p){ fossil_game_multiplayer_join(id,p); }
     void leave(const char* p){ fossil_game_multiplayer_leave(id,p); }
-    void broadcast(const char* msg){ fossil_game_multiplayer_broadcast(id,msg); }
+    int broadcast(const char* msg){ return fossil_game_multiplayer_broadcast(id,msg); }
     void send(const char* p,const char* msg){ fossil_game_multiplayer_send(id,p,msg); }
+    void moveTo(const char* p,float x,float y){ fossil_game_multiplayer_set_position(id,p,x,y); }
+    int broadcastNear(const char* p,float radius,const char* msg){ return fossil_game_multiplayer_broadcast_near(id,p,radius,msg); }
+    int poll(const char* p,char* out,size_t cap){ size_t n=0; return fossil_game_multiplayer_poll(id,p,out,cap,&n,nullptr)==1?(int)n:-1; }
 };
 }
 #endif
@@ -25,28 +25,197 @@
 #ifndef FOSSIL_GAME_PLAYER_H
 #define FOSSIL_GAME_PLAYER_H
 
+#include "feature.h"
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Player lifecycle */
+/* Player lifecycle; destroy is the same call as remove */
 int fossil_game_player_create(const char* player_id);
+int fossil_game_player_remove(const char* player_id);
 int fossil_game_player_destroy(const char* player_id);
 
-/* Player attributes */
+/*
+ * Player attributes. Values are typed and owned by the library; strings and
+ * blobs are copied. Keys are interned into a shared schema the first time
+ * they are set, and attr_key returns that schema id for the *_by_key
+ * fast path. Numeric getters convert between int and float; other type
+ * mismatches return -4, missing attributes -2.
+ *
+ * set_attr stores a string. get_attr returns strings as stored and renders
+ * numbers into a buffer that is valid until the next get_attr; blobs read
+ * as NULL.
+ */
+#define FOSSIL_GAME_PLAYER_ATTR_NONE   0
+#define FOSSIL_GAME_PLAYER_ATTR_INT    1
+#define FOSSIL_GAME_PLAYER_ATTR_FLOAT  2
+#define FOSSIL_GAME_PLAYER_ATTR_STRING 3
+#define FOSSIL_GAME_PLAYER_ATTR_BLOB   4
+
 int fossil_game_player_set_attr(const char* player_id,const char* key,const char* value);
 const char* fossil_game_player_get_attr(const char* player_id,const char* key);
 
+int fossil_game_player_set_int(const char* player_id,const char* key,int64_t value);
+int fossil_game_player_set_float(const char* player_id,const char* key,double value);
+int fossil_game_player_set_string(const char* player_id,const char* key,const char* value);
+int fossil_game_player_set_blob(const char* player_id,const char* key,const void* data,size_t len);
+
+int fossil_game_player_get_int(const char* player_id,const char* key,int64_t* out);
+int fossil_game_player_get_float(const char* player_id,const char* key,double* out);
+const char* fossil_game_player_get_string(const char* player_id,const char* key);
+int fossil_game_player_get_blob(const char* player_id,const char* key,const void** out_data,size_t* out_len);
+
+int fossil_game_player_attr_type(const char* player_id,const char* key);
+int fossil_game_player_unset_attr(const char* player_id,const char* key);
+
+int fossil_game_player_attr_key(const char* key);
+int fossil_game_player_get_int_by_key(const char* player_id,int key,int64_t* out);
+int fossil_game_player_set_int_by_key(const char* player_id,int key,int64_t value);
+int fossil_game_player_get_float_by_key(const char* player_id,int key,double* out);
+int fossil_game_player_set_float_by_key(const char* player_id,int key,double value);
+
+/* Visits every attribute: ints and floats as 8 native bytes, strings without the NUL */
+typedef int (*fossil_game_player_attr_fn)(const char* key,int type,const void* data,size_t len,void* ctx);
+int fossil_game_player_attr_foreach(const char* player_id,fossil_game_player_attr_fn fn,void* ctx);
+
 /* Inventory */
 int fossil_game_player_add_item(const char* player_id,const char* item_id);
 int fossil_game_player_remove_item(const char* player_id,const char* item_id);
 int fossil_game_player_has_item(const char* player_id,const char* item_id);
 
+/*
+ * Counted inventory. Items are referenced by their catalog id (item.h);
+ * each player holds a sorted vector of (item, count) and an item whose
+ * count reaches zero is dropped. The catalog stack size caps how many of an
+ * item one player may hold; adds past it fail with -4. remove returns -3
+ * for an item not held and -2 when fewer than count are held.
+ */
+int fossil_game_player_inventory_add(const char* player_id,const char* item_id,int count);
+int fossil_game_player_inventory_remove(const char* player_id,const char* item_id,int count);
+int fossil_game_player_inventory_count(const char* player_id,const char* item_id);
+
+/*
+ * Bulk moves are all-or-nothing: either every item changes hands or nothing
+ * does (-2 when a side lacks an item, -4 when a stack limit would be
+ * exceeded). trade moves a_items from a to b and b_items from b to a.
+ */
+int fossil_game_player_inventory_transfer(const char* from_id,const char* to_id,
+                                          const char* const* item_ids,const int* counts,size_t count);
+int fossil_game_player_inventory_trade(const char* player_a,const char* const* a_items,const int* a_counts,size_t a_count,
+                                       const char* player_b,const char* const* b_items,const int* b_counts,size_t b_count);
+
+/*
+ * Allocation-free reads. The iterator and the listed ids stay valid until
+ * the player's inventory next changes; list returns -4 when cap is too
+ * small (out_count holds the total).
+ */
+typedef struct {
+    const void* player;
+    uint32_t pos;
+} fossil_game_player_inventory_iter;
+
+int fossil_game_player_inventory_begin(const char* player_id,fossil_game_player_inventory_iter* it);
+int fossil_game_player_inventory_next(fossil_game_player_inventory_iter* it,const char** out_item,int* out_count);
+int fossil_game_player_inventory_list(const char* player_id,const char** out_items,int* out_counts,
+                                      int cap,int* out_count);
+
+/*
+ * Players holding an item, or any item carrying a catalog tag, from an
+ * index kept up to date by every inventory change; -4 when cap is too
+ * small (out_count holds the total).
+ */
+int fossil_game_player_query_holders(const char* item_id,const char** out_ids,int cap,int* out_count);
+int fossil_game_player_query_tag(const char* tag,const char** out_ids,int cap,int* out_count);
+
+/*
+ * Sessions. A player belongs to at most one session; joining another moves
+ * it. Each session keeps a roster of its members, so counting, listing and
+ * evicting cost O(members). session_list returns -4 when cap is too small
+ * (out_count holds the total); evict_session returns how many left.
+ */
+int fossil_game_player_join_session(const char* player_id,const char* session_id);
+int fossil_game_player_leave_session(const char* player_id);
+const char* fossil_game_player_get_session(const char* player_id);
+int fossil_game_player_session_count(const char* session_id);
+int fossil_game_player_session_list(const char* session_id,const char** out_ids,int cap,int* out_count);
+int fossil_game_player_evict_session(const char* session_id);
+
 /* Features */
 int fossil_game_player_enable_feature(const char* player_id,const char* feature);
 int fossil_game_player_disable_feature(const char* player_id,const char* feature);
 int fossil_game_player_has_feature(const char* player_id,const char* feature);
 
+/* Controls share the feature name registry */
+int fossil_game_player_enable_control(const char* player_id,const char* control);
+int fossil_game_player_disable_control(const char* player_id,const char* control);
+
+/* Ticks the player's clinker NPC if it has one; -1 for an unknown player */
+int fossil_game_player_npc_update(const char* npc_id);
+
+/* Iteration (callback returns non-zero to stop early; that value is returned) */
+typedef int (*fossil_game_player_item_fn)(const char* item_id,int count,void* ctx);
+typedef int (*fossil_game_player_visit_fn)(const char* player_id,void* ctx);
+
+int fossil_game_player_inventory_foreach(const char* player_id,fossil_game_player_item_fn fn,void* ctx);
+int fossil_game_player_foreach_in_session(const char* session_id,fossil_game_player_visit_fn fn,void* ctx);
+
+/* ===== Handles ===== */
+
+/*
+ * A handle is the player's view: the inventory and feature mask that hot
+ * reads need, read in place. It stays valid until the player is removed,
+ * so resolving the id once per session replaces a hash lookup per read.
+ * Item arguments are catalog ids (fossil_game_item_lookup), features are
+ * registry bits (fossil_game_feature_lookup).
+ */
+typedef struct fossil_game_player_item {
+    uint32_t item;
+    int32_t  count;
+    uint32_t holder;            /* position in the item's holder list */
+} fossil_game_player_item;
+
+typedef struct {
+    fossil_game_player_item* inventory;     /* sorted by item, counts never zero */
+    uint32_t inventory_count;
+    fossil_game_feature_mask_t features;
+} fossil_game_player_view;
+
+/* NULL for an unknown player */
+const fossil_game_player_view* fossil_game_player_handle(const char* player_id);
+
+/*
+ * Inline fast path, for callers that define FOSSIL_GAME_FAST_PATH. These
+ * read the view directly, so they bake in its layout: rebuild against the
+ * headers of the library you link.
+ */
+#if defined(FOSSIL_GAME_FAST_PATH)
+static inline int fossil_game_player_fast_count(const fossil_game_player_view* v,int item)
+{
+    uint32_t lo=0,hi=v->inventory_count;
+    while(lo<hi){
+        uint32_t mid=(lo+hi)>>1;
+        uint32_t at=v->inventory[mid].item;
+        if(at==(uint32_t)item) return v->inventory[mid].count;
+        if(at<(uint32_t)item) lo=mid+1;
+        else hi=mid;
+    }
+    return 0;
+}
+
+static inline int fossil_game_player_fast_has_item(const fossil_game_player_view* v,int item)
+{
+    return fossil_game_player_fast_count(v,item)>0;
+}
+
+static inline int fossil_game_player_fast_has_feature(const fossil_game_player_view* v,int bit)
+{
+    return bit>=0 && fossil_game_feature_mask_test(&v->features,bit);
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,13 +226,21 @@ class Player {
     const char* id;
 public:
     Player(const char* i):id(i){}
+    int create(){ return fossil_game_player_create(id); }
+    int destroy(){ return fossil_game_player_destroy(id); }
     void setAttr(const char* k,const char* v){ fossil_game_player_set_attr(id,k,v); }
     const char* getAttr(const char* k){ return fossil_game_player_get_attr(id,k); }
+    void setInt(const char* k,int64_t v){ fossil_game_player_set_int(id,k,v); }
+    int64_t getInt(const char* k,int64_t fallback=0){ int64_t v; return fossil_game_player_get_int(id,k,&v)==0?v:fallback; }
+    void setFloat(const char* k,double v){ fossil_game_player_set_float(id,k,v); }
+    double getFloat(const char* k,double fallback=0.0){ double v; return fossil_game_player_get_float(id,k,&v)==0?v:fallback; }
     void addItem(const char* i){ fossil_game_player_add_item(id,i); }
     void removeItem(const char* i){ fossil_game_player_remove_item(id,i); }
+    int itemCount(const char* i){ return fossil_game_player_inventory_count(id,i); }
+    bool hasItem(const char* i){ return fossil_game_player_has_item(id,i)>0; }
     void enableFeature(const char* f){ fossil_game_player_enable_feature(id,f); }
     void disableFeature(const char* f){ fossil_game_player_disable_feature(id,f); }
-    bool hasFeature(const char* f){ return fossil_game_player_has_feature(id,f)!=0; }
+    bool hasFeature(const char* f){ return fossil_game_player_has_feature(id,f)>0; }
 };
 }
 #endif
@@ -29,21 +29,37 @@
 extern "C" {
 #endif
 
-/* Quiz creation */
+/*
+ * Quizzes return -1 for bad arguments or an unknown quiz, -2 for an
+ * unknown question, -5 for a duplicate id. Each player walks the questions
+ * in order, wrapping around; answering advances to the next one.
+ */
+
+/* Quiz lifecycle */
 int fossil_game_quizzed_create(const char* quiz_id);
+int fossil_game_quizzed_remove(const char* quiz_id);
 
-/* Add question (AI generated or manual) */
+/* Add question (AI generated or manual); options are added one by one, the last one flagged correct is the answer */
 int fossil_game_quizzed_add_question(const char* quiz_id,const char* question_id,const char* text);
 int fossil_game_quizzed_add_option(const char* quiz_id,const char* question_id,const char* option_id,const char* text,int correct);
+int fossil_game_quizzed_remove_question(const char* quiz_id,const char* question_id);
 
-/* Ask question */
+/* Adds a built-in question for a topic ("math", "science", ...) at difficulty 1..5; option ids are "0".."3" */
+int fossil_game_quizzed_ai_generate(const char* quiz_id,const char* topic,int difficulty);
+
+/* Ask question: the player's current question text, NULL when the quiz has none */
 const char* fossil_game_quizzed_ask(const char* quiz_id,const char* player_id);
 
+/* Options of the current question, borrowed; -4 when cap is too small (out_count holds the total) */
+int fossil_game_quizzed_options(const char* quiz_id,const char* player_id,
+                                const char** out_ids,const char** out_texts,int cap,int* out_count);
+
 /* Answer question */
 int fossil_game_quizzed_answer(const char* quiz_id,const char* player_id,const char* option_id);
 
 /* Player score */
 int fossil_game_quizzed_score(const char* quiz_id,const char* player_id);
+int fossil_game_quizzed_reset(const char* quiz_id,const char* player_id);
 
 #ifdef __cplusplus
 }
@@ -55,9 +71,13 @@ class Quizzed {
     const char* id;
 public:
     Quizzed(const char* qid):id(qid){}
+    int create(){ return fossil_game_quizzed_create(id); }
+    int addQuestion(const char* q,const char* text){ return fossil_game_quizzed_add_question(id,q,text); }
+    int addOption(const char* q,const char* opt,const char* text,bool correct=false){ return fossil_game_quizzed_add_option(id,q,opt,text,correct); }
     const char* ask(const char* player){ return fossil_game_quizzed_ask(id,player); }
     void answer(const char* player,const char* option){ fossil_game_quizzed_answer(id,player,option); }
     int score(const char* player){ return fossil_game_quizzed_score(id,player); }
+    int reset(const char* player){ return fossil_game_quizzed_reset(id,player); }
 };
 }
 #endif
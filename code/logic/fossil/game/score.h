@@ -25,23 +25,233 @@
 #ifndef FOSSIL_GAME_SCOREBOARD_H
 #define FOSSIL_GAME_SCOREBOARD_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* Player score submission */
+/* Per-player lifetime score */
+int fossil_game_score_update(const char* player_id,int points);
+int fossil_game_score_get(const char* player_id,int* out_points);
+int fossil_game_score_reset(const char* player_id);
+
+/*
+ * Handles: a player's slot in the score store, created on first use like
+ * fossil_game_score_get. Players are never dropped from the store, so a
+ * handle stays valid for the life of the process.
+ */
+int fossil_game_score_handle(const char* player_id,uint32_t* out_handle);
+int fossil_game_score_get_by_handle(uint32_t handle,int* out_points);
+
+/* Score of handle h is the int at base + h*stride; base moves as the store grows */
+typedef struct {
+    const unsigned char* base;
+    size_t stride;
+} fossil_game_score_column;
+
+extern fossil_game_score_column fossil_game_score_values;
+
+/*
+ * Inline fast path, for callers that define FOSSIL_GAME_FAST_PATH: a score
+ * read is two dependent loads and no call. The handle is not range
+ * checked.
+ */
+#if defined(FOSSIL_GAME_FAST_PATH)
+static inline int fossil_game_score_fast_get(uint32_t handle)
+{
+    return *(const int*)(fossil_game_score_values.base+(size_t)handle*fossil_game_score_values.stride);
+}
+#endif
+
+/* Players of a leaderboard by descending score; an empty board takes every
+   player on first fetch. The id array is malloc'd, the ids are borrowed. */
+int fossil_game_score_leaderboard(const char* leaderboard_id,const char*** out_player_ids,int* out_count);
+
+/* Players within 100 points of player_id; same ownership as above */
+int fossil_game_score_matchmaking(const char* player_id,char*** out_opponents,int* out_count);
+
+/* ===== Achievements ===== */
+
+/* Catalog capacity; each achievement id maps to one bit of a player's set */
+#define FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX 256
+
+/* Rule metrics */
+#define FOSSIL_GAME_SCORE_RULE_SCORE        0   /* lifetime score >= threshold */
+#define FOSSIL_GAME_SCORE_RULE_QUIZ_STREAK  1   /* best run of correct quiz answers >= threshold */
+
+typedef void (*fossil_game_score_unlock_fn)(const char* player_id,const char* achievement_id,void* ctx);
+
+/* Registers an achievement id; returns its bit, -3 when the catalog is full */
+int fossil_game_score_define_achievement(const char* achievement_id);
+
+/* Unlocks achievement_id when the metric reaches threshold. Players that
+   already qualify unlock immediately; later checks run on score changes only. */
+int fossil_game_score_add_rule(const char* achievement_id,int kind,long long threshold);
+
+/* Called once per new unlock, whether granted directly or by a rule */
+void fossil_game_score_on_unlock(fossil_game_score_unlock_fn fn,void* ctx);
+
+int fossil_game_score_add_achievement(const char* player_id,const char* achievement_id);
+int fossil_game_score_has_achievement(const char* player_id,const char* achievement_id);
+
+/* Achievements held by a player */
+int fossil_game_score_achievement_count(const char* player_id);
+
+/* Players holding an achievement, O(1) */
+int fossil_game_score_achievement_holders(const char* achievement_id);
+
+/* Quiz streak tracking; quizzes report every answer here */
+int fossil_game_score_quiz_answer(const char* player_id,int correct);
+int fossil_game_score_quiz_streak(const char* player_id,int* out_current,int* out_best);
+
+/* ===== Windowed leaderboards ===== */
+
+/*
+ * Rankings over recent score deltas. A window covers its last bucket_count
+ * buckets of bucket_seconds each, counted from origin (unix seconds), and
+ * receives every fossil_game_score_update. bucket_count 1 gives a tumbling
+ * window (daily: 86400,1 with origin at local midnight); more buckets give
+ * a rolling one (7 x 86400 for "last 7 days"). A window created ahead of
+ * its origin ignores updates until the origin is reached.
+ *
+ * Time only moves through fossil_game_score_window_advance, normally once
+ * per tick; until the first call it is the wall clock at the first create.
+ * Advancing expires the buckets that left the window, amortised O(1) per
+ * recorded update; crossing a whole window resets in O(buckets). Rank is
+ * O(log n), top-k O(log n + k). Players whose window total is zero are not
+ * ranked; ties go to the player created first. Windows are not part of
+ * snapshots.
+ */
+int fossil_game_score_window_create(const char* window_id,int64_t origin,int64_t bucket_seconds,uint32_t bucket_count);
+int fossil_game_score_window_destroy(const char* window_id);
+void fossil_game_score_window_advance(int64_t now);
+
+int fossil_game_score_window_get(const char* window_id,const char* player_id,long long* out);
+
+/* 1-based; -2 when the player has no score in the window */
+int fossil_game_score_window_rank(const char* window_id,const char* player_id,int* out_rank);
+
+/* Ranked players in the window */
+int fossil_game_score_window_count(const char* window_id);
+
+/* Best `cap` players, highest first; either output array may be NULL */
+int fossil_game_score_window_top(const char* window_id,const char** out_ids,long long* out_scores,int cap,int* out_count);
+
+/* ===== Ratings ===== */
+
+/*
+ * Glicko-2 skill ratings, separate from the raw score. Ratings use the
+ * Glicko scale: new players start at 1500 with deviation 350 and
+ * volatility 0.06. Ratings change only through rating periods: one call
+ * takes every result of the period (millions are fine) and updates all
+ * players in a single pass over the rating columns; players without games
+ * in the period only grow their deviation. Unknown ids are created.
+ */
+typedef struct {
+    const char* player_a;
+    const char* player_b;
+    double score_a;             /* player_a's result: 1 win, 0.5 draw, 0 loss */
+} fossil_game_score_match_result;
+
+int fossil_game_score_rating_period(const fossil_game_score_match_result* results,size_t count);
+
+/* Any output may be NULL; -2 when the player is unknown */
+int fossil_game_score_rating_get(const char* player_id,double* out_rating,double* out_deviation,double* out_volatility);
+int fossil_game_score_rating_set(const char* player_id,double rating,double deviation,double volatility);
+
+/* System constant constraining volatility change, default 0.5 */
+int fossil_game_score_rating_set_tau(double tau);
+
+/* Players whose rating is within k combined deviations,
+   |r1 - r2| <= k * sqrt(rd1^2 + rd2^2); same ownership as matchmaking */
+int fossil_game_score_rating_matchmaking(const char* player_id,double k,char*** out_opponents,int* out_count);
+
+/* ===== Shard exports ===== */
+
+/*
+ * For deployments that split players across processes. Each shard exports
+ * a board (NULL = "global", an empty board = every player) as a compact
+ * blob: its top k entries, exact and sorted, plus a sparse histogram of
+ * all scores in log-linear buckets (16 per power of two). Merging N
+ * exports yields the global top-k in O(k*N) and approximate ranks for any
+ * score. Shards are assumed to hold disjoint players. The merged top-k is
+ * cut to the shortest export that was truncated, so it is always exact.
+ *
+ * Ranks count entries strictly above the score plus one. Scores within
+ * the merged top-k rank exactly (error 0); lower scores are estimated from
+ * the histogram and may be off by at most *out_error, the number of entries
+ * sharing the score's bucket.
+ */
+typedef struct fossil_game_score_merged fossil_game_score_merged;
+
+/* *out_buf is malloc'd */
+int fossil_game_score_shard_export(const char* leaderboard_id,int k,unsigned char** out_buf,size_t* out_len);
+
+/* -2 when an export is malformed */
+int fossil_game_score_shard_merge(const unsigned char* const* exports,const size_t* lens,int count,int k,
+                                  fossil_game_score_merged** out);
+
+/* Ids are owned by the merge; either output array may be NULL */
+int fossil_game_score_merged_top(const fossil_game_score_merged* m,const char** out_ids,long long* out_scores,int cap,int* out_count);
+
+/* Entries across all merged shards */
+long long fossil_game_score_merged_total(const fossil_game_score_merged* m);
+
+/* out_error may be NULL */
+int fossil_game_score_merged_rank(const fossil_game_score_merged* m,long long score,long long* out_rank,long long* out_error);
+void fossil_game_score_merged_free(fossil_game_score_merged* m);
+
+/* ===== Approximate ranks ===== */
+
+/*
+ * Rank among every player by lifetime score, answered from a histogram in
+ * the shard export buckets that fossil_game_score_update keeps current.
+ * Each update costs at most two Fenwick updates (none while the score
+ * stays in its bucket); queries are O(log buckets), memory is fixed at
+ * about 31 KB. Rank is one plus the players strictly above.
+ *
+ * Error bound: exact for scores whose magnitude is below 16. Above that a
+ * bucket spans at most 1/16 of its values, and the estimate is off by no
+ * more than the number of other players in the same bucket, which is what
+ * *out_error reports. Percentile error is that count over the population.
+ */
+int fossil_game_score_rank_estimate(const char* player_id,long long* out_rank,long long* out_error);
+
+/* Rank a player with this score would get */
+int fossil_game_score_rank_of(long long score,long long* out_rank,long long* out_error);
+
+/* Estimated rank over the population: 0.03 means the top 3% */
+int fossil_game_score_percentile(const char* player_id,double* out_top);
+
+/* ===== Scoreboards ===== */
+
+/*
+ * Named views over the lifetime score. Submitting adds score to the
+ * player's lifetime total, as fossil_game_score_update does, and makes the
+ * player a member of the board (created on first submit). The global board
+ * (board_id NULL or "global") holds every player. Returned ids are owned
+ * by the library.
+ */
 int fossil_game_scoreboard_submit(const char* board_id,const char* player_id,int score);
 
-/* Query score */
+/* Membership without points; a no-op for the global board */
+int fossil_game_scoreboard_join(const char* board_id,const char* player_id);
+
+/* Query score; -2 for an unknown player or board, or one the player is not on */
 int fossil_game_scoreboard_get(const char* board_id,const char* player_id,int* out);
 
-/* Ranking */
+/* Ranking: 1 + the members scoring strictly higher. The global board
+   (NULL or "global") uses the approximate lifetime rank above; a named
+   board counts its members exactly. -2 for an unknown board or a player
+   that is not on it */
 int fossil_game_scoreboard_rank(const char* board_id,const char* player_id,int* out);
 
-/* Leaderboard */
+/* Leaderboard: the board's top player, NULL when it is empty or unknown */
 const char* fossil_game_scoreboard_leaderboard(const char* board_id);
 
-/* AI matchmaking */
+/* AI matchmaking: the member with the closest score, NULL when there is none */
 const char* fossil_game_scoreboard_matchmake(const char* board_id,const char* player_id);
 
 #ifdef __cplusplus
@@ -50,11 +260,66 @@ const char* fossil_game_scoreboard_matchmake(const char* board_id,const char* pl
 
 #ifdef __cplusplus
 namespace fossil::game {
+class ScoreWindow {
+public:
+    explicit ScoreWindow(const char* id) : id(id) {}
+    static void advance(int64_t now){ fossil_game_score_window_advance(now); }
+    int create(int64_t origin,int64_t bucket_seconds,uint32_t buckets){ return fossil_game_score_window_create(id,origin,bucket_seconds,buckets); }
+    int rank(const char* player,int* out) const { return fossil_game_score_window_rank(id,player,out); }
+    int get(const char* player,long long* out) const { return fossil_game_score_window_get(id,player,out); }
+    int top(const char** ids,long long* scores,int cap,int* count) const { return fossil_game_score_window_top(id,ids,scores,cap,count); }
+private:
+    const char* id;
+};
+
+class Rating {
+public:
+    static int period(const fossil_game_score_match_result* results,size_t count){ return fossil_game_score_rating_period(results,count); }
+    static int get(const char* player,double* rating,double* deviation,double* volatility){ return fossil_game_score_rating_get(player,rating,deviation,volatility); }
+    static int set(const char* player,double rating,double deviation,double volatility){ return fossil_game_score_rating_set(player,rating,deviation,volatility); }
+    static int matchmaking(const char* player,double k,char*** out,int* count){ return fossil_game_score_rating_matchmaking(player,k,out,count); }
+};
+
+class ScoreMerge {
+public:
+    ScoreMerge(const unsigned char* const* exports,const size_t* lens,int count,int k){
+        if(fossil_game_score_shard_merge(exports,lens,count,k,&m)!=0) m=nullptr;
+    }
+    ~ScoreMerge(){ fossil_game_score_merged_free(m); }
+    ScoreMerge(const ScoreMerge&)=delete;
+    ScoreMerge& operator=(const ScoreMerge&)=delete;
+
+    static int exportShard(const char* board,int k,unsigned char** buf,size_t* len){ return fossil_game_score_shard_export(board,k,buf,len); }
+    bool ok() const { return m!=nullptr; }
+    long long total() const { return fossil_game_score_merged_total(m); }
+    int top(const char** ids,long long* scores,int cap,int* count) const { return fossil_game_score_merged_top(m,ids,scores,cap,count); }
+    int rank(long long score,long long* out,long long* error=nullptr) const { return fossil_game_score_merged_rank(m,score,out,error); }
+private:
+    fossil_game_score_merged* m=nullptr;
+};
+
+class ScoreRank {
+public:
+    static int estimate(const char* player,long long* rank,long long* error=nullptr){ return fossil_game_score_rank_estimate(player,rank,error); }
+    static int of(long long score,long long* rank,long long* error=nullptr){ return fossil_game_score_rank_of(score,rank,error); }
+    static int percentile(const char* player,double* top){ return fossil_game_score_percentile(player,top); }
+};
+
+class Achievements {
+public:
+    static int define(const char* a){ return fossil_game_score_define_achievement(a); }
+    static int rule(const char* a,int kind,long long threshold){ return fossil_game_score_add_rule(a,kind,threshold); }
+    static int grant(const char* p,const char* a){ return fossil_game_score_add_achievement(p,a); }
+    static bool has(const char* p,const char* a){ return fossil_game_score_has_achievement(p,a)!=0; }
+    static int count(const char* p){ return fossil_game_score_achievement_count(p); }
+    static int holders(const char* a){ return fossil_game_score_achievement_holders(a); }
+};
+
 class Scoreboard {
     const char* id;
 public:
     Scoreboard(const char* i):id(i){}
-    void submit(const char* p,int s){ fossil_game_scoreboard_submit(id,p,s); }
+    int submit(const char* p,int s){ return fossil_game_scoreboard_submit(id,p,s); }
     int get(const char* p){ int out=0; fossil_game_scoreboard_get(id,p,&out); return out; }
     int rank(const char* p){ int r=0; fossil_game_scoreboard_rank(id,p,&r); return r; }
     const char* leaderboard(){ return fossil_game_scoreboard_leaderboard(id); }
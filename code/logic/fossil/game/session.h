@@ -25,6 +25,8 @@
 #ifndef FOSSIL_GAME_SESSION_H
 #define FOSSIL_GAME_SESSION_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,8 +38,18 @@ int fossil_game_session_start(const char* session_id);
 int fossil_game_session_stop(const char* session_id);
 int fossil_game_session_tick(const char* session_id);
 
+/*
+ * Membership is the player module's session roster; add_player moves a
+ * player out of any other session. destroy evicts every member, -5 while
+ * the roster is being iterated.
+ *
+ * tick requires a started session (-3 otherwise) and returns the member
+ * count.
+ */
 int fossil_game_session_add_player(const char* session_id,const char* player_id);
 int fossil_game_session_remove_player(const char* session_id,const char* player_id);
+int fossil_game_session_player_count(const char* session_id);
+uint64_t fossil_game_session_ticks(const char* session_id);
 
 #ifdef __cplusplus
 }
@@ -54,6 +66,7 @@ public:
     void tick(){ fossil_game_session_tick(id); }
     void add_player(const char* p){ fossil_game_session_add_player(id,p); }
     void remove_player(const char* p){ fossil_game_session_remove_player(id,p); }
+    int player_count(){ return fossil_game_session_player_count(id); }
 };
 }
 #endif
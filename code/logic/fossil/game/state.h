@@ -0,0 +1,145 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_STATE_H
+#define FOSSIL_GAME_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Binary snapshot of the player, score and quiz stores.
+ *
+ * Layout: "FGST", u32 version, u32 section count, then per section a u32
+ * tag, a u64 payload length and the payload. Integers inside payloads are
+ * LEB128 varints (signed ones zigzag encoded), doubles are 8 raw little
+ * endian bytes, strings and blobs are a varint length plus bytes. Fixed
+ * width header fields are little endian. Unknown sections are skipped.
+ *
+ * save writes to "<path>.tmp" and renames it into place. load expects the
+ * stores it restores to be empty and maps the file read-only where the
+ * platform allows.
+ *
+ * save_background snapshots from a forked child holding a copy-on-write
+ * view of the process, so the game loop keeps running; poll returns 0
+ * while it runs, 1 once finished (the save's result in out_rc) and -1 when
+ * nothing is pending. A successful background snapshot compacts the
+ * write-ahead log. Without fork the save runs synchronously.
+ *
+ * It is not free for the loop: the fork itself stalls the caller for
+ * roughly a tick on a large process (17-19 ms with 1M players), the first
+ * ticks after it pay for copy-on-write faults, and ticks run about 40%
+ * slower until the child finishes. Schedule it where a hitch is acceptable.
+ *
+ * The child allocates and uses stdio, which POSIX only allows after fork
+ * in a single-threaded process. Call save_background only while no other
+ * thread exists, or on a C library whose malloc and stdio survive fork
+ * (glibc); otherwise use save.
+ *
+ * Errors: -1 bad args, -2 malformed or unsupported file, -3 alloc,
+ * -4 I/O failure, -5 a target store is not empty (load) or a background
+ * save is already running.
+ */
+#define FOSSIL_GAME_STATE_VERSION 2
+
+#define FOSSIL_GAME_STATE_SECTION_PLAYER  1
+#define FOSSIL_GAME_STATE_SECTION_SCORE   2
+#define FOSSIL_GAME_STATE_SECTION_QUIZZED 3
+#define FOSSIL_GAME_STATE_SECTION_WAL     4
+
+typedef struct fossil_game_state_writer {
+    FILE* file;
+    unsigned char* buf;
+    size_t len;
+    size_t cap;
+    uint64_t written;           /* bytes handed to the file so far */
+    int err;                    /* sticky; first failure wins */
+} fossil_game_state_writer;
+
+typedef struct fossil_game_state_reader {
+    const unsigned char* pos;
+    const unsigned char* end;
+    int err;                    /* sticky; reads past end return zeros */
+} fossil_game_state_reader;
+
+int fossil_game_state_save(const char* path);
+int fossil_game_state_load(const char* path);
+
+int fossil_game_state_save_background(const char* path);
+int fossil_game_state_poll(int* out_rc);
+
+/* Encoding primitives shared by the store hooks */
+void fossil_game_state_put_u64(fossil_game_state_writer* w,uint64_t v);
+void fossil_game_state_put_i64(fossil_game_state_writer* w,int64_t v);
+void fossil_game_state_put_f64(fossil_game_state_writer* w,double v);
+void fossil_game_state_put_bytes(fossil_game_state_writer* w,const void* data,size_t len);
+void fossil_game_state_put_str(fossil_game_state_writer* w,const char* s);
+
+uint64_t fossil_game_state_get_u64(fossil_game_state_reader* r);
+int64_t fossil_game_state_get_i64(fossil_game_state_reader* r);
+double fossil_game_state_get_f64(fossil_game_state_reader* r);
+
+/* Points into the mapped file; valid for the duration of the load */
+const void* fossil_game_state_get_bytes(fossil_game_state_reader* r,size_t* out_len);
+
+/* Owned NUL-terminated copy, NULL on error */
+char* fossil_game_state_get_str(fossil_game_state_reader* r);
+
+/* Store hooks, one section each */
+int fossil_game_player_state_save(fossil_game_state_writer* w);
+int fossil_game_player_state_load(fossil_game_state_reader* r);
+int fossil_game_score_state_save(fossil_game_state_writer* w);
+int fossil_game_score_state_load(fossil_game_state_reader* r);
+int fossil_game_quizzed_state_save(fossil_game_state_writer* w);
+int fossil_game_quizzed_state_load(fossil_game_state_reader* r);
+int fossil_game_wal_state_save(fossil_game_state_writer* w);
+int fossil_game_wal_state_load(fossil_game_state_reader* r);
+
+/* Empty a store again after a failed load; nothing is logged */
+void fossil_game_player_state_clear(void);
+void fossil_game_score_state_clear(void);
+void fossil_game_quizzed_state_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace fossil::game {
+class State {
+public:
+    static int save(const char* path){ return fossil_game_state_save(path); }
+    static int load(const char* path){ return fossil_game_state_load(path); }
+    static int saveBackground(const char* path){ return fossil_game_state_save_background(path); }
+    static int poll(int* rc){ return fossil_game_state_poll(rc); }
+};
+}
+#endif
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_SYNC_H
+#define FOSSIL_GAME_SYNC_H
+
+#include "fossil/game/player.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Session state replication.
+ *
+ * Every capture records a compact snapshot of the session's members (score,
+ * inventory and attributes) into a ring of FOSSIL_GAME_SYNC_HISTORY ticks. Encoding for a
+ * client produces a delta against the last snapshot that client acknowledged,
+ * or a full state when it has none (or it fell out of the ring).
+ *
+ * Wire format (all integers are LEB128 varints, signed values zigzag-coded):
+ *   tick, base_tick + 1 (0 = full state)
+ *   dict_first, dict_new, dict_new x { len, bytes }     new string table entries
+ *   entity_count, entity_count x {
+ *       entity gap (from previous entity, first from 0),
+ *       flags byte: 1 = score, 2 = items, 4 = removed, 8 = added, 16 = attrs
+ *       [score delta]
+ *       [item_count, item_count x { item gap, count delta }]
+ *       [attr_count, attr_count x { key gap, type byte, value }]
+ *   }
+ * An item whose new count is zero has been removed. An attribute carries its
+ * full new value: ints zigzag-coded, floats as 8 little-endian bytes, strings
+ * and blobs as len, bytes; type 0 (no value) means it was unset. Entity, item
+ * and key ids are indexes into the session string table, which only ever
+ * grows.
+ */
+#define FOSSIL_GAME_SYNC_HISTORY 32
+
+#define FOSSIL_GAME_SYNC_SCORE   0x01
+#define FOSSIL_GAME_SYNC_ITEMS   0x02
+#define FOSSIL_GAME_SYNC_REMOVED 0x04
+#define FOSSIL_GAME_SYNC_ADDED   0x08
+#define FOSSIL_GAME_SYNC_ATTRS   0x10
+
+/* Record a snapshot of the session for the next tick */
+int fossil_game_sync_capture(const char* session_id,uint32_t* out_tick);
+
+/* Encode the latest snapshot for a client (-4 when cap is too small) */
+int fossil_game_sync_encode(const char* session_id,const char* client_id,
+                            unsigned char* out,size_t cap,size_t* out_len);
+
+/* Client acknowledged a tick; later deltas are computed against it */
+int fossil_game_sync_ack(const char* session_id,const char* client_id,uint32_t tick);
+
+int fossil_game_sync_drop_client(const char* session_id,const char* client_id);
+int fossil_game_sync_release(const char* session_id);
+
+/*
+ * Client side: a mirror rebuilds session state from encoded updates. A full
+ * state replaces whatever the mirror held; a delta must be based on the
+ * mirror's current tick or apply returns -5 and changes nothing (the client
+ * should ask for a full state). Malformed input returns -2; a delta that
+ * fails leaves the previous state in place, a full state that fails leaves
+ * the mirror empty. The caller acks the tick apply reports.
+ *
+ * Lookups mirror the player API: attribute values use the attr_foreach
+ * layout and stay valid until the next apply. Unknown players return -2;
+ * item_count returns 0 for an item the player does not hold.
+ */
+typedef struct fossil_game_sync_mirror fossil_game_sync_mirror;
+
+fossil_game_sync_mirror* fossil_game_sync_mirror_create(void);
+void fossil_game_sync_mirror_free(fossil_game_sync_mirror* m);
+
+int fossil_game_sync_apply(fossil_game_sync_mirror* m,const unsigned char* data,size_t len,uint32_t* out_tick);
+
+uint32_t fossil_game_sync_mirror_tick(const fossil_game_sync_mirror* m);
+int fossil_game_sync_mirror_count(const fossil_game_sync_mirror* m);
+int fossil_game_sync_mirror_score(const fossil_game_sync_mirror* m,const char* player_id,int* out_points);
+int fossil_game_sync_mirror_item_count(const fossil_game_sync_mirror* m,const char* player_id,const char* item_id);
+int fossil_game_sync_mirror_attr(const fossil_game_sync_mirror* m,const char* player_id,const char* key,
+                                 int* out_type,const void** out_data,size_t* out_len);
+int fossil_game_sync_mirror_items(const fossil_game_sync_mirror* m,const char* player_id,
+                                  fossil_game_player_item_fn fn,void* ctx);
+int fossil_game_sync_mirror_attrs(const fossil_game_sync_mirror* m,const char* player_id,
+                                  fossil_game_player_attr_fn fn,void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace fossil::game {
+class Sync {
+    const char* id;
+public:
+    Sync(const char* s):id(s){}
+    uint32_t capture(){ uint32_t t=0; fossil_game_sync_capture(id,&t); return t; }
+    size_t encode(const char* c,unsigned char* out,size_t cap){ size_t n=0; return fossil_game_sync_encode(id,c,out,cap,&n)==0?n:0; }
+    void ack(const char* c,uint32_t tick){ fossil_game_sync_ack(id,c,tick); }
+    void dropClient(const char* c){ fossil_game_sync_drop_client(id,c); }
+};
+
+class SyncMirror {
+public:
+    SyncMirror():m(fossil_game_sync_mirror_create()){}
+    ~SyncMirror(){ fossil_game_sync_mirror_free(m); }
+    SyncMirror(const SyncMirror&)=delete;
+    SyncMirror& operator=(const SyncMirror&)=delete;
+
+    bool ok() const { return m!=nullptr; }
+    int apply(const unsigned char* data,size_t len,uint32_t* tick=nullptr){ return fossil_game_sync_apply(m,data,len,tick); }
+    uint32_t tick() const { return fossil_game_sync_mirror_tick(m); }
+    int count() const { return fossil_game_sync_mirror_count(m); }
+    int score(const char* p,int* out) const { return fossil_game_sync_mirror_score(m,p,out); }
+    int itemCount(const char* p,const char* i) const { return fossil_game_sync_mirror_item_count(m,p,i); }
+    int attr(const char* p,const char* k,int* type,const void** data,size_t* len) const { return fossil_game_sync_mirror_attr(m,p,k,type,data,len); }
+private:
+    fossil_game_sync_mirror* m=nullptr;
+};
+}
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_TRACE_H
+#define FOSSIL_GAME_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Tick profiler. The library marks its tick phases (session tick and
+ * member updates, NPC tick_all phases, matchmaking, message drains, sync
+ * capture) as begin/end zone events; the game loop brackets each tick
+ * with frame_begin/frame_end. Events go into a per-thread ring of
+ * FOSSIL_GAME_TRACE_EVENTS entries owned by the recording thread, so
+ * recording takes no locks; the oldest events are overwritten.
+ *
+ * Each ring costs FOSSIL_GAME_TRACE_EVENTS x 24 bytes (1.5 MiB) and is
+ * kept for export after its thread exits; the next thread that records
+ * takes over a retired ring instead of allocating. At most
+ * FOSSIL_GAME_TRACE_THREADS rings exist (96 MiB); threads beyond that
+ * while all are in use record nothing.
+ *
+ * Zones are compiled in only when the library is built with the
+ * with_trace option (FOSSIL_GAME_TRACE); otherwise the zone macros expand
+ * to nothing and enable returns -4. Frames are always counted so that
+ * budgets can be checked without tracing.
+ *
+ * Export writes Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ * Export while other threads record may contain torn events at the
+ * oldest end of their rings; export from the game loop for exact output.
+ *
+ * Zone names are stored by pointer and written unescaped: pass string
+ * literals.
+ */
+#define FOSSIL_GAME_TRACE_EVENTS (1u<<16)   /* per thread */
+#define FOSSIL_GAME_TRACE_THREADS 64        /* rings ever allocated */
+#define FOSSIL_GAME_TRACE_FRAMES 256        /* frame start times kept for frame-bounded export */
+
+/* Called from frame_end when a frame took longer than the budget */
+typedef void (*fossil_game_trace_overrun_fn)(uint64_t frame,double frame_ms,void* ctx);
+
+/* Returns -4 when the library was built without tracing */
+int fossil_game_trace_enable(int on);
+int fossil_game_trace_enabled(void);
+
+/* Frame markers; frame_end returns 1 when the frame overran the budget */
+void fossil_game_trace_frame_begin(void);
+int fossil_game_trace_frame_end(void);
+uint64_t fossil_game_trace_frame(void);
+
+/* budget_ms <= 0 disables the check */
+int fossil_game_trace_set_budget(double budget_ms,fossil_game_trace_overrun_fn fn,void* ctx);
+
+/* Zones for game code; same rules as the library zones */
+void fossil_game_trace_zone_begin(const char* name);
+void fossil_game_trace_zone_end(const char* name);
+
+/* Writes the last `frames` frames (0 = everything still buffered) */
+int fossil_game_trace_export(FILE* out,int frames);
+int fossil_game_trace_dump(const char* path,int frames);
+
+/* Drops every buffered event */
+void fossil_game_trace_clear(void);
+
+/* ===== Instrumentation used by the library sources ===== */
+
+#if defined(FOSSIL_GAME_TRACE)
+extern int fossil_game_trace_on;
+void fossil_game_trace_event(const char* name,char phase);
+
+#define FOSSIL_GAME_TRACE_BEGIN(name) \
+    do{ if(fossil_game_trace_on) fossil_game_trace_event(name,'B'); }while(0)
+#define FOSSIL_GAME_TRACE_END(name) \
+    do{ if(fossil_game_trace_on) fossil_game_trace_event(name,'E'); }while(0)
+#else
+#define FOSSIL_GAME_TRACE_BEGIN(name) ((void)0)
+#define FOSSIL_GAME_TRACE_END(name) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace fossil::game {
+/* Scoped zone: begins on construction, ends on destruction */
+class TraceZone {
+public:
+    explicit TraceZone(const char* name) : name(name) { fossil_game_trace_zone_begin(name); }
+    ~TraceZone(){ fossil_game_trace_zone_end(name); }
+    TraceZone(const TraceZone&)=delete;
+    TraceZone& operator=(const TraceZone&)=delete;
+private:
+    const char* name;
+};
+
+class Trace {
+public:
+    static int enable(bool on=true){ return fossil_game_trace_enable(on?1:0); }
+    static void frameBegin(){ fossil_game_trace_frame_begin(); }
+    static bool frameEnd(){ return fossil_game_trace_frame_end()==1; }
+    static int budget(double ms,fossil_game_trace_overrun_fn fn=nullptr,void* ctx=nullptr){ return fossil_game_trace_set_budget(ms,fn,ctx); }
+    static int dump(const char* path,int frames=0){ return fossil_game_trace_dump(path,frames); }
+};
+}
+#endif
+
+#endif
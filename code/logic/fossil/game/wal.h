@@ -0,0 +1,120 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#ifndef FOSSIL_GAME_WAL_H
+#define FOSSIL_GAME_WAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Write-ahead log of score, inventory and quiz mutations made between
+ * snapshots. Mutations are encoded into an in-memory batch and written as
+ * one checksummed frame per group commit: when the batch fills, or when
+ * the game loop calls commit (typically once per tick). Each frame carries
+ * a log sequence number; snapshots record the last committed one so that
+ * replay skips frames the snapshot already covers.
+ *
+ * Startup order: fossil_game_state_load, fossil_game_wal_replay, then
+ * fossil_game_wal_open on the same path. open drops a torn final frame.
+ *
+ * Errors: -1 bad args, -2 malformed log, -3 alloc, -4 I/O failure,
+ * -5 log already open (replay, open).
+ */
+#define FOSSIL_GAME_WAL_SYNC_NONE     0   /* write on commit, leave flushing to the OS */
+#define FOSSIL_GAME_WAL_SYNC_COMMIT   1   /* fsync every group commit */
+#define FOSSIL_GAME_WAL_SYNC_INTERVAL 2   /* fsync at most once per interval_ms */
+
+typedef struct {
+    int sync;                   /* FOSSIL_GAME_WAL_SYNC_* */
+    uint32_t interval_ms;       /* SYNC_INTERVAL period */
+    uint32_t batch_bytes;       /* commit once the batch reaches this size */
+} fossil_game_wal_config;
+
+/* NULL config: SYNC_COMMIT, 64 KiB batches */
+int fossil_game_wal_open(const char* path,const fossil_game_wal_config* config);
+int fossil_game_wal_commit(void);
+int fossil_game_wal_close(void);
+
+/* Applies frames newer than the loaded snapshot; returns the records applied */
+int fossil_game_wal_replay(const char* path);
+
+/* Commits, writes a snapshot to snapshot_path, then empties the log */
+int fossil_game_wal_checkpoint(const char* snapshot_path);
+
+/* Drops the frames up to lsn once a snapshot covering them is durable */
+int fossil_game_wal_compact(uint64_t lsn);
+
+/* Sequence number of the last committed frame */
+uint64_t fossil_game_wal_lsn(void);
+
+/* Record hooks, called by the stores once a mutation is certain to succeed; no-ops while no log is open */
+void fossil_game_wal_record_player_create(const char* player_id);
+void fossil_game_wal_record_player_remove(const char* player_id);
+void fossil_game_wal_record_score_update(const char* player_id,int points);
+void fossil_game_wal_record_score_reset(const char* player_id);
+void fossil_game_wal_record_scoreboard_join(const char* board_id,const char* player_id);
+void fossil_game_wal_record_inventory_add(const char* player_id,const char* item_id,int count);
+void fossil_game_wal_record_inventory_remove(const char* player_id,const char* item_id,int count);
+void fossil_game_wal_record_inventory_trade(const char* player_a,const char* const* a_items,const int* a_counts,size_t a_count,
+                                            const char* player_b,const char* const* b_items,const int* b_counts,size_t b_count);
+void fossil_game_wal_record_quizzed_answer(const char* quiz_id,const char* player_id,const char* answer);
+void fossil_game_wal_record_quizzed_create(const char* quiz_id);
+void fossil_game_wal_record_quizzed_remove(const char* quiz_id);
+void fossil_game_wal_record_quizzed_question(const char* quiz_id,const char* question_id,const char* text);
+void fossil_game_wal_record_quizzed_option(const char* quiz_id,const char* question_id,const char* option_id,
+                                           const char* text,int correct);
+void fossil_game_wal_record_quizzed_remove_question(const char* quiz_id,const char* question_id);
+void fossil_game_wal_record_quizzed_reset(const char* quiz_id,const char* player_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace fossil::game {
+/* Owns the log only when its open succeeded; error() holds the open result */
+class WriteAheadLog {
+public:
+    WriteAheadLog(const char* path,const fossil_game_wal_config* config=nullptr):rc(fossil_game_wal_open(path,config)){}
+    ~WriteAheadLog(){ if(rc==0) fossil_game_wal_close(); }
+    WriteAheadLog(const WriteAheadLog&)=delete;
+    WriteAheadLog& operator=(const WriteAheadLog&)=delete;
+
+    bool ok() const { return rc==0; }
+    int error() const { return rc; }
+    int commit(){ return fossil_game_wal_commit(); }
+    int checkpoint(const char* snapshot_path){ return fossil_game_wal_checkpoint(snapshot_path); }
+    uint64_t lsn() const { return fossil_game_wal_lsn(); }
+private:
+    int rc;
+};
+}
+#endif
+
+#endif
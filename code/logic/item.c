@@ -0,0 +1,431 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/item.h"
+#include <stdlib.h>
+#include <string.h>
+
+static char* fossil_strdup(const char* s)
+{
+    if(!s) return NULL;
+
+    size_t len = 0;
+    while(s[len]) len++;
+
+    char* out = (char*)malloc(len + 1);
+    if(!out) return NULL;
+
+    for(size_t i=0;i<=len;i++)
+        out[i] = s[i];
+
+    return out;
+}
+
+/* ============================================================
+   Interned names
+   ============================================================ */
+
+/* Append-only; names are never freed, so ids and pointers stay valid */
+typedef struct {
+    char** names;
+    uint32_t* hashes;
+    uint32_t count;
+    uint32_t limit;
+    uint32_t* index;            /* id + 1, 0 = empty */
+    uint32_t index_cap;
+} intern_table_t;
+
+static intern_table_t g_items = { NULL,NULL,0,INT32_MAX,NULL,0 };
+static intern_table_t g_tags = { NULL,NULL,0,UINT16_MAX,NULL,0 };
+
+static uint32_t hash_str(const char* s)
+{
+    uint32_t h=2166136261u;
+    while(*s){
+        h^=(unsigned char)*s++;
+        h*=16777619u;
+    }
+    return h;
+}
+
+static int intern(intern_table_t* t,const char* name,int create)
+{
+    uint32_t h=hash_str(name);
+
+    if(t->index_cap){
+        uint32_t mask=t->index_cap-1;
+        for(uint32_t i=h&mask;t->index[i];i=(i+1)&mask){
+            uint32_t id=t->index[i]-1;
+            if(t->hashes[id]==h && strcmp(t->names[id],name)==0)
+                return (int)id;
+        }
+    }
+
+    if(!create) return -1;
+    if(t->count==t->limit) return -3;
+
+    if((t->count+1)*2>t->index_cap){
+        uint32_t cap=t->index_cap?t->index_cap*2:64;
+        uint32_t* idx=calloc(cap,sizeof(*idx));
+        if(!idx) return -3;
+        for(uint32_t id=0;id<t->count;id++){
+            uint32_t j=t->hashes[id]&(cap-1);
+            while(idx[j]) j=(j+1)&(cap-1);
+            idx[j]=id+1;
+        }
+
+        char** names=realloc(t->names,sizeof(*names)*cap/2);
+        if(names) t->names=names;
+        uint32_t* hashes=realloc(t->hashes,sizeof(*hashes)*cap/2);
+        if(hashes) t->hashes=hashes;
+        if(!names||!hashes){ free(idx); return -3; }
+
+        free(t->index);
+        t->index=idx;
+        t->index_cap=cap;
+    }
+
+    char* copy=fossil_strdup(name);
+    if(!copy) return -3;
+
+    uint32_t id=t->count++;
+    t->names[id]=copy;
+    t->hashes[id]=h;
+
+    uint32_t j=h&(t->index_cap-1);
+    while(t->index[j]) j=(j+1)&(t->index_cap-1);
+    t->index[j]=id+1;
+    return (int)id;
+}
+
+int fossil_game_item_intern(const char* item_id)
+{
+    if(!item_id) return -1;
+    return intern(&g_items,item_id,1);
+}
+
+int fossil_game_item_lookup(const char* item_id)
+{
+    if(!item_id) return -1;
+    return intern(&g_items,item_id,0);
+}
+
+const char* fossil_game_item_name(int item)
+{
+    return item>=0 && (uint32_t)item<g_items.count?g_items.names[item]:NULL;
+}
+
+int fossil_game_item_count(void)
+{
+    return (int)g_items.count;
+}
+
+int fossil_game_item_tag_lookup(const char* tag)
+{
+    if(!tag) return -1;
+    return intern(&g_tags,tag,0);
+}
+
+const char* fossil_game_item_tag_name(int tag)
+{
+    return tag>=0 && (uint32_t)tag<g_tags.count?g_tags.names[tag]:NULL;
+}
+
+/* ============================================================
+   Catalog versions
+   ============================================================ */
+
+/*
+ * One immutable version of every definition. Tags are pooled, and an
+ * inverted index lists the items carrying each tag, grouped by tag id.
+ */
+struct fossil_game_item_catalog {
+    uint32_t refs;              /* holders, including being current */
+    uint32_t version;
+    uint32_t count;             /* definitions for item ids below count */
+    fossil_game_item_def* defs;
+    uint16_t* tag_pool;
+    uint32_t tag_count;         /* tag ids below tag_count are indexed */
+    uint32_t* by_tag_off;       /* tag_count + 1 offsets into by_tag */
+    uint32_t* by_tag;
+};
+
+typedef struct {
+    uint32_t item;
+    int32_t stack_size;
+    uint32_t tag_count;
+    uint16_t tags[FOSSIL_GAME_ITEM_MAX_TAGS];
+} item_change_t;
+
+static fossil_game_item_catalog* g_current = NULL;
+
+static void catalog_free(fossil_game_item_catalog* c)
+{
+    free(c->defs);
+    free(c->tag_pool);
+    free(c->by_tag_off);
+    free(c->by_tag);
+    free(c);
+}
+
+static void catalog_unref(fossil_game_item_catalog* c)
+{
+    if(c && --c->refs==0) catalog_free(c);
+}
+
+/* The change that applies to item (the last of its run), or NULL */
+static const item_change_t* next_change(const item_change_t* changes,size_t n,size_t* k,uint32_t item)
+{
+    if(*k>=n || changes[*k].item!=item) return NULL;
+    while(*k+1<n && changes[*k+1].item==item) (*k)++;
+    return &changes[(*k)++];
+}
+
+/*
+ * Builds the next version from the current one plus changes sorted by item
+ * and makes it current. Nothing changes on failure.
+ */
+static int catalog_publish(const item_change_t* changes,size_t n)
+{
+    const fossil_game_item_catalog* old=g_current;
+    fossil_game_item_catalog* c=calloc(1,sizeof(*c));
+    if(!c) return -3;
+
+    c->refs=1;
+    c->version=old?old->version+1:1;
+    c->count=g_items.count;
+    c->tag_count=g_tags.count;
+
+    size_t pool=0,k=0;
+    for(uint32_t item=0;item<c->count;item++){
+        const item_change_t* ch=next_change(changes,n,&k,item);
+        if(ch) pool+=ch->tag_count;
+        else if(old && item<old->count) pool+=old->defs[item].tag_count;
+    }
+
+    c->defs=calloc(c->count?c->count:1,sizeof(*c->defs));
+    c->tag_pool=malloc(sizeof(*c->tag_pool)*(pool?pool:1));
+    c->by_tag_off=calloc(c->tag_count+1,sizeof(*c->by_tag_off));
+    c->by_tag=malloc(sizeof(*c->by_tag)*(pool?pool:1));
+    uint32_t* fill=malloc(sizeof(*fill)*(c->tag_count?c->tag_count:1));
+    if(!c->defs||!c->tag_pool||!c->by_tag_off||!c->by_tag||!fill){
+        free(fill);
+        catalog_free(c);
+        return -3;
+    }
+
+    uint32_t used=0;
+    k=0;
+    for(uint32_t item=0;item<c->count;item++){
+        fossil_game_item_def* d=&c->defs[item];
+        const item_change_t* ch=next_change(changes,n,&k,item);
+        d->id=g_items.names[item];
+        d->tags=c->tag_pool+used;
+
+        if(ch){
+            d->stack_size=ch->stack_size;
+            d->tag_count=ch->tag_count;
+            d->defined=1;
+            memcpy(c->tag_pool+used,ch->tags,sizeof(uint16_t)*ch->tag_count);
+        }else if(old && item<old->count){
+            const fossil_game_item_def* od=&old->defs[item];
+            d->stack_size=od->stack_size;
+            d->tag_count=od->tag_count;
+            d->defined=od->defined;
+            memcpy(c->tag_pool+used,od->tags,sizeof(uint16_t)*od->tag_count);
+        }
+        used+=d->tag_count;
+    }
+
+    /* counting sort of (tag, item) pairs into the inverted index */
+    for(uint32_t i=0;i<used;i++)
+        c->by_tag_off[c->tag_pool[i]+1]++;
+    for(uint32_t t=0;t<c->tag_count;t++)
+        c->by_tag_off[t+1]+=c->by_tag_off[t];
+
+    memcpy(fill,c->by_tag_off,sizeof(*fill)*c->tag_count);
+    for(uint32_t item=0;item<c->count;item++)
+        for(uint32_t t=0;t<c->defs[item].tag_count;t++)
+            c->by_tag[fill[c->defs[item].tags[t]]++]=item;
+    free(fill);
+
+    catalog_unref(g_current);
+    g_current=c;
+    return 0;
+}
+
+/* Fills a change; tags are interned and duplicates dropped */
+static int change_init(item_change_t* ch,const char* item_id,int stack_size,const char* const* tags,size_t tag_count)
+{
+    if(!item_id||stack_size<0||tag_count>FOSSIL_GAME_ITEM_MAX_TAGS||(tag_count&&!tags)) return -1;
+
+    int item=intern(&g_items,item_id,1);
+    if(item<0) return -3;
+
+    ch->item=(uint32_t)item;
+    ch->stack_size=stack_size;
+    ch->tag_count=0;
+
+    for(size_t i=0;i<tag_count;i++){
+        if(!tags[i]) return -1;
+        int tag=intern(&g_tags,tags[i],1);
+        if(tag<0) return -3;
+
+        uint32_t j=0;
+        while(j<ch->tag_count && ch->tags[j]!=(uint16_t)tag) j++;
+        if(j==ch->tag_count) ch->tags[ch->tag_count++]=(uint16_t)tag;
+    }
+    return 0;
+}
+
+int fossil_game_item_define(const char* item_id,int stack_size,const char* const* tags,size_t tag_count)
+{
+    item_change_t ch;
+    int rc=change_init(&ch,item_id,stack_size,tags,tag_count);
+    return rc?rc:catalog_publish(&ch,1);
+}
+
+int fossil_game_item_load(const char* source)
+{
+    if(!source) return -1;
+
+    item_change_t* changes=NULL;
+    size_t count=0,cap=0;
+    int rc=0;
+
+    const char* p=source;
+    while(*p && rc==0){
+        const char* eol=strchr(p,'\n');
+        size_t len=eol?(size_t)(eol-p):strlen(p);
+
+        char line[512];
+        if(len>=sizeof(line)){ rc=-2; break; }
+        memcpy(line,p,len);
+        line[len]='\0';
+        p=eol?eol+1:p+len;
+
+        char* hash=strchr(line,'#');
+        if(hash) *hash='\0';
+
+        const char* words[FOSSIL_GAME_ITEM_MAX_TAGS+2];
+        size_t nw=0;
+        for(char* tok=strtok(line," \t\r");tok;tok=strtok(NULL," \t\r")){
+            if(nw==sizeof(words)/sizeof(*words)){ rc=-2; break; }
+            words[nw++]=tok;
+        }
+        if(rc||nw==0) continue;
+
+        char* end;
+        long stack=nw>=2?strtol(words[1],&end,10):-1;
+        if(nw<2||*end||stack<0||stack>INT32_MAX){ rc=-2; break; }
+
+        if(count==cap){
+            cap=cap?cap*2:64;
+            item_change_t* tmp=realloc(changes,sizeof(*tmp)*cap);
+            if(!tmp){ rc=-3; break; }
+            changes=tmp;
+        }
+
+        rc=change_init(&changes[count],words[0],(int)stack,words+2,nw-2);
+        if(rc==0) count++;
+    }
+
+    if(rc==0){
+        /* insertion sort is stable, so a later line for the same item wins */
+        for(size_t i=1;i<count;i++){
+            item_change_t ch=changes[i];
+            size_t j=i;
+            while(j>0 && changes[j-1].item>ch.item){ changes[j]=changes[j-1]; j--; }
+            changes[j]=ch;
+        }
+        rc=catalog_publish(changes,count);
+    }
+
+    free(changes);
+    return rc;
+}
+
+/* ============================================================
+   Queries
+   ============================================================ */
+
+int fossil_game_item_stack_size(int item)
+{
+    const fossil_game_item_catalog* c=g_current;
+    return c && item>=0 && (uint32_t)item<c->count?c->defs[item].stack_size:0;
+}
+
+int fossil_game_item_has_tag(int item,const char* tag)
+{
+    const fossil_game_item_catalog* c=g_current;
+    int t=fossil_game_item_tag_lookup(tag);
+    if(!c||t<0||item<0||(uint32_t)item>=c->count) return 0;
+
+    const fossil_game_item_def* d=&c->defs[item];
+    for(uint32_t i=0;i<d->tag_count;i++)
+        if(d->tags[i]==(uint16_t)t) return 1;
+    return 0;
+}
+
+int fossil_game_item_tagged(const char* tag,const uint32_t** out_items,size_t* out_count)
+{
+    if(!tag||!out_items||!out_count) return -1;
+
+    int t=fossil_game_item_tag_lookup(tag);
+    if(t<0) return -1;
+
+    const fossil_game_item_catalog* c=g_current;
+    if(!c||(uint32_t)t>=c->tag_count){
+        *out_items=NULL;
+        *out_count=0;
+        return 0;
+    }
+
+    *out_items=c->by_tag+c->by_tag_off[t];
+    *out_count=c->by_tag_off[t+1]-c->by_tag_off[t];
+    return 0;
+}
+
+const fossil_game_item_catalog* fossil_game_item_catalog_acquire(void)
+{
+    if(!g_current && catalog_publish(NULL,0)!=0) return NULL;
+    g_current->refs++;
+    return g_current;
+}
+
+void fossil_game_item_catalog_release(const fossil_game_item_catalog* catalog)
+{
+    catalog_unref((fossil_game_item_catalog*)catalog);
+}
+
+uint32_t fossil_game_item_catalog_version(const fossil_game_item_catalog* catalog)
+{
+    return catalog?catalog->version:0;
+}
+
+const fossil_game_item_def* fossil_game_item_catalog_get(const fossil_game_item_catalog* catalog,int item)
+{
+    if(!catalog||item<0||(uint32_t)item>=catalog->count) return NULL;
+    return &catalog->defs[item];
+}
@@ -0,0 +1,363 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/metrics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+static const char* const g_api_names[FOSSIL_GAME_METRIC_API_COUNT] = {
+    "player_create",
+    "player_remove",
+    "player_get_int",
+    "player_set_int",
+    "player_get_attr",
+    "player_inventory_add",
+    "player_inventory_remove",
+    "player_inventory_trade",
+    "score_update",
+    "score_leaderboard",
+    "score_matchmaking",
+    "score_rating_period",
+    "quizzed_ask",
+    "quizzed_answer",
+    "session_tick",
+    "clinker_tick_all",
+    "multiplayer_broadcast",
+};
+
+#if defined(FOSSIL_GAME_METRICS)
+
+/* ============================================================
+   Clock
+   ============================================================ */
+
+static uint64_t now_ns(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER f,c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (uint64_t)((double)c.QuadPart*1e9/(double)f.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec*1000000000u+(uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* The time stamp counter is read in a few cycles; anything else falls back to the OS clock */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TICKS() __rdtsc()
+#else
+#define TICKS() now_ns()
+#endif
+
+static double g_ns_per_tick = 1.0;
+static uint64_t g_overhead = 0;     /* ticks spent reading the clock, removed from every sample */
+static int g_calibrated = 0;
+
+/* Measures the cost of a clock read, and the tick rate against the OS clock over ~2 ms, once */
+static void calibrate(void)
+{
+    if(g_calibrated) return;
+
+    g_overhead=UINT64_MAX;
+    for(int i=0;i<64;i++){
+        uint64_t a=TICKS(),b=TICKS();
+        if(b-a<g_overhead) g_overhead=b-a;
+    }
+
+    uint64_t n0=now_ns(),t0=TICKS(),n1;
+    do n1=now_ns(); while(n1-n0<2000000u);
+    uint64_t t1=TICKS();
+
+    if(t1>t0) g_ns_per_tick=(double)(n1-n0)/(double)(t1-t0);
+    g_calibrated=1;
+}
+
+/* ============================================================
+   Per-thread blocks
+   ============================================================ */
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct {
+    uint64_t calls;
+    uint64_t samples;
+    uint64_t total;             /* ticks over the timed calls */
+    uint64_t max;
+    uint64_t buckets[FOSSIL_GAME_METRICS_BUCKETS];
+} api_block_t;
+
+/* Blocks outlive their threads so that their counts stay in snapshots */
+typedef struct metrics_block {
+    struct metrics_block* next;
+    api_block_t api[FOSSIL_GAME_METRIC_API_COUNT];
+    uint64_t allocations;
+    uint32_t countdown;         /* calls left until the next timed one */
+} metrics_block_t;
+
+static metrics_block_t* g_blocks = NULL;
+static THREAD_LOCAL metrics_block_t* t_block = NULL;
+
+int fossil_game_metrics_on = 0;
+static uint32_t g_sample_every = 16;
+
+static metrics_block_t* blocks_head(void)
+{
+#if defined(_MSC_VER)
+    return (metrics_block_t*)InterlockedCompareExchangePointer((void* volatile*)&g_blocks,NULL,NULL);
+#else
+    return __atomic_load_n(&g_blocks,__ATOMIC_ACQUIRE);
+#endif
+}
+
+static metrics_block_t* block_get(void)
+{
+    if(t_block) return t_block;
+
+    metrics_block_t* b=calloc(1,sizeof(*b));
+    if(!b) return NULL;
+
+#if defined(_MSC_VER)
+    metrics_block_t* head;
+    do{
+        head=blocks_head();
+        b->next=head;
+    }while(InterlockedCompareExchangePointer((void* volatile*)&g_blocks,b,head)!=head);
+#else
+    b->next=blocks_head();
+    while(!__atomic_compare_exchange_n(&g_blocks,&b->next,b,1,__ATOMIC_RELEASE,__ATOMIC_RELAXED));
+#endif
+
+    t_block=b;
+    return b;
+}
+
+static inline int bucket_of(uint64_t d)
+{
+    if(!d) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+    int b=64-__builtin_clzll(d);
+#else
+    int b=0;
+    while(d){ b++; d>>=1; }
+#endif
+    return b<FOSSIL_GAME_METRICS_BUCKETS?b:FOSSIL_GAME_METRICS_BUCKETS-1;
+}
+
+/* Counts the call; returns a start time only for the calls that get timed */
+uint64_t fossil_game_metrics_begin(int api)
+{
+    metrics_block_t* b=block_get();
+    if(!b) return 0;
+
+    b->api[api].calls++;
+    if(b->countdown>1){ b->countdown--; return 0; }
+    b->countdown=g_sample_every;
+    return TICKS();
+}
+
+void fossil_game_metrics_end(int api,uint64_t start)
+{
+    uint64_t d=TICKS()-start;
+    d=d>g_overhead?d-g_overhead:0;
+    metrics_block_t* b=t_block;
+
+    api_block_t* a=&b->api[api];
+    a->samples++;
+    a->total+=d;
+    if(d>a->max) a->max=d;
+    a->buckets[bucket_of(d)]++;
+}
+
+void fossil_game_metrics_alloc(void)
+{
+    metrics_block_t* b=block_get();
+    if(b) b->allocations++;
+}
+
+#endif /* FOSSIL_GAME_METRICS */
+
+/* ============================================================
+   Control and snapshots
+   ============================================================ */
+
+int fossil_game_metrics_enable(int on)
+{
+#if defined(FOSSIL_GAME_METRICS)
+    if(on) calibrate();
+    fossil_game_metrics_on=on?1:0;
+    return 0;
+#else
+    (void)on;
+    return -4;
+#endif
+}
+
+int fossil_game_metrics_set_sample(uint32_t every)
+{
+    if(!every) return -1;
+#if defined(FOSSIL_GAME_METRICS)
+    g_sample_every=every;
+    return 0;
+#else
+    return -4;
+#endif
+}
+
+int fossil_game_metrics_enabled(void)
+{
+#if defined(FOSSIL_GAME_METRICS)
+    return fossil_game_metrics_on;
+#else
+    return 0;
+#endif
+}
+
+int fossil_game_metrics_snapshot_take(fossil_game_metrics_snapshot* out)
+{
+    if(!out) return -1;
+    memset(out,0,sizeof(*out));
+
+#if defined(FOSSIL_GAME_METRICS)
+    out->compiled=1;
+    out->enabled=fossil_game_metrics_on;
+
+    double scale=g_ns_per_tick;
+    for(int b=0;b<FOSSIL_GAME_METRICS_BUCKETS;b++)
+        out->bucket_ns[b]=(double)((uint64_t)1<<b)*scale;
+
+    for(metrics_block_t* blk=blocks_head();blk;blk=blk->next){
+        for(int i=0;i<FOSSIL_GAME_METRIC_API_COUNT;i++){
+            const api_block_t* a=&blk->api[i];
+            fossil_game_metrics_api* o=&out->api[i];
+            o->calls+=a->calls;
+            o->samples+=a->samples;
+            if(a->samples) o->total_ns+=(double)a->total*scale*(double)a->calls/(double)a->samples;
+            if((double)a->max*scale>o->max_ns) o->max_ns=(double)a->max*scale;
+            for(int b=0;b<FOSSIL_GAME_METRICS_BUCKETS;b++)
+                o->buckets[b]+=a->buckets[b];
+        }
+        out->allocations+=blk->allocations;
+    }
+#endif
+
+    fossil_game_player_metrics_registry(&out->registry);
+    fossil_game_score_metrics_registry(&out->registry);
+    fossil_game_quizzed_metrics_registry(&out->registry);
+    fossil_game_session_metrics_registry(&out->registry);
+    fossil_game_clinker_metrics_registry(&out->registry);
+    return 0;
+}
+
+void fossil_game_metrics_reset(void)
+{
+#if defined(FOSSIL_GAME_METRICS)
+    for(metrics_block_t* blk=blocks_head();blk;blk=blk->next){
+        memset(blk->api,0,sizeof(blk->api));
+        blk->allocations=0;
+    }
+#endif
+}
+
+const char* fossil_game_metrics_api_name(int api)
+{
+    if(api<0||api>=FOSSIL_GAME_METRIC_API_COUNT) return NULL;
+    return g_api_names[api];
+}
+
+double fossil_game_metrics_quantile(const fossil_game_metrics_snapshot* s,int api,double q)
+{
+    if(!s||api<0||api>=FOSSIL_GAME_METRIC_API_COUNT) return 0;
+
+    const fossil_game_metrics_api* a=&s->api[api];
+    if(!a->samples) return 0;
+
+    uint64_t want=(uint64_t)(q*(double)a->samples);
+    if(want>=a->samples) want=a->samples-1;
+
+    uint64_t seen=0;
+    for(int b=0;b<FOSSIL_GAME_METRICS_BUCKETS;b++){
+        seen+=a->buckets[b];
+        if(seen>want) return s->bucket_ns[b];
+    }
+    return s->bucket_ns[FOSSIL_GAME_METRICS_BUCKETS-1];
+}
+
+/* ============================================================
+   Export
+   ============================================================ */
+
+int fossil_game_metrics_export(FILE* out)
+{
+    if(!out) return -1;
+
+    fossil_game_metrics_snapshot* s=malloc(sizeof(*s));
+    if(!s) return -3;
+    fossil_game_metrics_snapshot_take(s);
+
+    const fossil_game_metrics_registry* r=&s->registry;
+    fprintf(out,"{\"compiled\":%d,\"enabled\":%d,\"allocations\":%llu,",
+            s->compiled,s->enabled,(unsigned long long)s->allocations);
+    fprintf(out,"\"registry\":{\"players\":%zu,\"score_players\":%zu,\"boards\":%zu,"
+                "\"quizzes\":%zu,\"sessions\":%zu,\"npcs\":%zu},\"api\":{",
+            r->players,r->score_players,r->boards,r->quizzes,r->sessions,r->npcs);
+
+    int first=1;
+    for(int i=0;i<FOSSIL_GAME_METRIC_API_COUNT;i++){
+        const fossil_game_metrics_api* a=&s->api[i];
+        if(!a->calls) continue;
+
+        fprintf(out,"%s\"%s\":{\"calls\":%llu,\"samples\":%llu,\"mean_ns\":%.1f,\"p50_ns\":%.1f,\"p99_ns\":%.1f,\"max_ns\":%.1f,\"buckets\":[",
+                first?"":",",g_api_names[i],(unsigned long long)a->calls,(unsigned long long)a->samples,a->total_ns/(double)a->calls,
+                fossil_game_metrics_quantile(s,i,0.5),fossil_game_metrics_quantile(s,i,0.99),a->max_ns);
+        first=0;
+
+        int first_bucket=1;
+        for(int b=0;b<FOSSIL_GAME_METRICS_BUCKETS;b++){
+            if(!a->buckets[b]) continue;
+            fprintf(out,"%s[%.1f,%llu]",first_bucket?"":",",s->bucket_ns[b],(unsigned long long)a->buckets[b]);
+            first_bucket=0;
+        }
+        fprintf(out,"]}");
+    }
+    fprintf(out,"}}\n");
+
+    free(s);
+    return ferror(out)?-4:0;
+}
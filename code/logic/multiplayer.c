@@ -0,0 +1,857 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/multiplayer.h"
+#include "fossil/game/metrics.h"
+#include "fossil/game/player.h"
+#include "fossil/game/trace.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static char* fossil_strdup(const char* s)
+{
+    if(!s) return NULL;
+
+    size_t len = 0;
+    while(s[len]) len++;
+
+    char* out = (char*)malloc(len + 1);
+    if(!out) return NULL;
+
+    for(size_t i=0;i<=len;i++)
+        out[i] = s[i];
+
+    return out;
+}
+
+static uint64_t now_ns(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER f,c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (uint64_t)((double)c.QuadPart*1e9/(double)f.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec*1000000000ull+(uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* ============================================================
+   Internal structures
+   ============================================================ */
+
+/* Mailbox records are packed as [u32 len][u64 enqueue ns][bytes] */
+#define RECORD_HEADER 12
+
+typedef struct {
+    unsigned char* buf;
+    size_t head;
+    size_t tail;
+    size_t cap;
+    int count;
+} mailbox_t;
+
+#define NO_MEMBER UINT32_MAX
+
+typedef struct {
+    char* player_id;
+    uint32_t hash;
+    mailbox_t box;
+
+    /* area of interest: members with a position are linked into their cell */
+    float x;
+    float y;
+    uint64_t cell;
+    uint32_t cell_next;
+    uint32_t cell_prev;
+    int placed;
+} member_t;
+
+/* Open-addressing string index; hashes are kept so growth never rereads keys */
+typedef struct {
+    uint32_t hash;
+    uint32_t ref;           /* element index + 1, 0 = empty */
+} slot_t;
+
+typedef struct {
+    slot_t* slots;
+    uint32_t cap;
+    uint32_t used;
+} index_t;
+
+/* Uniform grid: occupied cells only, each heading an intrusive member list */
+typedef struct {
+    uint64_t key;
+    uint32_t head;          /* member index + 1, 0 = empty slot */
+    uint32_t count;
+} cell_t;
+
+typedef struct {
+    cell_t* cells;
+    uint32_t cap;
+    uint32_t used;
+    float size;
+} grid_t;
+
+#define DEFAULT_CELL_SIZE 32.0f
+
+typedef struct {
+    char* id;
+    uint32_t hash;
+
+    member_t* members;
+    uint32_t member_count;
+    uint32_t member_cap;
+    index_t index;
+
+    grid_t grid;
+} session_t;
+
+/* Global registry */
+static session_t** g_sessions=NULL;
+static uint32_t g_session_count=0;
+static uint32_t g_session_cap=0;
+static index_t g_session_index={NULL,0,0};
+
+static fossil_game_multiplayer_transport g_transport={NULL,NULL};
+static uint64_t g_dropped=0;
+
+
+/* ============================================================
+   Index helpers
+   ============================================================ */
+
+static uint32_t hash_str(const char* s)
+{
+    uint32_t h=2166136261u;
+    while(*s){
+        h^=(unsigned char)*s++;
+        h*=16777619u;
+    }
+    return h;
+}
+
+typedef const char* (*key_fn)(const void* owner,uint32_t idx);
+
+static const char* member_key(const void* owner,uint32_t idx)
+{
+    return ((const session_t*)owner)->members[idx].player_id;
+}
+
+static const char* session_key(const void* owner,uint32_t idx)
+{
+    (void)owner;
+    return g_sessions[idx]->id;
+}
+
+static long index_find(const index_t* ix,uint32_t h,const char* key,key_fn k,const void* owner)
+{
+    if(!ix->cap) return -1;
+
+    uint32_t mask=ix->cap-1;
+    for(uint32_t i=h&mask;ix->slots[i].ref;i=(i+1)&mask){
+        if(ix->slots[i].hash==h && strcmp(k(owner,ix->slots[i].ref-1),key)==0)
+            return (long)i;
+    }
+    return -1;
+}
+
+static void index_place(slot_t* slots,uint32_t cap,uint32_t h,uint32_t ref)
+{
+    uint32_t i=h&(cap-1);
+    while(slots[i].ref) i=(i+1)&(cap-1);
+    slots[i].hash=h;
+    slots[i].ref=ref;
+}
+
+static int index_insert(index_t* ix,uint32_t h,uint32_t idx)
+{
+    if((ix->used+1)*4>ix->cap*3){
+        uint32_t cap=ix->cap?ix->cap*2:16;
+        slot_t* slots=calloc(cap,sizeof(*slots));
+        if(!slots) return -1;
+
+        for(uint32_t i=0;i<ix->cap;i++)
+            if(ix->slots[i].ref)
+                index_place(slots,cap,ix->slots[i].hash,ix->slots[i].ref);
+
+        free(ix->slots);
+        ix->slots=slots;
+        ix->cap=cap;
+    }
+
+    index_place(ix->slots,ix->cap,h,idx+1);
+    ix->used++;
+    return 0;
+}
+
+/* Backward-shift deletion keeps probe chains intact without tombstones */
+static void index_erase(index_t* ix,uint32_t pos)
+{
+    uint32_t mask=ix->cap-1;
+    uint32_t hole=pos;
+
+    for(uint32_t i=(pos+1)&mask;ix->slots[i].ref;i=(i+1)&mask){
+        uint32_t home=ix->slots[i].hash&mask;
+        if(((i-home)&mask)>=((i-hole)&mask)){
+            ix->slots[hole]=ix->slots[i];
+            hole=i;
+        }
+    }
+
+    ix->slots[hole].ref=0;
+    ix->used--;
+}
+
+static void index_retarget(index_t* ix,uint32_t h,uint32_t from,uint32_t to)
+{
+    uint32_t mask=ix->cap-1;
+    for(uint32_t i=h&mask;ix->slots[i].ref;i=(i+1)&mask){
+        if(ix->slots[i].ref==from+1){
+            ix->slots[i].ref=to+1;
+            return;
+        }
+    }
+}
+
+static session_t* find_session(const char* id)
+{
+    long pos=index_find(&g_session_index,hash_str(id),id,session_key,NULL);
+    return pos<0?NULL:g_sessions[g_session_index.slots[pos].ref-1];
+}
+
+static member_t* find_member(session_t* s,const char* player_id)
+{
+    long pos=index_find(&s->index,hash_str(player_id),player_id,member_key,s);
+    return pos<0?NULL:&s->members[s->index.slots[pos].ref-1];
+}
+
+/* ============================================================
+   Loopback mailboxes
+   ============================================================ */
+
+static int mailbox_push(mailbox_t* box,const char* message,size_t len,uint64_t stamp)
+{
+    size_t need=RECORD_HEADER+len;
+
+    if(box->cap-box->tail<need){
+        if(box->head){
+            memmove(box->buf,box->buf+box->head,box->tail-box->head);
+            box->tail-=box->head;
+            box->head=0;
+        }
+        if(box->cap-box->tail<need){
+            size_t cap=box->cap?box->cap*2:256;
+            while(cap<box->tail+need) cap*=2;
+            if(cap>FOSSIL_GAME_MULTIPLAYER_MAILBOX_MAX) cap=FOSSIL_GAME_MULTIPLAYER_MAILBOX_MAX;
+            if(cap<box->tail+need){ g_dropped++; return -5; }
+
+            unsigned char* tmp=realloc(box->buf,cap);
+            if(!tmp){ g_dropped++; return -5; }
+            box->buf=tmp;
+            box->cap=cap;
+        }
+    }
+
+    uint32_t n=(uint32_t)len;
+    memcpy(box->buf+box->tail,&n,4);
+    memcpy(box->buf+box->tail+4,&stamp,8);
+    memcpy(box->buf+box->tail+RECORD_HEADER,message,len);
+    box->tail+=need;
+    box->count++;
+    return 0;
+}
+
+static int deliver(session_t* s,member_t* m,const char* message,size_t len,uint64_t stamp)
+{
+    if(g_transport.deliver)
+        return g_transport.deliver(g_transport.ctx,s->id,m->player_id,message,len);
+    return mailbox_push(&m->box,message,len,stamp);
+}
+
+int fossil_game_multiplayer_set_transport(const fossil_game_multiplayer_transport* transport)
+{
+    if(transport && !transport->deliver) return -1;
+
+    if(transport) g_transport=*transport;
+    else{
+        g_transport.ctx=NULL;
+        g_transport.deliver=NULL;
+    }
+    return 0;
+}
+
+/* ============================================================
+   Interest grid
+   ============================================================ */
+
+/* Cell coordinate of v, clamped in double so far-off points convert safely */
+static int32_t cell_coord(double v)
+{
+    v=floor(v);
+    if(v<(double)INT32_MIN) return INT32_MIN;
+    if(v>(double)INT32_MAX) return INT32_MAX;
+    return (int32_t)v;
+}
+
+static uint64_t cell_key(int64_t cx,int64_t cy)
+{
+    return ((uint64_t)(uint32_t)cx<<32)|(uint32_t)cy;
+}
+
+static uint64_t cell_of(const grid_t* g,float x,float y)
+{
+    return cell_key(cell_coord((double)x/g->size),cell_coord((double)y/g->size));
+}
+
+static uint32_t hash_cell(uint64_t k)
+{
+    k^=k>>33;
+    k*=0xff51afd7ed558ccdull;
+    k^=k>>33;
+    return (uint32_t)k;
+}
+
+static long grid_find(const grid_t* g,uint64_t key)
+{
+    if(!g->cap) return -1;
+
+    uint32_t mask=g->cap-1;
+    for(uint32_t i=hash_cell(key)&mask;g->cells[i].head;i=(i+1)&mask)
+        if(g->cells[i].key==key) return (long)i;
+    return -1;
+}
+
+static long grid_insert(grid_t* g,uint64_t key)
+{
+    if((g->used+1)*4>g->cap*3){
+        uint32_t cap=g->cap?g->cap*2:64;
+        cell_t* cells=calloc(cap,sizeof(*cells));
+        if(!cells) return -1;
+
+        for(uint32_t i=0;i<g->cap;i++){
+            if(!g->cells[i].head) continue;
+            uint32_t j=hash_cell(g->cells[i].key)&(cap-1);
+            while(cells[j].head) j=(j+1)&(cap-1);
+            cells[j]=g->cells[i];
+        }
+
+        free(g->cells);
+        g->cells=cells;
+        g->cap=cap;
+    }
+
+    uint32_t i=hash_cell(key)&(g->cap-1);
+    while(g->cells[i].head) i=(i+1)&(g->cap-1);
+    g->cells[i].key=key;
+    g->cells[i].count=0;
+    g->used++;
+    return (long)i;
+}
+
+static void grid_erase(grid_t* g,uint32_t pos)
+{
+    uint32_t mask=g->cap-1;
+    uint32_t hole=pos;
+
+    for(uint32_t i=(pos+1)&mask;g->cells[i].head;i=(i+1)&mask){
+        uint32_t home=hash_cell(g->cells[i].key)&mask;
+        if(((i-home)&mask)>=((i-hole)&mask)){
+            g->cells[hole]=g->cells[i];
+            hole=i;
+        }
+    }
+
+    g->cells[hole].head=0;
+    g->used--;
+}
+
+static int grid_link(session_t* s,uint32_t idx)
+{
+    member_t* m=&s->members[idx];
+    long pos=grid_find(&s->grid,m->cell);
+    if(pos<0) pos=grid_insert(&s->grid,m->cell);
+    if(pos<0) return -1;
+
+    cell_t* c=&s->grid.cells[pos];
+    m->cell_prev=NO_MEMBER;
+    m->cell_next=c->head?c->head-1:NO_MEMBER;
+    if(c->head) s->members[c->head-1].cell_prev=idx;
+    c->head=idx+1;
+    c->count++;
+    m->placed=1;
+    return 0;
+}
+
+static void grid_unlink(session_t* s,uint32_t idx)
+{
+    member_t* m=&s->members[idx];
+    long pos=grid_find(&s->grid,m->cell);
+    if(pos<0) return;
+
+    cell_t* c=&s->grid.cells[pos];
+    if(m->cell_prev!=NO_MEMBER) s->members[m->cell_prev].cell_next=m->cell_next;
+    else c->head=m->cell_next==NO_MEMBER?0:m->cell_next+1;
+    if(m->cell_next!=NO_MEMBER) s->members[m->cell_next].cell_prev=m->cell_prev;
+
+    m->placed=0;
+    if(--c->count==0) grid_erase(&s->grid,(uint32_t)pos);
+}
+
+/* A placed member moved from slot `from` to `to`; repoint its neighbours */
+static void grid_relabel(session_t* s,uint32_t from,uint32_t to)
+{
+    member_t* m=&s->members[to];
+    if(!m->placed) return;
+
+    if(m->cell_prev!=NO_MEMBER) s->members[m->cell_prev].cell_next=to;
+    else{
+        long pos=grid_find(&s->grid,m->cell);
+        if(pos>=0 && s->grid.cells[pos].head==from+1) s->grid.cells[pos].head=to+1;
+    }
+    if(m->cell_next!=NO_MEMBER) s->members[m->cell_next].cell_prev=to;
+}
+
+typedef void (*visit_fn)(session_t* s,uint32_t idx,void* ctx);
+
+static uint32_t visit_cell(session_t* s,uint32_t head,float x,float y,float r2,
+                           uint32_t skip,visit_fn fn,void* ctx)
+{
+    uint32_t hits=0;
+    for(uint32_t i=head?head-1:NO_MEMBER;i!=NO_MEMBER;i=s->members[i].cell_next){
+        const member_t* m=&s->members[i];
+        float dx=m->x-x,dy=m->y-y;
+        if(i==skip || dx*dx+dy*dy>r2) continue;
+        fn(s,i,ctx);
+        hits++;
+    }
+    return hits;
+}
+
+/* Visit every placed member within r of (x,y), touching only overlapping cells */
+static uint32_t visit_radius(session_t* s,float x,float y,float r,uint32_t skip,visit_fn fn,void* ctx)
+{
+    grid_t* g=&s->grid;
+    if(!g->used) return 0;
+
+    float r2=r*r;
+    int64_t cx0=cell_coord(((double)x-r)/g->size),cx1=cell_coord(((double)x+r)/g->size);
+    int64_t cy0=cell_coord(((double)y-r)/g->size),cy1=cell_coord(((double)y+r)/g->size);
+    double span=(double)(cx1-cx0+1)*(double)(cy1-cy0+1);
+    uint32_t hits=0;
+
+    /* a radius wider than the populated area is cheaper as a scan of occupied cells */
+    if(span>(double)g->used){
+        for(uint32_t i=0;i<g->cap;i++)
+            if(g->cells[i].head)
+                hits+=visit_cell(s,g->cells[i].head,x,y,r2,skip,fn,ctx);
+        return hits;
+    }
+
+    for(int64_t cx=cx0;cx<=cx1;cx++){
+        for(int64_t cy=cy0;cy<=cy1;cy++){
+            long pos=grid_find(g,cell_key(cx,cy));
+            if(pos>=0) hits+=visit_cell(s,g->cells[pos].head,x,y,r2,skip,fn,ctx);
+        }
+    }
+    return hits;
+}
+
+int fossil_game_multiplayer_set_cell_size(const char* session_id,float cell_size)
+{
+    if(!session_id||!(cell_size>0.0f)||!isfinite(cell_size)) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    s->grid.size=cell_size;
+    memset(s->grid.cells,0,sizeof(cell_t)*s->grid.cap);
+    s->grid.used=0;
+
+    for(uint32_t i=0;i<s->member_count;i++){
+        member_t* m=&s->members[i];
+        if(!m->placed) continue;
+        m->cell=cell_of(&s->grid,m->x,m->y);
+        if(grid_link(s,i)!=0) return -4;
+    }
+    return 0;
+}
+
+int fossil_game_multiplayer_set_position(const char* session_id,const char* player_id,float x,float y)
+{
+    if(!session_id||!player_id||!isfinite(x)||!isfinite(y)) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    member_t* m=find_member(s,player_id);
+    if(!m) return -3;
+
+    uint32_t idx=(uint32_t)(m-s->members);
+    uint64_t cell=cell_of(&s->grid,x,y);
+    m->x=x;
+    m->y=y;
+
+    /* only a cell change touches the grid */
+    if(m->placed && m->cell==cell) return 0;
+    if(m->placed) grid_unlink(s,idx);
+    m->cell=cell;
+    return grid_link(s,idx)==0?0:-4;
+}
+
+int fossil_game_multiplayer_clear_position(const char* session_id,const char* player_id)
+{
+    if(!session_id||!player_id) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    member_t* m=find_member(s,player_id);
+    if(!m) return -3;
+
+    if(m->placed) grid_unlink(s,(uint32_t)(m-s->members));
+    return 0;
+}
+
+typedef struct {
+    const char* message;
+    size_t len;
+    uint64_t stamp;
+    int sent;
+} scoped_msg_t;
+
+static void deliver_visit(session_t* s,uint32_t idx,void* ctx)
+{
+    scoped_msg_t* msg=ctx;
+    if(deliver(s,&s->members[idx],msg->message,msg->len,msg->stamp)==0) msg->sent++;
+}
+
+int fossil_game_multiplayer_broadcast_radius(const char* session_id,float x,float y,float radius,const char* message)
+{
+    if(!session_id||!message||!isfinite(x)||!isfinite(y)||!isfinite(radius)||radius<0.0f) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    scoped_msg_t msg={message,strlen(message),now_ns(),0};
+    visit_radius(s,x,y,radius,NO_MEMBER,deliver_visit,&msg);
+    return msg.sent;
+}
+
+int fossil_game_multiplayer_broadcast_near(const char* session_id,const char* player_id,float radius,const char* message)
+{
+    if(!session_id||!player_id||!message||!isfinite(radius)||radius<0.0f) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    member_t* m=find_member(s,player_id);
+    if(!m) return -3;
+    if(!m->placed) return -5;
+
+    scoped_msg_t msg={message,strlen(message),now_ns(),0};
+    visit_radius(s,m->x,m->y,radius,(uint32_t)(m-s->members),deliver_visit,&msg);
+    return msg.sent;
+}
+
+int fossil_game_multiplayer_broadcast_cells(const char* session_id,const int32_t* cells,size_t cell_count,const char* message)
+{
+    if(!session_id||!message||(!cells&&cell_count)) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    scoped_msg_t msg={message,strlen(message),now_ns(),0};
+
+    for(size_t i=0;i<cell_count;i++){
+        uint64_t key=((uint64_t)(uint32_t)cells[2*i]<<32)|(uint32_t)cells[2*i+1];
+        long pos=grid_find(&s->grid,key);
+        if(pos<0) continue;
+
+        for(uint32_t j=s->grid.cells[pos].head-1;j!=NO_MEMBER;j=s->members[j].cell_next)
+            deliver_visit(s,j,&msg);
+    }
+    return msg.sent;
+}
+
+typedef struct {
+    const char** out;
+    int cap;
+    int count;
+} query_t;
+
+static void collect_visit(session_t* s,uint32_t idx,void* ctx)
+{
+    query_t* q=ctx;
+    if(q->count<q->cap) q->out[q->count]=s->members[idx].player_id;
+    q->count++;
+}
+
+int fossil_game_multiplayer_query_radius(const char* session_id,float x,float y,float radius,
+                                         const char** out_ids,int cap,int* out_count)
+{
+    if(!session_id||!out_count||!isfinite(x)||!isfinite(y)||!isfinite(radius)||radius<0.0f||(!out_ids&&cap>0)) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    query_t q={out_ids,cap,0};
+    visit_radius(s,x,y,radius,NO_MEMBER,collect_visit,&q);
+    *out_count=q.count;
+    return q.count>cap?-4:0;
+}
+
+/* ============================================================
+   Sessions
+   ============================================================ */
+
+int fossil_game_multiplayer_create_session(const char* session_id)
+{
+    if(!session_id) return -1;
+    if(find_session(session_id)) return -2;
+
+    if(g_session_count==g_session_cap){
+        uint32_t cap=g_session_cap?g_session_cap*2:16;
+        session_t** tmp=realloc(g_sessions,sizeof(*tmp)*cap);
+        if(!tmp) return -3;
+        g_sessions=tmp;
+        g_session_cap=cap;
+    }
+
+    session_t* s=calloc(1,sizeof(*s));
+    if(!s) return -3;
+
+    s->id=fossil_strdup(session_id);
+    s->hash=hash_str(session_id);
+    s->grid.size=DEFAULT_CELL_SIZE;
+    if(!s->id || index_insert(&g_session_index,s->hash,g_session_count)!=0){
+        free(s->id);
+        free(s);
+        return -3;
+    }
+
+    g_sessions[g_session_count++]=s;
+    return 0;
+}
+
+/* The player store keeps one session per player; only clear it if it still points here */
+static void player_store_leave(const char* session_id,const char* player_id)
+{
+    const char* current=fossil_game_player_get_session(player_id);
+    if(current && strcmp(current,session_id)==0)
+        fossil_game_player_leave_session(player_id);
+}
+
+int fossil_game_multiplayer_destroy_session(const char* session_id)
+{
+    if(!session_id) return -1;
+
+    long pos=index_find(&g_session_index,hash_str(session_id),session_id,session_key,NULL);
+    if(pos<0) return -2;
+
+    uint32_t idx=g_session_index.slots[pos].ref-1;
+    session_t* s=g_sessions[idx];
+
+    for(uint32_t i=0;i<s->member_count;i++){
+        player_store_leave(s->id,s->members[i].player_id);
+        free(s->members[i].player_id);
+        free(s->members[i].box.buf);
+    }
+    free(s->members);
+    free(s->index.slots);
+    free(s->grid.cells);
+    free(s->id);
+    free(s);
+
+    index_erase(&g_session_index,(uint32_t)pos);
+
+    uint32_t last=--g_session_count;
+    if(idx!=last){
+        g_sessions[idx]=g_sessions[last];
+        index_retarget(&g_session_index,g_sessions[idx]->hash,last,idx);
+    }
+    return 0;
+}
+
+/* ============================================================
+   Membership
+   ============================================================ */
+
+int fossil_game_multiplayer_join(const char* session_id,const char* player_id)
+{
+    if(!session_id||!player_id) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+    if(find_member(s,player_id)) return -3;
+
+    if(s->member_count==s->member_cap){
+        uint32_t cap=s->member_cap?s->member_cap*2:8;
+        member_t* tmp=realloc(s->members,sizeof(*tmp)*cap);
+        if(!tmp) return -4;
+        s->members=tmp;
+        s->member_cap=cap;
+    }
+
+    member_t* m=&s->members[s->member_count];
+    memset(m,0,sizeof(*m));
+    m->player_id=fossil_strdup(player_id);
+    m->hash=hash_str(player_id);
+    if(!m->player_id || index_insert(&s->index,m->hash,s->member_count)!=0){
+        free(m->player_id);
+        return -4;
+    }
+    s->member_count++;
+
+    /* keep the player store in step for registered players */
+    fossil_game_player_join_session(player_id,session_id);
+    return 0;
+}
+
+int fossil_game_multiplayer_leave(const char* session_id,const char* player_id)
+{
+    if(!session_id||!player_id) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    uint32_t h=hash_str(player_id);
+    long pos=index_find(&s->index,h,player_id,member_key,s);
+    if(pos<0) return -3;
+
+    uint32_t idx=s->index.slots[pos].ref-1;
+    if(s->members[idx].placed) grid_unlink(s,idx);
+    free(s->members[idx].player_id);
+    free(s->members[idx].box.buf);
+    index_erase(&s->index,(uint32_t)pos);
+
+    uint32_t last=--s->member_count;
+    if(idx!=last){
+        s->members[idx]=s->members[last];
+        index_retarget(&s->index,s->members[idx].hash,last,idx);
+        grid_relabel(s,last,idx);
+    }
+
+    player_store_leave(session_id,player_id);
+    return 0;
+}
+
+/* ============================================================
+   Messaging
+   ============================================================ */
+
+static int multiplayer_broadcast(const char* session_id,const char* message)
+{
+    if(!session_id||!message) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    scoped_msg_t msg={message,strlen(message),now_ns(),0};
+    for(uint32_t i=0;i<s->member_count;i++)
+        deliver_visit(s,i,&msg);
+    return msg.sent;
+}
+
+int fossil_game_multiplayer_broadcast(const char* session_id,const char* message)
+{
+    FOSSIL_GAME_METRIC_BEGIN(MULTIPLAYER_BROADCAST);
+    FOSSIL_GAME_TRACE_BEGIN("multiplayer_broadcast");
+    int rc=multiplayer_broadcast(session_id,message);
+    FOSSIL_GAME_TRACE_END("multiplayer_broadcast");
+    FOSSIL_GAME_METRIC_END(MULTIPLAYER_BROADCAST);
+    return rc;
+}
+
+int fossil_game_multiplayer_send(const char* session_id,const char* player_id,const char* message)
+{
+    if(!session_id||!player_id||!message) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    member_t* m=find_member(s,player_id);
+    if(!m) return -3;
+
+    return deliver(s,m,message,strlen(message),now_ns());
+}
+
+int fossil_game_multiplayer_poll(const char* session_id,const char* player_id,
+                                 char* out,size_t cap,size_t* out_len,uint64_t* out_latency_ns)
+{
+    if(!session_id||!player_id||!out||!out_len) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    member_t* m=find_member(s,player_id);
+    if(!m) return -3;
+
+    mailbox_t* box=&m->box;
+    if(box->head==box->tail) return 0;
+
+    uint32_t len;
+    uint64_t stamp;
+    memcpy(&len,box->buf+box->head,4);
+    memcpy(&stamp,box->buf+box->head+4,8);
+
+    *out_len=len;
+    if(cap<(size_t)len+1) return -4;
+
+    memcpy(out,box->buf+box->head+RECORD_HEADER,len);
+    out[len]='\0';
+    if(out_latency_ns) *out_latency_ns=now_ns()-stamp;
+
+    box->head+=RECORD_HEADER+len;
+    box->count--;
+    if(box->head==box->tail) box->head=box->tail=0;
+    return 1;
+}
+
+int fossil_game_multiplayer_pending(const char* session_id,const char* player_id)
+{
+    if(!session_id||!player_id) return -1;
+
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    member_t* m=find_member(s,player_id);
+    if(!m) return -3;
+
+    return m->box.count;
+}
+
+uint64_t fossil_game_multiplayer_dropped(void)
+{
+    return g_dropped;
+}
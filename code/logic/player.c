@@ -23,6 +23,14 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/game/player.h"
+#include "fossil/game/clinker.h"
+#include "fossil/game/feature.h"
+#include "fossil/game/item.h"
+#include "fossil/game/metrics.h"
+#include "fossil/game/state.h"
+#include "fossil/game/wal.h"
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -35,6 +43,7 @@ static char* fossil_strdup(const char* s)
 
     char* out = (char*)malloc(len + 1);
     if(!out) return NULL;
+    FOSSIL_GAME_METRIC_ALLOC();
 
     for(size_t i=0;i<=len;i++)
         out[i] = s[i];
@@ -46,265 +55,1636 @@ static char* fossil_strdup(const char* s)
    Internal Structures
    ============================================================ */
 
-typedef struct fossil_game_player_attr {
-    char* key;
-    void* value;
-} fossil_game_player_attr;
-
-typedef struct fossil_game_player_item {
-    char* item_id;
-    int   count;
-} fossil_game_player_item;
+#define ATTR_INLINE 8
 
-typedef struct fossil_game_player_control {
-    char* name;
-    int enabled;
-} fossil_game_player_control;
+/* One typed value; strings and blobs are owned copies (strings NUL-terminated) */
+typedef struct {
+    uint16_t key;               /* attribute schema id */
+    uint8_t  type;              /* FOSSIL_GAME_PLAYER_ATTR_*, NONE = empty spill slot */
+    uint32_t len;               /* string or blob length */
+    union {
+        int64_t i;
+        double f;
+        unsigned char* bytes;
+    } v;
+} fossil_game_player_attr;
 
+/* Inventory and features live in the public view (player.h), first so a handle is the player */
 typedef struct fossil_game_player {
+    fossil_game_player_view view;
+
     char* id;
+    uint32_t hash;
+    uint32_t slot;              /* position in g_players */
 
-    fossil_game_player_attr* attrs;
-    size_t attr_count;
+    /* the first ATTR_INLINE attributes live here; the key array is what reads scan */
+    uint16_t attr_keys[ATTR_INLINE];
+    fossil_game_player_attr attrs[ATTR_INLINE];
+    uint32_t attr_count;
 
-    fossil_game_player_item* inventory;
-    size_t inventory_count;
+    /* later ones spill into an open-addressing table keyed by schema id */
+    fossil_game_player_attr* spill;
+    uint32_t spill_cap;
+    uint32_t spill_count;
 
-    fossil_game_player_control* controls;
-    size_t control_count;
+    uint32_t inventory_cap;
+    fossil_game_feature_mask_t controls;
 
-    char* session_id;
+    struct player_session* session;    /* roster this player is listed in */
+    uint32_t session_pos;               /* position in that roster */
+    uint32_t mark;              /* query epoch, dedups multi-item matches */
 } fossil_game_player;
 
 /* ============================================================
    Registry
    ============================================================ */
 
+typedef struct {
+    uint32_t hash;
+    fossil_game_player* p;      /* NULL = empty */
+} player_slot_t;
+
 static fossil_game_player** g_players = NULL;
 static size_t g_player_count = 0;
 
+static player_slot_t* g_player_index = NULL;
+static uint32_t g_player_index_cap = 0;
+
+static uint32_t hash_str(const char* s)
+{
+    uint32_t h=2166136261u;
+    while(*s){
+        h^=(unsigned char)*s++;
+        h*=16777619u;
+    }
+    return h;
+}
+
+static long index_find(const char* id,uint32_t h)
+{
+    if(!g_player_index_cap) return -1;
+
+    uint32_t mask=g_player_index_cap-1;
+    for(uint32_t i=h&mask;g_player_index[i].p;i=(i+1)&mask){
+        if(g_player_index[i].hash==h && strcmp(g_player_index[i].p->id,id)==0)
+            return (long)i;
+    }
+    return -1;
+}
+
+static int index_insert(fossil_game_player* p)
+{
+    if((g_player_count+1)*4>(size_t)g_player_index_cap*3){
+        uint32_t cap=g_player_index_cap?g_player_index_cap*2:64;
+        player_slot_t* tmp=calloc(cap,sizeof(*tmp));
+        if(!tmp) return -1;
+
+        for(uint32_t i=0;i<g_player_index_cap;i++){
+            if(!g_player_index[i].p) continue;
+            uint32_t j=g_player_index[i].hash&(cap-1);
+            while(tmp[j].p) j=(j+1)&(cap-1);
+            tmp[j]=g_player_index[i];
+        }
+
+        free(g_player_index);
+        g_player_index=tmp;
+        g_player_index_cap=cap;
+    }
+
+    uint32_t i=p->hash&(g_player_index_cap-1);
+    while(g_player_index[i].p) i=(i+1)&(g_player_index_cap-1);
+    g_player_index[i].hash=p->hash;
+    g_player_index[i].p=p;
+    return 0;
+}
+
+static void index_erase(uint32_t pos)
+{
+    uint32_t mask=g_player_index_cap-1;
+    uint32_t hole=pos;
+
+    for(uint32_t i=(pos+1)&mask;g_player_index[i].p;i=(i+1)&mask){
+        uint32_t home=g_player_index[i].hash&mask;
+        if(((i-home)&mask)>=((i-hole)&mask)){
+            g_player_index[hole]=g_player_index[i];
+            hole=i;
+        }
+    }
+    g_player_index[hole].p=NULL;
+}
+
 static fossil_game_player* find_player(const char* id)
 {
     if(!id) return NULL;
-    for(size_t i=0;i<g_player_count;i++){
-        if(g_players[i] && strcmp(g_players[i]->id,id)==0)
-            return g_players[i];
-    }
-    return NULL;
+
+    long pos=index_find(id,hash_str(id));
+    return pos<0?NULL:g_player_index[pos].p;
 }
 
+static void attrs_free(fossil_game_player* p);
+static void session_leave(fossil_game_player* p);
+static void holders_drop(fossil_game_player* p);
+
 /* ============================================================
    Lifecycle
    ============================================================ */
 
-int fossil_game_player_create(const char* player_id)
+static int player_create(const char* player_id)
 {
     if(!player_id) return -1;
     if(find_player(player_id)) return -2;
 
     fossil_game_player* p = calloc(1,sizeof(*p));
     if(!p) return -3;
+    FOSSIL_GAME_METRIC_ALLOC();
 
     p->id = fossil_strdup(player_id);
     if(!p->id){ free(p); return -3; }
+    p->hash = hash_str(player_id);
 
     fossil_game_player** tmp =
         realloc(g_players,(g_player_count+1)*sizeof(*g_players));
-    if(!tmp){ free(p->id); free(p); return -3; }
+    if(!tmp || index_insert(p)!=0){
+        if(tmp) g_players = tmp;
+        free(p->id); free(p); return -3;
+    }
 
     g_players = tmp;
+    p->slot = (uint32_t)g_player_count;
     g_players[g_player_count++] = p;
+
+    fossil_game_wal_record_player_create(player_id);
     return 0;
 }
 
-int fossil_game_player_remove(const char* player_id)
+int fossil_game_player_create(const char* player_id)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_CREATE);
+    int rc=player_create(player_id);
+    FOSSIL_GAME_METRIC_END(PLAYER_CREATE);
+    return rc;
+}
+
+static void player_free(fossil_game_player* p)
+{
+    free(p->id);
+    attrs_free(p);
+    holders_drop(p);
+    session_leave(p);
+    free(p->view.inventory);
+    free(p);
+}
+
+static int player_remove(const char* player_id)
 {
     if(!player_id) return -1;
 
-    for(size_t i=0;i<g_player_count;i++){
-        fossil_game_player* p=g_players[i];
-        if(p && strcmp(p->id,player_id)==0){
+    long pos=index_find(player_id,hash_str(player_id));
+    if(pos<0) return -2;
+
+    fossil_game_player* p=g_player_index[pos].p;
+    index_erase((uint32_t)pos);
+
+    g_players[p->slot]=g_players[g_player_count-1];
+    g_players[p->slot]->slot=p->slot;
+    g_player_count--;
+
+    /* logged before the id is freed, in case player_id is that string */
+    fossil_game_wal_record_player_remove(player_id);
+    player_free(p);
+    return 0;
+}
+
+int fossil_game_player_remove(const char* player_id)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_REMOVE);
+    int rc=player_remove(player_id);
+    FOSSIL_GAME_METRIC_END(PLAYER_REMOVE);
+    return rc;
+}
+
+int fossil_game_player_destroy(const char* player_id)
+{
+    return fossil_game_player_remove(player_id);
+}
+
+const fossil_game_player_view* fossil_game_player_handle(const char* player_id)
+{
+    fossil_game_player* p=find_player(player_id);
+    return p?&p->view:NULL;
+}
+
+/* ============================================================
+   Interned names
+   ============================================================ */
+
+/*
+ * Attribute keys are interned once into an append-only table; players store
+ * the numeric id, so lookups compare integers instead of strings. Item ids
+ * are interned the same way by the item catalog.
+ */
+typedef struct {
+    char** names;
+    uint32_t* hashes;
+    uint32_t count;
+    uint32_t limit;             /* largest id + 1 the table may hand out */
+    uint32_t* index;            /* id + 1, 0 = empty */
+    uint32_t index_cap;
+} intern_table_t;
+
+static intern_table_t g_attr_keys = { NULL,NULL,0,UINT16_MAX,NULL,0 };
+
+static int intern(intern_table_t* t,const char* name,int create)
+{
+    uint32_t h=hash_str(name);
+
+    if(t->index_cap){
+        uint32_t mask=t->index_cap-1;
+        for(uint32_t i=h&mask;t->index[i];i=(i+1)&mask){
+            uint32_t id=t->index[i]-1;
+            if(t->hashes[id]==h && strcmp(t->names[id],name)==0)
+                return (int)id;
+        }
+    }
 
-            free(p->id);
-            free(p->attrs);
-            free(p->inventory);
-            free(p->controls);
-            free(p->session_id);
-            free(p);
+    if(!create) return -2;
+    if(t->count==t->limit || t->count==INT32_MAX) return -3;
 
-            g_players[i]=g_players[g_player_count-1];
-            g_player_count--;
-            return 0;
+    if((t->count+1)*2>t->index_cap){
+        uint32_t cap=t->index_cap?t->index_cap*2:64;
+        uint32_t* idx=calloc(cap,sizeof(*idx));
+        if(!idx) return -3;
+        for(uint32_t id=0;id<t->count;id++){
+            uint32_t j=t->hashes[id]&(cap-1);
+            while(idx[j]) j=(j+1)&(cap-1);
+            idx[j]=id+1;
         }
+
+        char** names=realloc(t->names,sizeof(*names)*cap/2);
+        if(names) t->names=names;
+        uint32_t* hashes=realloc(t->hashes,sizeof(*hashes)*cap/2);
+        if(hashes) t->hashes=hashes;
+        if(!names||!hashes){ free(idx); return -3; }
+
+        free(t->index);
+        t->index=idx;
+        t->index_cap=cap;
     }
-    return -2;
+
+    char* copy=fossil_strdup(name);
+    if(!copy) return -3;
+
+    uint32_t id=t->count++;
+    t->names[id]=copy;
+    t->hashes[id]=h;
+
+    uint32_t j=h&(t->index_cap-1);
+    while(t->index[j]) j=(j+1)&(t->index_cap-1);
+    t->index[j]=id+1;
+    return (int)id;
+}
+
+static int attr_key(const char* key,int create)
+{
+    return intern(&g_attr_keys,key,create);
+}
+
+int fossil_game_player_attr_key(const char* key)
+{
+    if(!key) return -1;
+    return attr_key(key,1);
 }
 
 /* ============================================================
    Attributes
    ============================================================ */
 
-int fossil_game_player_set_attribute(const char* player_id,const char* key,const void* value)
+static inline uint32_t spill_home(uint16_t key,uint32_t mask)
 {
-    fossil_game_player* p=find_player(player_id);
-    if(!p||!key) return -1;
+    return (key*2654435761u)&mask;
+}
 
-    for(size_t i=0;i<p->attr_count;i++){
-        if(strcmp(p->attrs[i].key,key)==0){
-            p->attrs[i].value=(void*)value;
-            return 0;
-        }
+static fossil_game_player_attr* attr_find(fossil_game_player* p,uint16_t key)
+{
+    for(uint32_t i=0;i<p->attr_count;i++)
+        if(p->attr_keys[i]==key) return &p->attrs[i];
+
+    if(!p->spill_count) return NULL;
+
+    uint32_t mask=p->spill_cap-1;
+    for(uint32_t i=spill_home(key,mask);p->spill[i].type;i=(i+1)&mask)
+        if(p->spill[i].key==key) return &p->spill[i];
+    return NULL;
+}
+
+static void attr_release(fossil_game_player_attr* a)
+{
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_STRING||a->type==FOSSIL_GAME_PLAYER_ATTR_BLOB)
+        free(a->v.bytes);
+}
+
+static void attrs_free(fossil_game_player* p)
+{
+    for(uint32_t i=0;i<p->attr_count;i++)
+        attr_release(&p->attrs[i]);
+    for(uint32_t i=0;i<p->spill_cap;i++)
+        if(p->spill[i].type) attr_release(&p->spill[i]);
+    free(p->spill);
+}
+
+static int spill_grow(fossil_game_player* p)
+{
+    uint32_t cap=p->spill_cap?p->spill_cap*2:16;
+    fossil_game_player_attr* tmp=calloc(cap,sizeof(*tmp));
+    if(!tmp) return -1;
+    FOSSIL_GAME_METRIC_ALLOC();
+
+    for(uint32_t i=0;i<p->spill_cap;i++){
+        if(!p->spill[i].type) continue;
+        uint32_t j=spill_home(p->spill[i].key,cap-1);
+        while(tmp[j].type) j=(j+1)&(cap-1);
+        tmp[j]=p->spill[i];
     }
 
-    fossil_game_player_attr* tmp =
-        realloc(p->attrs,(p->attr_count+1)*sizeof(*tmp));
-    if(!tmp) return -2;
+    free(p->spill);
+    p->spill=tmp;
+    p->spill_cap=cap;
+    return 0;
+}
+
+/* Stores v (taking ownership of its bytes) under key, replacing any old value */
+static int attr_put(fossil_game_player* p,uint16_t key,const fossil_game_player_attr* v)
+{
+    fossil_game_player_attr* slot=attr_find(p,key);
+
+    if(slot){
+        attr_release(slot);
+    }else if(p->attr_count<ATTR_INLINE){
+        p->attr_keys[p->attr_count]=key;
+        slot=&p->attrs[p->attr_count++];
+    }else{
+        if((p->spill_count+1)*2>p->spill_cap && spill_grow(p)!=0) return -3;
+
+        uint32_t mask=p->spill_cap-1;
+        uint32_t i=spill_home(key,mask);
+        while(p->spill[i].type) i=(i+1)&mask;
+        slot=&p->spill[i];
+        p->spill_count++;
+    }
 
-    p->attrs=tmp;
-    p->attrs[p->attr_count].key=fossil_strdup(key);
-    p->attrs[p->attr_count].value=(void*)value;
-    p->attr_count++;
+    *slot=*v;
+    slot->key=key;
     return 0;
 }
 
-int fossil_game_player_get_attribute(const char* player_id,const char* key,void* out_value)
+static int attr_erase(fossil_game_player* p,uint16_t key)
 {
-    fossil_game_player* p=find_player(player_id);
-    if(!p||!key||!out_value) return -1;
+    for(uint32_t i=0;i<p->attr_count;i++){
+        if(p->attr_keys[i]!=key) continue;
+        attr_release(&p->attrs[i]);
+        uint32_t last=--p->attr_count;
+        p->attr_keys[i]=p->attr_keys[last];
+        p->attrs[i]=p->attrs[last];
+        return 0;
+    }
+
+    fossil_game_player_attr* a=p->spill_count?attr_find(p,key):NULL;
+    if(!a) return -2;
+
+    attr_release(a);
 
-    for(size_t i=0;i<p->attr_count;i++){
-        if(strcmp(p->attrs[i].key,key)==0){
-            *(void**)out_value=p->attrs[i].value;
-            return 0;
+    /* backward-shift deletion keeps probe chains intact */
+    uint32_t mask=p->spill_cap-1;
+    uint32_t hole=(uint32_t)(a-p->spill);
+    for(uint32_t i=(hole+1)&mask;p->spill[i].type;i=(i+1)&mask){
+        uint32_t home=spill_home(p->spill[i].key,mask);
+        if(((i-home)&mask)>=((i-hole)&mask)){
+            p->spill[hole]=p->spill[i];
+            hole=i;
         }
     }
-    return -2;
+    p->spill[hole].type=FOSSIL_GAME_PLAYER_ATTR_NONE;
+    p->spill_count--;
+    return 0;
 }
 
-/* ============================================================
-   Inventory
-   ============================================================ */
+/* Builds an owned string or blob value; strings keep a terminating NUL */
+static int attr_bytes(fossil_game_player_attr* v,int type,const void* data,size_t len)
+{
+    if(len>UINT32_MAX-1) return -1;
 
-int fossil_game_player_inventory_add(const char* player_id,const char* item_id,int count)
+    v->type=(uint8_t)type;
+    v->len=(uint32_t)len;
+    v->v.bytes=malloc(len+1);
+    if(!v->v.bytes) return -3;
+    FOSSIL_GAME_METRIC_ALLOC();
+
+    if(len) memcpy(v->v.bytes,data,len);
+    v->v.bytes[len]='\0';
+    return 0;
+}
+
+static int set_value(const char* player_id,const char* key,fossil_game_player_attr* v)
 {
     fossil_game_player* p=find_player(player_id);
-    if(!p||!item_id||count<=0) return -1;
+    int id=p&&key?attr_key(key,1):-1;
+    int rc=id<0?(p&&key?-3:-1):attr_put(p,(uint16_t)id,v);
 
-    for(size_t i=0;i<p->inventory_count;i++){
-        if(strcmp(p->inventory[i].item_id,item_id)==0){
-            p->inventory[i].count+=count;
-            return 0;
-        }
-    }
+    if(rc!=0) attr_release(v);
+    return rc;
+}
+
+static const fossil_game_player_attr* get_value(const char* player_id,const char* key,int* rc)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!key){ *rc=-1; return NULL; }
+
+    int id=attr_key(key,0);
+    const fossil_game_player_attr* a=id<0?NULL:attr_find(p,(uint16_t)id);
+    *rc=a?0:-2;
+    return a;
+}
+
+static int player_set_int(const char* player_id,const char* key,int64_t value)
+{
+    fossil_game_player_attr v={0};
+    v.type=FOSSIL_GAME_PLAYER_ATTR_INT;
+    v.v.i=value;
+    return set_value(player_id,key,&v);
+}
+
+int fossil_game_player_set_int(const char* player_id,const char* key,int64_t value)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_SET_INT);
+    int rc=player_set_int(player_id,key,value);
+    FOSSIL_GAME_METRIC_END(PLAYER_SET_INT);
+    return rc;
+}
+
+int fossil_game_player_set_float(const char* player_id,const char* key,double value)
+{
+    fossil_game_player_attr v={0};
+    v.type=FOSSIL_GAME_PLAYER_ATTR_FLOAT;
+    v.v.f=value;
+    return set_value(player_id,key,&v);
+}
+
+int fossil_game_player_set_string(const char* player_id,const char* key,const char* value)
+{
+    if(!value) return -1;
+
+    fossil_game_player_attr v={0};
+    int rc=attr_bytes(&v,FOSSIL_GAME_PLAYER_ATTR_STRING,value,strlen(value));
+    return rc?rc:set_value(player_id,key,&v);
+}
+
+int fossil_game_player_set_blob(const char* player_id,const char* key,const void* data,size_t len)
+{
+    if(!data&&len) return -1;
+
+    fossil_game_player_attr v={0};
+    int rc=attr_bytes(&v,FOSSIL_GAME_PLAYER_ATTR_BLOB,data,len);
+    return rc?rc:set_value(player_id,key,&v);
+}
+
+int fossil_game_player_set_attr(const char* player_id,const char* key,const char* value)
+{
+    return fossil_game_player_set_string(player_id,key,value);
+}
+
+static int player_get_int(const char* player_id,const char* key,int64_t* out)
+{
+    int rc;
+    const fossil_game_player_attr* a=get_value(player_id,key,&rc);
+    if(!out) return -1;
+    if(!a) return rc;
+
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_INT)   { *out=a->v.i; return 0; }
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT) { *out=(int64_t)a->v.f; return 0; }
+    return -4;
+}
+
+int fossil_game_player_get_int(const char* player_id,const char* key,int64_t* out)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_GET_INT);
+    int rc=player_get_int(player_id,key,out);
+    FOSSIL_GAME_METRIC_END(PLAYER_GET_INT);
+    return rc;
+}
+
+int fossil_game_player_get_float(const char* player_id,const char* key,double* out)
+{
+    int rc;
+    const fossil_game_player_attr* a=get_value(player_id,key,&rc);
+    if(!out) return -1;
+    if(!a) return rc;
 
-    fossil_game_player_item* tmp =
-        realloc(p->inventory,(p->inventory_count+1)*sizeof(*tmp));
-    if(!tmp) return -2;
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT) { *out=a->v.f; return 0; }
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_INT)   { *out=(double)a->v.i; return 0; }
+    return -4;
+}
+
+const char* fossil_game_player_get_string(const char* player_id,const char* key)
+{
+    int rc;
+    const fossil_game_player_attr* a=get_value(player_id,key,&rc);
+    return a&&a->type==FOSSIL_GAME_PLAYER_ATTR_STRING?(const char*)a->v.bytes:NULL;
+}
 
-    p->inventory=tmp;
-    p->inventory[p->inventory_count].item_id=strdup(item_id);
-    p->inventory[p->inventory_count].count=count;
-    p->inventory_count++;
+int fossil_game_player_get_blob(const char* player_id,const char* key,const void** out_data,size_t* out_len)
+{
+    int rc;
+    const fossil_game_player_attr* a=get_value(player_id,key,&rc);
+    if(!out_data||!out_len) return -1;
+    if(!a) return rc;
+    if(a->type!=FOSSIL_GAME_PLAYER_ATTR_BLOB) return -4;
+
+    *out_data=a->v.bytes;
+    *out_len=a->len;
     return 0;
 }
 
-int fossil_game_player_inventory_remove(const char* player_id,const char* item_id,int count)
+/* Numbers are rendered into a shared buffer valid until the next call */
+static const char* player_get_attr(const char* player_id,const char* key)
 {
-    fossil_game_player* p=find_player(player_id);
-    if(!p||!item_id||count<=0) return -1;
+    static char text[32];
 
-    for(size_t i=0;i<p->inventory_count;i++){
-        if(strcmp(p->inventory[i].item_id,item_id)==0){
-            if(p->inventory[i].count<count) return -2;
-            p->inventory[i].count-=count;
-            return 0;
-        }
+    int rc;
+    const fossil_game_player_attr* a=get_value(player_id,key,&rc);
+    if(!a) return NULL;
+
+    switch(a->type){
+    case FOSSIL_GAME_PLAYER_ATTR_STRING:
+        return (const char*)a->v.bytes;
+    case FOSSIL_GAME_PLAYER_ATTR_INT:
+        snprintf(text,sizeof(text),"%lld",(long long)a->v.i);
+        return text;
+    case FOSSIL_GAME_PLAYER_ATTR_FLOAT:
+        snprintf(text,sizeof(text),"%.17g",a->v.f);
+        return text;
+    default:
+        return NULL;
     }
-    return -3;
 }
 
-int fossil_game_player_inventory_list(const char* player_id,const char*** out_items,int* out_count)
+const char* fossil_game_player_get_attr(const char* player_id,const char* key)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_GET_ATTR);
+    const char* rc=player_get_attr(player_id,key);
+    FOSSIL_GAME_METRIC_END(PLAYER_GET_ATTR);
+    return rc;
+}
+
+int fossil_game_player_attr_type(const char* player_id,const char* key)
+{
+    int rc;
+    const fossil_game_player_attr* a=get_value(player_id,key,&rc);
+    if(rc==-1) return -1;
+    return a?a->type:FOSSIL_GAME_PLAYER_ATTR_NONE;
+}
+
+int fossil_game_player_unset_attr(const char* player_id,const char* key)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!key) return -1;
+
+    int id=attr_key(key,0);
+    return id<0?-2:attr_erase(p,(uint16_t)id);
+}
+
+int fossil_game_player_attr_foreach(const char* player_id,fossil_game_player_attr_fn fn,void* ctx)
 {
     fossil_game_player* p=find_player(player_id);
-    if(!p||!out_items||!out_count) return -1;
+    if(!p||!fn) return -1;
 
-    const char** arr = malloc(sizeof(char*)*p->inventory_count);
-    if(!arr) return -2;
+    for(uint32_t i=0;i<p->attr_count+p->spill_cap;i++){
+        const fossil_game_player_attr* a=i<p->attr_count?&p->attrs[i]:&p->spill[i-p->attr_count];
+        if(!a->type) continue;
 
-    for(size_t i=0;i<p->inventory_count;i++)
-        arr[i]=p->inventory[i].item_id;
+        const void* data=a->type==FOSSIL_GAME_PLAYER_ATTR_INT?(const void*)&a->v.i:
+                         a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT?(const void*)&a->v.f:a->v.bytes;
+        size_t len=a->type==FOSSIL_GAME_PLAYER_ATTR_INT||a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT?8:a->len;
 
-    *out_items=arr;
-    *out_count=(int)p->inventory_count;
+        int rc=fn(g_attr_keys.names[a->key],a->type,data,len,ctx);
+        if(rc) return rc;
+    }
     return 0;
 }
 
-/* ============================================================
-   Controls
-   ============================================================ */
+/* ===== Schema-id fast path ===== */
 
-static int set_control(const char* player_id,const char* name,int enabled)
+int fossil_game_player_get_int_by_key(const char* player_id,int key,int64_t* out)
 {
     fossil_game_player* p=find_player(player_id);
-    if(!p||!name) return -1;
+    if(!p||!out||key<0||(uint32_t)key>=g_attr_keys.count) return -1;
 
-    for(size_t i=0;i<p->control_count;i++){
-        if(strcmp(p->controls[i].name,name)==0){
-            p->controls[i].enabled=enabled;
-            return 0;
-        }
-    }
+    const fossil_game_player_attr* a=attr_find(p,(uint16_t)key);
+    if(!a) return -2;
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_INT)   { *out=a->v.i; return 0; }
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT) { *out=(int64_t)a->v.f; return 0; }
+    return -4;
+}
 
-    fossil_game_player_control* tmp =
-        realloc(p->controls,(p->control_count+1)*sizeof(*tmp));
-    if(!tmp) return -2;
+int fossil_game_player_set_int_by_key(const char* player_id,int key,int64_t value)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||key<0||(uint32_t)key>=g_attr_keys.count) return -1;
 
-    p->controls=tmp;
-    p->controls[p->control_count].name=fossil_strdup(name);
-    p->controls[p->control_count].enabled=enabled;
-    p->control_count++;
-    return 0;
+    fossil_game_player_attr v={0};
+    v.type=FOSSIL_GAME_PLAYER_ATTR_INT;
+    v.v.i=value;
+    return attr_put(p,(uint16_t)key,&v);
 }
 
-int fossil_game_player_enable_control(const char* player_id,const char* control){
-    return set_control(player_id,control,1);
+int fossil_game_player_get_float_by_key(const char* player_id,int key,double* out)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!out||key<0||(uint32_t)key>=g_attr_keys.count) return -1;
+
+    const fossil_game_player_attr* a=attr_find(p,(uint16_t)key);
+    if(!a) return -2;
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT) { *out=a->v.f; return 0; }
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_INT)   { *out=(double)a->v.i; return 0; }
+    return -4;
 }
-int fossil_game_player_disable_control(const char* player_id,const char* control){
-    return set_control(player_id,control,0);
+
+int fossil_game_player_set_float_by_key(const char* player_id,int key,double value)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||key<0||(uint32_t)key>=g_attr_keys.count) return -1;
+
+    fossil_game_player_attr v={0};
+    v.type=FOSSIL_GAME_PLAYER_ATTR_FLOAT;
+    v.v.f=value;
+    return attr_put(p,(uint16_t)key,&v);
 }
 
 /* ============================================================
-   NPC / AI
+   Inventory
    ============================================================ */
 
-int fossil_game_player_npc_update(const char* npc_id)
+/*
+ * Holder lists: for every catalog item, the players holding it. Each
+ * inventory entry remembers its position so both sides update in O(1)
+ * (plus a binary search for the entry that moves into the hole).
+ */
+typedef struct {
+    fossil_game_player** players;
+    uint32_t count;
+    uint32_t cap;
+} holder_list_t;
+
+static holder_list_t* g_holders = NULL;
+static uint32_t g_holder_items = 0;
+static uint32_t g_query_epoch = 0;
+
+static inline int32_t item_limit(uint32_t item)
 {
-    /* Stub for future AI logic */
-    fossil_game_player* p=find_player(npc_id);
-    if(!p) return -1;
+    int32_t limit=fossil_game_item_stack_size((int)item);
+    return limit>0?limit:INT32_MAX;
+}
+
+/* Position of item, or of the entry it would be inserted before */
+static uint32_t inv_search(const fossil_game_player* p,uint32_t item)
+{
+    uint32_t lo=0,hi=p->view.inventory_count;
+    while(lo<hi){
+        uint32_t mid=(lo+hi)/2;
+        if(p->view.inventory[mid].item<item) lo=mid+1;
+        else hi=mid;
+    }
+    return lo;
+}
+
+static int32_t inv_count(const fossil_game_player* p,uint32_t item)
+{
+    uint32_t i=inv_search(p,item);
+    return i<p->view.inventory_count&&p->view.inventory[i].item==item?p->view.inventory[i].count:0;
+}
+
+/* Makes room for one more holder of each listed item */
+static int holders_reserve(uint32_t item)
+{
+    if(item>=g_holder_items){
+        uint32_t n=g_holder_items?g_holder_items:64;
+        while(n<=item) n*=2;
+        holder_list_t* tmp=realloc(g_holders,sizeof(*tmp)*n);
+        if(!tmp) return -1;
+        memset(tmp+g_holder_items,0,sizeof(*tmp)*(n-g_holder_items));
+        g_holders=tmp;
+        g_holder_items=n;
+    }
+
+    holder_list_t* h=&g_holders[item];
+    if(h->count<h->cap) return 0;
+
+    uint32_t cap=h->cap?h->cap*2:8;
+    fossil_game_player** tmp=realloc(h->players,sizeof(*tmp)*cap);
+    if(!tmp) return -1;
+    FOSSIL_GAME_METRIC_ALLOC();
+    h->players=tmp;
+    h->cap=cap;
     return 0;
 }
 
-/* ============================================================
-   Multiplayer
-   ============================================================ */
+static uint32_t inv_search(const fossil_game_player* p,uint32_t item);
 
-int fossil_game_player_join_session(const char* player_id,const char* session_id)
+static void holders_remove(uint32_t item,uint32_t pos)
 {
-    fossil_game_player* p=find_player(player_id);
-    if(!p||!session_id) return -1;
+    holder_list_t* h=&g_holders[item];
+    fossil_game_player* moved=h->players[--h->count];
+    if(pos==h->count) return;
 
-    free(p->session_id);
-    p->session_id=fossil_strdup(session_id);
-    return p->session_id?0:-2;
+    h->players[pos]=moved;
+    moved->view.inventory[inv_search(moved,item)].holder=pos;
 }
 
-int fossil_game_player_leave_session(const char* player_id)
+static void holders_drop(fossil_game_player* p)
+{
+    for(uint32_t i=0;i<p->view.inventory_count;i++)
+        holders_remove(p->view.inventory[i].item,p->view.inventory[i].holder);
+}
+
+static int inv_reserve(fossil_game_player* p,uint32_t need)
+{
+    if(need<=p->inventory_cap) return 0;
+
+    uint32_t cap=p->inventory_cap?p->inventory_cap*2:8;
+    while(cap<need) cap*=2;
+
+    fossil_game_player_item* tmp=realloc(p->view.inventory,sizeof(*tmp)*cap);
+    if(!tmp) return -1;
+    FOSSIL_GAME_METRIC_ALLOC();
+    p->view.inventory=tmp;
+    p->inventory_cap=cap;
+    return 0;
+}
+
+/*
+ * Sets an item's count. Room for a new entry, in the inventory and in the
+ * item's holder list, must already be reserved.
+ */
+static void inv_set(fossil_game_player* p,uint32_t item,int32_t count)
+{
+    uint32_t i=inv_search(p,item);
+    int held=i<p->view.inventory_count&&p->view.inventory[i].item==item;
+    fossil_game_player_item* at=&p->view.inventory[i];
+
+    if(held&&count>0){
+        at->count=count;
+    }else if(held){
+        holders_remove(item,at->holder);
+        memmove(at,at+1,sizeof(*at)*(p->view.inventory_count-i-1));
+        p->view.inventory_count--;
+    }else if(count>0){
+        holder_list_t* h=&g_holders[item];
+        memmove(at+1,at,sizeof(*at)*(p->view.inventory_count-i));
+        at->item=item;
+        at->count=count;
+        at->holder=h->count;
+        h->players[h->count++]=p;
+        p->view.inventory_count++;
+    }
+}
+
+/* Adding past the item's stack limit fails (-4) and adds nothing */
+static int inventory_add(const char* player_id,const char* item_id,int count)
 {
     fossil_game_player* p=find_player(player_id);
-    if(!p) return -1;
+    if(!p||!item_id||count<=0) return -1;
+
+    int item=fossil_game_item_intern(item_id);
+    if(item<0) return -2;
 
-    free(p->session_id);
-    p->session_id=NULL;
+    int32_t held=inv_count(p,(uint32_t)item);
+    if(count>item_limit((uint32_t)item)-held) return -4;
+    if(!held && (inv_reserve(p,p->view.inventory_count+1)!=0||holders_reserve((uint32_t)item)!=0)) return -2;
+
+    inv_set(p,(uint32_t)item,held+count);
+    fossil_game_wal_record_inventory_add(player_id,item_id,count);
     return 0;
 }
+
+int fossil_game_player_inventory_add(const char* player_id,const char* item_id,int count)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_INVENTORY_ADD);
+    int rc=inventory_add(player_id,item_id,count);
+    FOSSIL_GAME_METRIC_END(PLAYER_INVENTORY_ADD);
+    return rc;
+}
+
+static int inventory_remove(const char* player_id,const char* item_id,int count)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!item_id||count<=0) return -1;
+
+    int item=fossil_game_item_lookup(item_id);
+    int32_t held=item<0?0:inv_count(p,(uint32_t)item);
+    if(!held) return -3;
+    if(held<count) return -2;
+
+    inv_set(p,(uint32_t)item,held-count);
+    fossil_game_wal_record_inventory_remove(player_id,item_id,count);
+    return 0;
+}
+
+int fossil_game_player_inventory_remove(const char* player_id,const char* item_id,int count)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_INVENTORY_REMOVE);
+    int rc=inventory_remove(player_id,item_id,count);
+    FOSSIL_GAME_METRIC_END(PLAYER_INVENTORY_REMOVE);
+    return rc;
+}
+
+int fossil_game_player_inventory_count(const char* player_id,const char* item_id)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!item_id) return -1;
+
+    int item=fossil_game_item_lookup(item_id);
+    return item<0?0:inv_count(p,(uint32_t)item);
+}
+
+int fossil_game_player_add_item(const char* player_id,const char* item_id){
+    return fossil_game_player_inventory_add(player_id,item_id,1);
+}
+int fossil_game_player_remove_item(const char* player_id,const char* item_id){
+    return fossil_game_player_inventory_remove(player_id,item_id,1);
+}
+int fossil_game_player_has_item(const char* player_id,const char* item_id){
+    int n=fossil_game_player_inventory_count(player_id,item_id);
+    return n<0?n:n>0;
+}
+
+/* ===== Bulk moves ===== */
+
+typedef struct {
+    fossil_game_player* p;
+    uint32_t item;
+    int64_t delta;
+} inv_delta_t;
+
+static int delta_cmp(const void* a,const void* b)
+{
+    const inv_delta_t* x=a;
+    const inv_delta_t* y=b;
+    if(x->p!=y->p) return (uintptr_t)x->p<(uintptr_t)y->p?-1:1;
+    return x->item<y->item?-1:(x->item>y->item);
+}
+
+/*
+ * Applies a batch of count changes all-or-nothing: deltas are merged per
+ * (player, item), every result is checked against holdings and stack limits,
+ * and room for new entries is reserved before the first entry changes.
+ */
+static int inv_apply(inv_delta_t* d,size_t n)
+{
+    qsort(d,n,sizeof(*d),delta_cmp);
+
+    size_t m=0;
+    for(size_t i=0;i<n;i++){
+        if(m && d[m-1].p==d[i].p && d[m-1].item==d[i].item) d[m-1].delta+=d[i].delta;
+        else d[m++]=d[i];
+    }
+
+    for(size_t i=0;i<m;){
+        fossil_game_player* p=d[i].p;
+        uint32_t added=0;
+
+        for(;i<m && d[i].p==p;i++){
+            int64_t held=inv_count(p,d[i].item);
+            int64_t next=held+d[i].delta;
+            if(next<0) return -2;
+            if(next>item_limit(d[i].item)) return -4;
+            /* two-party batches add at most one new holder per item */
+            if(!held && next>0){
+                if(holders_reserve(d[i].item)!=0) return -3;
+                added++;
+            }
+        }
+        if(inv_reserve(p,p->view.inventory_count+added)!=0) return -3;
+    }
+
+    for(size_t i=0;i<m;i++)
+        inv_set(d[i].p,d[i].item,(int32_t)(inv_count(d[i].p,d[i].item)+d[i].delta));
+    return 0;
+}
+
+/* Adds one side of a transfer (items leave from, arrive at to) to the batch */
+static int inv_collect(inv_delta_t* d,size_t* n,fossil_game_player* from,fossil_game_player* to,
+                       const char* const* item_ids,const int* counts,size_t count)
+{
+    for(size_t i=0;i<count;i++){
+        if(!item_ids[i]||counts[i]<=0) return -1;
+
+        /* an item nobody has interned cannot be held */
+        int item=fossil_game_item_lookup(item_ids[i]);
+        if(item<0) return -2;
+
+        d[(*n)++]=(inv_delta_t){ from,(uint32_t)item,-(int64_t)counts[i] };
+        d[(*n)++]=(inv_delta_t){ to,(uint32_t)item,counts[i] };
+    }
+    return 0;
+}
+
+#define INV_BATCH_INLINE 32
+
+static int inventory_trade(const char* player_a,const char* const* a_items,const int* a_counts,size_t a_count,
+                           const char* player_b,const char* const* b_items,const int* b_counts,size_t b_count)
+{
+    fossil_game_player* a=find_player(player_a);
+    fossil_game_player* b=find_player(player_b);
+    if(!a||!b||a==b) return -1;
+    if((a_count&&(!a_items||!a_counts))||(b_count&&(!b_items||!b_counts))) return -1;
+    if(a_count>SIZE_MAX/4||b_count>SIZE_MAX/4) return -1;
+
+    inv_delta_t local[INV_BATCH_INLINE];
+    size_t total=(a_count+b_count)*2,n=0;
+    inv_delta_t* d=total<=INV_BATCH_INLINE?local:malloc(sizeof(*d)*total);
+    if(!d) return -3;
+
+    int rc=inv_collect(d,&n,a,b,a_items,a_counts,a_count);
+    if(rc==0) rc=inv_collect(d,&n,b,a,b_items,b_counts,b_count);
+    if(rc==0) rc=inv_apply(d,n);
+    if(rc==0) fossil_game_wal_record_inventory_trade(player_a,a_items,a_counts,a_count,player_b,b_items,b_counts,b_count);
+
+    if(d!=local) free(d);
+    return rc;
+}
+
+int fossil_game_player_inventory_trade(const char* player_a,const char* const* a_items,const int* a_counts,size_t a_count,
+                                       const char* player_b,const char* const* b_items,const int* b_counts,size_t b_count)
+{
+    FOSSIL_GAME_METRIC_BEGIN(PLAYER_INVENTORY_TRADE);
+    int rc=inventory_trade(player_a,a_items,a_counts,a_count,player_b,b_items,b_counts,b_count);
+    FOSSIL_GAME_METRIC_END(PLAYER_INVENTORY_TRADE);
+    return rc;
+}
+
+int fossil_game_player_inventory_transfer(const char* from_id,const char* to_id,
+                                          const char* const* item_ids,const int* counts,size_t count)
+{
+    return fossil_game_player_inventory_trade(from_id,item_ids,counts,count,to_id,NULL,NULL,0);
+}
+
+/* ===== Iteration ===== */
+
+int fossil_game_player_inventory_foreach(const char* player_id,fossil_game_player_item_fn fn,void* ctx)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!fn) return -1;
+
+    for(uint32_t i=0;i<p->view.inventory_count;i++){
+        int rc=fn(fossil_game_item_name((int)p->view.inventory[i].item),p->view.inventory[i].count,ctx);
+        if(rc) return rc;
+    }
+    return 0;
+}
+
+int fossil_game_player_inventory_begin(const char* player_id,fossil_game_player_inventory_iter* it)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!it) return -1;
+
+    it->player=p;
+    it->pos=0;
+    return 0;
+}
+
+int fossil_game_player_inventory_next(fossil_game_player_inventory_iter* it,const char** out_item,int* out_count)
+{
+    if(!it||!it->player) return 0;
+
+    const fossil_game_player* p=it->player;
+    if(it->pos>=p->view.inventory_count) return 0;
+
+    const fossil_game_player_item* e=&p->view.inventory[it->pos++];
+    if(out_item) *out_item=fossil_game_item_name((int)e->item);
+    if(out_count) *out_count=e->count;
+    return 1;
+}
+
+/* ===== Holder queries ===== */
+
+static void emit_holder(fossil_game_player* p,const char** out_ids,int cap,int* found)
+{
+    if(p->mark==g_query_epoch) return;
+    p->mark=g_query_epoch;
+    if(*found<cap) out_ids[*found]=p->id;
+    (*found)++;
+}
+
+int fossil_game_player_query_holders(const char* item_id,const char** out_ids,int cap,int* out_count)
+{
+    if(!item_id||!out_count||cap<0||(cap>0&&!out_ids)) return -1;
+
+    int item=fossil_game_item_lookup(item_id);
+    const holder_list_t* h=item>=0&&(uint32_t)item<g_holder_items?&g_holders[item]:NULL;
+    int found=h?(int)h->count:0;
+
+    for(int i=0;i<found&&i<cap;i++)
+        out_ids[i]=h->players[i]->id;
+
+    *out_count=found;
+    return found>cap?-4:0;
+}
+
+int fossil_game_player_query_tag(const char* tag,const char** out_ids,int cap,int* out_count)
+{
+    if(!tag||!out_count||cap<0||(cap>0&&!out_ids)) return -1;
+    *out_count=0;
+
+    const uint32_t* items;
+    size_t n;
+    if(fossil_game_item_tagged(tag,&items,&n)!=0) return 0;
+
+    /* a player holding several tagged items is listed once */
+    if(++g_query_epoch==0){
+        for(size_t i=0;i<g_player_count;i++) g_players[i]->mark=0;
+        g_query_epoch=1;
+    }
+
+    int found=0;
+    for(size_t i=0;i<n;i++){
+        if(items[i]>=g_holder_items) continue;
+        const holder_list_t* h=&g_holders[items[i]];
+        for(uint32_t k=0;k<h->count;k++)
+            emit_holder(h->players[k],out_ids,cap,&found);
+    }
+
+    *out_count=found;
+    return found>cap?-4:0;
+}
+
+int fossil_game_player_inventory_list(const char* player_id,const char** out_items,int* out_counts,
+                                      int cap,int* out_count)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!out_count||cap<0||(cap>0&&!out_items)) return -1;
+
+    uint32_t n=p->view.inventory_count<(uint32_t)cap?p->view.inventory_count:(uint32_t)cap;
+    for(uint32_t i=0;i<n;i++){
+        out_items[i]=fossil_game_item_name((int)p->view.inventory[i].item);
+        if(out_counts) out_counts[i]=p->view.inventory[i].count;
+    }
+
+    *out_count=(int)p->view.inventory_count;
+    return p->view.inventory_count>(uint32_t)cap?-4:0;
+}
+
+/* ============================================================
+   Controls
+   ============================================================ */
+
+/* Names map to registry bits; clearing an unregistered name is a no-op */
+static int set_flag(fossil_game_feature_mask_t* mask,const char* name,int enabled)
+{
+    int bit=enabled?fossil_game_feature_register(name):fossil_game_feature_lookup(name);
+    if(bit<0) return enabled?-2:0;
+
+    fossil_game_feature_mask_set(mask,bit,enabled);
+    return 0;
+}
+
+static int set_control(const char* player_id,const char* name,int enabled)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!name) return -1;
+
+    return set_flag(&p->controls,name,enabled);
+}
+
+int fossil_game_player_enable_control(const char* player_id,const char* control){
+    return set_control(player_id,control,1);
+}
+int fossil_game_player_disable_control(const char* player_id,const char* control){
+    return set_control(player_id,control,0);
+}
+
+/* ============================================================
+   Features
+   ============================================================ */
+
+static int set_feature(const char* player_id,const char* name,int enabled)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!name) return -1;
+
+    return set_flag(&p->view.features,name,enabled);
+}
+
+int fossil_game_player_enable_feature(const char* player_id,const char* feature){
+    return set_feature(player_id,feature,1);
+}
+int fossil_game_player_disable_feature(const char* player_id,const char* feature){
+    return set_feature(player_id,feature,0);
+}
+
+int fossil_game_player_has_feature(const char* player_id,const char* feature)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!feature) return -1;
+
+    int bit=fossil_game_feature_lookup(feature);
+    return bit<0?0:fossil_game_feature_mask_test(&p->view.features,bit);
+}
+
+/* ============================================================
+   NPC / AI
+   ============================================================ */
+
+int fossil_game_player_npc_update(const char* npc_id)
+{
+    /* NPC state lives in the clinker engine; plain players have nothing to tick */
+    if(fossil_game_clinker_tick(npc_id)==0) return 0;
+
+    fossil_game_player* p=find_player(npc_id);
+    if(!p) return -1;
+    return 0;
+}
+
+/* ============================================================
+   Multiplayer
+   ============================================================ */
+
+/*
+ * Session rosters: each session lists its members and each member points
+ * back at its roster slot, so join, leave, listing and eviction cost
+ * O(members) or less. A roster is freed when its last member leaves.
+ */
+typedef struct player_session {
+    char* id;
+    uint32_t hash;
+    fossil_game_player** members;
+    uint32_t count;
+    uint32_t cap;
+    uint32_t busy;              /* foreach in progress, defer freeing */
+} player_session_t;
+
+typedef struct {
+    uint32_t hash;
+    player_session_t* s;        /* NULL = empty */
+} session_slot_t;
+
+static session_slot_t* g_session_index = NULL;
+static uint32_t g_session_index_cap = 0;
+static uint32_t g_session_count = 0;
+
+static long session_find(const char* id,uint32_t h)
+{
+    if(!g_session_index_cap) return -1;
+
+    uint32_t mask=g_session_index_cap-1;
+    for(uint32_t i=h&mask;g_session_index[i].s;i=(i+1)&mask){
+        if(g_session_index[i].hash==h && strcmp(g_session_index[i].s->id,id)==0)
+            return (long)i;
+    }
+    return -1;
+}
+
+static player_session_t* session_lookup(const char* id)
+{
+    long pos=session_find(id,hash_str(id));
+    return pos<0?NULL:g_session_index[pos].s;
+}
+
+static player_session_t* session_create(const char* id)
+{
+    if((g_session_count+1)*4>g_session_index_cap*3){
+        uint32_t cap=g_session_index_cap?g_session_index_cap*2:64;
+        session_slot_t* tmp=calloc(cap,sizeof(*tmp));
+        if(!tmp) return NULL;
+
+        for(uint32_t i=0;i<g_session_index_cap;i++){
+            if(!g_session_index[i].s) continue;
+            uint32_t j=g_session_index[i].hash&(cap-1);
+            while(tmp[j].s) j=(j+1)&(cap-1);
+            tmp[j]=g_session_index[i];
+        }
+
+        free(g_session_index);
+        g_session_index=tmp;
+        g_session_index_cap=cap;
+    }
+
+    player_session_t* s=calloc(1,sizeof(*s));
+    if(!s) return NULL;
+    s->id=fossil_strdup(id);
+    if(!s->id){ free(s); return NULL; }
+    s->hash=hash_str(id);
+
+    uint32_t i=s->hash&(g_session_index_cap-1);
+    while(g_session_index[i].s) i=(i+1)&(g_session_index_cap-1);
+    g_session_index[i].hash=s->hash;
+    g_session_index[i].s=s;
+    g_session_count++;
+    return s;
+}
+
+static void session_free(player_session_t* s)
+{
+    long pos=session_find(s->id,s->hash);
+    uint32_t mask=g_session_index_cap-1;
+    uint32_t hole=(uint32_t)pos;
+
+    for(uint32_t i=(hole+1)&mask;g_session_index[i].s;i=(i+1)&mask){
+        uint32_t home=g_session_index[i].hash&mask;
+        if(((i-home)&mask)>=((i-hole)&mask)){
+            g_session_index[hole]=g_session_index[i];
+            hole=i;
+        }
+    }
+    g_session_index[hole].s=NULL;
+    g_session_count--;
+
+    free(s->members);
+    free(s->id);
+    free(s);
+}
+
+static void session_leave(fossil_game_player* p)
+{
+    player_session_t* s=p->session;
+    if(!s) return;
+
+    fossil_game_player* moved=s->members[--s->count];
+    s->members[p->session_pos]=moved;
+    moved->session_pos=p->session_pos;
+    p->session=NULL;
+
+    if(!s->count && !s->busy) session_free(s);
+}
+
+int fossil_game_player_join_session(const char* player_id,const char* session_id)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p||!session_id) return -1;
+    if(p->session && strcmp(p->session->id,session_id)==0) return 0;
+
+    player_session_t* s=session_lookup(session_id);
+    if(!s && !(s=session_create(session_id))) return -2;
+
+    if(s->count==s->cap){
+        uint32_t cap=s->cap?s->cap*2:8;
+        fossil_game_player** tmp=realloc(s->members,sizeof(*tmp)*cap);
+        if(!tmp){
+            if(!s->count && !s->busy) session_free(s);
+            return -2;
+        }
+        s->members=tmp;
+        s->cap=cap;
+    }
+
+    /* a player is in at most one session; joining another moves it */
+    session_leave(p);
+
+    p->session=s;
+    p->session_pos=s->count;
+    s->members[s->count++]=p;
+    return 0;
+}
+
+int fossil_game_player_leave_session(const char* player_id)
+{
+    fossil_game_player* p=find_player(player_id);
+    if(!p) return -1;
+
+    session_leave(p);
+    return 0;
+}
+
+const char* fossil_game_player_get_session(const char* player_id)
+{
+    fossil_game_player* p=find_player(player_id);
+    return p&&p->session?p->session->id:NULL;
+}
+
+/* Visits members last to first, so fn may make the current player leave */
+int fossil_game_player_foreach_in_session(const char* session_id,fossil_game_player_visit_fn fn,void* ctx)
+{
+    if(!session_id||!fn) return -1;
+
+    player_session_t* s=session_lookup(session_id);
+    if(!s) return 0;
+
+    int rc=0;
+    s->busy++;
+    for(uint32_t i=s->count;i-->0;){
+        if(i>=s->count) continue;
+        if((rc=fn(s->members[i]->id,ctx))!=0) break;
+    }
+    if(--s->busy==0 && !s->count) session_free(s);
+    return rc;
+}
+
+int fossil_game_player_session_count(const char* session_id)
+{
+    if(!session_id) return -1;
+
+    player_session_t* s=session_lookup(session_id);
+    return s?(int)s->count:0;
+}
+
+int fossil_game_player_session_list(const char* session_id,const char** out_ids,int cap,int* out_count)
+{
+    if(!session_id||!out_count||cap<0||(cap>0&&!out_ids)) return -1;
+
+    player_session_t* s=session_lookup(session_id);
+    uint32_t n=s?s->count:0;
+
+    for(uint32_t i=0;i<n && i<(uint32_t)cap;i++)
+        out_ids[i]=s->members[i]->id;
+
+    *out_count=(int)n;
+    return n>(uint32_t)cap?-4:0;
+}
+
+int fossil_game_player_evict_session(const char* session_id)
+{
+    if(!session_id) return -1;
+
+    player_session_t* s=session_lookup(session_id);
+    if(!s) return 0;
+    if(s->busy) return -2;
+
+    int n=(int)s->count;
+    for(uint32_t i=0;i<s->count;i++)
+        s->members[i]->session=NULL;
+    session_free(s);
+    return n;
+}
+
+/* ============================================================
+   Snapshot
+   ============================================================ */
+
+/*
+ * Records refer to attribute keys, items and feature bits by position in
+ * name tables written ahead of them; loading re-interns the names, so
+ * snapshots survive a different registration order.
+ */
+static void put_attr(fossil_game_state_writer* w,const fossil_game_player_attr* a)
+{
+    fossil_game_state_put_u64(w,a->key);
+    fossil_game_state_put_u64(w,a->type);
+
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_INT)        fossil_game_state_put_i64(w,a->v.i);
+    else if(a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT) fossil_game_state_put_f64(w,a->v.f);
+    else fossil_game_state_put_bytes(w,a->v.bytes,a->len);
+}
+
+int fossil_game_player_state_save(fossil_game_state_writer* w)
+{
+    if(!w) return -1;
+
+    fossil_game_state_put_u64(w,g_attr_keys.count);
+    for(uint32_t i=0;i<g_attr_keys.count;i++)
+        fossil_game_state_put_str(w,g_attr_keys.names[i]);
+
+    int items=fossil_game_item_count();
+    fossil_game_state_put_u64(w,(uint64_t)items);
+    for(int i=0;i<items;i++)
+        fossil_game_state_put_str(w,fossil_game_item_name(i));
+
+    int features=fossil_game_feature_count();
+    fossil_game_state_put_u64(w,(uint64_t)features);
+    for(int i=0;i<features;i++)
+        fossil_game_state_put_str(w,fossil_game_feature_name(i));
+
+    fossil_game_state_put_u64(w,g_player_count);
+    for(size_t n=0;n<g_player_count;n++){
+        const fossil_game_player* p=g_players[n];
+
+        fossil_game_state_put_str(w,p->id);
+        for(int i=0;i<2;i++) fossil_game_state_put_u64(w,p->controls.bits[i]);
+        for(int i=0;i<2;i++) fossil_game_state_put_u64(w,p->view.features.bits[i]);
+
+        fossil_game_state_put_u64(w,p->attr_count+p->spill_count);
+        for(uint32_t i=0;i<p->attr_count;i++)
+            put_attr(w,&p->attrs[i]);
+        for(uint32_t i=0;i<p->spill_cap;i++)
+            if(p->spill[i].type) put_attr(w,&p->spill[i]);
+
+        fossil_game_state_put_u64(w,p->view.inventory_count);
+        for(uint32_t i=0;i<p->view.inventory_count;i++){
+            fossil_game_state_put_u64(w,p->view.inventory[i].item);
+            fossil_game_state_put_u64(w,(uint64_t)p->view.inventory[i].count);
+        }
+    }
+    return w->err;
+}
+
+/* Reads a name table and resolves every entry through lookup; -1 from lookup fails the load */
+static int32_t* load_names(fossil_game_state_reader* r,uint64_t limit,uint32_t* out_count,int (*lookup)(const char*))
+{
+    uint64_t n=fossil_game_state_get_u64(r);
+    if(r->err || n>limit || n>(uint64_t)(r->end-r->pos)){ r->err=-2; return NULL; }
+
+    int32_t* map=malloc(sizeof(*map)*(n?n:1));
+    if(!map){ r->err=-3; return NULL; }
+
+    for(uint64_t i=0;i<n;i++){
+        char* name=fossil_game_state_get_str(r);
+        int id=name?lookup(name):-1;
+        free(name);
+        if(id<0){
+            if(!r->err) r->err=-2;
+            free(map);
+            return NULL;
+        }
+        map[i]=id;
+    }
+
+    *out_count=(uint32_t)n;
+    return map;
+}
+
+static int intern_attr_key(const char* name){ return attr_key(name,1); }
+
+static int intern_feature(const char* name)
+{
+    int bit=fossil_game_feature_lookup(name);
+    return bit>=0?bit:fossil_game_feature_register(name);
+}
+
+/* bits is NULL when every saved feature kept its bit */
+static void load_mask(fossil_game_state_reader* r,fossil_game_feature_mask_t* m,const int32_t* bits,uint32_t n)
+{
+    fossil_game_feature_mask_t in;
+    for(uint32_t w=0;w<2;w++){
+        in.bits[w]=fossil_game_state_get_u64(r);
+        uint64_t known=n>=64*(w+1)?~(uint64_t)0:n<=64*w?0:((uint64_t)1<<(n-64*w))-1;
+        if(in.bits[w]&~known) r->err=-2;
+    }
+
+    if(!bits){ *m=in; return; }
+
+    memset(m,0,sizeof(*m));
+    for(uint32_t i=0;i<n;i++)
+        if(fossil_game_feature_mask_test(&in,(int)i))
+            fossil_game_feature_mask_set(m,bits[i],1);
+}
+
+static int load_attr(fossil_game_state_reader* r,fossil_game_player* p,const int32_t* keys,uint32_t nkeys)
+{
+    uint64_t key=fossil_game_state_get_u64(r);
+    uint64_t type=fossil_game_state_get_u64(r);
+    if(r->err || key>=nkeys) return -2;
+
+    fossil_game_player_attr v={0};
+    v.type=(uint8_t)type;
+
+    if(type==FOSSIL_GAME_PLAYER_ATTR_INT){
+        v.v.i=fossil_game_state_get_i64(r);
+    }else if(type==FOSSIL_GAME_PLAYER_ATTR_FLOAT){
+        v.v.f=fossil_game_state_get_f64(r);
+    }else if(type==FOSSIL_GAME_PLAYER_ATTR_STRING||type==FOSSIL_GAME_PLAYER_ATTR_BLOB){
+        size_t len;
+        const void* data=fossil_game_state_get_bytes(r,&len);
+        if(r->err) return -2;
+        int rc=attr_bytes(&v,(int)type,data,len);
+        if(rc) return rc;
+    }else{
+        return -2;
+    }
+
+    if(r->err){ attr_release(&v); return -2; }
+    int rc=attr_put(p,(uint16_t)keys[key],&v);
+    if(rc) attr_release(&v);
+    return rc;
+}
+
+static int inv_entry_cmp(const void* a,const void* b)
+{
+    uint32_t x=((const fossil_game_player_item*)a)->item;
+    uint32_t y=((const fossil_game_player_item*)b)->item;
+    return x<y?-1:x>y;
+}
+
+static int load_inventory(fossil_game_state_reader* r,fossil_game_player* p,const int32_t* items,uint32_t nitems)
+{
+    uint64_t n=fossil_game_state_get_u64(r);
+    if(r->err || n>(uint64_t)(r->end-r->pos)/2) return -2;
+    if(!n) return 0;
+    if(inv_reserve(p,(uint32_t)n)!=0) return -3;
+
+    int sorted=1;
+    for(uint64_t i=0;i<n;i++){
+        uint64_t item=fossil_game_state_get_u64(r);
+        uint64_t count=fossil_game_state_get_u64(r);
+        if(r->err || item>=nitems || !count || count>INT32_MAX) return -2;
+
+        fossil_game_player_item* e=&p->view.inventory[i];
+        e->item=(uint32_t)items[item];
+        e->count=(int32_t)count;
+        if(i && e->item<=e[-1].item) sorted=0;
+    }
+
+    /* only a reordered item catalog breaks the saved order */
+    if(!sorted){
+        qsort(p->view.inventory,(size_t)n,sizeof(*p->view.inventory),inv_entry_cmp);
+        for(uint64_t i=1;i<n;i++)
+            if(p->view.inventory[i].item==p->view.inventory[i-1].item) return -2;
+    }
+
+    for(uint64_t i=0;i<n;i++){
+        fossil_game_player_item* e=&p->view.inventory[i];
+        if(holders_reserve(e->item)!=0) return -3;
+
+        holder_list_t* h=&g_holders[e->item];
+        e->holder=h->count;
+        h->players[h->count++]=p;
+        p->view.inventory_count++;
+    }
+    return 0;
+}
+
+int fossil_game_player_state_load(fossil_game_state_reader* r)
+{
+    if(!r) return -1;
+    if(g_player_count) return -5;
+
+    uint32_t nkeys=0,nitems=0,nfeatures=0;
+    int32_t* keys=load_names(r,UINT16_MAX,&nkeys,intern_attr_key);
+    int32_t* items=keys?load_names(r,UINT32_MAX,&nitems,fossil_game_item_intern):NULL;
+    int32_t* features=items?load_names(r,128,&nfeatures,intern_feature):NULL;
+
+    uint64_t n=features?fossil_game_state_get_u64(r):0;
+    int rc=features?0:(r->err?r->err:-2);
+    if(!rc && (r->err || n>(uint64_t)(r->end-r->pos) || n>=UINT32_MAX)) rc=-2;
+
+    const int32_t* remap=NULL;
+    for(uint32_t i=0;i<nfeatures;i++)
+        if(features[i]!=(int32_t)i) remap=features;
+
+    /* size the registry and its index once instead of growing per player */
+    if(!rc && n){
+        fossil_game_player** tmp=realloc(g_players,sizeof(*tmp)*(size_t)n);
+        if(tmp) g_players=tmp;
+
+        uint32_t cap=64;
+        while(cap<n*4/3+1) cap*=2;
+        player_slot_t* idx=tmp&&cap>g_player_index_cap?calloc(cap,sizeof(*idx)):NULL;
+        if(idx){
+            free(g_player_index);
+            g_player_index=idx;
+            g_player_index_cap=cap;
+        }
+        if(!tmp||(!idx&&cap>g_player_index_cap)) rc=-3;
+    }
+
+    for(uint64_t i=0;i<n && !rc;i++){
+        char* id=fossil_game_state_get_str(r);
+        if(!id){ rc=r->err?r->err:-2; break; }
+
+        /* the index is presized, so one probe both rejects duplicates and finds the free slot */
+        uint32_t h=hash_str(id),mask=g_player_index_cap-1,j=h&mask;
+        for(;g_player_index[j].p;j=(j+1)&mask)
+            if(g_player_index[j].hash==h && strcmp(g_player_index[j].p->id,id)==0) break;
+
+        fossil_game_player* p=g_player_index[j].p?NULL:calloc(1,sizeof(*p));
+        if(!p){ rc=g_player_index[j].p?-2:-3; free(id); break; }
+        p->id=id;
+        p->hash=h;
+        g_player_index[j].hash=h;
+        g_player_index[j].p=p;
+        p->slot=(uint32_t)g_player_count;
+        g_players[g_player_count++]=p;
+
+        load_mask(r,&p->controls,remap,nfeatures);
+        load_mask(r,&p->view.features,remap,nfeatures);
+
+        uint64_t attrs=fossil_game_state_get_u64(r);
+        if(r->err || attrs>(uint64_t)(r->end-r->pos)){ rc=-2; break; }
+        for(uint64_t a=0;a<attrs && !rc;a++)
+            rc=load_attr(r,p,keys,nkeys);
+
+        if(!rc) rc=load_inventory(r,p,items,nitems);
+        if(!rc && r->err) rc=r->err;
+    }
+
+    free(keys);
+    free(items);
+    free(features);
+    return rc;
+}
+
+/* Drops every player unlogged, back to the empty store a load expects */
+void fossil_game_player_state_clear(void)
+{
+    for(size_t i=0;i<g_player_count;i++)
+        player_free(g_players[i]);
+    g_player_count=0;
+
+    if(g_player_index_cap)
+        memset(g_player_index,0,sizeof(*g_player_index)*g_player_index_cap);
+}
+
+/* ============================================================
+   Metrics
+   ============================================================ */
+
+void fossil_game_player_metrics_registry(fossil_game_metrics_registry* out)
+{
+    out->players=g_player_count;
+}
@@ -23,6 +23,11 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/game/quizzed.h"
+#include "fossil/game/metrics.h"
+#include "fossil/game/score.h"
+#include "fossil/game/state.h"
+#include "fossil/game/wal.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -36,6 +41,7 @@ static char* fossil_strdup(const char* s)
 
     char* out = (char*)malloc(len + 1);
     if(!out) return NULL;
+    FOSSIL_GAME_METRIC_ALLOC();
 
     for(size_t i=0;i<=len;i++)
         out[i] = s[i];
@@ -50,9 +56,10 @@ static char* fossil_strdup(const char* s)
 typedef struct {
     char* id;
     char* text;
+    char** option_ids;
     char** options;
     int option_count;
-    int correct_index;
+    int correct_index;          /* -1 until an option is marked correct */
 } question_t;
 
 typedef struct {
@@ -84,6 +91,7 @@ static int g_quiz_count = 0;
 
 static quiz_t* find_quiz(const char* id)
 {
+    if(!id) return NULL;
     for(int i=0;i<g_quiz_count;i++)
         if(strcmp(g_quizzes[i].id,id)==0)
             return &g_quizzes[i];
@@ -105,14 +113,48 @@ static player_state_t* find_player(quiz_t* q,const char* player_id)
     return p;
 }
 
+static question_t* find_question(quiz_t* q,const char* question_id)
+{
+    for(int i=0;i<q->question_count;i++)
+        if(strcmp(q->questions[i].id,question_id)==0)
+            return &q->questions[i];
+    return NULL;
+}
+
+static int find_option(const question_t* qu,const char* option_id)
+{
+    for(int i=0;i<qu->option_count;i++)
+        if(strcmp(qu->option_ids[i],option_id)==0)
+            return i;
+    return -1;
+}
+
 static void free_question(question_t* q)
 {
     free(q->id);
     free(q->text);
-    for(int i=0;i<q->option_count;i++) free(q->options[i]);
+    for(int i=0;i<q->option_count;i++){
+        free(q->option_ids[i]);
+        free(q->options[i]);
+    }
+    free(q->option_ids);
     free(q->options);
 }
 
+static void free_quiz(quiz_t* q)
+{
+    for(int j=0;j<q->question_count;j++)
+        free_question(&q->questions[j]);
+
+    free(q->questions);
+
+    for(int j=0;j<q->player_count;j++)
+        free(q->players[j].player_id);
+
+    free(q->players);
+    free(q->id);
+}
+
 /* ============================================================
    Quiz lifecycle
    ============================================================ */
@@ -127,27 +169,19 @@ int fossil_game_quizzed_create(const char* quiz_id)
 
     memset(q,0,sizeof(*q));
     q->id=fossil_strdup(quiz_id);
+
+    fossil_game_wal_record_quizzed_create(quiz_id);
     return 0;
 }
 
 int fossil_game_quizzed_remove(const char* quiz_id)
 {
-    for(int i=0;i<g_quiz_count;i++)
+    for(int i=0;quiz_id && i<g_quiz_count;i++)
     {
         if(strcmp(g_quizzes[i].id,quiz_id)==0)
         {
-            quiz_t* q=&g_quizzes[i];
-
-            for(int j=0;j<q->question_count;j++)
-                free_question(&q->questions[j]);
-
-            free(q->questions);
-
-            for(int j=0;j<q->player_count;j++)
-                free(q->players[j].player_id);
-
-            free(q->players);
-            free(q->id);
+            fossil_game_wal_record_quizzed_remove(quiz_id);
+            free_quiz(&g_quizzes[i]);
 
             memmove(&g_quizzes[i],&g_quizzes[i+1],
                     sizeof(quiz_t)*(g_quiz_count-i-1));
@@ -163,30 +197,63 @@ int fossil_game_quizzed_remove(const char* quiz_id)
    Question management
    ============================================================ */
 
-int fossil_game_quizzed_add_question(
-    const char* quiz_id,
-    const char* question_id,
-    const char* question_text,
-    const char** options,
-    int num_options,
-    int correct_index)
+int fossil_game_quizzed_add_question(const char* quiz_id,const char* question_id,const char* text)
 {
     quiz_t* q=find_quiz(quiz_id);
-    if(!q || !question_id || !question_text) return -1;
-    if(num_options<=0) return -2;
+    if(!q || !question_id || !text) return -1;
+    if(find_question(q,question_id)) return -5;
 
-    q->questions=realloc(q->questions,sizeof(question_t)*(q->question_count+1));
-    question_t* nq=&q->questions[q->question_count++];
+    question_t* tmp=realloc(q->questions,sizeof(question_t)*(q->question_count+1));
+    if(!tmp) return -3;
+    q->questions=tmp;
 
+    question_t* nq=&q->questions[q->question_count];
+    memset(nq,0,sizeof(*nq));
     nq->id=fossil_strdup(question_id);
-    nq->text=fossil_strdup(question_text);
-    nq->option_count=num_options;
-    nq->correct_index=correct_index;
+    nq->text=fossil_strdup(text);
+    nq->correct_index=-1;
+    if(!nq->id || !nq->text){
+        free_question(nq);
+        return -3;
+    }
+
+    q->question_count++;
+
+    fossil_game_wal_record_quizzed_question(quiz_id,question_id,text);
+    return 0;
+}
 
-    nq->options=malloc(sizeof(char*)*num_options);
-    for(int i=0;i<num_options;i++)
-        nq->options[i]=fossil_strdup(options[i]);
+/* Marking an option correct moves the mark from any earlier one */
+int fossil_game_quizzed_add_option(const char* quiz_id,const char* question_id,const char* option_id,const char* text,int correct)
+{
+    quiz_t* q=find_quiz(quiz_id);
+    if(!q || !question_id || !option_id || !text) return -1;
+
+    question_t* qu=find_question(q,question_id);
+    if(!qu) return -2;
+    if(find_option(qu,option_id)>=0) return -5;
+
+    int n=qu->option_count+1;
+    char** ids=realloc(qu->option_ids,sizeof(char*)*n);
+    if(!ids) return -3;
+    qu->option_ids=ids;
+    char** texts=realloc(qu->options,sizeof(char*)*n);
+    if(!texts) return -3;
+    qu->options=texts;
+
+    char* id=fossil_strdup(option_id);
+    char* t=fossil_strdup(text);
+    if(!id || !t){
+        free(id); free(t);
+        return -3;
+    }
 
+    ids[qu->option_count]=id;
+    texts[qu->option_count]=t;
+    if(correct) qu->correct_index=qu->option_count;
+    qu->option_count++;
+
+    fossil_game_wal_record_quizzed_option(quiz_id,question_id,option_id,text,correct!=0);
     return 0;
 }
 
@@ -195,61 +262,100 @@ int fossil_game_quizzed_remove_question(
     const char* question_id)
 {
     quiz_t* q=find_quiz(quiz_id);
-    if(!q) return -1;
+    if(!q || !question_id) return -1;
 
-    for(int i=0;i<q->question_count;i++)
-    {
-        if(strcmp(q->questions[i].id,question_id)==0)
-        {
-            free_question(&q->questions[i]);
-            memmove(&q->questions[i],&q->questions[i+1],
-                    sizeof(question_t)*(q->question_count-i-1));
-            q->question_count--;
-            return 0;
-        }
-    }
-    return -2;
+    question_t* qu=find_question(q,question_id);
+    if(!qu) return -2;
+
+    int i=(int)(qu-q->questions);
+    fossil_game_wal_record_quizzed_remove_question(quiz_id,question_id);
+    free_question(qu);
+    memmove(&q->questions[i],&q->questions[i+1],
+            sizeof(question_t)*(q->question_count-i-1));
+    q->question_count--;
+    return 0;
 }
 
 /* ============================================================
    Gameplay
    ============================================================ */
 
-int fossil_game_quizzed_ask(
-    const char* quiz_id,
-    const char* player_id,
-    char* out_question,
-    int max_len)
+static question_t* current_question(const char* quiz_id,const char* player_id)
 {
     quiz_t* q=find_quiz(quiz_id);
-    if(!q || q->question_count==0) return -1;
+    if(!q || !player_id || q->question_count==0) return NULL;
 
     player_state_t* p=find_player(q,player_id);
-    int idx=p->current_question % q->question_count;
+    return &q->questions[p->current_question % q->question_count];
+}
 
-    snprintf(out_question,max_len,"%s",q->questions[idx].text);
-    return 0;
+static const char* quizzed_ask(const char* quiz_id,const char* player_id)
+{
+    question_t* qu=current_question(quiz_id,player_id);
+    return qu?qu->text:NULL;
 }
 
-int fossil_game_quizzed_answer(
+const char* fossil_game_quizzed_ask(const char* quiz_id,const char* player_id)
+{
+    FOSSIL_GAME_METRIC_BEGIN(QUIZZED_ASK);
+    const char* text=quizzed_ask(quiz_id,player_id);
+    FOSSIL_GAME_METRIC_END(QUIZZED_ASK);
+    return text;
+}
+
+int fossil_game_quizzed_options(const char* quiz_id,const char* player_id,
+                                const char** out_ids,const char** out_texts,int cap,int* out_count)
+{
+    if(!out_count || cap<0) return -1;
+
+    question_t* qu=current_question(quiz_id,player_id);
+    if(!qu) return -2;
+
+    int n=qu->option_count<cap?qu->option_count:cap;
+    for(int i=0;i<n;i++){
+        if(out_ids) out_ids[i]=qu->option_ids[i];
+        if(out_texts) out_texts[i]=qu->options[i];
+    }
+
+    *out_count=qu->option_count;
+    return qu->option_count>cap?-4:0;
+}
+
+static int quizzed_answer(
     const char* quiz_id,
     const char* player_id,
     const char* answer)
 {
     quiz_t* q=find_quiz(quiz_id);
-    if(!q) return -1;
+    if(!q || !player_id) return -1;
+    if(q->question_count==0) return -2;
 
     player_state_t* p=find_player(q,player_id);
     int idx=p->current_question % q->question_count;
     question_t* qu=&q->questions[idx];
 
-    if(answer && atoi(answer)==qu->correct_index)
+    int correct=answer && qu->correct_index>=0 && find_option(qu,answer)==qu->correct_index;
+    if(correct)
         p->score++;
 
+    fossil_game_score_quiz_answer(player_id,correct);
     p->current_question++;
+
+    fossil_game_wal_record_quizzed_answer(quiz_id,player_id,answer);
     return 0;
 }
 
+int fossil_game_quizzed_answer(
+    const char* quiz_id,
+    const char* player_id,
+    const char* answer)
+{
+    FOSSIL_GAME_METRIC_BEGIN(QUIZZED_ANSWER);
+    int rc=quizzed_answer(quiz_id,player_id,answer);
+    FOSSIL_GAME_METRIC_END(QUIZZED_ANSWER);
+    return rc;
+}
+
 /* ============================================================
    Scoring
    ============================================================ */
@@ -257,7 +363,7 @@ int fossil_game_quizzed_answer(
 int fossil_game_quizzed_score(const char* quiz_id,const char* player_id)
 {
     quiz_t* q=find_quiz(quiz_id);
-    if(!q) return -1;
+    if(!q || !player_id) return -1;
     player_state_t* p=find_player(q,player_id);
     return p->score;
 }
@@ -265,10 +371,12 @@ int fossil_game_quizzed_score(const char* quiz_id,const char* player_id)
 int fossil_game_quizzed_reset(const char* quiz_id,const char* player_id)
 {
     quiz_t* q=find_quiz(quiz_id);
-    if(!q) return -1;
+    if(!q || !player_id) return -1;
     player_state_t* p=find_player(q,player_id);
     p->score=0;
     p->current_question=0;
+
+    fossil_game_wal_record_quizzed_reset(quiz_id,player_id);
     return 0;
 }
 
@@ -547,12 +655,181 @@ int fossil_game_quizzed_ai_generate(
              difficulty,
              q->question_count);
 
-    /* forward into quiz system */
-    return fossil_game_quizzed_add_question(
-        quiz_id,
-        qid,
-        gq->question,
-        gq->options,
-        4,
-        gq->correct);
+    /* forward into quiz system; option ids are the choice indices */
+    int rc=fossil_game_quizzed_add_question(quiz_id,qid,gq->question);
+    for(int i=0;i<4 && !rc;i++){
+        char oid[4];
+        snprintf(oid,sizeof(oid),"%d",i);
+        rc=fossil_game_quizzed_add_option(quiz_id,qid,oid,gq->options[i],i==gq->correct);
+    }
+    return rc;
+}
+
+/* ============================================================
+   Snapshot
+   ============================================================ */
+
+int fossil_game_quizzed_state_save(fossil_game_state_writer* w)
+{
+    if(!w) return -1;
+
+    fossil_game_state_put_u64(w,(uint64_t)g_quiz_count);
+    for(int i=0;i<g_quiz_count;i++)
+    {
+        const quiz_t* q=&g_quizzes[i];
+        fossil_game_state_put_str(w,q->id);
+
+        fossil_game_state_put_u64(w,(uint64_t)q->question_count);
+        for(int j=0;j<q->question_count;j++)
+        {
+            const question_t* qu=&q->questions[j];
+            fossil_game_state_put_str(w,qu->id);
+            fossil_game_state_put_str(w,qu->text);
+            fossil_game_state_put_i64(w,qu->correct_index);
+            fossil_game_state_put_u64(w,(uint64_t)qu->option_count);
+            for(int k=0;k<qu->option_count;k++){
+                fossil_game_state_put_str(w,qu->option_ids[k]);
+                fossil_game_state_put_str(w,qu->options[k]);
+            }
+        }
+
+        fossil_game_state_put_u64(w,(uint64_t)q->player_count);
+        for(int j=0;j<q->player_count;j++)
+        {
+            const player_state_t* p=&q->players[j];
+            fossil_game_state_put_str(w,p->player_id);
+            fossil_game_state_put_i64(w,p->score);
+            fossil_game_state_put_i64(w,p->current_question);
+        }
+    }
+    return w->err;
+}
+
+/* Counts are checked against the bytes left, so corrupt input cannot force huge allocations */
+static int load_count(fossil_game_state_reader* r,int* out)
+{
+    uint64_t n=fossil_game_state_get_u64(r);
+    if(r->err || n>(uint64_t)(r->end-r->pos) || n>INT_MAX) return -2;
+    *out=(int)n;
+    return 0;
+}
+
+static int load_int(fossil_game_state_reader* r,int* out)
+{
+    int64_t v=fossil_game_state_get_i64(r);
+    if(r->err || v<INT_MIN || v>INT_MAX) return -2;
+    *out=(int)v;
+    return 0;
+}
+
+static int load_question(fossil_game_state_reader* r,question_t* qu)
+{
+    memset(qu,0,sizeof(*qu));
+    qu->id=fossil_game_state_get_str(r);
+    qu->text=fossil_game_state_get_str(r);
+    if(!qu->id || !qu->text) return -2;
+
+    int n;
+    if(load_int(r,&qu->correct_index) || load_count(r,&n)) return -2;
+
+    qu->options=calloc(n?n:1,sizeof(char*));
+    qu->option_ids=calloc(n?n:1,sizeof(char*));
+    if(!qu->options || !qu->option_ids) return -3;
+
+    for(int k=0;k<n;k++)
+    {
+        qu->option_ids[k]=fossil_game_state_get_str(r);
+        qu->options[k]=fossil_game_state_get_str(r);
+        if(!qu->option_ids[k] || !qu->options[k]){
+            free(qu->option_ids[k]);
+            free(qu->options[k]);
+            return -2;
+        }
+        qu->option_count++;
+    }
+
+    /* gameplay indexes options with it */
+    if(qu->correct_index<-1 || qu->correct_index>=qu->option_count) return -2;
+    return 0;
+}
+
+static int load_quiz(fossil_game_state_reader* r,quiz_t* q)
+{
+    int n;
+    if(load_count(r,&n)) return -2;
+
+    q->questions=calloc(n?n:1,sizeof(question_t));
+    if(!q->questions) return -3;
+
+    for(int j=0;j<n;j++)
+    {
+        int rc=load_question(r,&q->questions[j]);
+        q->question_count++;
+        if(rc) return rc;
+    }
+
+    if(load_count(r,&n)) return -2;
+    q->players=calloc(n?n:1,sizeof(player_state_t));
+    if(!q->players) return -3;
+
+    for(int j=0;j<n;j++)
+    {
+        player_state_t* p=&q->players[j];
+        p->player_id=fossil_game_state_get_str(r);
+        if(!p->player_id) return -2;
+        q->player_count++;
+
+        if(load_int(r,&p->score) || load_int(r,&p->current_question)) return -2;
+
+        /* both only count up; a negative question would index before the array */
+        if(p->score<0 || p->current_question<0) return -2;
+    }
+    return 0;
+}
+
+int fossil_game_quizzed_state_load(fossil_game_state_reader* r)
+{
+    if(!r) return -1;
+    if(g_quiz_count) return -5;
+
+    int n;
+    if(load_count(r,&n)) return -2;
+    if(!n) return 0;
+
+    g_quizzes=calloc(n,sizeof(quiz_t));
+    if(!g_quizzes) return -3;
+
+    for(int i=0;i<n;i++)
+    {
+        quiz_t* q=&g_quizzes[i];
+        q->id=fossil_game_state_get_str(r);
+        if(!q->id) return -2;
+        g_quiz_count++;
+
+        if(find_quiz(q->id)!=q) return -2;
+
+        int rc=load_quiz(r,q);
+        if(rc) return rc;
+    }
+    return 0;
+}
+
+/* Drops every quiz unlogged, back to the empty store a load expects */
+void fossil_game_quizzed_state_clear(void)
+{
+    for(int i=0;i<g_quiz_count;i++)
+        free_quiz(&g_quizzes[i]);
+
+    free(g_quizzes);
+    g_quizzes=NULL;
+    g_quiz_count=0;
+}
+
+/* ============================================================
+   Metrics
+   ============================================================ */
+
+void fossil_game_quizzed_metrics_registry(fossil_game_metrics_registry* out)
+{
+    out->quizzes=(size_t)g_quiz_count;
 }
@@ -23,8 +23,16 @@
  * -----------------------------------------------------------------------------
  */
 #include "fossil/game/score.h"
+#include "fossil/game/metrics.h"
+#include "fossil/game/state.h"
+#include "fossil/game/trace.h"
+#include "fossil/game/wal.h"
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 static char* fossil_strdup(const char* s)
 {
@@ -35,6 +43,7 @@ static char* fossil_strdup(const char* s)
 
     char* out = (char*)malloc(len + 1);
     if(!out) return NULL;
+    FOSSIL_GAME_METRIC_ALLOC();
 
     for(size_t i=0;i<=len;i++)
         out[i] = s[i];
@@ -46,14 +55,25 @@ static char* fossil_strdup(const char* s)
    Internal structures
    ============================================================ */
 
+#define ACH_WORDS (FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX/64)
+
 typedef struct {
     char* id;
+    uint32_t hash;
     int score;
 
-    char** achievements;
-    int achievement_count;
+    int streak;                 /* consecutive correct quiz answers */
+    int best_streak;
+
+    uint64_t achievements[ACH_WORDS];   /* one bit per catalog achievement */
 } player_score_t;
 
+/* Unlocks an achievement once its player's metric reaches threshold */
+typedef struct {
+    long long threshold;
+    uint16_t bit;
+} rule_t;
+
 typedef struct {
     char* id;
     char** players;
@@ -65,31 +85,94 @@ typedef struct {
 static player_score_t* g_players=NULL;
 static int g_player_count=0;
 
+/* player id -> index + 1, 0 = empty */
+static uint32_t* g_player_index=NULL;
+static uint32_t g_player_index_cap=0;
+
 static leaderboard_t* g_boards=NULL;
 static int g_board_count=0;
 
+/* Where inline readers find the scores; moves with g_players */
+fossil_game_score_column fossil_game_score_values={ NULL,sizeof(player_score_t) };
+
 
 /* ============================================================
    Helpers
    ============================================================ */
 
+static void approx_move(long long before,long long after,int added);
+
+static uint32_t hash_str(const char* s)
+{
+    uint32_t h=2166136261u;
+    while(*s){
+        h^=(unsigned char)*s++;
+        h*=16777619u;
+    }
+    return h;
+}
+
+static int index_grow(void)
+{
+    uint32_t cap=g_player_index_cap?g_player_index_cap*2:64;
+    uint32_t* tmp=calloc(cap,sizeof(*tmp));
+    if(!tmp) return -1;
+
+    for(int i=0;i<g_player_count;i++){
+        uint32_t j=g_players[i].hash&(cap-1);
+        while(tmp[j]) j=(j+1)&(cap-1);
+        tmp[j]=(uint32_t)i+1;
+    }
+
+    free(g_player_index);
+    g_player_index=tmp;
+    g_player_index_cap=cap;
+    return 0;
+}
+
+static player_score_t* lookup_player(const char* id,uint32_t h)
+{
+    if(!g_player_index_cap) return NULL;
+
+    uint32_t mask=g_player_index_cap-1;
+    for(uint32_t i=h&mask;g_player_index[i];i=(i+1)&mask){
+        player_score_t* p=&g_players[g_player_index[i]-1];
+        if(p->hash==h && strcmp(p->id,id)==0) return p;
+    }
+    return NULL;
+}
+
 static player_score_t* find_player(const char* id)
 {
-    for(int i=0;i<g_player_count;i++)
-        if(strcmp(g_players[i].id,id)==0)
-            return &g_players[i];
+    uint32_t h=hash_str(id);
+    player_score_t* p=lookup_player(id,h);
+    if(p) return p;
 
     /* create automatically */
-    g_players=realloc(g_players,sizeof(player_score_t)*(g_player_count+1));
-    player_score_t* p=&g_players[g_player_count++];
+    if(((uint32_t)g_player_count+1)*4>g_player_index_cap*3 && index_grow()!=0) return NULL;
 
+    player_score_t* tmp=realloc(g_players,sizeof(player_score_t)*(g_player_count+1));
+    if(!tmp) return NULL;
+    FOSSIL_GAME_METRIC_ALLOC();
+    g_players=tmp;
+    fossil_game_score_values.base=(const unsigned char*)&tmp[0].score;
+
+    p=&g_players[g_player_count];
+    memset(p,0,sizeof(*p));
     p->id=fossil_strdup(id);
-    p->score=0;
-    p->achievements=NULL;
-    p->achievement_count=0;
+    if(!p->id) return NULL;
+    p->hash=h;
+
+    uint32_t i=h&(g_player_index_cap-1);
+    while(g_player_index[i]) i=(i+1)&(g_player_index_cap-1);
+    g_player_index[i]=(uint32_t)++g_player_count;
+    approx_move(0,0,1);
     return p;
 }
 
+static void check_score_rules(player_score_t* p,long long before,long long after);
+static void windows_record(uint32_t slot,int points);
+
 static leaderboard_t* find_board(const char* id)
 {
     if(!id) id = "global";
@@ -115,6 +198,7 @@ static void board_add_player(leaderboard_t* b,const char* player_id)
             return;
 
     b->players=realloc(b->players,sizeof(char*)*(b->count+1));
+    FOSSIL_GAME_METRIC_ALLOC();
     b->players[b->count++]=(char*)player_id; /* reference only */
 }
 
@@ -129,27 +213,65 @@ static int cmp_scores_desc(const void* a,const void* b)
    Score updates
    ============================================================ */
 
-int fossil_game_score_update(const char* player_id,int points)
+static int score_update(const char* player_id,int points)
 {
     if(!player_id) return -1;
     player_score_t* p=find_player(player_id);
+    if(!p) return -3;
+
+    int before=p->score;
     p->score+=points;
+    approx_move(before,p->score,0);
+    if(points>0) check_score_rules(p,before,p->score);
+    windows_record((uint32_t)(p-g_players),points);
+
+    fossil_game_wal_record_score_update(player_id,points);
     return 0;
 }
 
+int fossil_game_score_update(const char* player_id,int points)
+{
+    FOSSIL_GAME_METRIC_BEGIN(SCORE_UPDATE);
+    int rc=score_update(player_id,points);
+    FOSSIL_GAME_METRIC_END(SCORE_UPDATE);
+    return rc;
+}
+
 int fossil_game_score_get(const char* player_id,int* out_points)
 {
     if(!player_id||!out_points) return -1;
     player_score_t* p=find_player(player_id);
+    if(!p) return -3;
     *out_points=p->score;
     return 0;
 }
 
+int fossil_game_score_handle(const char* player_id,uint32_t* out_handle)
+{
+    if(!player_id||!out_handle) return -1;
+    player_score_t* p=find_player(player_id);
+    if(!p) return -3;
+    *out_handle=(uint32_t)(p-g_players);
+    return 0;
+}
+
+int fossil_game_score_get_by_handle(uint32_t handle,int* out_points)
+{
+    if(!out_points) return -1;
+    if(handle>=(uint32_t)g_player_count) return -2;
+    *out_points=g_players[handle].score;
+    return 0;
+}
+
 int fossil_game_score_reset(const char* player_id)
 {
     if(!player_id) return -1;
     player_score_t* p=find_player(player_id);
+    if(!p) return -3;
+    approx_move(p->score,0,0);
     p->score=0;
+
+    fossil_game_wal_record_score_reset(player_id);
     return 0;
 }
 
@@ -157,7 +279,7 @@ int fossil_game_score_reset(const char* player_id)
    Leaderboards
    ============================================================ */
 
-int fossil_game_score_leaderboard(
+static int score_leaderboard(
     const char* leaderboard_id,
     const char*** out_player_ids,
     int* out_count)
@@ -190,6 +312,7 @@ int fossil_game_score_leaderboard(
     qsort(sorted,board->count,sizeof(player_score_t*),cmp_scores_desc);
 
     const char** result=malloc(sizeof(char*)*board->count);
+    FOSSIL_GAME_METRIC_ALLOC();
     for(int i=0;i<board->count;i++)
         result[i]=sorted[i]->id;
 
@@ -200,11 +323,22 @@ int fossil_game_score_leaderboard(
     return 0;
 }
 
+int fossil_game_score_leaderboard(
+    const char* leaderboard_id,
+    const char*** out_player_ids,
+    int* out_count)
+{
+    FOSSIL_GAME_METRIC_BEGIN(SCORE_LEADERBOARD);
+    int rc=score_leaderboard(leaderboard_id,out_player_ids,out_count);
+    FOSSIL_GAME_METRIC_END(SCORE_LEADERBOARD);
+    return rc;
+}
+
 /* ============================================================
    Matchmaking (skill proximity search)
    ============================================================ */
 
-int fossil_game_score_matchmaking(
+static int score_matchmaking(
     const char* player_id,
     char*** out_opponents,
     int* out_count)
@@ -212,6 +346,7 @@ int fossil_game_score_matchmaking(
     if(!player_id||!out_opponents||!out_count) return -1;
 
     player_score_t* me=find_player(player_id);
+    if(!me) return -3;
 
     /* simple window search */
     int window=100;
@@ -230,6 +365,7 @@ int fossil_game_score_matchmaking(
         if(diff<=window)
         {
             matches=realloc(matches,sizeof(char*)*(count+1));
+            FOSSIL_GAME_METRIC_ALLOC();
             matches[count++]=p->id;
         }
     }
@@ -239,42 +375,1839 @@ int fossil_game_score_matchmaking(
     return 0;
 }
 
+int fossil_game_score_matchmaking(
+    const char* player_id,
+    char*** out_opponents,
+    int* out_count)
+{
+    FOSSIL_GAME_METRIC_BEGIN(SCORE_MATCHMAKING);
+    FOSSIL_GAME_TRACE_BEGIN("score_matchmaking");
+    int rc=score_matchmaking(player_id,out_opponents,out_count);
+    FOSSIL_GAME_TRACE_END("score_matchmaking");
+    FOSSIL_GAME_METRIC_END(SCORE_MATCHMAKING);
+    return rc;
+}
+
 /* ============================================================
-   Achievements
+   Windowed leaderboards
    ============================================================ */
 
-int fossil_game_score_add_achievement(
-    const char* player_id,
-    const char* achievement_id)
+/*
+ * A window covers its last bucket_count buckets of bucket_seconds each.
+ * Score deltas are aggregated per player per bucket; when a bucket falls
+ * out of the window its entries are subtracted again, so every update is
+ * added and removed once. A jump past the whole window (every tumbling
+ * boundary) bumps a generation instead: stale players reset lazily on
+ * their next update and the ranking starts empty.
+ *
+ * The ranking is a list of sorted blocks of (total desc, slot asc) keys.
+ * The blocks' first keys sit in one array for the block search and a
+ * Fenwick tree over block sizes gives the ranked count before a block, so
+ * rank and updates touch a handful of cache lines instead of a tree path.
+ */
+#define WBLOCK_MAX 512
+
+typedef struct {
+    uint32_t slot;
+    int64_t delta;
+} window_entry_t;
+
+typedef struct {
+    window_entry_t* entries;
+    uint32_t count;
+    uint32_t cap;
+} window_bucket_t;
+
+typedef struct {
+    int64_t total;
+    int64_t last_epoch;         /* bucket holding the player's newest entry */
+    uint32_t last_entry;
+    uint32_t gen;               /* stale unless equal to the window's */
+} window_player_t;
+
+typedef struct {
+    int64_t total;
+    uint32_t slot;
+} window_key_t;
+
+typedef struct {
+    window_key_t* keys;         /* WBLOCK_MAX capacity */
+    uint32_t count;
+} window_block_t;
+
+typedef struct {
+    char* id;
+    int64_t origin;
+    int64_t bucket_seconds;
+    uint32_t bucket_count;
+
+    int64_t epoch;              /* current bucket number */
+    uint32_t gen;
+    window_bucket_t* buckets;   /* bucket_count, epoch % bucket_count is current */
+
+    window_player_t* players;   /* indexed by score player slot */
+    uint32_t player_cap;
+
+    window_block_t* blocks;     /* [0,block_count) live, then spare allocations */
+    window_key_t* first;        /* first key of each live block */
+    uint32_t* fenwick;          /* block sizes, 1-based */
+    uint32_t block_count;
+    uint32_t block_alloc;
+    uint32_t block_cap;
+    uint32_t ranked;
+} score_window_t;
+
+static score_window_t* g_windows=NULL;
+static int g_window_count=0;
+static int64_t g_window_now=0;
+static int g_window_clock_set=0;
+
+static score_window_t* find_window(const char* id)
 {
-    if(!player_id||!achievement_id) return -1;
+    if(!id) return NULL;
+    for(int i=0;i<g_window_count;i++)
+        if(strcmp(g_windows[i].id,id)==0)
+            return &g_windows[i];
+    return NULL;
+}
 
-    player_score_t* p=find_player(player_id);
+static int64_t window_epoch(const score_window_t* w,int64_t now)
+{
+    int64_t d=now-w->origin;
+    return d>=0?d/w->bucket_seconds:-((-d+w->bucket_seconds-1)/w->bucket_seconds);
+}
+
+/* Does a rank above b */
+static inline int key_before(window_key_t a,window_key_t b)
+{
+    return a.total>b.total || (a.total==b.total && a.slot<b.slot);
+}
+
+static void fenwick_add(score_window_t* w,uint32_t block,int32_t d)
+{
+    for(uint32_t i=block+1;i<=w->block_count;i+=i&-i)
+        w->fenwick[i]+=(uint32_t)d;
+}
+
+static uint32_t fenwick_prefix(const score_window_t* w,uint32_t block)
+{
+    uint32_t s=0;
+    for(uint32_t i=block;i;i-=i&-i)
+        s+=w->fenwick[i];
+    return s;
+}
+
+static void fenwick_build(score_window_t* w)
+{
+    for(uint32_t i=1;i<=w->block_count;i++) w->fenwick[i]=w->blocks[i-1].count;
+    for(uint32_t i=1;i<=w->block_count;i++){
+        uint32_t j=i+(i&-i);
+        if(j<=w->block_count) w->fenwick[j]+=w->fenwick[i];
+    }
+}
+
+/* Last block whose first key does not rank below k */
+static uint32_t block_find(const score_window_t* w,window_key_t k)
+{
+    uint32_t lo=0,hi=w->block_count;
+    while(hi-lo>1){
+        uint32_t mid=(lo+hi)/2;
+        if(key_before(k,w->first[mid])) hi=mid;
+        else lo=mid;
+    }
+    return lo;
+}
+
+static uint32_t key_find(const window_block_t* b,window_key_t k)
+{
+    uint32_t lo=0,hi=b->count;
+    while(lo<hi){
+        uint32_t mid=(lo+hi)/2;
+        if(key_before(b->keys[mid],k)) lo=mid+1;
+        else hi=mid;
+    }
+    return lo;
+}
+
+/* Opens an empty block at position at */
+static int block_open(score_window_t* w,uint32_t at)
+{
+    if(w->block_alloc==w->block_cap){
+        uint32_t cap=w->block_cap?w->block_cap*2:16;
+        window_block_t* blocks=realloc(w->blocks,sizeof(*blocks)*cap);
+        if(blocks) w->blocks=blocks;
+        window_key_t* first=blocks?realloc(w->first,sizeof(*first)*cap):NULL;
+        if(first) w->first=first;
+        uint32_t* fen=first?realloc(w->fenwick,sizeof(*fen)*(cap+1)):NULL;
+        if(!fen) return -3;
+        w->fenwick=fen;
+        w->block_cap=cap;
+    }
+
+    window_key_t* keys;
+    if(w->block_count<w->block_alloc){
+        keys=w->blocks[w->block_count].keys;
+    }else{
+        keys=malloc(sizeof(*keys)*WBLOCK_MAX);
+        if(!keys) return -3;
+        w->block_alloc++;
+    }
+
+    memmove(&w->blocks[at+1],&w->blocks[at],sizeof(*w->blocks)*(w->block_count-at));
+    memmove(&w->first[at+1],&w->first[at],sizeof(*w->first)*(w->block_count-at));
+    w->blocks[at].keys=keys;
+    w->blocks[at].count=0;
+    w->block_count++;
+    return 0;
+}
+
+/* Retires an empty block to the spare allocations */
+static void block_close(score_window_t* w,uint32_t at)
+{
+    window_key_t* keys=w->blocks[at].keys;
+    w->block_count--;
+    memmove(&w->blocks[at],&w->blocks[at+1],sizeof(*w->blocks)*(w->block_count-at));
+    memmove(&w->first[at],&w->first[at+1],sizeof(*w->first)*(w->block_count-at));
+    w->blocks[w->block_count].keys=keys;
+    fenwick_build(w);
+}
+
+static int rank_insert(score_window_t* w,window_key_t k)
+{
+    if(!w->block_count){
+        if(block_open(w,0)!=0) return -3;
+        fenwick_build(w);
+    }
+
+    uint32_t bi=block_find(w,k);
+    window_block_t* b=&w->blocks[bi];
+
+    if(b->count==WBLOCK_MAX){
+        if(block_open(w,bi+1)!=0) return -3;
+        b=&w->blocks[bi];
+        window_block_t* nb=&w->blocks[bi+1];
+        nb->count=WBLOCK_MAX/2;
+        memcpy(nb->keys,b->keys+WBLOCK_MAX/2,sizeof(*nb->keys)*nb->count);
+        b->count=WBLOCK_MAX/2;
+        w->first[bi+1]=nb->keys[0];
+        fenwick_build(w);
+        if(!key_before(k,w->first[bi+1])) b=nb,bi++;
+    }
 
-    /* prevent duplicates */
-    for(int i=0;i<p->achievement_count;i++)
-        if(strcmp(p->achievements[i],achievement_id)==0)
+    uint32_t pos=key_find(b,k);
+    memmove(&b->keys[pos+1],&b->keys[pos],sizeof(*b->keys)*(b->count-pos));
+    b->keys[pos]=k;
+    b->count++;
+    if(pos==0) w->first[bi]=k;
+    fenwick_add(w,bi,1);
+    w->ranked++;
+    return 0;
+}
+
+static void rank_erase(score_window_t* w,window_key_t k)
+{
+    uint32_t bi=block_find(w,k);
+    window_block_t* b=&w->blocks[bi];
+    uint32_t pos=key_find(b,k);
+
+    b->count--;
+    memmove(&b->keys[pos],&b->keys[pos+1],sizeof(*b->keys)*(b->count-pos));
+    w->ranked--;
+
+    if(!b->count){
+        block_close(w,bi);
+        return;
+    }
+    if(pos==0) w->first[bi]=b->keys[0];
+    fenwick_add(w,bi,-1);
+}
+
+/* Moves a player to its new total; zero totals leave the ranking */
+static int window_move(score_window_t* w,uint32_t slot,int64_t delta)
+{
+    window_player_t* p=&w->players[slot];
+    if(!delta) return 0;
+
+    if(p->total){
+        window_key_t old={ p->total,slot };
+        window_key_t now={ p->total+delta,slot };
+
+        /* a small change usually lands in the same block: shift in place */
+        uint32_t bi=block_find(w,old);
+        window_block_t* b=&w->blocks[bi];
+        if(now.total && !key_before(now,b->keys[0]) && !key_before(b->keys[b->count-1],now) &&
+           (bi+1==w->block_count || key_before(now,w->first[bi+1]))){
+            uint32_t from=key_find(b,old);
+            uint32_t to=key_find(b,now);
+            if(to>from){
+                to--;
+                memmove(&b->keys[from],&b->keys[from+1],sizeof(*b->keys)*(to-from));
+            }else{
+                memmove(&b->keys[to+1],&b->keys[to],sizeof(*b->keys)*(from-to));
+            }
+            b->keys[to]=now;
+            w->first[bi]=b->keys[0];
+            p->total=now.total;
             return 0;
+        }
+        rank_erase(w,old);
+    }
+
+    p->total+=delta;
+    if(p->total){
+        window_key_t k={ p->total,slot };
+        return rank_insert(w,k);
+    }
+    return 0;
+}
+
+/* Subtracts the entries of a bucket leaving the window */
+static void window_expire(score_window_t* w,window_bucket_t* b,int64_t epoch)
+{
+    for(uint32_t i=0;i<b->count;i++){
+        const window_entry_t* e=&b->entries[i];
+        window_player_t* p=&w->players[e->slot];
+        if(p->gen!=w->gen) continue;
+
+        window_move(w,e->slot,-e->delta);
+        if(p->last_epoch==epoch) p->last_epoch=INT64_MIN;
+    }
+    b->count=0;
+}
+
+/* Ring slot of an epoch; epochs before origin are negative */
+static inline window_bucket_t* window_bucket(score_window_t* w,int64_t epoch)
+{
+    int64_t n=(int64_t)w->bucket_count;
+    return &w->buckets[((epoch%n)+n)%n];
+}
+
+static void window_rotate(score_window_t* w,int64_t epoch)
+{
+    if(epoch<=w->epoch) return;
+
+    if(epoch-w->epoch>=(int64_t)w->bucket_count){
+        w->gen++;
+        w->block_count=0;
+        w->ranked=0;
+        for(uint32_t i=0;i<w->bucket_count;i++) w->buckets[i].count=0;
+        w->epoch=epoch;
+        return;
+    }
+
+    while(w->epoch<epoch){
+        w->epoch++;
+        window_bucket_t* b=window_bucket(w,w->epoch);
+        window_expire(w,b,w->epoch-(int64_t)w->bucket_count);
+    }
+}
+
+static int window_reserve(score_window_t* w,uint32_t slot)
+{
+    if(slot<w->player_cap) return 0;
 
-    p->achievements=realloc(
-        p->achievements,
-        sizeof(char*)*(p->achievement_count+1));
+    uint32_t cap=w->player_cap?w->player_cap:1024;
+    while(cap<=slot) cap*=2;
 
-    p->achievements[p->achievement_count++]=strdup(achievement_id);
+    window_player_t* tmp=realloc(w->players,sizeof(*tmp)*cap);
+    if(!tmp) return -3;
+    memset(tmp+w->player_cap,0,sizeof(*tmp)*(cap-w->player_cap));
+    w->players=tmp;
+    w->player_cap=cap;
     return 0;
 }
 
-int fossil_game_score_has_achievement(
-    const char* player_id,
-    const char* achievement_id)
+static int window_record(score_window_t* w,uint32_t slot,int points)
 {
-    if(!player_id||!achievement_id) return 0;
+    /* a window opens at its origin; earlier updates do not count */
+    if(w->epoch<0) return 0;
+    if(window_reserve(w,slot)!=0) return -3;
 
-    player_score_t* p=find_player(player_id);
+    window_player_t* p=&w->players[slot];
+    if(p->gen!=w->gen){
+        memset(p,0,sizeof(*p));
+        p->gen=w->gen;
+        p->last_epoch=INT64_MIN;
+    }
 
-    for(int i=0;i<p->achievement_count;i++)
-        if(strcmp(p->achievements[i],achievement_id)==0)
-            return 1;
+    window_bucket_t* b=window_bucket(w,w->epoch);
+    if(p->last_epoch==w->epoch){
+        b->entries[p->last_entry].delta+=points;
+    }else{
+        if(b->count==b->cap){
+            uint32_t cap=b->cap?b->cap*2:256;
+            window_entry_t* tmp=realloc(b->entries,sizeof(*tmp)*cap);
+            if(!tmp) return -3;
+            b->entries=tmp;
+            b->cap=cap;
+        }
+        b->entries[b->count]=(window_entry_t){ slot,points };
+        p->last_epoch=w->epoch;
+        p->last_entry=b->count++;
+    }
+
+    return window_move(w,slot,points);
+}
+
+static void windows_record(uint32_t slot,int points)
+{
+    for(int i=0;i<g_window_count;i++)
+        window_record(&g_windows[i],slot,points);
+}
+
+static int window_slot(const score_window_t* w,const char* player_id,uint32_t* out)
+{
+    player_score_t* p=lookup_player(player_id,hash_str(player_id));
+    if(!p) return -2;
+
+    uint32_t slot=(uint32_t)(p-g_players);
+    if(slot>=w->player_cap || w->players[slot].gen!=w->gen) return -2;
+    *out=slot;
+    return 0;
+}
+
+int fossil_game_score_window_create(const char* window_id,int64_t origin,int64_t bucket_seconds,uint32_t bucket_count)
+{
+    if(!window_id||bucket_seconds<=0||bucket_count==0) return -1;
+    if(find_window(window_id)) return -5;
+
+    if(!g_window_clock_set){
+        g_window_now=(int64_t)time(NULL);
+        g_window_clock_set=1;
+    }
+
+    score_window_t* tmp=realloc(g_windows,sizeof(*tmp)*(g_window_count+1));
+    if(!tmp) return -3;
+    g_windows=tmp;
+
+    score_window_t* w=&g_windows[g_window_count];
+    memset(w,0,sizeof(*w));
+    w->id=fossil_strdup(window_id);
+    w->buckets=calloc(bucket_count,sizeof(*w->buckets));
+    if(!w->id||!w->buckets){
+        free(w->id); free(w->buckets);
+        return -3;
+    }
+
+    w->origin=origin;
+    w->bucket_seconds=bucket_seconds;
+    w->bucket_count=bucket_count;
+    w->gen=1;
+    w->epoch=window_epoch(w,g_window_now);
+    g_window_count++;
+    return 0;
+}
+
+int fossil_game_score_window_destroy(const char* window_id)
+{
+    score_window_t* w=find_window(window_id);
+    if(!w) return -2;
+
+    for(uint32_t i=0;i<w->bucket_count;i++) free(w->buckets[i].entries);
+    for(uint32_t i=0;i<w->block_alloc;i++) free(w->blocks[i].keys);
+    free(w->buckets);
+    free(w->players);
+    free(w->blocks);
+    free(w->first);
+    free(w->fenwick);
+    free(w->id);
+
+    *w=g_windows[--g_window_count];
+    return 0;
+}
+
+void fossil_game_score_window_advance(int64_t now)
+{
+    if(g_window_clock_set && now<g_window_now) return;
+    g_window_now=now;
+    g_window_clock_set=1;
+
+    for(int i=0;i<g_window_count;i++)
+        window_rotate(&g_windows[i],window_epoch(&g_windows[i],now));
+}
+
+int fossil_game_score_window_get(const char* window_id,const char* player_id,long long* out)
+{
+    score_window_t* w=find_window(window_id);
+    if(!w||!player_id||!out) return -1;
+
+    uint32_t slot;
+    *out=window_slot(w,player_id,&slot)==0?w->players[slot].total:0;
+    return 0;
+}
+
+int fossil_game_score_window_rank(const char* window_id,const char* player_id,int* out_rank)
+{
+    score_window_t* w=find_window(window_id);
+    if(!w||!player_id||!out_rank) return -1;
+
+    uint32_t slot;
+    if(window_slot(w,player_id,&slot)!=0 || !w->players[slot].total) return -2;
+
+    window_key_t k={ w->players[slot].total,slot };
+    uint32_t bi=block_find(w,k);
+    *out_rank=(int)(fenwick_prefix(w,bi)+key_find(&w->blocks[bi],k)+1);
+    return 0;
+}
+
+int fossil_game_score_window_count(const char* window_id)
+{
+    score_window_t* w=find_window(window_id);
+    return w?(int)w->ranked:-1;
+}
+
+int fossil_game_score_window_top(const char* window_id,const char** out_ids,long long* out_scores,int cap,int* out_count)
+{
+    score_window_t* w=find_window(window_id);
+    if(!w||cap<0||!out_count) return -1;
+
+    int n=0;
+    for(uint32_t bi=0;bi<w->block_count && n<cap;bi++){
+        const window_block_t* b=&w->blocks[bi];
+        for(uint32_t i=0;i<b->count && n<cap;i++,n++){
+            if(out_ids) out_ids[n]=g_players[b->keys[i].slot].id;
+            if(out_scores) out_scores[n]=b->keys[i].total;
+        }
+    }
+    *out_count=n;
+    return 0;
+}
 
+/* ============================================================
+   Ratings (Glicko-2)
+   ============================================================ */
+
+/*
+ * Ratings are columns parallel to g_players on the Glicko-2 scale; the
+ * public API speaks the Glicko scale (1500, deviation 350). A rating
+ * period runs as flat passes: resolve every result to slots, accumulate
+ * v^-1 and the score-expectation sum per player against the pre-period
+ * ratings, then one loop over the columns updates everyone. Players who
+ * sat the period out only widen their deviation, as Glicko-2 specifies.
+ */
+#define RATING_SCALE 173.7178
+#define RATING_BASE 1500.0
+#define RATING_PHI_MAX (350.0/RATING_SCALE)
+#define RATING_SIGMA 0.06
+#define RATING_EPSILON 0.000001
+#define RATING_PI2 9.8696044010893586
+
+static double* g_rating_mu=NULL;
+static double* g_rating_phi=NULL;
+static double* g_rating_sigma=NULL;
+static int g_rating_count=0;
+static int g_rating_cap=0;
+static double g_rating_tau=0.5;
+
+/* Gives every player a rating column, new ones at the defaults */
+static int rating_reserve(void)
+{
+    if(g_player_count>g_rating_cap){
+        int cap=g_rating_cap?g_rating_cap:1024;
+        while(cap<g_player_count) cap*=2;
+
+        double* mu=realloc(g_rating_mu,sizeof(double)*(size_t)cap);
+        if(mu) g_rating_mu=mu;
+        double* phi=mu?realloc(g_rating_phi,sizeof(double)*(size_t)cap):NULL;
+        if(phi) g_rating_phi=phi;
+        double* sigma=phi?realloc(g_rating_sigma,sizeof(double)*(size_t)cap):NULL;
+        if(!sigma) return -3;
+        g_rating_sigma=sigma;
+        g_rating_cap=cap;
+    }
+
+    for(;g_rating_count<g_player_count;g_rating_count++){
+        g_rating_mu[g_rating_count]=0.0;
+        g_rating_phi[g_rating_count]=RATING_PHI_MAX;
+        g_rating_sigma[g_rating_count]=RATING_SIGMA;
+    }
     return 0;
 }
+
+static inline double rating_g(double phi)
+{
+    return 1.0/sqrt(1.0+3.0*phi*phi/RATING_PI2);
+}
+
+static double volatility_f(double x,double delta2,double phi2,double v,double a)
+{
+    double ex=exp(x);
+    double d=phi2+v+ex;
+    return ex*(delta2-phi2-v-ex)/(2.0*d*d)-(x-a)/(g_rating_tau*g_rating_tau);
+}
+
+/* Step 5 of Glickman's paper: Illinois iteration for the new volatility */
+static double rating_volatility(double phi,double sigma,double delta,double v)
+{
+    double delta2=delta*delta,phi2=phi*phi;
+    double a=log(sigma*sigma);
+    double A=a,B;
+
+    if(delta2>phi2+v){
+        B=log(delta2-phi2-v);
+    }else{
+        int k=1;
+        while(volatility_f(a-k*g_rating_tau,delta2,phi2,v,a)<0 && k<64) k++;
+        B=a-k*g_rating_tau;
+    }
+
+    double fA=volatility_f(A,delta2,phi2,v,a);
+    double fB=volatility_f(B,delta2,phi2,v,a);
+    for(int i=0;i<100 && fabs(B-A)>RATING_EPSILON;i++){
+        double C=A+(A-B)*fA/(fB-fA);
+        double fC=volatility_f(C,delta2,phi2,v,a);
+        if(fC*fB<0){
+            A=B;
+            fA=fB;
+        }else{
+            fA/=2.0;
+        }
+        B=C;
+        fB=fC;
+    }
+    return exp(A/2.0);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RATING_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define RATING_PREFETCH(p) ((void)(p))
+#endif
+
+#define RESOLVE_GROUP 32
+
+/* Per-player period state packed so each result touches one line per player */
+typedef struct {
+    double mu;
+    double g;
+    double v;                   /* sum g^2 E (1-E); 0 = no games this period */
+    double d;                   /* sum g (s - E) */
+} rating_scratch_t;
+
+/*
+ * Maps both ids of every result to player slots. Lookups run a group at a
+ * time, touching each level (index slot, player, id string) for the whole
+ * group before the next, so a million-player index costs overlapped cache
+ * misses rather than one full miss chain per id.
+ */
+static int resolve_results(const fossil_game_score_match_result* results,size_t count,uint32_t* slots)
+{
+    uint32_t hash[2*RESOLVE_GROUP];
+    uint32_t at[2*RESOLVE_GROUP];
+
+    for(size_t base=0;base<count;base+=RESOLVE_GROUP){
+        size_t n=count-base<RESOLVE_GROUP?2*(count-base):2*RESOLVE_GROUP;
+        const fossil_game_score_match_result* r=results+base;
+        uint32_t mask=g_player_index_cap?g_player_index_cap-1:0;
+
+        for(size_t k=0;k<n;k++){
+            hash[k]=hash_str(k&1?r[k/2].player_b:r[k/2].player_a);
+            if(g_player_index_cap) RATING_PREFETCH(&g_player_index[hash[k]&mask]);
+        }
+        for(size_t k=0;k<n;k++){
+            at[k]=g_player_index_cap?g_player_index[hash[k]&mask]:0;
+            if(at[k]) RATING_PREFETCH(&g_players[at[k]-1]);
+        }
+        for(size_t k=0;k<n;k++)
+            if(at[k]) RATING_PREFETCH(g_players[at[k]-1].id);
+
+        for(size_t k=0;k<n;k++){
+            const char* id=k&1?r[k/2].player_b:r[k/2].player_a;
+            player_score_t* p=lookup_player(id,hash[k]);
+            if(!p) p=find_player(id);
+            if(!p) return -3;
+            slots[2*base+k]=(uint32_t)(p-g_players);
+        }
+    }
+    return 0;
+}
+
+static int score_rating_period(const fossil_game_score_match_result* results,size_t count)
+{
+    if(!results&&count) return -1;
+    for(size_t i=0;i<count;i++)
+        if(!results[i].player_a||!results[i].player_b||
+           strcmp(results[i].player_a,results[i].player_b)==0)
+            return -1;
+
+    uint32_t* slots=count?malloc(sizeof(uint32_t)*2*count):NULL;
+    if(count&&!slots) return -3;
+
+    if(resolve_results(results,count,slots)!=0){
+        free(slots);
+        return -3;
+    }
+
+    size_t n=(size_t)g_player_count;
+    rating_scratch_t* t=malloc(sizeof(*t)*(n?n:1));
+    if(!t||rating_reserve()!=0){
+        free(slots); free(t);
+        return -3;
+    }
+
+    double* phi=g_rating_phi;
+    double* sigma=g_rating_sigma;
+
+    for(size_t i=0;i<n;i++){
+        t[i].mu=g_rating_mu[i];
+        t[i].g=rating_g(phi[i]);
+        t[i].v=0.0;
+        t[i].d=0.0;
+    }
+
+    /* every expectation uses the ratings from before the period */
+    for(size_t i=0;i<count;i++){
+        rating_scratch_t* a=&t[slots[2*i]];
+        rating_scratch_t* b=&t[slots[2*i+1]];
+        double s=results[i].score_a;
+
+        double ea=1.0/(1.0+exp(-b->g*(a->mu-b->mu)));
+        double eb=1.0/(1.0+exp(-a->g*(b->mu-a->mu)));
+        a->v+=b->g*b->g*ea*(1.0-ea);
+        a->d+=b->g*(s-ea);
+        b->v+=a->g*a->g*eb*(1.0-eb);
+        b->d+=a->g*((1.0-s)-eb);
+    }
+
+    for(size_t i=0;i<n;i++){
+        if(t[i].v==0.0){
+            double p=sqrt(phi[i]*phi[i]+sigma[i]*sigma[i]);
+            phi[i]=p<RATING_PHI_MAX?p:RATING_PHI_MAX;
+            continue;
+        }
+
+        double vi=1.0/t[i].v;
+        sigma[i]=rating_volatility(phi[i],sigma[i],vi*t[i].d,vi);
+        double pre=phi[i]*phi[i]+sigma[i]*sigma[i];
+        double p=1.0/sqrt(1.0/pre+t[i].v);
+        phi[i]=p;
+        g_rating_mu[i]+=p*p*t[i].d;
+    }
+
+    free(slots);
+    free(t);
+    return 0;
+}
+
+int fossil_game_score_rating_period(const fossil_game_score_match_result* results,size_t count)
+{
+    FOSSIL_GAME_METRIC_BEGIN(SCORE_RATING_PERIOD);
+    FOSSIL_GAME_TRACE_BEGIN("score_rating_period");
+    int rc=score_rating_period(results,count);
+    FOSSIL_GAME_TRACE_END("score_rating_period");
+    FOSSIL_GAME_METRIC_END(SCORE_RATING_PERIOD);
+    return rc;
+}
+
+int fossil_game_score_rating_get(const char* player_id,double* out_rating,double* out_deviation,double* out_volatility)
+{
+    if(!player_id) return -1;
+    player_score_t* p=lookup_player(player_id,hash_str(player_id));
+    if(!p) return -2;
+
+    int i=(int)(p-g_players);
+    int rated=i<g_rating_count;
+    if(out_rating) *out_rating=RATING_BASE+RATING_SCALE*(rated?g_rating_mu[i]:0.0);
+    if(out_deviation) *out_deviation=RATING_SCALE*(rated?g_rating_phi[i]:RATING_PHI_MAX);
+    if(out_volatility) *out_volatility=rated?g_rating_sigma[i]:RATING_SIGMA;
+    return 0;
+}
+
+int fossil_game_score_rating_set(const char* player_id,double rating,double deviation,double volatility)
+{
+    if(!player_id||deviation<=0||volatility<=0) return -1;
+    player_score_t* p=find_player(player_id);
+    if(!p||rating_reserve()!=0) return -3;
+
+    int i=(int)(p-g_players);
+    g_rating_mu[i]=(rating-RATING_BASE)/RATING_SCALE;
+    g_rating_phi[i]=deviation/RATING_SCALE;
+    g_rating_sigma[i]=volatility;
+    return 0;
+}
+
+int fossil_game_score_rating_set_tau(double tau)
+{
+    if(tau<=0) return -1;
+    g_rating_tau=tau;
+    return 0;
+}
+
+int fossil_game_score_rating_matchmaking(const char* player_id,double k,char*** out_opponents,int* out_count)
+{
+    if(!player_id||k<0||!out_opponents||!out_count) return -1;
+
+    player_score_t* me=find_player(player_id);
+    if(!me||rating_reserve()!=0) return -3;
+
+    int self=(int)(me-g_players);
+    double mu=g_rating_mu[self];
+    double phi2=g_rating_phi[self]*g_rating_phi[self];
+    double k2=k*k;
+
+    char** matches=NULL;
+    int count=0,cap=0;
+
+    /* within k combined deviations, compared squared */
+    for(int i=0;i<g_player_count;i++){
+        double diff=g_rating_mu[i]-mu;
+        if(i==self || diff*diff>k2*(phi2+g_rating_phi[i]*g_rating_phi[i])) continue;
+
+        if(count==cap){
+            cap=cap?cap*2:16;
+            char** tmp=realloc(matches,sizeof(char*)*(size_t)cap);
+            if(!tmp){ free(matches); return -3; }
+            FOSSIL_GAME_METRIC_ALLOC();
+            matches=tmp;
+        }
+        matches[count++]=g_players[i].id;
+    }
+
+    *out_opponents=matches;
+    *out_count=count;
+    return 0;
+}
+
+/* ============================================================
+   Shard exports
+   ============================================================ */
+
+/*
+ * Score histograms use fixed log-linear buckets: values below 16 get
+ * their own bucket, larger magnitudes 16 buckets per power of two, so a
+ * bucket never spans more than 1/16 of its values. Negative scores mirror
+ * the positive side below zero. Every process buckets alike, which is
+ * what lets shard histograms merge by adding counts.
+ */
+#define HIST_SIDE 976
+#define HIST_BUCKETS (2*HIST_SIDE)
+
+#define SHARD_MAGIC "FGSX"
+#define SHARD_VERSION 1
+
+static uint32_t magnitude_bucket(uint64_t u)
+{
+    if(u<16) return (uint32_t)u;
+#if defined(__GNUC__) || defined(__clang__)
+    int e=63-__builtin_clzll(u);
+#else
+    int e=0;
+    for(int step=32;step;step/=2)
+        if(u>>(e+step)) e+=step;
+#endif
+    return 16+(uint32_t)(e-4)*16+(uint32_t)((u>>(e-4))&15);
+}
+
+static uint64_t magnitude_floor(uint32_t b)
+{
+    if(b<16) return b;
+    uint32_t e=(b-16)/16+4;
+    return ((uint64_t)16|((b-16)%16))<<(e-4);
+}
+
+static uint32_t hist_bucket(long long v)
+{
+    if(v>=0) return HIST_SIDE+magnitude_bucket((uint64_t)v);
+    return HIST_SIDE-1-magnitude_bucket((uint64_t)-(v+1));
+}
+
+/* Inclusive value range of a bucket */
+static void hist_bounds(uint32_t b,long long* lo,long long* hi)
+{
+    if(b>=HIST_SIDE){
+        uint32_t m=b-HIST_SIDE;
+        *lo=(long long)magnitude_floor(m);
+        *hi=m+1<HIST_SIDE?(long long)(magnitude_floor(m+1)-1):LLONG_MAX;
+    }else{
+        uint32_t m=HIST_SIDE-1-b;
+        *hi=-(long long)magnitude_floor(m)-1;
+        *lo=m+1<HIST_SIDE?-(long long)(magnitude_floor(m+1)-1)-1:LLONG_MIN;
+    }
+}
+
+/*
+ * Entries above score inside its own bucket of `count` entries, assuming
+ * they spread evenly over the bucket's values. The estimate can be off by
+ * at most the bucket's count, and is exact for single-value buckets.
+ */
+static long long hist_within(uint32_t sb,long long score,uint64_t count,long long* out_error)
+{
+    long long lo,hi;
+    hist_bounds(sb,&lo,&hi);
+    if(out_error) *out_error=hi>lo?(long long)count:0;
+    if(hi==lo) return 0;
+
+    double frac=((double)hi-(double)score)/((double)hi-(double)lo+1.0);
+    return (long long)(frac*(double)count);
+}
+
+/* Entries strictly above score, given counts per bucket */
+static long long hist_above(const uint64_t* hist,long long score,long long* out_error)
+{
+    uint32_t sb=hist_bucket(score);
+    long long above=0;
+    for(uint32_t b=sb+1;b<HIST_BUCKETS;b++) above+=(long long)hist[b];
+    return above+hist_within(sb,score,hist[sb],out_error);
+}
+
+typedef struct {
+    unsigned char* buf;
+    size_t len;
+    size_t cap;
+    int err;
+} shard_writer_t;
+
+static void shard_put(shard_writer_t* w,const void* data,size_t n)
+{
+    if(w->err) return;
+    if(w->len+n>w->cap){
+        size_t cap=w->cap?w->cap*2:256;
+        while(cap<w->len+n) cap*=2;
+        unsigned char* tmp=realloc(w->buf,cap);
+        if(!tmp){ w->err=-3; return; }
+        w->buf=tmp;
+        w->cap=cap;
+    }
+    memcpy(w->buf+w->len,data,n);
+    w->len+=n;
+}
+
+static void shard_put_u64(shard_writer_t* w,uint64_t v)
+{
+    unsigned char out[10];
+    size_t n=0;
+    while(v>=0x80){
+        out[n++]=(unsigned char)(v|0x80);
+        v>>=7;
+    }
+    out[n++]=(unsigned char)v;
+    shard_put(w,out,n);
+}
+
+static void shard_put_i64(shard_writer_t* w,long long v)
+{
+    shard_put_u64(w,((uint64_t)v<<1)^(uint64_t)(v>>63));
+}
+
+typedef struct {
+    const unsigned char* pos;
+    const unsigned char* end;
+    int err;
+} shard_reader_t;
+
+static uint64_t shard_get_u64(shard_reader_t* r)
+{
+    uint64_t v=0;
+    for(int shift=0;shift<64;shift+=7){
+        if(r->pos==r->end){ r->err=-2; return 0; }
+        unsigned char b=*r->pos++;
+        v|=(uint64_t)(b&0x7f)<<shift;
+        if(!(b&0x80)) return v;
+    }
+    r->err=-2;
+    return 0;
+}
+
+static long long shard_get_i64(shard_reader_t* r)
+{
+    uint64_t v=shard_get_u64(r);
+    return (long long)(v>>1)^-(long long)(v&1);
+}
+
+/* Min-heap on score keeping the best k players seen */
+static void top_sift(const player_score_t** heap,int n,int i)
+{
+    for(;;){
+        int l=2*i+1,r=l+1,m=i;
+        if(l<n && heap[l]->score<heap[m]->score) m=l;
+        if(r<n && heap[r]->score<heap[m]->score) m=r;
+        if(m==i) return;
+        const player_score_t* t=heap[i]; heap[i]=heap[m]; heap[m]=t;
+        i=m;
+    }
+}
+
+static void top_offer(const player_score_t** heap,int* n,int k,const player_score_t* p)
+{
+    if(*n<k){
+        int i=(*n)++;
+        heap[i]=p;
+        while(i && heap[(i-1)/2]->score>heap[i]->score){
+            const player_score_t* t=heap[i]; heap[i]=heap[(i-1)/2]; heap[(i-1)/2]=t;
+            i=(i-1)/2;
+        }
+    }else if(p->score>heap[0]->score){
+        heap[0]=p;
+        top_sift(heap,*n,0);
+    }
+}
+
+int fossil_game_score_shard_export(const char* leaderboard_id,int k,unsigned char** out_buf,size_t* out_len)
+{
+    if(k<0||!out_buf||!out_len) return -1;
+
+    leaderboard_t* board=find_board(leaderboard_id);
+    int everyone=board->count==0;
+    int members=everyone?g_player_count:board->count;
+
+    const player_score_t** heap=malloc(sizeof(*heap)*(size_t)(k?k:1));
+    uint64_t* hist=calloc(HIST_BUCKETS,sizeof(*hist));
+    if(!heap||!hist){ free(heap); free(hist); return -3; }
+
+    int n=0;
+    for(int i=0;i<members;i++){
+        const player_score_t* p=everyone?&g_players[i]:lookup_player(board->players[i],hash_str(board->players[i]));
+        if(!p) continue;
+        hist[hist_bucket(p->score)]++;
+        if(k) top_offer(heap,&n,k,p);
+    }
+
+    /* pop the heap back to front for descending order */
+    for(int end=n-1;end>0;end--){
+        const player_score_t* t=heap[0]; heap[0]=heap[end]; heap[end]=t;
+        top_sift(heap,end,0);
+    }
+
+    shard_writer_t w={0};
+    shard_put(&w,SHARD_MAGIC,4);
+    shard_put_u64(&w,SHARD_VERSION);
+    shard_put_u64(&w,(uint64_t)members);
+    shard_put_u64(&w,(uint64_t)n);
+    for(int i=0;i<n;i++){
+        size_t len=strlen(heap[i]->id);
+        shard_put_u64(&w,len);
+        shard_put(&w,heap[i]->id,len);
+        shard_put_i64(&w,heap[i]->score);
+    }
+
+    uint64_t used=0;
+    for(uint32_t b=0;b<HIST_BUCKETS;b++) used+=hist[b]!=0;
+    shard_put_u64(&w,used);
+    for(uint32_t b=0,prev=0;b<HIST_BUCKETS;b++){
+        if(!hist[b]) continue;
+        shard_put_u64(&w,b-prev);
+        shard_put_u64(&w,hist[b]);
+        prev=b;
+    }
+
+    free(heap);
+    free(hist);
+    if(w.err){ free(w.buf); return w.err; }
+
+    *out_buf=w.buf;
+    *out_len=w.len;
+    return 0;
+}
+
+struct fossil_game_score_merged {
+    long long total;
+    int count;
+    char** ids;
+    long long* scores;
+    uint64_t hist[HIST_BUCKETS];
+};
+
+typedef struct {
+    const char* id;
+    size_t id_len;
+    long long score;
+} shard_entry_t;
+
+/* Parses one export: its top entries (ids borrowed from data) and histogram */
+static int shard_parse(const unsigned char* data,size_t len,shard_entry_t** out_top,int* out_count,
+                       long long* out_members,uint64_t* hist)
+{
+    if(!data||len<4||memcmp(data,SHARD_MAGIC,4)!=0) return -2;
+
+    shard_reader_t r={ data+4,data+len,0 };
+    if(shard_get_u64(&r)!=SHARD_VERSION) return -2;
+    uint64_t members=shard_get_u64(&r);
+    uint64_t n=shard_get_u64(&r);
+    if(r.err || n>(uint64_t)(r.end-r.pos) || n>members) return -2;
+
+    shard_entry_t* top=malloc(sizeof(*top)*(size_t)(n?n:1));
+    if(!top) return -3;
+
+    for(uint64_t i=0;i<n && !r.err;i++){
+        uint64_t id_len=shard_get_u64(&r);
+        if(r.err || id_len>(uint64_t)(r.end-r.pos)){ r.err=-2; break; }
+        top[i].id=(const char*)r.pos;
+        top[i].id_len=(size_t)id_len;
+        r.pos+=id_len;
+        top[i].score=shard_get_i64(&r);
+        if(i && top[i].score>top[i-1].score) r.err=-2;
+    }
+
+    uint64_t used=r.err?0:shard_get_u64(&r);
+    uint64_t b=0,sum=0;
+    for(uint64_t i=0;i<used && !r.err;i++){
+        b+=shard_get_u64(&r);
+        uint64_t c=shard_get_u64(&r);
+        if(b>=HIST_BUCKETS){ r.err=-2; break; }
+        hist[b]+=c;
+        sum+=c;
+    }
+    if(!r.err && (r.pos!=r.end || sum!=members)) r.err=-2;
+
+    if(r.err){ free(top); return r.err; }
+    *out_top=top;
+    *out_count=(int)n;
+    *out_members=(long long)members;
+    return 0;
+}
+
+int fossil_game_score_shard_merge(const unsigned char* const* exports,const size_t* lens,int count,int k,
+                                  fossil_game_score_merged** out)
+{
+    if((!exports||!lens)&&count) return -1;
+    if(count<0||k<0||!out) return -1;
+
+    fossil_game_score_merged* m=calloc(1,sizeof(*m));
+    shard_entry_t** tops=calloc((size_t)(count?count:1),sizeof(*tops));
+    int* counts=calloc((size_t)(count?count:1),sizeof(*counts));
+    int* heads=calloc((size_t)(count?count:1),sizeof(*heads));
+    int rc=m&&tops&&counts&&heads?0:-3;
+
+    /* a truncated shard list is only complete down to its own length */
+    for(int s=0;s<count && !rc;s++){
+        long long members=0;
+        rc=shard_parse(exports[s],lens[s],&tops[s],&counts[s],&members,m->hist);
+        m->total+=members;
+        if(!rc && counts[s]<members && counts[s]<k) k=counts[s];
+    }
+
+    if(!rc){
+        m->ids=malloc(sizeof(char*)*(size_t)(k?k:1));
+        m->scores=malloc(sizeof(long long)*(size_t)(k?k:1));
+        if(!m->ids||!m->scores) rc=-3;
+    }
+
+    /* k picks, each comparing the N shard heads: O(K*N) */
+    while(!rc && m->count<k){
+        int best=-1;
+        for(int s=0;s<count;s++)
+            if(heads[s]<counts[s] && (best<0 || tops[s][heads[s]].score>tops[best][heads[best]].score))
+                best=s;
+        if(best<0) break;
+
+        const shard_entry_t* e=&tops[best][heads[best]++];
+        char* id=malloc(e->id_len+1);
+        if(!id){ rc=-3; break; }
+        memcpy(id,e->id,e->id_len);
+        id[e->id_len]='\0';
+        m->ids[m->count]=id;
+        m->scores[m->count++]=e->score;
+    }
+
+    for(int s=0;s<count && tops;s++) free(tops[s]);
+    free(tops); free(counts); free(heads);
+
+    if(rc){
+        fossil_game_score_merged_free(m);
+        return rc;
+    }
+    *out=m;
+    return 0;
+}
+
+int fossil_game_score_merged_top(const fossil_game_score_merged* m,const char** out_ids,long long* out_scores,int cap,int* out_count)
+{
+    if(!m||cap<0||!out_count) return -1;
+
+    int n=m->count<cap?m->count:cap;
+    for(int i=0;i<n;i++){
+        if(out_ids) out_ids[i]=m->ids[i];
+        if(out_scores) out_scores[i]=m->scores[i];
+    }
+    *out_count=n;
+    return 0;
+}
+
+long long fossil_game_score_merged_total(const fossil_game_score_merged* m)
+{
+    return m?m->total:-1;
+}
+
+int fossil_game_score_merged_rank(const fossil_game_score_merged* m,long long score,long long* out_rank,long long* out_error)
+{
+    if(!m||!out_rank) return -1;
+
+    /* every entry above a score that makes the merged top-K is in it */
+    if(m->count && score>=m->scores[m->count-1]){
+        long long above=0;
+        while(above<m->count && m->scores[above]>score) above++;
+        *out_rank=above+1;
+        if(out_error) *out_error=0;
+        return 0;
+    }
+
+    *out_rank=hist_above(m->hist,score,out_error)+1;
+    return 0;
+}
+
+void fossil_game_score_merged_free(fossil_game_score_merged* m)
+{
+    if(!m) return;
+    for(int i=0;i<m->count;i++) free(m->ids[i]);
+    free(m->ids);
+    free(m->scores);
+    free(m);
+}
+
+/* ============================================================
+   Approximate ranks
+   ============================================================ */
+
+/*
+ * Every player's lifetime score is counted in the shard histogram buckets,
+ * with a Fenwick tree over the counts. A change that stays inside its
+ * bucket costs nothing; one that crosses buckets costs two Fenwick updates
+ * of at most 11 steps whatever the population. Queries sum the buckets
+ * above in O(log buckets) and interpolate inside the score's own bucket.
+ */
+static uint64_t g_approx_count[HIST_BUCKETS];
+static uint64_t g_approx_fenwick[HIST_BUCKETS+1];
+
+static void approx_add(uint32_t b,uint64_t d)
+{
+    g_approx_count[b]+=d;
+    for(uint32_t i=b+1;i<=HIST_BUCKETS;i+=i&-i)
+        g_approx_fenwick[i]+=d;
+}
+
+/* added: a new player entering at after, before is ignored */
+static void approx_move(long long before,long long after,int added)
+{
+    uint32_t to=hist_bucket(after);
+    if(added){
+        approx_add(to,1);
+        return;
+    }
+
+    uint32_t from=hist_bucket(before);
+    if(from==to) return;
+    approx_add(from,(uint64_t)-1);
+    approx_add(to,1);
+}
+
+/* Players above score; self excludes one player holding that score */
+static long long approx_above(long long score,int self,long long* out_error)
+{
+    uint32_t sb=hist_bucket(score);
+    uint64_t upto=0;
+    for(uint32_t i=sb+1;i;i-=i&-i)
+        upto+=g_approx_fenwick[i];
+
+    long long above=(long long)((uint64_t)g_player_count-upto);
+    return above+hist_within(sb,score,g_approx_count[sb]-(self?1:0),out_error);
+}
+
+int fossil_game_score_rank_of(long long score,long long* out_rank,long long* out_error)
+{
+    if(!out_rank) return -1;
+    *out_rank=approx_above(score,0,out_error)+1;
+    return 0;
+}
+
+int fossil_game_score_rank_estimate(const char* player_id,long long* out_rank,long long* out_error)
+{
+    if(!player_id||!out_rank) return -1;
+    player_score_t* p=lookup_player(player_id,hash_str(player_id));
+    if(!p) return -2;
+
+    *out_rank=approx_above(p->score,1,out_error)+1;
+    return 0;
+}
+
+int fossil_game_score_percentile(const char* player_id,double* out_top)
+{
+    long long rank;
+    if(!out_top) return -1;
+    int rc=fossil_game_score_rank_estimate(player_id,&rank,NULL);
+    if(rc) return rc;
+
+    *out_top=(double)rank/(double)g_player_count;
+    return 0;
+}
+
+/* ============================================================
+   Scoreboards
+   ============================================================ */
+
+/*
+ * Named boards over the lifetime score: submitting adds to the player's
+ * score and makes it a member of the board. The global board (NULL or
+ * "global") holds every player.
+ */
+static int is_global(const char* board_id)
+{
+    return !board_id || strcmp(board_id,"global")==0;
+}
+
+static leaderboard_t* board_lookup(const char* board_id)
+{
+    for(int i=0;i<g_board_count;i++)
+        if(strcmp(g_boards[i].id,board_id)==0)
+            return &g_boards[i];
+    return NULL;
+}
+
+static int board_has(const leaderboard_t* b,const char* player_id)
+{
+    for(int i=0;i<b->count;i++)
+        if(strcmp(b->players[i],player_id)==0)
+            return 1;
+    return 0;
+}
+
+/* b NULL is the global board */
+static int board_size(const leaderboard_t* b)
+{
+    return b?b->count:g_player_count;
+}
+
+static player_score_t* board_member(const leaderboard_t* b,int n)
+{
+    if(!b) return &g_players[n];
+    return lookup_player(b->players[n],hash_str(b->players[n]));
+}
+
+int fossil_game_scoreboard_join(const char* board_id,const char* player_id)
+{
+    if(!player_id) return -1;
+    if(is_global(board_id)) return 0;
+
+    player_score_t* p=find_player(player_id);
+    if(!p) return -3;
+
+    leaderboard_t* b=find_board(board_id);
+    if(board_has(b,player_id)) return 0;
+
+    board_add_player(b,p->id);
+    fossil_game_wal_record_scoreboard_join(board_id,player_id);
+    return 0;
+}
+
+int fossil_game_scoreboard_submit(const char* board_id,const char* player_id,int score)
+{
+    if(!player_id) return -1;
+
+    int rc=fossil_game_score_update(player_id,score);
+    if(rc) return rc;
+    return fossil_game_scoreboard_join(board_id,player_id);
+}
+
+int fossil_game_scoreboard_get(const char* board_id,const char* player_id,int* out)
+{
+    if(!player_id||!out) return -1;
+
+    player_score_t* p=lookup_player(player_id,hash_str(player_id));
+    if(!p) return -2;
+    if(!is_global(board_id)){
+        leaderboard_t* b=board_lookup(board_id);
+        if(!b || !board_has(b,player_id)) return -2;
+    }
+
+    *out=p->score;
+    return 0;
+}
+
+const char* fossil_game_scoreboard_leaderboard(const char* board_id)
+{
+    leaderboard_t* b=is_global(board_id)?NULL:board_lookup(board_id);
+    if(!b && !is_global(board_id)) return NULL;
+
+    player_score_t* best=NULL;
+    for(int i=0;i<board_size(b);i++){
+        player_score_t* p=board_member(b,i);
+        if(p && (!best || p->score>best->score)) best=p;
+    }
+    return best?best->id:NULL;
+}
+
+/* Closest score among the other members; ties go to the earlier member */
+const char* fossil_game_scoreboard_matchmake(const char* board_id,const char* player_id)
+{
+    if(!player_id) return NULL;
+
+    leaderboard_t* b=is_global(board_id)?NULL:board_lookup(board_id);
+    if(!b && !is_global(board_id)) return NULL;
+
+    player_score_t* me=lookup_player(player_id,hash_str(player_id));
+    if(!me || (b && !board_has(b,player_id))) return NULL;
+
+    player_score_t* best=NULL;
+    long long best_gap=0;
+    for(int i=0;i<board_size(b);i++){
+        player_score_t* p=board_member(b,i);
+        if(!p || p==me) continue;
+        long long gap=llabs((long long)p->score-me->score);
+        if(!best || gap<best_gap){
+            best=p;
+            best_gap=gap;
+        }
+    }
+    return best?best->id:NULL;
+}
+
+int fossil_game_scoreboard_rank(const char* board_id,const char* player_id,int* out)
+{
+    if(!player_id||!out) return -1;
+
+    if(is_global(board_id)){
+        long long rank;
+        int rc=fossil_game_score_rank_estimate(player_id,&rank,NULL);
+        if(rc) return rc;
+        *out=rank>INT_MAX?INT_MAX:(int)rank;
+        return 0;
+    }
+
+    /* named boards are small: count the members strictly above us */
+    leaderboard_t* b=board_lookup(board_id);
+    if(!b || !board_has(b,player_id)) return -2;
+    player_score_t* me=lookup_player(player_id,hash_str(player_id));
+    if(!me) return -2;
+
+    int rank=1;
+    for(int i=0;i<board_size(b);i++){
+        player_score_t* p=board_member(b,i);
+        if(p && p->score>me->score) rank++;
+    }
+    *out=rank;
+    return 0;
+}
+
+/* ============================================================
+   Achievements
+   ============================================================ */
+
+/*
+ * Achievement ids are assigned bit positions once; players hold a bitset.
+ * Each bit also keeps a population count, updated on unlock, so "how many
+ * players have X" never scans players.
+ */
+#define ACH_SLOTS (FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX*2)
+
+static char* g_ach_names[FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX];
+static uint32_t g_ach_holders[FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX];
+static int g_ach_count=0;
+static uint16_t g_ach_slots[ACH_SLOTS];         /* bit + 1, 0 = empty */
+
+/* Rules per metric, sorted by threshold so a change only visits the rules it crosses */
+static rule_t* g_rules[2]={NULL,NULL};
+static int g_rule_count[2]={0,0};
+
+static fossil_game_score_unlock_fn g_on_unlock=NULL;
+static void* g_on_unlock_ctx=NULL;
+
+static int popcount64(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#else
+    v=v-((v>>1)&0x5555555555555555ull);
+    v=(v&0x3333333333333333ull)+((v>>2)&0x3333333333333333ull);
+    v=(v+(v>>4))&0x0F0F0F0F0F0F0F0Full;
+    return (int)((v*0x0101010101010101ull)>>56);
+#endif
+}
+
+static uint32_t ach_slot(const char* id)
+{
+    uint32_t i=hash_str(id)&(ACH_SLOTS-1);
+    while(g_ach_slots[i] && strcmp(g_ach_names[g_ach_slots[i]-1],id)!=0)
+        i=(i+1)&(ACH_SLOTS-1);
+    return i;
+}
+
+static int ach_bit(const char* id,int create)
+{
+    uint32_t i=ach_slot(id);
+    if(g_ach_slots[i]) return g_ach_slots[i]-1;
+    if(!create) return -2;
+    if(g_ach_count==FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX) return -3;
+
+    char* name=fossil_strdup(id);
+    if(!name) return -3;
+
+    g_ach_names[g_ach_count]=name;
+    g_ach_slots[i]=(uint16_t)(g_ach_count+1);
+    return g_ach_count++;
+}
+
+/* Sets the bit; returns 1 when this was a new unlock */
+static int unlock(player_score_t* p,int bit)
+{
+    uint64_t m=(uint64_t)1<<(bit&63);
+    if(p->achievements[bit>>6]&m) return 0;
+
+    p->achievements[bit>>6]|=m;
+    g_ach_holders[bit]++;
+    if(g_on_unlock) g_on_unlock(p->id,g_ach_names[bit],g_on_unlock_ctx);
+    return 1;
+}
+
+/* Unlocks every rule of a kind whose threshold lies in (before, after] */
+static void check_rules(player_score_t* p,int kind,long long before,long long after)
+{
+    const rule_t* r=g_rules[kind];
+    int lo=0,hi=g_rule_count[kind];
+
+    while(lo<hi){
+        int mid=(lo+hi)/2;
+        if(r[mid].threshold<=before) lo=mid+1;
+        else hi=mid;
+    }
+    for(int i=lo;i<g_rule_count[kind] && r[i].threshold<=after;i++)
+        unlock(p,r[i].bit);
+}
+
+static void check_score_rules(player_score_t* p,long long before,long long after)
+{
+    check_rules(p,FOSSIL_GAME_SCORE_RULE_SCORE,before,after);
+}
+
+int fossil_game_score_define_achievement(const char* achievement_id)
+{
+    if(!achievement_id) return -1;
+    return ach_bit(achievement_id,1);
+}
+
+int fossil_game_score_add_rule(const char* achievement_id,int kind,long long threshold)
+{
+    if(!achievement_id||kind<0||kind>FOSSIL_GAME_SCORE_RULE_QUIZ_STREAK) return -1;
+
+    int bit=ach_bit(achievement_id,1);
+    if(bit<0) return bit;
+
+    rule_t* tmp=realloc(g_rules[kind],sizeof(*tmp)*(g_rule_count[kind]+1));
+    if(!tmp) return -3;
+    g_rules[kind]=tmp;
+
+    int i=g_rule_count[kind]++;
+    while(i>0 && tmp[i-1].threshold>threshold){ tmp[i]=tmp[i-1]; i--; }
+    tmp[i].threshold=threshold;
+    tmp[i].bit=(uint16_t)bit;
+
+    /* players who already qualify unlock now; afterwards only crossings are checked */
+    for(int k=0;k<g_player_count;k++){
+        player_score_t* p=&g_players[k];
+        long long v=kind==FOSSIL_GAME_SCORE_RULE_SCORE?p->score:p->best_streak;
+        if(v>=threshold) unlock(p,bit);
+    }
+    return 0;
+}
+
+void fossil_game_score_on_unlock(fossil_game_score_unlock_fn fn,void* ctx)
+{
+    g_on_unlock=fn;
+    g_on_unlock_ctx=ctx;
+}
+
+int fossil_game_score_quiz_answer(const char* player_id,int correct)
+{
+    if(!player_id) return -1;
+    player_score_t* p=find_player(player_id);
+    if(!p) return -3;
+
+    if(!correct){
+        p->streak=0;
+        return 0;
+    }
+
+    p->streak++;
+    if(p->streak>p->best_streak){
+        int before=p->best_streak;
+        p->best_streak=p->streak;
+        check_rules(p,FOSSIL_GAME_SCORE_RULE_QUIZ_STREAK,before,p->best_streak);
+    }
+    return 0;
+}
+
+int fossil_game_score_quiz_streak(const char* player_id,int* out_current,int* out_best)
+{
+    if(!player_id) return -1;
+    player_score_t* p=find_player(player_id);
+    if(!p) return -3;
+
+    if(out_current) *out_current=p->streak;
+    if(out_best) *out_best=p->best_streak;
+    return 0;
+}
+
+int fossil_game_score_add_achievement(
+    const char* player_id,
+    const char* achievement_id)
+{
+    if(!player_id||!achievement_id) return -1;
+
+    player_score_t* p=find_player(player_id);
+    int bit=ach_bit(achievement_id,1);
+    if(!p||bit<0) return -3;
+
+    unlock(p,bit);
+    return 0;
+}
+
+int fossil_game_score_has_achievement(
+    const char* player_id,
+    const char* achievement_id)
+{
+    if(!player_id||!achievement_id) return 0;
+
+    player_score_t* p=lookup_player(player_id,hash_str(player_id));
+    int bit=ach_bit(achievement_id,0);
+    if(!p||bit<0) return 0;
+
+    return (int)((p->achievements[bit>>6]>>(bit&63))&1);
+}
+
+int fossil_game_score_achievement_count(const char* player_id)
+{
+    if(!player_id) return -1;
+
+    player_score_t* p=lookup_player(player_id,hash_str(player_id));
+    if(!p) return 0;
+
+    int n=0;
+    for(int w=0;w<ACH_WORDS;w++)
+        n+=popcount64(p->achievements[w]);
+    return n;
+}
+
+int fossil_game_score_achievement_holders(const char* achievement_id)
+{
+    if(!achievement_id) return -1;
+
+    int bit=ach_bit(achievement_id,0);
+    return bit<0?0:(int)g_ach_holders[bit];
+}
+
+/* ============================================================
+   Snapshot
+   ============================================================ */
+
+/* Achievement bits are saved by name table position; boards list members by player position */
+int fossil_game_score_state_save(fossil_game_state_writer* w)
+{
+    if(!w) return -1;
+
+    fossil_game_state_put_u64(w,(uint64_t)g_ach_count);
+    for(int i=0;i<g_ach_count;i++)
+        fossil_game_state_put_str(w,g_ach_names[i]);
+
+    fossil_game_state_put_u64(w,(uint64_t)g_player_count);
+    for(int i=0;i<g_player_count;i++){
+        const player_score_t* p=&g_players[i];
+        fossil_game_state_put_str(w,p->id);
+        fossil_game_state_put_i64(w,p->score);
+        fossil_game_state_put_u64(w,(uint64_t)p->streak);
+        fossil_game_state_put_u64(w,(uint64_t)p->best_streak);
+        for(int k=0;k<ACH_WORDS;k++)
+            fossil_game_state_put_u64(w,p->achievements[k]);
+    }
+
+    fossil_game_state_put_u64(w,(uint64_t)g_board_count);
+    for(int i=0;i<g_board_count;i++){
+        const leaderboard_t* b=&g_boards[i];
+        fossil_game_state_put_str(w,b->id);
+        fossil_game_state_put_u64(w,(uint64_t)b->count);
+        for(int k=0;k<b->count;k++){
+            const player_score_t* p=lookup_player(b->players[k],hash_str(b->players[k]));
+            fossil_game_state_put_u64(w,(uint64_t)(p-g_players));
+        }
+    }
+
+    fossil_game_state_put_u64(w,(uint64_t)g_rating_count);
+    for(int i=0;i<g_rating_count;i++){
+        fossil_game_state_put_f64(w,g_rating_mu[i]);
+        fossil_game_state_put_f64(w,g_rating_phi[i]);
+        fossil_game_state_put_f64(w,g_rating_sigma[i]);
+    }
+    return w->err;
+}
+
+static int load_achievements(fossil_game_state_reader* r,int* bits,int* out_count)
+{
+    uint64_t n=fossil_game_state_get_u64(r);
+    if(r->err || n>FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX) return -2;
+
+    for(uint64_t i=0;i<n;i++){
+        char* name=fossil_game_state_get_str(r);
+        if(!name) return r->err?r->err:-2;
+        bits[i]=ach_bit(name,1);
+        free(name);
+        if(bits[i]<0) return -2;
+    }
+
+    *out_count=(int)n;
+    return 0;
+}
+
+static int load_players(fossil_game_state_reader* r,const int* bits,int nbits)
+{
+    uint64_t n=fossil_game_state_get_u64(r);
+    if(r->err || n>(uint64_t)(r->end-r->pos) || n>=INT_MAX) return -2;
+    if(!n) return 0;
+
+    /* size the array and index once instead of growing per player */
+    player_score_t* tmp=realloc(g_players,sizeof(*tmp)*(size_t)n);
+    if(!tmp) return -3;
+    g_players=tmp;
+    fossil_game_score_values.base=(const unsigned char*)&tmp[0].score;
+    while(n*4>(uint64_t)g_player_index_cap*3)
+        if(index_grow()!=0) return -3;
+
+    int identity=1;
+    for(int i=0;i<nbits;i++)
+        if(bits[i]!=i) identity=0;
+
+    for(uint64_t i=0;i<n;i++){
+        player_score_t* p=&g_players[g_player_count];
+        memset(p,0,sizeof(*p));
+
+        p->id=fossil_game_state_get_str(r);
+        if(!p->id) return r->err?r->err:-2;
+        p->hash=hash_str(p->id);
+
+        /* one probe both rejects duplicates and finds the free slot */
+        uint32_t mask=g_player_index_cap-1,j=p->hash&mask;
+        for(;g_player_index[j];j=(j+1)&mask){
+            const player_score_t* o=&g_players[g_player_index[j]-1];
+            if(o->hash==p->hash && strcmp(o->id,p->id)==0){ free(p->id); return -2; }
+        }
+
+        int64_t score=fossil_game_state_get_i64(r);
+        uint64_t streak=fossil_game_state_get_u64(r);
+        uint64_t best=fossil_game_state_get_u64(r);
+        uint64_t saved[ACH_WORDS];
+        for(int k=0;k<ACH_WORDS;k++)
+            saved[k]=fossil_game_state_get_u64(r);
+
+        if(r->err || score<INT_MIN || score>INT_MAX || streak>INT_MAX || best>INT_MAX){
+            free(p->id);
+            return -2;
+        }
+        p->score=(int)score;
+        p->streak=(int)streak;
+        p->best_streak=(int)best;
+
+        g_player_index[j]=(uint32_t)++g_player_count;
+        approx_move(0,p->score,1);
+
+        for(int k=0;k<ACH_WORDS;k++){
+            for(uint64_t m=saved[k];m;m&=m-1){
+                int b=k*64+popcount64((m&(0-m))-1);
+                if(b>=nbits) return -2;
+
+                int bit=identity?b:bits[b];
+                p->achievements[bit>>6]|=(uint64_t)1<<(bit&63);
+                g_ach_holders[bit]++;
+            }
+        }
+    }
+    return 0;
+}
+
+static int load_boards(fossil_game_state_reader* r)
+{
+    uint64_t n=fossil_game_state_get_u64(r);
+    if(r->err || n>(uint64_t)(r->end-r->pos)) return -2;
+
+    for(uint64_t i=0;i<n;i++){
+        char* id=fossil_game_state_get_str(r);
+        uint64_t count=fossil_game_state_get_u64(r);
+        if(!id || r->err || count>(uint64_t)(r->end-r->pos)){ free(id); return -2; }
+
+        char** players=malloc(sizeof(*players)*(count?count:1));
+        leaderboard_t* tmp=players?realloc(g_boards,sizeof(*tmp)*(g_board_count+1)):NULL;
+        if(!tmp){ free(players); free(id); return -3; }
+        g_boards=tmp;
+
+        leaderboard_t* b=&g_boards[g_board_count++];
+        b->id=id;
+        b->players=players;
+        b->count=0;
+
+        for(uint64_t k=0;k<count;k++){
+            uint64_t at=fossil_game_state_get_u64(r);
+            if(r->err || at>=(uint64_t)g_player_count) return -2;
+            b->players[b->count++]=g_players[at].id;
+        }
+    }
+    return 0;
+}
+
+/* Snapshots taken before ratings existed end after the boards */
+static int load_ratings(fossil_game_state_reader* r)
+{
+    if(r->pos==r->end) return 0;
+
+    uint64_t n=fossil_game_state_get_u64(r);
+    if(r->err || n>(uint64_t)g_player_count) return -2;
+    if(rating_reserve()!=0) return -3;
+
+    for(uint64_t i=0;i<n;i++){
+        g_rating_mu[i]=fossil_game_state_get_f64(r);
+        g_rating_phi[i]=fossil_game_state_get_f64(r);
+        g_rating_sigma[i]=fossil_game_state_get_f64(r);
+    }
+    return r->err;
+}
+
+int fossil_game_score_state_load(fossil_game_state_reader* r)
+{
+    if(!r) return -1;
+    if(g_player_count||g_board_count) return -5;
+
+    int bits[FOSSIL_GAME_SCORE_ACHIEVEMENT_MAX];
+    int nbits=0;
+
+    int rc=load_achievements(r,bits,&nbits);
+    if(!rc) rc=load_players(r,bits,nbits);
+    if(!rc) rc=load_boards(r);
+    if(!rc) rc=load_ratings(r);
+    if(rc) return rc;
+
+    /* rules added since the snapshot was taken apply to the restored players */
+    for(int i=0;i<g_player_count;i++){
+        check_rules(&g_players[i],FOSSIL_GAME_SCORE_RULE_SCORE,LLONG_MIN,g_players[i].score);
+        check_rules(&g_players[i],FOSSIL_GAME_SCORE_RULE_QUIZ_STREAK,LLONG_MIN,g_players[i].best_streak);
+    }
+    return 0;
+}
+
+/*
+ * Drops every player and board unlogged, back to the empty store a load
+ * expects. Windows and the achievement catalog stay; a load only fills in
+ * the rest.
+ */
+void fossil_game_score_state_clear(void)
+{
+    for(int i=0;i<g_board_count;i++){
+        free(g_boards[i].id);
+        free(g_boards[i].players);
+    }
+    g_board_count=0;
+
+    for(int i=0;i<g_player_count;i++)
+        free(g_players[i].id);
+    g_player_count=0;
+    g_rating_count=0;
+
+    if(g_player_index_cap)
+        memset(g_player_index,0,sizeof(*g_player_index)*g_player_index_cap);
+    memset(g_approx_count,0,sizeof(g_approx_count));
+    memset(g_approx_fenwick,0,sizeof(g_approx_fenwick));
+    memset(g_ach_holders,0,sizeof(g_ach_holders));
+}
+
+/* ============================================================
+   Metrics
+   ============================================================ */
+
+void fossil_game_score_metrics_registry(fossil_game_metrics_registry* out)
+{
+    out->score_players=(size_t)g_player_count;
+    out->boards=(size_t)g_board_count;
+}
@@ -0,0 +1,276 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/session.h"
+#include "fossil/game/metrics.h"
+#include "fossil/game/trace.h"
+#include "fossil/game/player.h"
+#include "fossil/game/clinker.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char* fossil_strdup(const char* s)
+{
+    if(!s) return NULL;
+
+    size_t len = 0;
+    while(s[len]) len++;
+
+    char* out = (char*)malloc(len + 1);
+    if(!out) return NULL;
+    FOSSIL_GAME_METRIC_ALLOC();
+
+    for(size_t i=0;i<=len;i++)
+        out[i] = s[i];
+
+    return out;
+}
+
+/* ============================================================
+   Internal structures
+   ============================================================ */
+
+/*
+ * Session lifecycle. Membership itself lives in the player module's
+ * session rosters; a session here adds the running state and tick clock.
+ */
+typedef struct {
+    char* id;
+    uint32_t hash;
+    int running;
+    uint64_t ticks;
+} session_t;
+
+typedef struct {
+    uint32_t hash;
+    session_t* s;               /* NULL = empty */
+} session_slot_t;
+
+static session_slot_t* g_index = NULL;
+static uint32_t g_index_cap = 0;
+static uint32_t g_count = 0;
+
+static uint32_t hash_str(const char* s)
+{
+    uint32_t h=2166136261u;
+    while(*s){
+        h^=(unsigned char)*s++;
+        h*=16777619u;
+    }
+    return h;
+}
+
+static long index_find(const char* id,uint32_t h)
+{
+    if(!g_index_cap) return -1;
+
+    uint32_t mask=g_index_cap-1;
+    for(uint32_t i=h&mask;g_index[i].s;i=(i+1)&mask){
+        if(g_index[i].hash==h && strcmp(g_index[i].s->id,id)==0)
+            return (long)i;
+    }
+    return -1;
+}
+
+static int index_insert(session_t* s)
+{
+    if((g_count+1)*4>g_index_cap*3){
+        uint32_t cap=g_index_cap?g_index_cap*2:64;
+        session_slot_t* tmp=calloc(cap,sizeof(*tmp));
+        if(!tmp) return -1;
+
+        for(uint32_t i=0;i<g_index_cap;i++){
+            if(!g_index[i].s) continue;
+            uint32_t j=g_index[i].hash&(cap-1);
+            while(tmp[j].s) j=(j+1)&(cap-1);
+            tmp[j]=g_index[i];
+        }
+
+        free(g_index);
+        g_index=tmp;
+        g_index_cap=cap;
+    }
+
+    uint32_t i=s->hash&(g_index_cap-1);
+    while(g_index[i].s) i=(i+1)&(g_index_cap-1);
+    g_index[i].hash=s->hash;
+    g_index[i].s=s;
+    g_count++;
+    return 0;
+}
+
+static void index_erase(uint32_t pos)
+{
+    uint32_t mask=g_index_cap-1;
+    uint32_t hole=pos;
+
+    for(uint32_t i=(pos+1)&mask;g_index[i].s;i=(i+1)&mask){
+        uint32_t home=g_index[i].hash&mask;
+        if(((i-home)&mask)>=((i-hole)&mask)){
+            g_index[hole]=g_index[i];
+            hole=i;
+        }
+    }
+    g_index[hole].s=NULL;
+    g_count--;
+}
+
+static session_t* find_session(const char* id)
+{
+    if(!id) return NULL;
+
+    long pos=index_find(id,hash_str(id));
+    return pos<0?NULL:g_index[pos].s;
+}
+
+/* ============================================================
+   Lifecycle
+   ============================================================ */
+
+int fossil_game_session_create(const char* session_id)
+{
+    if(!session_id) return -1;
+    if(find_session(session_id)) return -2;
+
+    session_t* s=calloc(1,sizeof(*s));
+    if(!s) return -3;
+
+    s->id=fossil_strdup(session_id);
+    s->hash=hash_str(session_id);
+    if(!s->id || index_insert(s)!=0){
+        free(s->id);
+        free(s);
+        return -3;
+    }
+    return 0;
+}
+
+/* Closing a room evicts its members through the roster, O(members) */
+int fossil_game_session_destroy(const char* session_id)
+{
+    if(!session_id) return -1;
+
+    long pos=index_find(session_id,hash_str(session_id));
+    if(pos<0) return -2;
+
+    /* the roster cannot be dropped while a foreach walks it */
+    session_t* s=g_index[pos].s;
+    if(fossil_game_player_evict_session(session_id)<0) return -5;
+    index_erase((uint32_t)pos);
+
+    free(s->id);
+    free(s);
+    return 0;
+}
+
+int fossil_game_session_start(const char* session_id)
+{
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    s->running=1;
+    return 0;
+}
+
+int fossil_game_session_stop(const char* session_id)
+{
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    s->running=0;
+    return 0;
+}
+
+/* Members driven by the NPC engine advance one step; plain players have nothing to tick */
+static int tick_member(const char* player_id,void* ctx)
+{
+    (void)ctx;
+    fossil_game_clinker_tick(player_id);
+    return 0;
+}
+
+/* Advances the session clock and ticks every member; returns the member count */
+static int session_tick(const char* session_id)
+{
+    session_t* s=find_session(session_id);
+    if(!s) return -2;
+    if(!s->running) return -3;
+
+    s->ticks++;
+    FOSSIL_GAME_TRACE_BEGIN("session_members");
+    fossil_game_player_foreach_in_session(session_id,tick_member,NULL);
+    FOSSIL_GAME_TRACE_END("session_members");
+    return fossil_game_player_session_count(session_id);
+}
+
+int fossil_game_session_tick(const char* session_id)
+{
+    FOSSIL_GAME_METRIC_BEGIN(SESSION_TICK);
+    FOSSIL_GAME_TRACE_BEGIN("session_tick");
+    int rc=session_tick(session_id);
+    FOSSIL_GAME_TRACE_END("session_tick");
+    FOSSIL_GAME_METRIC_END(SESSION_TICK);
+    return rc;
+}
+
+/* ============================================================
+   Membership
+   ============================================================ */
+
+int fossil_game_session_add_player(const char* session_id,const char* player_id)
+{
+    if(!find_session(session_id)) return -2;
+    return fossil_game_player_join_session(player_id,session_id);
+}
+
+int fossil_game_session_remove_player(const char* session_id,const char* player_id)
+{
+    if(!find_session(session_id)||!player_id) return -2;
+
+    const char* current=fossil_game_player_get_session(player_id);
+    if(!current||strcmp(current,session_id)!=0) return -3;
+    return fossil_game_player_leave_session(player_id);
+}
+
+int fossil_game_session_player_count(const char* session_id)
+{
+    if(!find_session(session_id)) return -2;
+    return fossil_game_player_session_count(session_id);
+}
+
+uint64_t fossil_game_session_ticks(const char* session_id)
+{
+    session_t* s=find_session(session_id);
+    return s?s->ticks:0;
+}
+
+/* ============================================================
+   Metrics
+   ============================================================ */
+
+void fossil_game_session_metrics_registry(fossil_game_metrics_registry* out)
+{
+    out->sessions=g_count;
+}
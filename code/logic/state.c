@@ -0,0 +1,436 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/state.h"
+#include "fossil/game/wal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define STATE_MAGIC "FGST"
+#define STATE_BUFFER (1u<<20)
+
+static const struct {
+    uint32_t tag;
+    int (*save)(fossil_game_state_writer*);
+    int (*load)(fossil_game_state_reader*);
+    void (*clear)(void);
+} g_sections[] = {
+    { FOSSIL_GAME_STATE_SECTION_PLAYER,  fossil_game_player_state_save,  fossil_game_player_state_load,  fossil_game_player_state_clear },
+    { FOSSIL_GAME_STATE_SECTION_SCORE,   fossil_game_score_state_save,   fossil_game_score_state_load,   fossil_game_score_state_clear },
+    { FOSSIL_GAME_STATE_SECTION_QUIZZED, fossil_game_quizzed_state_save, fossil_game_quizzed_state_load, fossil_game_quizzed_state_clear },
+    { FOSSIL_GAME_STATE_SECTION_WAL,     fossil_game_wal_state_save,     fossil_game_wal_state_load,     NULL },
+};
+
+#define SECTION_COUNT (sizeof(g_sections)/sizeof(g_sections[0]))
+
+/* ============================================================
+   Writer
+   ============================================================ */
+
+static void flush(fossil_game_state_writer* w)
+{
+    if(w->len && !w->err && fwrite(w->buf,1,w->len,w->file)!=w->len)
+        w->err=-4;
+    w->written+=w->len;
+    w->len=0;
+}
+
+static inline unsigned char* reserve(fossil_game_state_writer* w,size_t n)
+{
+    if(w->len+n>w->cap) flush(w);
+    return w->buf+w->len;
+}
+
+static void put_raw(fossil_game_state_writer* w,const void* data,size_t len)
+{
+    if(len>w->cap/2){
+        flush(w);
+        if(!w->err && fwrite(data,1,len,w->file)!=len) w->err=-4;
+        w->written+=len;
+        return;
+    }
+    memcpy(reserve(w,len),data,len);
+    w->len+=len;
+}
+
+static void put_le(unsigned char* out,uint64_t v,int n)
+{
+    for(int i=0;i<n;i++) out[i]=(unsigned char)(v>>(8*i));
+}
+
+void fossil_game_state_put_u64(fossil_game_state_writer* w,uint64_t v)
+{
+    unsigned char* out=reserve(w,10);
+    size_t n=0;
+    while(v>=0x80){
+        out[n++]=(unsigned char)(v|0x80);
+        v>>=7;
+    }
+    out[n++]=(unsigned char)v;
+    w->len+=n;
+}
+
+void fossil_game_state_put_i64(fossil_game_state_writer* w,int64_t v)
+{
+    fossil_game_state_put_u64(w,((uint64_t)v<<1)^(uint64_t)(v>>63));
+}
+
+void fossil_game_state_put_f64(fossil_game_state_writer* w,double v)
+{
+    uint64_t bits;
+    memcpy(&bits,&v,sizeof(bits));
+    put_le(reserve(w,8),bits,8);
+    w->len+=8;
+}
+
+void fossil_game_state_put_bytes(fossil_game_state_writer* w,const void* data,size_t len)
+{
+    fossil_game_state_put_u64(w,len);
+    if(len) put_raw(w,data,len);
+}
+
+void fossil_game_state_put_str(fossil_game_state_writer* w,const char* s)
+{
+    fossil_game_state_put_bytes(w,s,s?strlen(s):0);
+}
+
+/* ============================================================
+   Reader
+   ============================================================ */
+
+uint64_t fossil_game_state_get_u64(fossil_game_state_reader* r)
+{
+    uint64_t v=0;
+    for(int shift=0;shift<64;shift+=7){
+        if(r->pos==r->end){ r->err=-2; return 0; }
+        unsigned char b=*r->pos++;
+        v|=(uint64_t)(b&0x7f)<<shift;
+        if(!(b&0x80)) return v;
+    }
+    r->err=-2;
+    return 0;
+}
+
+int64_t fossil_game_state_get_i64(fossil_game_state_reader* r)
+{
+    uint64_t v=fossil_game_state_get_u64(r);
+    return (int64_t)(v>>1)^-(int64_t)(v&1);
+}
+
+double fossil_game_state_get_f64(fossil_game_state_reader* r)
+{
+    double v=0;
+    if(r->end-r->pos<8){ r->err=-2; r->pos=r->end; return v; }
+
+    uint64_t bits=0;
+    for(int i=0;i<8;i++) bits|=(uint64_t)r->pos[i]<<(8*i);
+    r->pos+=8;
+    memcpy(&v,&bits,sizeof(v));
+    return v;
+}
+
+const void* fossil_game_state_get_bytes(fossil_game_state_reader* r,size_t* out_len)
+{
+    uint64_t len=fossil_game_state_get_u64(r);
+    if(r->err || len>(uint64_t)(r->end-r->pos)){
+        r->err=-2;
+        r->pos=r->end;
+        *out_len=0;
+        return NULL;
+    }
+
+    const void* data=r->pos;
+    r->pos+=len;
+    *out_len=(size_t)len;
+    return data;
+}
+
+char* fossil_game_state_get_str(fossil_game_state_reader* r)
+{
+    size_t len;
+    const void* data=fossil_game_state_get_bytes(r,&len);
+    if(r->err) return NULL;
+
+    char* s=malloc(len+1);
+    if(!s){ r->err=-3; return NULL; }
+    if(len) memcpy(s,data,len);
+    s[len]='\0';
+    return s;
+}
+
+static uint64_t get_le(const unsigned char* in,int n)
+{
+    uint64_t v=0;
+    for(int i=0;i<n;i++) v|=(uint64_t)in[i]<<(8*i);
+    return v;
+}
+
+/* ============================================================
+   Snapshot files
+   ============================================================ */
+
+/* Section header goes out with a zero length that is patched once the payload is written */
+static int write_section(fossil_game_state_writer* w,uint32_t tag,int (*save)(fossil_game_state_writer*))
+{
+    unsigned char head[12];
+    fpos_t at;
+
+    flush(w);
+    if(w->err || fgetpos(w->file,&at)!=0) return -4;
+
+    put_le(head,tag,4);
+    put_le(head+4,0,8);
+    if(fwrite(head,1,sizeof(head),w->file)!=sizeof(head)) return -4;
+    uint64_t start=w->written;
+
+    int rc=save(w);
+    flush(w);
+    if(rc) return rc;
+    if(w->err) return w->err;
+
+    put_le(head+4,w->written-start,8);
+    if(fsetpos(w->file,&at)!=0 ||
+       fwrite(head,1,sizeof(head),w->file)!=sizeof(head) ||
+       fseek(w->file,0,SEEK_END)!=0)
+        return -4;
+    return 0;
+}
+
+int fossil_game_state_save(const char* path)
+{
+    if(!path) return -1;
+
+    size_t n=strlen(path);
+    char* tmp=malloc(n+5);
+    if(!tmp) return -3;
+    memcpy(tmp,path,n);
+    memcpy(tmp+n,".tmp",5);
+
+    fossil_game_state_writer w={0};
+    w.buf=malloc(STATE_BUFFER);
+    w.cap=STATE_BUFFER;
+    w.file=w.buf?fopen(tmp,"wb"):NULL;
+    if(!w.file){
+        int rc=w.buf?-4:-3;
+        free(w.buf); free(tmp);
+        return rc;
+    }
+
+    unsigned char head[12];
+    memcpy(head,STATE_MAGIC,4);
+    put_le(head+4,FOSSIL_GAME_STATE_VERSION,4);
+    put_le(head+8,SECTION_COUNT,4);
+    put_raw(&w,head,sizeof(head));
+
+    int rc=0;
+    for(size_t i=0;i<SECTION_COUNT && !rc;i++)
+        rc=write_section(&w,g_sections[i].tag,g_sections[i].save);
+
+    flush(&w);
+    if(!rc) rc=w.err;
+    if(fclose(w.file)!=0 && !rc) rc=-4;
+
+    if(!rc){
+#if defined(_WIN32)
+        if(!MoveFileExA(tmp,path,MOVEFILE_REPLACE_EXISTING)) rc=-4;
+#else
+        if(rename(tmp,path)!=0) rc=-4;
+#endif
+    }
+    if(rc) remove(tmp);
+
+    free(w.buf);
+    free(tmp);
+    return rc;
+}
+
+/*
+ * Restores every known section of an in-memory image, all or nothing: when
+ * a section fails, the stores already restored from this image are emptied
+ * again so a later load starts clean. A store that was not empty to begin
+ * with (-5) is left as it was.
+ */
+static int load_image(const unsigned char* data,size_t size)
+{
+    if(size<12 || memcmp(data,STATE_MAGIC,4)!=0) return -2;
+    if(get_le(data+4,4)!=FOSSIL_GAME_STATE_VERSION) return -2;
+
+    uint32_t sections=(uint32_t)get_le(data+8,4);
+    const unsigned char* pos=data+12;
+    const unsigned char* end=data+size;
+
+    uint32_t touched=0;
+    int rc=0;
+    for(uint32_t s=0;s<sections && !rc;s++){
+        if(end-pos<12){ rc=-2; break; }
+        uint32_t tag=(uint32_t)get_le(pos,4);
+        uint64_t len=get_le(pos+4,8);
+        pos+=12;
+        if(len>(uint64_t)(end-pos)){ rc=-2; break; }
+
+        for(size_t i=0;i<SECTION_COUNT && !rc;i++){
+            if(g_sections[i].tag!=tag) continue;
+
+            fossil_game_state_reader r={ pos,pos+len,0 };
+            rc=g_sections[i].load(&r);
+            if(rc!=-5) touched|=1u<<i;
+            if(!rc) rc=r.err?r.err:r.pos!=r.end?-2:0;
+        }
+        pos+=len;
+    }
+
+    if(rc){
+        for(size_t i=0;i<SECTION_COUNT;i++)
+            if((touched&(1u<<i)) && g_sections[i].clear) g_sections[i].clear();
+    }
+    return rc;
+}
+
+int fossil_game_state_load(const char* path)
+{
+    if(!path) return -1;
+
+#if defined(_WIN32)
+    FILE* f=fopen(path,"rb");
+    if(!f) return -4;
+
+    long long size=(fseek(f,0,SEEK_END)==0)?_ftelli64(f):-1;
+    unsigned char* data=size>0?malloc((size_t)size):NULL;
+    int rc=size<=0?-2:!data?-3:0;
+    if(!rc && (fseek(f,0,SEEK_SET)!=0 || fread(data,1,(size_t)size,f)!=(size_t)size)) rc=-4;
+    fclose(f);
+
+    if(!rc) rc=load_image(data,(size_t)size);
+    free(data);
+    return rc;
+#else
+    int fd=open(path,O_RDONLY);
+    if(fd<0) return -4;
+
+    struct stat st;
+    if(fstat(fd,&st)!=0){ close(fd); return -4; }
+    if(st.st_size<=0){ close(fd); return -2; }
+
+    size_t size=(size_t)st.st_size;
+    void* map=mmap(NULL,size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(map==MAP_FAILED) return -4;
+
+#if defined(MADV_SEQUENTIAL)
+    madvise(map,size,MADV_SEQUENTIAL);
+#endif
+
+    int rc=load_image(map,size);
+    munmap(map,size);
+    return rc;
+#endif
+}
+
+/* ============================================================
+   Background snapshots
+   ============================================================ */
+
+/*
+ * A forked child inherits a copy-on-write image of the whole process, so it
+ * serialises a consistent point-in-time view while the parent keeps
+ * mutating; the parent only pays for the fork and for the pages it touches
+ * while the child runs. The child drops to the lowest priority so it does
+ * not compete with the game loop for CPU. Platforms without fork save
+ * synchronously.
+ *
+ * The child runs the ordinary save, malloc and stdio included, so it is
+ * only safe when the caller is the process's only thread or the C library
+ * keeps those usable across fork (state.h).
+ */
+static int g_bg_running=0;
+static int g_bg_done=0;
+static int g_bg_rc=0;
+static uint64_t g_bg_lsn=0;
+#if !defined(_WIN32)
+static pid_t g_bg_child=0;
+#endif
+
+int fossil_game_state_save_background(const char* path)
+{
+    if(!path) return -1;
+    if(g_bg_running) return -5;
+
+    /* pending log records must reach the log before the image is split */
+    fossil_game_wal_commit();
+    g_bg_lsn=fossil_game_wal_lsn();
+    g_bg_done=0;
+
+#if defined(_WIN32)
+    g_bg_rc=fossil_game_state_save(path);
+    g_bg_done=1;
+    return 0;
+#else
+    pid_t pid=fork();
+    if(pid<0) return -4;
+    if(pid==0){
+        /* lowest priority: the child lives on the game loop's idle time */
+        setpriority(PRIO_PROCESS,0,19);
+        _exit(-fossil_game_state_save(path));
+    }
+
+    g_bg_child=pid;
+    g_bg_running=1;
+    return 0;
+#endif
+}
+
+int fossil_game_state_poll(int* out_rc)
+{
+#if !defined(_WIN32)
+    if(g_bg_running){
+        int status;
+        pid_t r=waitpid(g_bg_child,&status,WNOHANG);
+        if(r==0) return 0;
+
+        g_bg_running=0;
+        g_bg_done=1;
+        g_bg_rc=r<0||!WIFEXITED(status)?-4:-WEXITSTATUS(status);
+    }
+#endif
+    if(!g_bg_done) return -1;
+
+    g_bg_done=0;
+    if(out_rc) *out_rc=g_bg_rc;
+
+    /* frames the snapshot covers are no longer needed for recovery */
+    if(!g_bg_rc) fossil_game_wal_compact(g_bg_lsn);
+    return 1;
+}
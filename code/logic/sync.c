@@ -0,0 +1,1154 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/sync.h"
+#include "fossil/game/player.h"
+#include "fossil/game/score.h"
+#include "fossil/game/trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+static char* fossil_strdup(const char* s)
+{
+    if(!s) return NULL;
+
+    size_t len = 0;
+    while(s[len]) len++;
+
+    char* out = (char*)malloc(len + 1);
+    if(!out) return NULL;
+
+    for(size_t i=0;i<=len;i++)
+        out[i] = s[i];
+
+    return out;
+}
+
+/* ============================================================
+   Internal structures
+   ============================================================ */
+
+typedef struct {
+    uint32_t item;          /* string table index */
+    int32_t  count;
+} sync_item_t;
+
+typedef struct {
+    uint32_t key;           /* string table index of the attribute name */
+    uint32_t type;          /* FOSSIL_GAME_PLAYER_ATTR_* */
+    uint32_t off;           /* value bytes in the snapshot arena */
+    uint32_t len;
+} sync_attr_t;
+
+typedef struct {
+    uint32_t entity;        /* string table index of the player id */
+    int32_t  score;
+    uint32_t item_off;
+    uint32_t item_count;
+    uint32_t attr_off;
+    uint32_t attr_count;
+} sync_entity_t;
+
+typedef struct {
+    uint32_t tick;          /* 0 = slot unused */
+    uint32_t dict_count;    /* string table size at capture time */
+
+    sync_entity_t* entities;
+    uint32_t entity_count;
+    uint32_t entity_cap;
+
+    sync_item_t* items;
+    uint32_t item_count;
+    uint32_t item_cap;
+
+    sync_attr_t* attrs;
+    uint32_t attr_count;
+    uint32_t attr_cap;
+
+    /* attribute values: ints and floats as 8 native bytes */
+    unsigned char* bytes;
+    uint32_t byte_count;
+    uint32_t byte_cap;
+} sync_snapshot_t;
+
+/* append-only string table shared by player ids, item ids and attribute names */
+typedef struct {
+    char** strings;
+    uint32_t* lengths;
+    uint32_t count;
+    uint32_t cap;
+
+    uint32_t* slots;        /* open addressing, string index + 1, 0 = empty */
+    uint32_t slot_cap;
+} sync_dict_t;
+
+typedef struct {
+    char* id;
+    uint32_t acked;         /* 0 = nothing acknowledged yet */
+} sync_client_t;
+
+typedef struct {
+    char* id;
+    uint32_t tick;
+
+    sync_snapshot_t ring[FOSSIL_GAME_SYNC_HISTORY];
+    sync_dict_t dict;
+
+    sync_client_t* clients;
+    int client_count;
+} sync_session_t;
+
+struct fossil_game_sync_mirror {
+    uint32_t tick;          /* 0 = nothing applied yet */
+    sync_dict_t dict;
+    sync_snapshot_t snap[2];
+    int cur;                /* snap[cur] is the applied state, the other is scratch */
+};
+
+/* Global registry */
+static sync_session_t** g_sessions=NULL;
+static int g_session_count=0;
+
+
+/* ============================================================
+   Helpers
+   ============================================================ */
+
+static uint32_t hash_bytes(const char* s,size_t len)
+{
+    uint32_t h=2166136261u;
+    for(size_t n=0;n<len;n++){
+        h^=(unsigned char)s[n];
+        h*=16777619u;
+    }
+    return h;
+}
+
+static int grow(void** ptr,uint32_t* cap,uint32_t need,size_t elem)
+{
+    if(need<=*cap) return 0;
+
+    uint32_t ncap=*cap?*cap:16;
+    while(ncap<need) ncap*=2;
+
+    void* tmp=realloc(*ptr,(size_t)ncap*elem);
+    if(!tmp) return -1;
+
+    *ptr=tmp;
+    *cap=ncap;
+    return 0;
+}
+
+/* Rebuild the slot table at cap; reuses the current table when the size is unchanged */
+static int rehash(sync_dict_t* d,uint32_t cap)
+{
+    uint32_t* slots=d->slots;
+    if(cap==d->slot_cap) memset(slots,0,sizeof(*slots)*cap);
+    else if(!(slots=calloc(cap,sizeof(*slots)))) return -1;
+
+    for(uint32_t i=0;i<d->count;i++){
+        uint32_t h=hash_bytes(d->strings[i],d->lengths[i])&(cap-1);
+        while(slots[h]) h=(h+1)&(cap-1);
+        slots[h]=i+1;
+    }
+
+    if(slots!=d->slots) free(d->slots);
+    d->slots=slots;
+    d->slot_cap=cap;
+    return 0;
+}
+
+static uint32_t dict_find(const sync_dict_t* d,const char* str,size_t len)
+{
+    if(!d->slot_cap) return UINT32_MAX;
+
+    uint32_t h=hash_bytes(str,len)&(d->slot_cap-1);
+    while(d->slots[h]){
+        uint32_t idx=d->slots[h]-1;
+        if(d->lengths[idx]==len && memcmp(d->strings[idx],str,len)==0)
+            return idx;
+        h=(h+1)&(d->slot_cap-1);
+    }
+    return UINT32_MAX;
+}
+
+/* Returns the string table index for str, adding it when new (UINT32_MAX on OOM) */
+static uint32_t intern(sync_dict_t* d,const char* str,size_t len)
+{
+    uint32_t idx=dict_find(d,str,len);
+    if(idx!=UINT32_MAX) return idx;
+
+    if((d->count+1)*2>d->slot_cap &&
+       rehash(d,d->slot_cap?d->slot_cap*2:64)!=0)
+        return UINT32_MAX;
+
+    uint32_t cap=d->cap;
+    if(grow((void**)&d->strings,&cap,d->count+1,sizeof(char*))!=0)
+        return UINT32_MAX;
+    if(grow((void**)&d->lengths,&d->cap,d->count+1,sizeof(uint32_t))!=0)
+        return UINT32_MAX;
+
+    char* copy=malloc(len+1);
+    if(!copy) return UINT32_MAX;
+    memcpy(copy,str,len);
+    copy[len]='\0';
+
+    uint32_t h=hash_bytes(str,len)&(d->slot_cap-1);
+    while(d->slots[h]) h=(h+1)&(d->slot_cap-1);
+
+    idx=d->count++;
+    d->strings[idx]=copy;
+    d->lengths[idx]=(uint32_t)len;
+    d->slots[h]=idx+1;
+    return idx;
+}
+
+/* Drop entries from count on; the slot table keeps its size */
+static void dict_truncate(sync_dict_t* d,uint32_t count)
+{
+    if(count>=d->count) return;
+
+    for(uint32_t i=count;i<d->count;i++) free(d->strings[i]);
+    d->count=count;
+    rehash(d,d->slot_cap);
+}
+
+static void dict_free(sync_dict_t* d)
+{
+    for(uint32_t i=0;i<d->count;i++) free(d->strings[i]);
+    free(d->strings);
+    free(d->lengths);
+    free(d->slots);
+    memset(d,0,sizeof(*d));
+}
+
+static void snapshot_clear(sync_snapshot_t* snap)
+{
+    snap->tick=0;
+    snap->entity_count=0;
+    snap->item_count=0;
+    snap->attr_count=0;
+    snap->byte_count=0;
+}
+
+static void snapshot_free(sync_snapshot_t* snap)
+{
+    free(snap->entities);
+    free(snap->items);
+    free(snap->attrs);
+    free(snap->bytes);
+}
+
+static int push_item(sync_snapshot_t* snap,uint32_t item,int32_t count)
+{
+    if(grow((void**)&snap->items,&snap->item_cap,snap->item_count+1,sizeof(sync_item_t))!=0)
+        return -1;
+
+    snap->items[snap->item_count].item=item;
+    snap->items[snap->item_count].count=count;
+    snap->item_count++;
+    return 0;
+}
+
+static int push_attr(sync_snapshot_t* snap,uint32_t key,uint32_t type,const void* data,size_t len)
+{
+    if(len>UINT32_MAX-snap->byte_count ||
+       grow((void**)&snap->attrs,&snap->attr_cap,snap->attr_count+1,sizeof(sync_attr_t))!=0 ||
+       grow((void**)&snap->bytes,&snap->byte_cap,snap->byte_count+(uint32_t)len,1)!=0)
+        return -1;
+
+    sync_attr_t* a=&snap->attrs[snap->attr_count++];
+    a->key=key;
+    a->type=type;
+    a->off=snap->byte_count;
+    a->len=(uint32_t)len;
+
+    if(len) memcpy(snap->bytes+snap->byte_count,data,len);
+    snap->byte_count+=(uint32_t)len;
+    return 0;
+}
+
+static sync_session_t* find_session(const char* id)
+{
+    for(int i=0;i<g_session_count;i++)
+        if(strcmp(g_sessions[i]->id,id)==0)
+            return g_sessions[i];
+    return NULL;
+}
+
+static sync_session_t* create_session(const char* id)
+{
+    sync_session_t** tmp=realloc(g_sessions,sizeof(*tmp)*(g_session_count+1));
+    if(!tmp) return NULL;
+    g_sessions=tmp;
+
+    sync_session_t* s=calloc(1,sizeof(*s));
+    if(!s) return NULL;
+
+    s->id=fossil_strdup(id);
+    if(!s->id){ free(s); return NULL; }
+
+    g_sessions[g_session_count++]=s;
+    return s;
+}
+
+static sync_client_t* find_client(sync_session_t* s,const char* id,int create)
+{
+    for(int i=0;i<s->client_count;i++)
+        if(strcmp(s->clients[i].id,id)==0)
+            return &s->clients[i];
+
+    if(!create) return NULL;
+
+    sync_client_t* tmp=realloc(s->clients,sizeof(*tmp)*(s->client_count+1));
+    if(!tmp) return NULL;
+    s->clients=tmp;
+
+    sync_client_t* c=&s->clients[s->client_count];
+    c->id=fossil_strdup(id);
+    if(!c->id) return NULL;
+    c->acked=0;
+    s->client_count++;
+    return c;
+}
+
+static sync_snapshot_t* snapshot_at(sync_session_t* s,uint32_t tick)
+{
+    if(tick==0) return NULL;
+    sync_snapshot_t* snap=&s->ring[tick%FOSSIL_GAME_SYNC_HISTORY];
+    return snap->tick==tick?snap:NULL;
+}
+
+/* ============================================================
+   Capture
+   ============================================================ */
+
+typedef struct {
+    sync_session_t* session;
+    sync_snapshot_t* snap;
+    int failed;
+} capture_ctx_t;
+
+static int capture_item(const char* item_id,int count,void* ctx)
+{
+    capture_ctx_t* c=ctx;
+
+    uint32_t item=intern(&c->session->dict,item_id,strlen(item_id));
+    if(item==UINT32_MAX || push_item(c->snap,item,count)!=0){
+        c->failed=1;
+        return 1;
+    }
+    return 0;
+}
+
+static int capture_attr(const char* key,int type,const void* data,size_t len,void* ctx)
+{
+    capture_ctx_t* c=ctx;
+
+    uint32_t k=intern(&c->session->dict,key,strlen(key));
+    if(k==UINT32_MAX || push_attr(c->snap,k,(uint32_t)type,data,len)!=0){
+        c->failed=1;
+        return 1;
+    }
+    return 0;
+}
+
+static int cmp_item(const void* a,const void* b)
+{
+    uint32_t x=((const sync_item_t*)a)->item;
+    uint32_t y=((const sync_item_t*)b)->item;
+    return (x>y)-(x<y);
+}
+
+static int cmp_attr(const void* a,const void* b)
+{
+    uint32_t x=((const sync_attr_t*)a)->key;
+    uint32_t y=((const sync_attr_t*)b)->key;
+    return (x>y)-(x<y);
+}
+
+static int cmp_entity(const void* a,const void* b)
+{
+    uint32_t x=((const sync_entity_t*)a)->entity;
+    uint32_t y=((const sync_entity_t*)b)->entity;
+    return (x>y)-(x<y);
+}
+
+static int capture_player(const char* player_id,void* ctx)
+{
+    capture_ctx_t* c=ctx;
+    sync_snapshot_t* snap=c->snap;
+
+    uint32_t entity=intern(&c->session->dict,player_id,strlen(player_id));
+    if(entity==UINT32_MAX ||
+       grow((void**)&snap->entities,&snap->entity_cap,snap->entity_count+1,sizeof(sync_entity_t))!=0){
+        c->failed=1;
+        return 1;
+    }
+
+    int score=0;
+    fossil_game_score_get(player_id,&score);
+
+    sync_entity_t* e=&snap->entities[snap->entity_count++];
+    e->entity=entity;
+    e->score=score;
+    e->item_off=snap->item_count;
+    e->attr_off=snap->attr_count;
+
+    if(fossil_game_player_inventory_foreach(player_id,capture_item,c)!=0 && c->failed)
+        return 1;
+    if(fossil_game_player_attr_foreach(player_id,capture_attr,c)!=0 && c->failed)
+        return 1;
+
+    e->item_count=snap->item_count-e->item_off;
+    if(e->item_count>1)
+        qsort(&snap->items[e->item_off],e->item_count,sizeof(sync_item_t),cmp_item);
+
+    e->attr_count=snap->attr_count-e->attr_off;
+    if(e->attr_count>1)
+        qsort(&snap->attrs[e->attr_off],e->attr_count,sizeof(sync_attr_t),cmp_attr);
+    return 0;
+}
+
+static int sync_capture(const char* session_id,uint32_t* out_tick)
+{
+    if(!session_id) return -1;
+
+    sync_session_t* s=find_session(session_id);
+    if(!s) s=create_session(session_id);
+    if(!s) return -2;
+
+    uint32_t tick=s->tick+1;
+    sync_snapshot_t* snap=&s->ring[tick%FOSSIL_GAME_SYNC_HISTORY];
+
+    /* reuse the evicted slot's buffers */
+    snapshot_clear(snap);
+
+    capture_ctx_t ctx={s,snap,0};
+    fossil_game_player_foreach_in_session(session_id,capture_player,&ctx);
+    if(ctx.failed) return -2;
+
+    if(snap->entity_count>1)
+        qsort(snap->entities,snap->entity_count,sizeof(sync_entity_t),cmp_entity);
+
+    snap->dict_count=s->dict.count;
+    snap->tick=tick;
+    s->tick=tick;
+
+    if(out_tick) *out_tick=tick;
+    return 0;
+}
+
+int fossil_game_sync_capture(const char* session_id,uint32_t* out_tick)
+{
+    FOSSIL_GAME_TRACE_BEGIN("sync_capture");
+    int rc=sync_capture(session_id,out_tick);
+    FOSSIL_GAME_TRACE_END("sync_capture");
+    return rc;
+}
+
+/* ============================================================
+   Delta encoding
+   ============================================================ */
+
+typedef struct {
+    unsigned char* p;
+    size_t len;
+    size_t cap;
+    int overflow;
+} writer_t;
+
+static void put_varint(writer_t* w,uint64_t v)
+{
+    while(v>=0x80){
+        if(w->len<w->cap) w->p[w->len]=(unsigned char)(v|0x80);
+        w->len++;
+        v>>=7;
+    }
+    if(w->len<w->cap) w->p[w->len]=(unsigned char)v;
+    w->len++;
+    if(w->len>w->cap) w->overflow=1;
+}
+
+static void put_zigzag(writer_t* w,int64_t v)
+{
+    put_varint(w,((uint64_t)v<<1)^(uint64_t)(v>>63));
+}
+
+static void put_byte(writer_t* w,unsigned char b)
+{
+    if(w->len<w->cap) w->p[w->len]=b;
+    else w->overflow=1;
+    w->len++;
+}
+
+static void put_bytes(writer_t* w,const void* b,size_t n)
+{
+    if(w->len+n<=w->cap) memcpy(w->p+w->len,b,n);
+    else w->overflow=1;
+    w->len+=n;
+}
+
+static size_t varint_size(uint64_t v)
+{
+    size_t n=1;
+    while(v>=0x80){ v>>=7; n++; }
+    return n;
+}
+
+/* Walk two sorted item lists; write changed items when w is set, return the change count */
+static uint32_t item_diff(const sync_item_t* a,uint32_t na,
+                          const sync_item_t* b,uint32_t nb,
+                          writer_t* w)
+{
+    uint32_t i=0,j=0,changes=0,prev=0;
+
+    while(i<na||j<nb){
+        uint32_t item;
+        int64_t delta;
+
+        if(j>=nb || (i<na && a[i].item<b[j].item)){
+            item=a[i].item; delta=-(int64_t)a[i].count; i++;
+        }else if(i>=na || b[j].item<a[i].item){
+            item=b[j].item; delta=b[j].count; j++;
+        }else{
+            item=a[i].item; delta=(int64_t)b[j].count-a[i].count; i++; j++;
+            if(delta==0) continue;
+        }
+
+        if(w){
+            put_varint(w,item-prev);
+            put_zigzag(w,delta);
+        }
+        prev=item;
+        changes++;
+    }
+    return changes;
+}
+
+static void put_attr_value(writer_t* w,const sync_attr_t* a,const unsigned char* bytes)
+{
+    const unsigned char* v=bytes+a->off;
+
+    if(a->type==FOSSIL_GAME_PLAYER_ATTR_INT){
+        int64_t i;
+        memcpy(&i,v,8);
+        put_zigzag(w,i);
+    }else if(a->type==FOSSIL_GAME_PLAYER_ATTR_FLOAT){
+        uint64_t bits;
+        memcpy(&bits,v,8);
+        for(int k=0;k<8;k++) put_byte(w,(unsigned char)(bits>>(8*k)));
+    }else{
+        put_varint(w,a->len);
+        put_bytes(w,v,a->len);
+    }
+}
+
+/* Same walk for attributes; a removed attribute is written with type 0 */
+static uint32_t attr_diff(const sync_attr_t* a,uint32_t na,const unsigned char* abytes,
+                          const sync_attr_t* b,uint32_t nb,const unsigned char* bbytes,
+                          writer_t* w)
+{
+    uint32_t i=0,j=0,changes=0,prev=0;
+
+    while(i<na||j<nb){
+        const sync_attr_t* set=NULL;
+        uint32_t key;
+
+        if(j>=nb || (i<na && a[i].key<b[j].key)){
+            key=a[i++].key;
+        }else if(i>=na || b[j].key<a[i].key){
+            set=&b[j++];
+            key=set->key;
+        }else{
+            const sync_attr_t* x=&a[i++];
+            set=&b[j++];
+            key=set->key;
+            if(x->type==set->type && x->len==set->len &&
+               (!set->len || memcmp(abytes+x->off,bbytes+set->off,set->len)==0))
+                continue;
+        }
+
+        if(w){
+            put_varint(w,key-prev);
+            put_byte(w,set?(unsigned char)set->type:0);
+            if(set) put_attr_value(w,set,bbytes);
+        }
+        prev=key;
+        changes++;
+    }
+    return changes;
+}
+
+static uint32_t encode_entities(const sync_snapshot_t* base,const sync_snapshot_t* cur,writer_t* w)
+{
+    static const sync_entity_t none={0,0,0,0,0,0};
+    uint32_t nb=base?base->entity_count:0;
+    uint32_t i=0,j=0,changes=0,prev=0;
+
+    while(i<nb||j<cur->entity_count){
+        const sync_entity_t* a;
+        const sync_entity_t* b;
+        unsigned char flags=0;
+
+        if(j>=cur->entity_count || (i<nb && base->entities[i].entity<cur->entities[j].entity)){
+            a=&base->entities[i++]; b=&none;
+            flags=FOSSIL_GAME_SYNC_REMOVED;
+        }else if(i>=nb || cur->entities[j].entity<base->entities[i].entity){
+            a=&none; b=&cur->entities[j++];
+            flags=FOSSIL_GAME_SYNC_ADDED;
+        }else{
+            a=&base->entities[i++]; b=&cur->entities[j++];
+        }
+
+        const sync_item_t* ai=a->item_count?base->items+a->item_off:NULL;
+        const sync_item_t* bi=b->item_count?cur->items+b->item_off:NULL;
+        const sync_attr_t* aa=a->attr_count?base->attrs+a->attr_off:NULL;
+        const sync_attr_t* ba=b->attr_count?cur->attrs+b->attr_off:NULL;
+        const unsigned char* abytes=base?base->bytes:NULL;
+        uint32_t items=0,attrs=0;
+
+        if(!(flags&FOSSIL_GAME_SYNC_REMOVED)){
+            if(a->score!=b->score) flags|=FOSSIL_GAME_SYNC_SCORE;
+            items=item_diff(ai,a->item_count,bi,b->item_count,NULL);
+            if(items) flags|=FOSSIL_GAME_SYNC_ITEMS;
+            attrs=attr_diff(aa,a->attr_count,abytes,ba,b->attr_count,cur->bytes,NULL);
+            if(attrs) flags|=FOSSIL_GAME_SYNC_ATTRS;
+        }
+        if(!flags) continue;
+
+        uint32_t entity=(flags&FOSSIL_GAME_SYNC_REMOVED)?a->entity:b->entity;
+        put_varint(w,entity-prev);
+        put_byte(w,flags);
+        prev=entity;
+
+        if(flags&FOSSIL_GAME_SYNC_SCORE)
+            put_zigzag(w,(int64_t)b->score-a->score);
+        if(flags&FOSSIL_GAME_SYNC_ITEMS){
+            put_varint(w,items);
+            item_diff(ai,a->item_count,bi,b->item_count,w);
+        }
+        if(flags&FOSSIL_GAME_SYNC_ATTRS){
+            put_varint(w,attrs);
+            attr_diff(aa,a->attr_count,abytes,ba,b->attr_count,cur->bytes,w);
+        }
+        changes++;
+    }
+    return changes;
+}
+
+int fossil_game_sync_encode(const char* session_id,const char* client_id,
+                            unsigned char* out,size_t cap,size_t* out_len)
+{
+    if(!session_id||!client_id||!out||!out_len) return -1;
+
+    sync_session_t* s=find_session(session_id);
+    if(!s||s->tick==0) return -2;
+
+    sync_client_t* c=find_client(s,client_id,1);
+    if(!c) return -3;
+
+    const sync_snapshot_t* cur=snapshot_at(s,s->tick);
+    const sync_snapshot_t* base=snapshot_at(s,c->acked);
+
+    writer_t w={out,0,cap,0};
+    put_varint(&w,cur->tick);
+    put_varint(&w,base?base->tick+1:0);
+
+    uint32_t first=base?base->dict_count:0;
+    put_varint(&w,first);
+    put_varint(&w,cur->dict_count-first);
+    for(uint32_t i=first;i<cur->dict_count;i++){
+        put_varint(&w,s->dict.lengths[i]);
+        put_bytes(&w,s->dict.strings[i],s->dict.lengths[i]);
+    }
+
+    /* entity count goes first; reserve the widest varint and close the gap after */
+    size_t count_at=w.len;
+    w.len+=5;
+    uint32_t changes=encode_entities(base,cur,&w);
+    if(w.len>w.cap) w.overflow=1;
+    if(w.overflow) return -4;
+
+    size_t used=varint_size(changes);
+    memmove(out+count_at+used,out+count_at+5,w.len-count_at-5);
+    w.len-=5-used;
+
+    writer_t cw={out+count_at,0,used,0};
+    put_varint(&cw,changes);
+
+    *out_len=w.len;
+    return 0;
+}
+
+/* ============================================================
+   Client bookkeeping
+   ============================================================ */
+
+int fossil_game_sync_ack(const char* session_id,const char* client_id,uint32_t tick)
+{
+    if(!session_id||!client_id) return -1;
+
+    sync_session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    /* an ack for a snapshot we no longer hold cannot serve as a base */
+    if(!snapshot_at(s,tick)) return -3;
+
+    sync_client_t* c=find_client(s,client_id,1);
+    if(!c) return -2;
+
+    if(tick>c->acked) c->acked=tick;
+    return 0;
+}
+
+int fossil_game_sync_drop_client(const char* session_id,const char* client_id)
+{
+    if(!session_id||!client_id) return -1;
+
+    sync_session_t* s=find_session(session_id);
+    if(!s) return -2;
+
+    for(int i=0;i<s->client_count;i++){
+        if(strcmp(s->clients[i].id,client_id)==0){
+            free(s->clients[i].id);
+            s->clients[i]=s->clients[s->client_count-1];
+            s->client_count--;
+            return 0;
+        }
+    }
+    return -3;
+}
+
+int fossil_game_sync_release(const char* session_id)
+{
+    if(!session_id) return -1;
+
+    for(int i=0;i<g_session_count;i++){
+        sync_session_t* s=g_sessions[i];
+        if(strcmp(s->id,session_id)!=0) continue;
+
+        for(int k=0;k<FOSSIL_GAME_SYNC_HISTORY;k++)
+            snapshot_free(&s->ring[k]);
+        for(int k=0;k<s->client_count;k++) free(s->clients[k].id);
+
+        dict_free(&s->dict);
+        free(s->clients);
+        free(s->id);
+        free(s);
+
+        g_sessions[i]=g_sessions[g_session_count-1];
+        g_session_count--;
+        return 0;
+    }
+    return -2;
+}
+
+/* ============================================================
+   Client mirror
+   ============================================================ */
+
+typedef struct {
+    const unsigned char* p;
+    size_t len;
+    size_t pos;
+    int bad;
+} reader_t;
+
+static uint64_t get_varint(reader_t* r)
+{
+    uint64_t v=0;
+    for(int shift=0;shift<64;shift+=7){
+        if(r->pos>=r->len) break;
+        unsigned char b=r->p[r->pos++];
+        v|=(uint64_t)(b&0x7f)<<shift;
+        if(!(b&0x80)) return v;
+    }
+    r->bad=1;
+    return 0;
+}
+
+static int64_t get_zigzag(reader_t* r)
+{
+    uint64_t v=get_varint(r);
+    return (int64_t)(v>>1)^-(int64_t)(v&1);
+}
+
+static unsigned char get_byte(reader_t* r)
+{
+    if(r->pos>=r->len){ r->bad=1; return 0; }
+    return r->p[r->pos++];
+}
+
+static const unsigned char* get_bytes(reader_t* r,uint64_t n)
+{
+    if(n>r->len-r->pos){ r->bad=1; return NULL; }
+    const unsigned char* b=r->p+r->pos;
+    r->pos+=(size_t)n;
+    return b;
+}
+
+/* Next id in a gap-coded ascending list; -2 when out of order or past the table */
+static int get_index(reader_t* r,uint32_t k,uint32_t prev,uint32_t limit,uint32_t* out)
+{
+    uint64_t gap=get_varint(r);
+    if(r->bad || (k>0 && gap==0) || gap>=limit || prev+gap>=limit) return -2;
+    *out=prev+(uint32_t)gap;
+    return 0;
+}
+
+static int apply_items(reader_t* r,sync_snapshot_t* out,const sync_item_t* a,uint32_t na,uint32_t limit)
+{
+    uint64_t n=get_varint(r);
+    uint32_t i=0,prev=0;
+
+    for(uint64_t k=0;k<n;k++){
+        uint32_t item;
+        if(get_index(r,(uint32_t)(k>0),prev,limit,&item)!=0) return -2;
+        int64_t count=get_zigzag(r);
+        if(r->bad) return -2;
+
+        for(;i<na && a[i].item<item;i++)
+            if(push_item(out,a[i].item,a[i].count)!=0) return -3;
+        if(i<na && a[i].item==item) count+=a[i++].count;
+
+        if(count<0 || count>INT32_MAX) return -2;
+        if(count && push_item(out,item,(int32_t)count)!=0) return -3;
+        prev=item;
+    }
+
+    for(;i<na;i++)
+        if(push_item(out,a[i].item,a[i].count)!=0) return -3;
+    return 0;
+}
+
+static int apply_attrs(reader_t* r,sync_snapshot_t* out,const sync_attr_t* a,uint32_t na,
+                       const unsigned char* abytes,uint32_t limit)
+{
+    uint64_t n=get_varint(r);
+    uint32_t i=0,prev=0;
+
+    for(uint64_t k=0;k<n;k++){
+        uint32_t key;
+        if(get_index(r,(uint32_t)(k>0),prev,limit,&key)!=0) return -2;
+        unsigned char type=get_byte(r);
+        if(r->bad || type>FOSSIL_GAME_PLAYER_ATTR_BLOB) return -2;
+
+        for(;i<na && a[i].key<key;i++)
+            if(push_attr(out,a[i].key,a[i].type,abytes+a[i].off,a[i].len)!=0) return -3;
+
+        int held=i<na && a[i].key==key;
+        if(held) i++;
+        prev=key;
+
+        if(type==FOSSIL_GAME_PLAYER_ATTR_NONE){
+            if(!held) return -2;
+            continue;
+        }
+
+        int rc;
+        if(type==FOSSIL_GAME_PLAYER_ATTR_INT){
+            int64_t v=get_zigzag(r);
+            rc=r->bad?-2:push_attr(out,key,type,&v,8);
+        }else if(type==FOSSIL_GAME_PLAYER_ATTR_FLOAT){
+            const unsigned char* b=get_bytes(r,8);
+            uint64_t bits=0;
+            for(int s=0;b && s<8;s++) bits|=(uint64_t)b[s]<<(8*s);
+            rc=r->bad?-2:push_attr(out,key,type,&bits,8);
+        }else{
+            uint64_t len=get_varint(r);
+            const unsigned char* b=r->bad?NULL:get_bytes(r,len);
+            rc=r->bad?-2:push_attr(out,key,type,b,(size_t)len);
+        }
+        if(rc) return rc==-2?-2:-3;
+    }
+
+    for(;i<na;i++)
+        if(push_attr(out,a[i].key,a[i].type,abytes+a[i].off,a[i].len)!=0) return -3;
+    return 0;
+}
+
+static int copy_entity(sync_snapshot_t* out,const sync_snapshot_t* in,const sync_entity_t* e)
+{
+    if(grow((void**)&out->entities,&out->entity_cap,out->entity_count+1,sizeof(sync_entity_t))!=0)
+        return -3;
+
+    sync_entity_t* n=&out->entities[out->entity_count++];
+    *n=*e;
+    n->item_off=out->item_count;
+    n->attr_off=out->attr_count;
+
+    for(uint32_t k=0;k<e->item_count;k++){
+        const sync_item_t* it=&in->items[e->item_off+k];
+        if(push_item(out,it->item,it->count)!=0) return -3;
+    }
+    for(uint32_t k=0;k<e->attr_count;k++){
+        const sync_attr_t* a=&in->attrs[e->attr_off+k];
+        if(push_attr(out,a->key,a->type,in->bytes+a->off,a->len)!=0) return -3;
+    }
+    return 0;
+}
+
+/* Merge one encoded entity over its base record (NULL when the mirror lacks it) */
+static int apply_entity(reader_t* r,sync_snapshot_t* out,const sync_snapshot_t* in,
+                        const sync_entity_t* a,uint32_t entity,unsigned flags,uint32_t limit)
+{
+    if(flags&FOSSIL_GAME_SYNC_REMOVED)
+        return a && flags==FOSSIL_GAME_SYNC_REMOVED?0:-2;
+    if(!a==!(flags&FOSSIL_GAME_SYNC_ADDED))
+        return -2;
+
+    static const sync_entity_t none={0,0,0,0,0,0};
+    if(!a) a=&none;
+
+    if(grow((void**)&out->entities,&out->entity_cap,out->entity_count+1,sizeof(sync_entity_t))!=0)
+        return -3;
+    uint32_t at=out->entity_count++;
+
+    int64_t score=a->score;
+    if(flags&FOSSIL_GAME_SYNC_SCORE) score+=get_zigzag(r);
+    if(r->bad || score<INT32_MIN || score>INT32_MAX) return -2;
+
+    uint32_t item_off=out->item_count;
+    const sync_item_t* ai=a->item_count?in->items+a->item_off:NULL;
+    int rc=0;
+    if(flags&FOSSIL_GAME_SYNC_ITEMS) rc=apply_items(r,out,ai,a->item_count,limit);
+    else for(uint32_t k=0;k<a->item_count && !rc;k++) rc=push_item(out,ai[k].item,ai[k].count)?-3:0;
+    if(rc) return rc;
+
+    uint32_t attr_off=out->attr_count;
+    const sync_attr_t* aa=a->attr_count?in->attrs+a->attr_off:NULL;
+    if(flags&FOSSIL_GAME_SYNC_ATTRS) rc=apply_attrs(r,out,aa,a->attr_count,in->bytes,limit);
+    else for(uint32_t k=0;k<a->attr_count && !rc;k++)
+        rc=push_attr(out,aa[k].key,aa[k].type,in->bytes+aa[k].off,aa[k].len)?-3:0;
+    if(rc) return rc;
+
+    sync_entity_t* e=&out->entities[at];
+    e->entity=entity;
+    e->score=(int32_t)score;
+    e->item_off=item_off;
+    e->item_count=out->item_count-item_off;
+    e->attr_off=attr_off;
+    e->attr_count=out->attr_count-attr_off;
+    return 0;
+}
+
+static int mirror_apply(fossil_game_sync_mirror* m,reader_t* r,uint32_t* out_tick)
+{
+    uint64_t tick=get_varint(r);
+    uint64_t base=get_varint(r);
+    if(r->bad || tick==0 || tick>UINT32_MAX) return -2;
+
+    if(base && (m->tick==0 || base-1!=m->tick)) return -5;
+    if(!base){
+        /* full state: start over with an empty table */
+        dict_free(&m->dict);
+        snapshot_clear(&m->snap[m->cur]);
+        m->tick=0;
+    }
+
+    const sync_snapshot_t* in=&m->snap[m->cur];
+    sync_snapshot_t* out=&m->snap[m->cur^1];
+    snapshot_clear(out);
+
+    uint64_t first=get_varint(r);
+    uint64_t fresh=get_varint(r);
+    if(r->bad || first!=m->dict.count || fresh>r->len) return -2;
+
+    for(uint64_t k=0;k<fresh;k++){
+        uint64_t len=get_varint(r);
+        const unsigned char* b=r->bad?NULL:get_bytes(r,len);
+        if(r->bad) return -2;
+
+        uint32_t count=m->dict.count;
+        if(intern(&m->dict,(const char*)b,(size_t)len)==UINT32_MAX) return -3;
+        if(m->dict.count==count) return -2;   /* a repeated string */
+    }
+
+    uint32_t limit=m->dict.count;
+    uint64_t n=get_varint(r);
+    uint32_t i=0,prev=0;
+
+    for(uint64_t k=0;k<n;k++){
+        uint32_t entity;
+        if(get_index(r,(uint32_t)(k>0),prev,limit,&entity)!=0) return -2;
+        unsigned flags=get_byte(r);
+        if(r->bad || (flags&~0x1fu)) return -2;
+
+        int rc;
+        for(;i<in->entity_count && in->entities[i].entity<entity;i++)
+            if((rc=copy_entity(out,in,&in->entities[i]))!=0) return rc;
+
+        const sync_entity_t* a=NULL;
+        if(i<in->entity_count && in->entities[i].entity==entity) a=&in->entities[i++];
+
+        if((rc=apply_entity(r,out,in,a,entity,flags,limit))!=0) return rc;
+        prev=entity;
+    }
+
+    for(int rc;i<in->entity_count;i++)
+        if((rc=copy_entity(out,in,&in->entities[i]))!=0) return rc;
+
+    if(r->pos!=r->len) return -2;
+
+    out->tick=(uint32_t)tick;
+    out->dict_count=limit;
+    m->cur^=1;
+    m->tick=(uint32_t)tick;
+    if(out_tick) *out_tick=m->tick;
+    return 0;
+}
+
+fossil_game_sync_mirror* fossil_game_sync_mirror_create(void)
+{
+    return calloc(1,sizeof(fossil_game_sync_mirror));
+}
+
+void fossil_game_sync_mirror_free(fossil_game_sync_mirror* m)
+{
+    if(!m) return;
+
+    dict_free(&m->dict);
+    snapshot_free(&m->snap[0]);
+    snapshot_free(&m->snap[1]);
+    free(m);
+}
+
+int fossil_game_sync_apply(fossil_game_sync_mirror* m,const unsigned char* data,size_t len,uint32_t* out_tick)
+{
+    if(!m||!data) return -1;
+
+    uint32_t tick=m->tick,dict_count=m->dict.count;
+    reader_t r={data,len,0,0};
+
+    FOSSIL_GAME_TRACE_BEGIN("sync_apply");
+    int rc=mirror_apply(m,&r,out_tick);
+    FOSSIL_GAME_TRACE_END("sync_apply");
+
+    if(rc!=0 && rc!=-5){
+        /* a failed delta leaves the previous state in place; a failed full state leaves none */
+        if(m->tick==tick) dict_truncate(&m->dict,dict_count);
+        else snapshot_clear(&m->snap[m->cur]);
+    }
+    return rc;
+}
+
+uint32_t fossil_game_sync_mirror_tick(const fossil_game_sync_mirror* m)
+{
+    return m?m->tick:0;
+}
+
+int fossil_game_sync_mirror_count(const fossil_game_sync_mirror* m)
+{
+    return m?(int)m->snap[m->cur].entity_count:0;
+}
+
+static const sync_entity_t* mirror_entity(const fossil_game_sync_mirror* m,const char* player_id)
+{
+    if(!m||!player_id) return NULL;
+
+    uint32_t entity=dict_find(&m->dict,player_id,strlen(player_id));
+    if(entity==UINT32_MAX) return NULL;
+
+    const sync_snapshot_t* snap=&m->snap[m->cur];
+    uint32_t lo=0,hi=snap->entity_count;
+    while(lo<hi){
+        uint32_t mid=lo+(hi-lo)/2;
+        if(snap->entities[mid].entity<entity) lo=mid+1;
+        else hi=mid;
+    }
+    return lo<snap->entity_count && snap->entities[lo].entity==entity?&snap->entities[lo]:NULL;
+}
+
+int fossil_game_sync_mirror_score(const fossil_game_sync_mirror* m,const char* player_id,int* out_points)
+{
+    if(!out_points) return -1;
+
+    const sync_entity_t* e=mirror_entity(m,player_id);
+    if(!e) return -2;
+
+    *out_points=e->score;
+    return 0;
+}
+
+int fossil_game_sync_mirror_item_count(const fossil_game_sync_mirror* m,const char* player_id,const char* item_id)
+{
+    const sync_entity_t* e=mirror_entity(m,player_id);
+    if(!e||!item_id) return -2;
+
+    uint32_t item=dict_find(&m->dict,item_id,strlen(item_id));
+    const sync_item_t* items=m->snap[m->cur].items+e->item_off;
+    for(uint32_t k=0;k<e->item_count && items[k].item<=item;k++)
+        if(items[k].item==item) return items[k].count;
+    return 0;
+}
+
+int fossil_game_sync_mirror_attr(const fossil_game_sync_mirror* m,const char* player_id,const char* key,
+                                 int* out_type,const void** out_data,size_t* out_len)
+{
+    const sync_entity_t* e=mirror_entity(m,player_id);
+    if(!e||!key) return -2;
+
+    uint32_t k=dict_find(&m->dict,key,strlen(key));
+    const sync_snapshot_t* snap=&m->snap[m->cur];
+    const sync_attr_t* attrs=snap->attrs+e->attr_off;
+
+    for(uint32_t i=0;i<e->attr_count && attrs[i].key<=k;i++){
+        if(attrs[i].key!=k) continue;
+        if(out_type) *out_type=(int)attrs[i].type;
+        if(out_data) *out_data=snap->bytes+attrs[i].off;
+        if(out_len) *out_len=attrs[i].len;
+        return 0;
+    }
+    return -2;
+}
+
+int fossil_game_sync_mirror_items(const fossil_game_sync_mirror* m,const char* player_id,
+                                  fossil_game_player_item_fn fn,void* ctx)
+{
+    const sync_entity_t* e=mirror_entity(m,player_id);
+    if(!e||!fn) return -2;
+
+    const sync_item_t* items=m->snap[m->cur].items+e->item_off;
+    for(uint32_t k=0;k<e->item_count;k++){
+        int rc=fn(m->dict.strings[items[k].item],items[k].count,ctx);
+        if(rc) return rc;
+    }
+    return 0;
+}
+
+int fossil_game_sync_mirror_attrs(const fossil_game_sync_mirror* m,const char* player_id,
+                                  fossil_game_player_attr_fn fn,void* ctx)
+{
+    const sync_entity_t* e=mirror_entity(m,player_id);
+    if(!e||!fn) return -2;
+
+    const sync_snapshot_t* snap=&m->snap[m->cur];
+    const sync_attr_t* attrs=snap->attrs+e->attr_off;
+    for(uint32_t k=0;k<e->attr_count;k++){
+        int rc=fn(m->dict.strings[attrs[k].key],(int)attrs[k].type,snap->bytes+attrs[k].off,attrs[k].len,ctx);
+        if(rc) return rc;
+    }
+    return 0;
+}
@@ -0,0 +1,385 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(FOSSIL_GAME_TRACE)
+#include <pthread.h>
+#endif
+
+static uint64_t now_ns(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER f,c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (uint64_t)((double)c.QuadPart*1e9/(double)f.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec*1000000000u+(uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Frame bookkeeping, always compiled */
+static uint64_t g_frame = 0;
+static uint64_t g_frame_start_ns = 0;
+static double g_budget_ms = 0;
+static fossil_game_trace_overrun_fn g_overrun_fn = NULL;
+static void* g_overrun_ctx = NULL;
+
+#if defined(FOSSIL_GAME_TRACE)
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define TICKS() __rdtsc()
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TICKS() __rdtsc()
+#else
+#define TICKS() now_ns()
+#endif
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+#define RING_MASK (FOSSIL_GAME_TRACE_EVENTS-1)
+
+typedef struct {
+    uint64_t ts;                /* ticks */
+    const char* name;
+    char phase;                 /* 'B' or 'E' */
+} trace_event_t;
+
+/*
+ * Rings outlive their threads so their events still export. A thread that
+ * exits retires its ring and the next new thread takes it over, lane
+ * included, so short-lived workers do not grow the list; at most
+ * FOSSIL_GAME_TRACE_THREADS rings are ever allocated.
+ */
+typedef struct trace_ring {
+    struct trace_ring* next;
+    uint32_t tid;
+    uint32_t owned;             /* a live thread records into it */
+    uint64_t head;              /* events ever written; published after the slot */
+    trace_event_t events[FOSSIL_GAME_TRACE_EVENTS];
+} trace_ring_t;
+
+int fossil_game_trace_on = 0;
+
+static trace_ring_t* g_rings = NULL;
+static uint32_t g_next_tid = 0;
+static THREAD_LOCAL trace_ring_t* t_ring = NULL;
+static THREAD_LOCAL int t_no_ring = 0;      /* over the cap; do not retry every event */
+
+static uint64_t g_epoch = 0;            /* ticks at enable, time zero of the export */
+static double g_ns_per_tick = 1.0;
+static int g_calibrated = 0;
+static uint64_t g_frame_ticks[FOSSIL_GAME_TRACE_FRAMES];
+
+static void calibrate(void)
+{
+    if(g_calibrated) return;
+
+    uint64_t n0=now_ns(),t0=TICKS(),n1;
+    do n1=now_ns(); while(n1-n0<2000000u);
+    uint64_t t1=TICKS();
+
+    if(t1>t0) g_ns_per_tick=(double)(n1-n0)/(double)(t1-t0);
+    g_calibrated=1;
+}
+
+static trace_ring_t* rings_head(void)
+{
+#if defined(_MSC_VER)
+    return (trace_ring_t*)InterlockedCompareExchangePointer((void* volatile*)&g_rings,NULL,NULL);
+#else
+    return __atomic_load_n(&g_rings,__ATOMIC_ACQUIRE);
+#endif
+}
+
+static uint64_t ring_head(trace_ring_t* r)
+{
+#if defined(_MSC_VER)
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)&r->head,0,0);
+#else
+    return __atomic_load_n(&r->head,__ATOMIC_ACQUIRE);
+#endif
+}
+
+static int ring_claim(trace_ring_t* r)
+{
+#if defined(_MSC_VER)
+    return InterlockedCompareExchange((volatile LONG*)&r->owned,1,0)==0;
+#else
+    uint32_t free_=0;
+    return __atomic_compare_exchange_n(&r->owned,&free_,1,0,__ATOMIC_ACQUIRE,__ATOMIC_RELAXED);
+#endif
+}
+
+/* Thread exit hook: hands the ring back for the next new thread */
+#if defined(_WIN32)
+static DWORD g_exit_slot = FLS_OUT_OF_INDEXES;
+static INIT_ONCE g_exit_once = INIT_ONCE_STATIC_INIT;
+
+static VOID NTAPI ring_retire(PVOID p)
+{
+    if(p) InterlockedExchange((volatile LONG*)&((trace_ring_t*)p)->owned,0);
+}
+
+static BOOL CALLBACK exit_init(PINIT_ONCE once,PVOID param,PVOID* ctx)
+{
+    (void)once; (void)param; (void)ctx;
+    g_exit_slot=FlsAlloc(ring_retire);
+    return TRUE;
+}
+
+static void ring_watch(trace_ring_t* r)
+{
+    InitOnceExecuteOnce(&g_exit_once,exit_init,NULL,NULL);
+    if(g_exit_slot!=FLS_OUT_OF_INDEXES) FlsSetValue(g_exit_slot,r);
+}
+#else
+static pthread_key_t g_exit_key;
+static pthread_once_t g_exit_once = PTHREAD_ONCE_INIT;
+static int g_exit_ok = 0;
+
+static void ring_retire(void* p)
+{
+    __atomic_store_n(&((trace_ring_t*)p)->owned,0,__ATOMIC_RELEASE);
+}
+
+static void exit_init(void)
+{
+    g_exit_ok=pthread_key_create(&g_exit_key,ring_retire)==0;
+}
+
+static void ring_watch(trace_ring_t* r)
+{
+    pthread_once(&g_exit_once,exit_init);
+    if(g_exit_ok) pthread_setspecific(g_exit_key,r);
+}
+#endif
+
+static trace_ring_t* ring_get(void)
+{
+    if(t_ring) return t_ring;
+    if(t_no_ring) return NULL;
+
+    trace_ring_t* r=rings_head();
+    while(r && !ring_claim(r)) r=r->next;
+
+    if(!r){
+#if defined(_MSC_VER)
+        uint32_t tid=(uint32_t)InterlockedIncrement((volatile LONG*)&g_next_tid);
+#else
+        uint32_t tid=__atomic_add_fetch(&g_next_tid,1,__ATOMIC_RELAXED);
+#endif
+        if(tid>FOSSIL_GAME_TRACE_THREADS || !(r=calloc(1,sizeof(*r)))){
+            t_no_ring=1;
+            return NULL;
+        }
+        r->tid=tid;
+        r->owned=1;
+
+#if defined(_MSC_VER)
+        trace_ring_t* head;
+        do{
+            head=rings_head();
+            r->next=head;
+        }while(InterlockedCompareExchangePointer((void* volatile*)&g_rings,r,head)!=head);
+#else
+        r->next=rings_head();
+        while(!__atomic_compare_exchange_n(&g_rings,&r->next,r,1,__ATOMIC_RELEASE,__ATOMIC_RELAXED));
+#endif
+    }
+
+    ring_watch(r);
+    t_ring=r;
+    return r;
+}
+
+void fossil_game_trace_event(const char* name,char phase)
+{
+    trace_ring_t* r=ring_get();
+    if(!r) return;
+
+    uint64_t h=r->head;
+    trace_event_t* e=&r->events[h&RING_MASK];
+    e->ts=TICKS();
+    e->name=name;
+    e->phase=phase;
+
+#if defined(_MSC_VER)
+    InterlockedExchange64((volatile LONG64*)&r->head,(LONG64)(h+1));
+#else
+    __atomic_store_n(&r->head,h+1,__ATOMIC_RELEASE);
+#endif
+}
+
+#endif /* FOSSIL_GAME_TRACE */
+
+/* ============================================================
+   Control and frames
+   ============================================================ */
+
+int fossil_game_trace_enable(int on)
+{
+#if defined(FOSSIL_GAME_TRACE)
+    if(on && !g_calibrated){
+        calibrate();
+        g_epoch=TICKS();
+    }
+    fossil_game_trace_on=on?1:0;
+    return 0;
+#else
+    (void)on;
+    return -4;
+#endif
+}
+
+int fossil_game_trace_enabled(void)
+{
+#if defined(FOSSIL_GAME_TRACE)
+    return fossil_game_trace_on;
+#else
+    return 0;
+#endif
+}
+
+void fossil_game_trace_frame_begin(void)
+{
+    g_frame++;
+    g_frame_start_ns=now_ns();
+
+#if defined(FOSSIL_GAME_TRACE)
+    if(fossil_game_trace_on){
+        g_frame_ticks[g_frame%FOSSIL_GAME_TRACE_FRAMES]=TICKS();
+        fossil_game_trace_event("frame",'B');
+    }
+#endif
+}
+
+int fossil_game_trace_frame_end(void)
+{
+    FOSSIL_GAME_TRACE_END("frame");
+    if(g_budget_ms<=0 || !g_frame_start_ns) return 0;
+
+    double ms=(double)(now_ns()-g_frame_start_ns)/1e6;
+    if(ms<=g_budget_ms) return 0;
+
+    if(g_overrun_fn) g_overrun_fn(g_frame,ms,g_overrun_ctx);
+    return 1;
+}
+
+uint64_t fossil_game_trace_frame(void)
+{
+    return g_frame;
+}
+
+int fossil_game_trace_set_budget(double budget_ms,fossil_game_trace_overrun_fn fn,void* ctx)
+{
+    g_budget_ms=budget_ms;
+    g_overrun_fn=fn;
+    g_overrun_ctx=ctx;
+    return 0;
+}
+
+void fossil_game_trace_zone_begin(const char* name)
+{
+    if(!name) return;
+    FOSSIL_GAME_TRACE_BEGIN(name);
+}
+
+void fossil_game_trace_zone_end(const char* name)
+{
+    if(!name) return;
+    FOSSIL_GAME_TRACE_END(name);
+}
+
+/* ============================================================
+   Export
+   ============================================================ */
+
+int fossil_game_trace_export(FILE* out,int frames)
+{
+    if(!out||frames<0) return -1;
+
+    fprintf(out,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+#if defined(FOSSIL_GAME_TRACE)
+    /* frames older than the kept start times fall back to everything buffered */
+    uint64_t since=0;
+    if(frames && (uint64_t)frames<=g_frame && frames<=FOSSIL_GAME_TRACE_FRAMES)
+        since=g_frame_ticks[(g_frame-(uint64_t)frames+1)%FOSSIL_GAME_TRACE_FRAMES];
+
+    int first=1;
+    for(trace_ring_t* r=rings_head();r;r=r->next){
+        uint64_t head=ring_head(r);
+        uint64_t tail=head>FOSSIL_GAME_TRACE_EVENTS?head-FOSSIL_GAME_TRACE_EVENTS:0;
+
+        for(uint64_t i=tail;i<head;i++){
+            const trace_event_t* e=&r->events[i&RING_MASK];
+            if(e->ts<since || e->ts<g_epoch || !e->name) continue;
+
+            fprintf(out,"%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                    first?"":",",e->name,e->phase,(double)(e->ts-g_epoch)*g_ns_per_tick/1e3,r->tid);
+            first=0;
+        }
+    }
+#else
+    (void)frames;
+#endif
+
+    fprintf(out,"\n]}\n");
+    return ferror(out)?-4:0;
+}
+
+int fossil_game_trace_dump(const char* path,int frames)
+{
+    if(!path) return -1;
+
+    FILE* f=fopen(path,"w");
+    if(!f) return -4;
+
+    int rc=fossil_game_trace_export(f,frames);
+    if(fclose(f)!=0 && !rc) rc=-4;
+    return rc;
+}
+
+void fossil_game_trace_clear(void)
+{
+#if defined(FOSSIL_GAME_TRACE)
+    /* moving the epoch hides every event recorded so far */
+    g_epoch=TICKS();
+#endif
+}
@@ -0,0 +1,811 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/wal.h"
+#include "fossil/game/player.h"
+#include "fossil/game/quizzed.h"
+#include "fossil/game/score.h"
+#include "fossil/game/state.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define WAL_MAGIC "FGWL"
+#define WAL_VERSION 1
+#define WAL_HEADER 8
+#define FRAME_HEADER 16         /* u32 payload length, u32 checksum, u64 lsn */
+#define WAL_DEFAULT_BATCH (64u<<10)
+
+enum {
+    OP_PLAYER_CREATE=1,
+    OP_SCORE_UPDATE,
+    OP_INVENTORY_ADD,
+    OP_INVENTORY_REMOVE,
+    OP_INVENTORY_TRADE,
+    OP_QUIZZED_ANSWER,
+    OP_PLAYER_REMOVE,
+    OP_SCORE_RESET,
+    OP_SCOREBOARD_JOIN,
+    OP_QUIZZED_CREATE,
+    OP_QUIZZED_REMOVE,
+    OP_QUIZZED_QUESTION,
+    OP_QUIZZED_OPTION,
+    OP_QUIZZED_REMOVE_QUESTION,
+    OP_QUIZZED_RESET
+};
+
+static FILE* g_file=NULL;
+static char* g_path=NULL;
+static fossil_game_wal_config g_config;
+
+/* pending batch; the first FRAME_HEADER bytes are filled in at commit */
+static unsigned char* g_buf=NULL;
+static size_t g_len=0;
+static size_t g_cap=0;
+static int g_err=0;
+
+static uint64_t g_lsn=0;            /* last committed or replayed frame */
+static uint64_t g_snapshot_lsn=0;   /* last frame covered by the loaded snapshot */
+static uint64_t g_last_sync_ms=0;
+
+static char* fossil_strdup(const char* s)
+{
+    if(!s) return NULL;
+
+    size_t len = 0;
+    while(s[len]) len++;
+
+    char* out = (char*)malloc(len + 1);
+    if(!out) return NULL;
+
+    for(size_t i=0;i<=len;i++)
+        out[i] = s[i];
+
+    return out;
+}
+
+static uint64_t now_ms(void)
+{
+#if defined(_WIN32)
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (uint64_t)ts.tv_sec*1000u+(uint64_t)ts.tv_nsec/1000000u;
+#endif
+}
+
+static uint32_t checksum(const unsigned char* data,size_t len)
+{
+    uint32_t h=2166136261u;
+    for(size_t i=0;i<len;i++){
+        h^=data[i];
+        h*=16777619u;
+    }
+    return h;
+}
+
+static void put_le(unsigned char* out,uint64_t v,int n)
+{
+    for(int i=0;i<n;i++) out[i]=(unsigned char)(v>>(8*i));
+}
+
+static uint64_t get_le(const unsigned char* in,int n)
+{
+    uint64_t v=0;
+    for(int i=0;i<n;i++) v|=(uint64_t)in[i]<<(8*i);
+    return v;
+}
+
+/* ============================================================
+   Encoding
+   ============================================================ */
+
+static int reserve(size_t n)
+{
+    if(g_len+n<=g_cap) return 0;
+
+    size_t cap=g_cap*2;
+    while(cap<g_len+n) cap*=2;
+    unsigned char* tmp=realloc(g_buf,cap);
+    if(!tmp){ g_err=-3; return -1; }
+    g_buf=tmp;
+    g_cap=cap;
+    return 0;
+}
+
+static inline void put_u(uint64_t v)
+{
+    while(v>=0x80){
+        g_buf[g_len++]=(unsigned char)(v|0x80);
+        v>>=7;
+    }
+    g_buf[g_len++]=(unsigned char)v;
+}
+
+static inline void put_i(int64_t v)
+{
+    put_u(((uint64_t)v<<1)^(uint64_t)(v>>63));
+}
+
+static inline void put_str(const char* s,size_t len)
+{
+    put_u(len);
+    memcpy(g_buf+g_len,s,len);
+    g_len+=len;
+}
+
+/* Upper bound for an encoded string */
+#define STR_BOUND(len) ((len)+10)
+
+static void write_frame(void)
+{
+    size_t payload=g_len-FRAME_HEADER;
+    uint64_t lsn=g_lsn+1;
+
+    put_le(g_buf+8,lsn,8);
+    put_le(g_buf,payload,4);
+    put_le(g_buf+4,checksum(g_buf+8,g_len-8),4);
+
+    if(fwrite(g_buf,1,g_len,g_file)!=g_len || fflush(g_file)!=0){
+        g_err=-4;
+        return;
+    }
+    g_lsn=lsn;
+    g_len=FRAME_HEADER;
+
+    int sync=g_config.sync==FOSSIL_GAME_WAL_SYNC_COMMIT;
+    if(g_config.sync==FOSSIL_GAME_WAL_SYNC_INTERVAL){
+        uint64_t now=now_ms();
+        if(now-g_last_sync_ms>=g_config.interval_ms){
+            g_last_sync_ms=now;
+            sync=1;
+        }
+    }
+    if(!sync) return;
+
+#if defined(_WIN32)
+    if(_commit(_fileno(g_file))!=0) g_err=-4;
+#else
+    if(fsync(fileno(g_file))!=0) g_err=-4;
+#endif
+}
+
+/* Record tail: commits once the batch is full */
+static inline void end_record(void)
+{
+    if(g_len-FRAME_HEADER>=g_config.batch_bytes && !g_err) write_frame();
+}
+
+/* ============================================================
+   Record hooks
+   ============================================================ */
+
+void fossil_game_wal_record_player_create(const char* player_id)
+{
+    if(!g_file||!player_id) return;
+
+    size_t n=strlen(player_id);
+    if(reserve(1+STR_BOUND(n))) return;
+
+    g_buf[g_len++]=OP_PLAYER_CREATE;
+    put_str(player_id,n);
+    end_record();
+}
+
+/* Record of n ids and, when value is non-NULL, one trailing int */
+static void record_ids(int op,const char* const* ids,int n,const int* value)
+{
+    if(!g_file) return;
+
+    size_t bound=1+(value?10:0);
+    for(int i=0;i<n;i++){
+        if(!ids[i]) return;
+        bound+=STR_BOUND(strlen(ids[i]));
+    }
+    if(reserve(bound)) return;
+
+    g_buf[g_len++]=(unsigned char)op;
+    for(int i=0;i<n;i++) put_str(ids[i],strlen(ids[i]));
+    if(value) put_i(*value);
+    end_record();
+}
+
+void fossil_game_wal_record_player_remove(const char* player_id)
+{
+    record_ids(OP_PLAYER_REMOVE,&player_id,1,NULL);
+}
+
+void fossil_game_wal_record_score_update(const char* player_id,int points)
+{
+    if(!g_file||!player_id) return;
+
+    size_t n=strlen(player_id);
+    if(reserve(1+STR_BOUND(n)+10)) return;
+
+    g_buf[g_len++]=OP_SCORE_UPDATE;
+    put_str(player_id,n);
+    put_i(points);
+    end_record();
+}
+
+void fossil_game_wal_record_score_reset(const char* player_id)
+{
+    record_ids(OP_SCORE_RESET,&player_id,1,NULL);
+}
+
+void fossil_game_wal_record_scoreboard_join(const char* board_id,const char* player_id)
+{
+    const char* ids[2]={ board_id,player_id };
+    record_ids(OP_SCOREBOARD_JOIN,ids,2,NULL);
+}
+
+static void record_inventory(int op,const char* player_id,const char* item_id,int count)
+{
+    if(!g_file||!player_id||!item_id) return;
+
+    size_t n=strlen(player_id),m=strlen(item_id);
+    if(reserve(1+STR_BOUND(n)+STR_BOUND(m)+10)) return;
+
+    g_buf[g_len++]=(unsigned char)op;
+    put_str(player_id,n);
+    put_str(item_id,m);
+    put_i(count);
+    end_record();
+}
+
+void fossil_game_wal_record_inventory_add(const char* player_id,const char* item_id,int count)
+{
+    record_inventory(OP_INVENTORY_ADD,player_id,item_id,count);
+}
+
+void fossil_game_wal_record_inventory_remove(const char* player_id,const char* item_id,int count)
+{
+    record_inventory(OP_INVENTORY_REMOVE,player_id,item_id,count);
+}
+
+static int put_side(const char* player,const char* const* items,const int* counts,size_t count)
+{
+    size_t bound=STR_BOUND(strlen(player))+10;
+    for(size_t i=0;i<count;i++) bound+=STR_BOUND(strlen(items[i]))+10;
+    if(reserve(bound)) return -1;
+
+    put_str(player,strlen(player));
+    put_u(count);
+    for(size_t i=0;i<count;i++){
+        put_str(items[i],strlen(items[i]));
+        put_i(counts[i]);
+    }
+    return 0;
+}
+
+void fossil_game_wal_record_inventory_trade(const char* player_a,const char* const* a_items,const int* a_counts,size_t a_count,
+                                            const char* player_b,const char* const* b_items,const int* b_counts,size_t b_count)
+{
+    if(!g_file||!player_a||!player_b) return;
+    if(reserve(1)) return;
+
+    /* a failed side leaves a partial record behind; drop it */
+    size_t start=g_len;
+    g_buf[g_len++]=OP_INVENTORY_TRADE;
+    if(put_side(player_a,a_items,a_counts,a_count) || put_side(player_b,b_items,b_counts,b_count)){
+        g_len=start;
+        return;
+    }
+    end_record();
+}
+
+void fossil_game_wal_record_quizzed_answer(const char* quiz_id,const char* player_id,const char* answer)
+{
+    if(!g_file||!quiz_id||!player_id) return;
+
+    size_t q=strlen(quiz_id),p=strlen(player_id),a=answer?strlen(answer):0;
+    if(reserve(2+STR_BOUND(q)+STR_BOUND(p)+STR_BOUND(a))) return;
+
+    g_buf[g_len++]=OP_QUIZZED_ANSWER;
+    put_str(quiz_id,q);
+    put_str(player_id,p);
+    g_buf[g_len++]=answer!=NULL;
+    if(answer) put_str(answer,a);
+    end_record();
+}
+
+void fossil_game_wal_record_quizzed_create(const char* quiz_id)
+{
+    record_ids(OP_QUIZZED_CREATE,&quiz_id,1,NULL);
+}
+
+void fossil_game_wal_record_quizzed_remove(const char* quiz_id)
+{
+    record_ids(OP_QUIZZED_REMOVE,&quiz_id,1,NULL);
+}
+
+void fossil_game_wal_record_quizzed_question(const char* quiz_id,const char* question_id,const char* text)
+{
+    const char* ids[3]={ quiz_id,question_id,text };
+    record_ids(OP_QUIZZED_QUESTION,ids,3,NULL);
+}
+
+void fossil_game_wal_record_quizzed_option(const char* quiz_id,const char* question_id,const char* option_id,
+                                           const char* text,int correct)
+{
+    const char* ids[4]={ quiz_id,question_id,option_id,text };
+    record_ids(OP_QUIZZED_OPTION,ids,4,&correct);
+}
+
+void fossil_game_wal_record_quizzed_remove_question(const char* quiz_id,const char* question_id)
+{
+    const char* ids[2]={ quiz_id,question_id };
+    record_ids(OP_QUIZZED_REMOVE_QUESTION,ids,2,NULL);
+}
+
+void fossil_game_wal_record_quizzed_reset(const char* quiz_id,const char* player_id)
+{
+    const char* ids[2]={ quiz_id,player_id };
+    record_ids(OP_QUIZZED_RESET,ids,2,NULL);
+}
+
+/* ============================================================
+   Frames
+   ============================================================ */
+
+typedef struct {
+    const unsigned char* pos;
+    const unsigned char* end;
+    char* arena;                /* NUL-terminated copies of the record's strings */
+    size_t used;
+    int err;
+} record_reader_t;
+
+static uint64_t get_u(record_reader_t* r)
+{
+    uint64_t v=0;
+    for(int shift=0;shift<64;shift+=7){
+        if(r->pos==r->end){ r->err=1; return 0; }
+        unsigned char b=*r->pos++;
+        v|=(uint64_t)(b&0x7f)<<shift;
+        if(!(b&0x80)) return v;
+    }
+    r->err=1;
+    return 0;
+}
+
+static int get_i(record_reader_t* r)
+{
+    uint64_t v=get_u(r);
+    int64_t s=(int64_t)(v>>1)^-(int64_t)(v&1);
+    if(s<INT32_MIN||s>INT32_MAX) r->err=1;
+    return (int)s;
+}
+
+/* the arena holds payload + one NUL per string, so copies always fit */
+static const char* get_str(record_reader_t* r)
+{
+    uint64_t len=get_u(r);
+    if(r->err || len>(uint64_t)(r->end-r->pos)){ r->err=1; return ""; }
+
+    char* s=r->arena+r->used;
+    memcpy(s,r->pos,(size_t)len);
+    s[len]='\0';
+    r->pos+=len;
+    r->used+=(size_t)len+1;
+    return s;
+}
+
+static int apply_trade(record_reader_t* r)
+{
+    const char* player[2];
+    const char** items[2]={NULL,NULL};
+    int* counts[2]={NULL,NULL};
+    size_t n[2]={0,0};
+
+    for(int side=0;side<2 && !r->err;side++){
+        player[side]=get_str(r);
+        uint64_t count=get_u(r);
+        if(r->err || count>(uint64_t)(r->end-r->pos)){ r->err=1; break; }
+
+        n[side]=(size_t)count;
+        items[side]=malloc(sizeof(char*)*(n[side]?n[side]:1));
+        counts[side]=malloc(sizeof(int)*(n[side]?n[side]:1));
+        if(!items[side]||!counts[side]){ r->err=1; break; }
+
+        for(size_t i=0;i<n[side];i++){
+            items[side][i]=get_str(r);
+            counts[side][i]=get_i(r);
+        }
+    }
+
+    int rc=r->err?-2:fossil_game_player_inventory_trade(player[0],(const char* const*)items[0],counts[0],n[0],
+                                                          player[1],(const char* const*)items[1],counts[1],n[1]);
+    for(int side=0;side<2;side++){
+        free(items[side]);
+        free(counts[side]);
+    }
+    return rc;
+}
+
+/* Applies one record; returns 1 when the mutation took effect, 0 when it was refused, -1 on a bad record */
+static int apply_record(record_reader_t* r)
+{
+    int op=r->pos<r->end?*r->pos++:0;
+    r->used=0;
+    int rc;
+
+    if(op==OP_PLAYER_CREATE){
+        const char* id=get_str(r);
+        rc=r->err?0:fossil_game_player_create(id);
+    }else if(op==OP_SCORE_UPDATE){
+        const char* id=get_str(r);
+        int points=get_i(r);
+        rc=r->err?0:fossil_game_score_update(id,points);
+    }else if(op==OP_INVENTORY_ADD||op==OP_INVENTORY_REMOVE){
+        const char* id=get_str(r);
+        const char* item=get_str(r);
+        int count=get_i(r);
+        if(r->err) rc=0;
+        else if(op==OP_INVENTORY_ADD) rc=fossil_game_player_inventory_add(id,item,count);
+        else rc=fossil_game_player_inventory_remove(id,item,count);
+    }else if(op==OP_INVENTORY_TRADE){
+        rc=apply_trade(r);
+    }else if(op==OP_QUIZZED_ANSWER){
+        const char* quiz=get_str(r);
+        const char* id=get_str(r);
+        int has=r->pos<r->end?*r->pos++:(r->err=1,0);
+        const char* answer=has?get_str(r):NULL;
+        rc=r->err?0:fossil_game_quizzed_answer(quiz,id,answer);
+    }else if(op==OP_PLAYER_REMOVE){
+        const char* id=get_str(r);
+        rc=r->err?0:fossil_game_player_remove(id);
+    }else if(op==OP_SCORE_RESET){
+        const char* id=get_str(r);
+        rc=r->err?0:fossil_game_score_reset(id);
+    }else if(op==OP_SCOREBOARD_JOIN){
+        const char* board=get_str(r);
+        const char* id=get_str(r);
+        rc=r->err?0:fossil_game_scoreboard_join(board,id);
+    }else if(op==OP_QUIZZED_CREATE||op==OP_QUIZZED_REMOVE){
+        const char* quiz=get_str(r);
+        if(r->err) rc=0;
+        else if(op==OP_QUIZZED_CREATE) rc=fossil_game_quizzed_create(quiz);
+        else rc=fossil_game_quizzed_remove(quiz);
+    }else if(op==OP_QUIZZED_QUESTION){
+        const char* quiz=get_str(r);
+        const char* question=get_str(r);
+        const char* text=get_str(r);
+        rc=r->err?0:fossil_game_quizzed_add_question(quiz,question,text);
+    }else if(op==OP_QUIZZED_OPTION){
+        const char* quiz=get_str(r);
+        const char* question=get_str(r);
+        const char* option=get_str(r);
+        const char* text=get_str(r);
+        int correct=get_i(r);
+        rc=r->err?0:fossil_game_quizzed_add_option(quiz,question,option,text,correct);
+    }else if(op==OP_QUIZZED_REMOVE_QUESTION||op==OP_QUIZZED_RESET){
+        const char* quiz=get_str(r);
+        const char* id=get_str(r);
+        if(r->err) rc=0;
+        else if(op==OP_QUIZZED_RESET) rc=fossil_game_quizzed_reset(quiz,id);
+        else rc=fossil_game_quizzed_remove_question(quiz,id);
+    }else{
+        return -1;
+    }
+
+    if(r->err) return -1;
+    return rc==0;
+}
+
+/*
+ * Walks the frames of a log image. Stops at the first frame that is
+ * truncated or fails its checksum, which is where a crash mid-write leaves
+ * the log; *out_valid is the length of the intact prefix.
+ */
+static int scan(const unsigned char* data,size_t size,int apply,size_t* out_valid,int* out_applied)
+{
+    *out_valid=0;
+    *out_applied=0;
+    if(size<WAL_HEADER) return 0;
+    if(memcmp(data,WAL_MAGIC,4)!=0 || get_le(data+4,4)!=WAL_VERSION) return -2;
+
+    size_t pos=WAL_HEADER;
+    *out_valid=pos;
+
+    char* arena=NULL;
+    size_t arena_cap=0;
+
+    while(size-pos>=FRAME_HEADER){
+        const unsigned char* f=data+pos;
+        size_t len=(size_t)get_le(f,4);
+        if(len>size-pos-FRAME_HEADER) break;
+        if((uint32_t)get_le(f+4,4)!=checksum(f+8,len+8)) break;
+
+        uint64_t lsn=get_le(f+8,8);
+        if(apply && lsn>g_snapshot_lsn){
+            if(arena_cap<len*2+1){
+                free(arena);
+                arena_cap=len*2+1;
+                arena=malloc(arena_cap);
+                if(!arena) return -3;
+            }
+
+            record_reader_t r={ f+FRAME_HEADER,f+FRAME_HEADER+len,arena,0,0 };
+            while(r.pos<r.end){
+                int rc=apply_record(&r);
+                if(rc<0){ free(arena); return -2; }
+                *out_applied+=rc;
+            }
+        }
+        if(lsn>g_lsn) g_lsn=lsn;
+
+        pos+=FRAME_HEADER+len;
+        *out_valid=pos;
+    }
+
+    free(arena);
+    return 0;
+}
+
+static int read_file(const char* path,unsigned char** out,size_t* out_size)
+{
+    *out=NULL;
+    *out_size=0;
+
+    FILE* f=fopen(path,"rb");
+    if(!f) return 1;            /* no log yet */
+
+    long size=fseek(f,0,SEEK_END)==0?ftell(f):-1;
+    if(size<0 || fseek(f,0,SEEK_SET)!=0){ fclose(f); return -4; }
+
+    unsigned char* data=malloc(size?(size_t)size:1);
+    if(!data){ fclose(f); return -3; }
+    if(fread(data,1,(size_t)size,f)!=(size_t)size){ free(data); fclose(f); return -4; }
+
+    fclose(f);
+    *out=data;
+    *out_size=(size_t)size;
+    return 0;
+}
+
+static int truncate_file(const char* path,size_t size)
+{
+#if defined(_WIN32)
+    int fd=_open(path,_O_RDWR|_O_BINARY);
+    if(fd<0) return -4;
+    int rc=_chsize_s(fd,(__int64)size)==0?0:-4;
+    _close(fd);
+    return rc;
+#else
+    int fd=open(path,O_RDWR);
+    if(fd<0) return -4;
+    int rc=ftruncate(fd,(off_t)size)==0?0:-4;
+    close(fd);
+    return rc;
+#endif
+}
+
+static FILE* create_log(const char* path)
+{
+    FILE* f=fopen(path,"wb");
+    if(!f) return NULL;
+
+    unsigned char head[WAL_HEADER];
+    memcpy(head,WAL_MAGIC,4);
+    put_le(head+4,WAL_VERSION,4);
+    if(fwrite(head,1,sizeof(head),f)!=sizeof(head) || fflush(f)!=0){
+        fclose(f);
+        return NULL;
+    }
+    return f;
+}
+
+/* ============================================================
+   Lifecycle
+   ============================================================ */
+
+int fossil_game_wal_open(const char* path,const fossil_game_wal_config* config)
+{
+    if(!path) return -1;
+    if(g_file) return -5;
+
+    g_config.sync=FOSSIL_GAME_WAL_SYNC_COMMIT;
+    g_config.interval_ms=0;
+    g_config.batch_bytes=WAL_DEFAULT_BATCH;
+    if(config){
+        g_config=*config;
+        if(!g_config.batch_bytes) g_config.batch_bytes=WAL_DEFAULT_BATCH;
+    }
+
+    unsigned char* data;
+    size_t size,valid=0;
+    int applied;
+    int rc=read_file(path,&data,&size);
+    if(rc<0) return rc;
+
+    rc=rc?0:scan(data,size,0,&valid,&applied);
+    free(data);
+    if(rc) return rc;
+
+    /* an empty or headerless file starts over; a torn final frame is cut off */
+    if(valid<WAL_HEADER) g_file=create_log(path);
+    else if(valid<size && truncate_file(path,valid)!=0) return -4;
+    else g_file=fopen(path,"ab");
+    if(!g_file) return -4;
+
+    g_path=fossil_strdup(path);
+    g_cap=g_config.batch_bytes+FRAME_HEADER+256;
+    g_buf=malloc(g_cap);
+    if(!g_path||!g_buf){
+        fossil_game_wal_close();
+        return -3;
+    }
+
+    g_len=FRAME_HEADER;
+    g_err=0;
+    g_last_sync_ms=now_ms();
+    return 0;
+}
+
+int fossil_game_wal_commit(void)
+{
+    if(!g_file) return -1;
+    if(g_len>FRAME_HEADER && !g_err) write_frame();
+    return g_err;
+}
+
+int fossil_game_wal_close(void)
+{
+    int rc=g_file?fossil_game_wal_commit():0;
+
+    if(g_file && fclose(g_file)!=0 && !rc) rc=-4;
+    g_file=NULL;
+    free(g_path);
+    g_path=NULL;
+    free(g_buf);
+    g_buf=NULL;
+    g_len=g_cap=0;
+    return rc;
+}
+
+int fossil_game_wal_replay(const char* path)
+{
+    if(!path) return -1;
+    if(g_file) return -5;
+
+    unsigned char* data;
+    size_t size,valid;
+    int applied=0;
+    int rc=read_file(path,&data,&size);
+    if(rc) return rc>0?0:rc;
+
+    rc=scan(data,size,1,&valid,&applied);
+    free(data);
+    return rc?rc:applied;
+}
+
+int fossil_game_wal_checkpoint(const char* snapshot_path)
+{
+    if(!snapshot_path||!g_file) return -1;
+
+    int rc=fossil_game_wal_commit();
+    if(!rc) rc=fossil_game_state_save(snapshot_path);
+    if(rc) return rc;
+
+    /* the snapshot now covers every frame; a crash before this point replays them, skipping by lsn */
+    fclose(g_file);
+    g_file=create_log(g_path);
+    if(!g_file){
+        g_err=-4;
+        g_file=fopen(g_path,"ab");
+        return -4;
+    }
+    return 0;
+}
+
+/* Rewrites the log without the frames a snapshot already covers */
+int fossil_game_wal_compact(uint64_t lsn)
+{
+    if(!g_file) return -1;
+
+    int rc=fossil_game_wal_commit();
+    if(rc) return rc;
+
+    unsigned char* data;
+    size_t size;
+    rc=read_file(g_path,&data,&size);
+    if(rc) return rc>0?-4:rc;
+
+    size_t pos=WAL_HEADER;
+    while(size>=WAL_HEADER+FRAME_HEADER && pos<=size-FRAME_HEADER && get_le(data+pos+8,8)<=lsn)
+        pos+=FRAME_HEADER+(size_t)get_le(data+pos,4);
+    if(pos<=WAL_HEADER || pos>size){ free(data); return 0; }
+
+    size_t n=strlen(g_path);
+    char* tmp=malloc(n+5);
+    FILE* f=NULL;
+    if(tmp){
+        memcpy(tmp,g_path,n);
+        memcpy(tmp+n,".tmp",5);
+        f=create_log(tmp);
+    }
+
+    rc=!tmp?-3:!f?-4:0;
+    if(!rc && (fwrite(data+pos,1,size-pos,f)!=size-pos || fflush(f)!=0)) rc=-4;
+#if defined(_WIN32)
+    if(!rc && g_config.sync!=FOSSIL_GAME_WAL_SYNC_NONE && _commit(_fileno(f))!=0) rc=-4;
+#else
+    if(!rc && g_config.sync!=FOSSIL_GAME_WAL_SYNC_NONE && fsync(fileno(f))!=0) rc=-4;
+#endif
+    if(f && fclose(f)!=0 && !rc) rc=-4;
+    free(data);
+
+    if(!rc){
+        fclose(g_file);
+#if defined(_WIN32)
+        if(!MoveFileExA(tmp,g_path,MOVEFILE_REPLACE_EXISTING)) rc=-4;
+#else
+        if(rename(tmp,g_path)!=0) rc=-4;
+#endif
+        g_file=fopen(g_path,"ab");
+        if(!g_file){ g_err=-4; rc=-4; }
+    }
+    if(rc && tmp) remove(tmp);
+    free(tmp);
+    return rc;
+}
+
+uint64_t fossil_game_wal_lsn(void)
+{
+    return g_lsn;
+}
+
+/* ============================================================
+   Snapshot
+   ============================================================ */
+
+int fossil_game_wal_state_save(fossil_game_state_writer* w)
+{
+    if(!w) return -1;
+
+    /* pending records describe state the snapshot is about to include */
+    if(g_file) fossil_game_wal_commit();
+    fossil_game_state_put_u64(w,g_lsn);
+    return w->err;
+}
+
+int fossil_game_wal_state_load(fossil_game_state_reader* r)
+{
+    if(!r) return -1;
+
+    g_snapshot_lsn=fossil_game_state_get_u64(r);
+    if(g_snapshot_lsn>g_lsn) g_lsn=g_snapshot_lsn;
+    return r->err;
+}
@@ -0,0 +1,76 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/framework.h"
+#include <stdio.h>
+
+/*
+ * Score regression checks; each case prints its failures and the program
+ * exits non-zero when any case failed.
+ */
+
+static int g_failures=0;
+
+#define CHECK(cond) do{ if(!(cond)){ printf("%s:%d: %s\n",__FILE__,__LINE__,#cond); g_failures++; } }while(0)
+
+/* A season created ahead of its start ignores updates until it opens */
+static void window_future_origin(void)
+{
+    const int64_t day=86400;
+    const int64_t now=1700000000;
+    fossil_game_score_window_advance(now);
+
+    CHECK(fossil_game_score_window_create("season",now+3*day+10,day,7)==0);
+    CHECK(fossil_game_score_update("early",5)==0);
+
+    long long total=-1;
+    int rank=0;
+    CHECK(fossil_game_score_window_get("season","early",&total)==0 && total==0);
+    CHECK(fossil_game_score_window_rank("season","early",&rank)==-2);
+
+    /* step a day at a time across the origin */
+    for(int64_t t=now;t<now+3*day+10;t+=day){
+        fossil_game_score_window_advance(t);
+        CHECK(fossil_game_score_update("early",1)==0);
+    }
+    CHECK(fossil_game_score_window_count("season")==0);
+
+    fossil_game_score_window_advance(now+3*day+10);
+    CHECK(fossil_game_score_update("early",2)==0);
+    CHECK(fossil_game_score_update("late",3)==0);
+    CHECK(fossil_game_score_window_get("season","early",&total)==0 && total==2);
+    CHECK(fossil_game_score_window_rank("season","late",&rank)==0 && rank==1);
+    CHECK(fossil_game_score_window_count("season")==2);
+
+    /* the open window rolls over as usual */
+    fossil_game_score_window_advance(now+11*day);
+    CHECK(fossil_game_score_window_count("season")==0);
+    CHECK(fossil_game_score_window_destroy("season")==0);
+}
+
+int main(void)
+{
+    window_future_origin();
+    return g_failures?1:0;
+}
@@ -0,0 +1,217 @@
+/**
+ * -----------------------------------------------------------------------------
+ * Project: Fossil Logic
+ *
+ * This file is part of the Fossil Logic project, which aims to develop
+ * high-performance, cross-platform applications and libraries. The code
+ * contained herein is licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License. You may obtain
+ * a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ * Author: Michael Gene Brockus (Dreamer)
+ * Date: 04/05/2014
+ *
+ * Copyright (C) 2014-2025 Fossil Logic. All rights reserved.
+ * -----------------------------------------------------------------------------
+ */
+#include "fossil/game/framework.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Replication round trip: a client mirror fed a full state and then a run
+ * of deltas must match the live session after every tick.
+ */
+
+static int g_failures=0;
+
+#define CHECK(cond) do{ if(!(cond)){ printf("%s:%d: %s\n",__FILE__,__LINE__,#cond); g_failures++; } }while(0)
+
+#define PLAYERS 48
+
+static unsigned char g_buf[1<<20];
+
+typedef struct {
+    const fossil_game_sync_mirror* m;
+    const char* player;
+    int seen;
+    int bad;
+} match_ctx_t;
+
+static int match_item(const char* item_id,int count,void* ctx)
+{
+    match_ctx_t* c=ctx;
+    c->seen++;
+    if(fossil_game_sync_mirror_item_count(c->m,c->player,item_id)!=count) c->bad++;
+    return 0;
+}
+
+static int match_attr(const char* key,int type,const void* data,size_t len,void* ctx)
+{
+    match_ctx_t* c=ctx;
+    int mtype=0;
+    const void* mdata=NULL;
+    size_t mlen=0;
+
+    c->seen++;
+    if(fossil_game_sync_mirror_attr(c->m,c->player,key,&mtype,&mdata,&mlen)!=0 ||
+       mtype!=type || mlen!=len || (len && memcmp(mdata,data,len)!=0))
+        c->bad++;
+    return 0;
+}
+
+static int count_item(const char* item_id,int count,void* ctx){ (void)item_id; (void)count; ++*(int*)ctx; return 0; }
+static int count_attr(const char* key,int type,const void* data,size_t len,void* ctx){ (void)key; (void)type; (void)data; (void)len; ++*(int*)ctx; return 0; }
+
+static int match_player(const char* player_id,void* ctx)
+{
+    const fossil_game_sync_mirror* m=ctx;
+    int live=0,mirrored=-1,n=0;
+
+    fossil_game_score_get(player_id,&live);
+    if(fossil_game_sync_mirror_score(m,player_id,&mirrored)!=0 || live!=mirrored){
+        printf("  %s: score %d, mirror %d\n",player_id,live,mirrored);
+        g_failures++;
+    }
+
+    match_ctx_t c={m,player_id,0,0};
+    fossil_game_player_inventory_foreach(player_id,match_item,&c);
+    fossil_game_sync_mirror_items(m,player_id,count_item,&n);
+    if(c.bad || n!=c.seen){
+        printf("  %s: inventory differs\n",player_id);
+        g_failures++;
+    }
+
+    c.seen=c.bad=n=0;
+    fossil_game_player_attr_foreach(player_id,match_attr,&c);
+    fossil_game_sync_mirror_attrs(m,player_id,count_attr,&n);
+    if(c.bad || n!=c.seen){
+        printf("  %s: attributes differ\n",player_id);
+        g_failures++;
+    }
+    return 0;
+}
+
+static void match_session(const fossil_game_sync_mirror* m)
+{
+    CHECK(fossil_game_sync_mirror_count(m)==fossil_game_player_session_count("rt"));
+    fossil_game_player_foreach_in_session("rt",match_player,(void*)m);
+}
+
+/* capture, encode for the client, apply to its mirror and ack */
+static uint32_t step(fossil_game_sync_mirror* m,const char* client,size_t* out_len)
+{
+    uint32_t tick=0,applied=0;
+    size_t n=0;
+
+    CHECK(fossil_game_sync_capture("rt",&tick)==0);
+    CHECK(fossil_game_sync_encode("rt",client,g_buf,sizeof(g_buf),&n)==0);
+    CHECK(fossil_game_sync_apply(m,g_buf,n,&applied)==0);
+    CHECK(applied==tick);
+    CHECK(fossil_game_sync_ack("rt",client,applied)==0);
+    if(out_len) *out_len=n;
+    return tick;
+}
+
+static void mutate(int t)
+{
+    char id[32],key[32];
+
+    for(int k=0;k<12;k++){
+        snprintf(id,sizeof(id),"p%d",rand()%PLAYERS);
+        snprintf(key,sizeof(key),"k%d",rand()%6);
+
+        switch(rand()%9){
+        case 0: fossil_game_score_update(id,1+rand()%50); break;
+        case 1: fossil_game_player_inventory_add(id,"potion",1+rand()%3); break;
+        case 2: fossil_game_player_inventory_remove(id,"potion",1); break;
+        case 3: fossil_game_player_set_int(id,key,(int64_t)rand()-RAND_MAX/2); break;
+        case 4: fossil_game_player_set_float(id,key,rand()/7.0); break;
+        case 5: fossil_game_player_set_string(id,key,t%2?"":"north gate"); break;
+        case 6: fossil_game_player_set_blob(id,key,&t,sizeof(t)); break;
+        case 7: fossil_game_player_unset_attr(id,key); break;
+        case 8:
+            if(fossil_game_player_get_session(id)) fossil_game_player_leave_session(id);
+            else fossil_game_player_join_session(id,"rt");
+            break;
+        }
+    }
+}
+
+static void round_trip(void)
+{
+    char id[32];
+    srand(7);
+
+    for(int i=0;i<PLAYERS;i++){
+        snprintf(id,sizeof(id),"p%d",i);
+        fossil_game_player_create(id);
+        if(i%4) fossil_game_player_join_session(id,"rt");
+        fossil_game_score_update(id,i*10);
+        fossil_game_player_inventory_add(id,"arrow",1+i%7);
+        fossil_game_player_set_int(id,"level",i);
+        fossil_game_player_set_string(id,"class",i%2?"mage":"rogue");
+    }
+
+    fossil_game_sync_mirror* m=fossil_game_sync_mirror_create();
+    fossil_game_sync_mirror* late=fossil_game_sync_mirror_create();
+    CHECK(m && late);
+
+    size_t full=0,delta=0;
+    step(m,"c0",&full);
+    match_session(m);
+
+    for(int t=0;t<40;t++){
+        mutate(t);
+        step(m,"c0",&delta);
+        match_session(m);
+    }
+    CHECK(delta<full);
+
+    /* a client joining late starts from a full state and follows deltas */
+    step(late,"c1",NULL);
+    mutate(99);
+    step(late,"c1",NULL);
+    match_session(late);
+
+    /* an update the client never applied cannot be layered on the mirror */
+    uint32_t tick=0;
+    size_t n=0;
+    mutate(100);
+    CHECK(fossil_game_sync_capture("rt",&tick)==0);
+    CHECK(fossil_game_sync_encode("rt","c1",g_buf,sizeof(g_buf),&n)==0);
+    mutate(101);
+    step(m,"c0",NULL);
+    CHECK(fossil_game_sync_apply(m,g_buf,n,NULL)==-5);
+    match_session(m);
+
+    /* truncated input is rejected and leaves the state in place */
+    step(late,"c1",NULL);
+    mutate(102);
+    CHECK(fossil_game_sync_capture("rt",&tick)==0);
+    CHECK(fossil_game_sync_encode("rt","c1",g_buf,sizeof(g_buf),&n)==0);
+    uint32_t before=fossil_game_sync_mirror_tick(late);
+    CHECK(fossil_game_sync_apply(late,g_buf,n-1,NULL)==-2);
+    CHECK(fossil_game_sync_mirror_tick(late)==before);
+    CHECK(fossil_game_sync_apply(late,g_buf,n,NULL)==0);
+    match_session(late);
+
+    fossil_game_sync_mirror_free(m);
+    fossil_game_sync_mirror_free(late);
+    fossil_game_sync_release("rt");
+}
+
+int main(void)
+{
+    round_trip();
+    return g_failures?1:0;
+}